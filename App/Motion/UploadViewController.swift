@@ -48,6 +48,13 @@ class UploadViewController: FormViewController {
 //                APIClient.shared.upload(predictionAggregator: aggregator, withMetadata: metadata)
                 APIClient.shared.uploadPredictionAggregators([aggregator])
                 
+                // keep a trace of the session around for replaying through the classifier
+                if let documentsURL = FileManager.default.urls(for: .documentDirectory, in: .userDomainMask).first {
+                    let tracesURL = documentsURL.appendingPathComponent("Traces")
+                    try? FileManager.default.createDirectory(at: tracesURL, withIntermediateDirectories: true, attributes: nil)
+                    aggregator.writeSensorTrace(to: tracesURL.appendingPathComponent(UUID().uuidString + ".trace"))
+                }
+                
                 strongSelf.navigationController?.popToRootViewController(animated: true)
             }
         }
@@ -10,6 +10,7 @@ import Foundation
 import HealthKit
 import CoreData
 import CocoaLumberjack
+import RouteRecorder
 
 enum HealthKitManagerAuthorizationStatus {
     case notDetermined
@@ -152,6 +153,22 @@ class HealthKitManager {
         self.healthStore.execute(query)
     }
     
+    // The trip's fixes, each with the heart rate around it from HealthKit and the motion intensity from the phone.
+    func getEnrichedLocations(for trip: Trip, completionHandler:@escaping ([LocationEnrichment])->Void) {
+        guard let route = trip.route else {
+            completionHandler([])
+            return
+        }
+        
+        self.getHeartRateSamples(trip.startDate, endDate: trip.endDate) { (samples) -> Void in
+            let heartRates = (samples ?? []).map { (date: $0.startDate, beatsPerMinute: $0.quantity.doubleValue(for: HKUnit(from:"count/min"))) }
+            
+            DispatchQueue.main.async {
+                completionHandler(route.enrichedLocations(heartRates: heartRates))
+            }
+        }
+    }
+    
     func getAge() {
         do {
             let dob = try self.healthStore.dateOfBirth()
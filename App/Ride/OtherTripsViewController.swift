@@ -276,12 +276,6 @@ class OtherTripsViewController: UIViewController, UITableViewDataSource, UITable
 //                }))
 //                alertController.addAction(UIAlertAction(title: "Simulate Ride End", style: UIAlertActionStyle.default, handler: { (_) in
 //                    trip.sendTripCompletionNotificationLocally(secondsFromNow:5.0)
-//                }))
-//                alertController.addAction(UIAlertAction(title: "Re-Classify", style: UIAlertActionStyle.default, handler: { (_) in
-//                    for prediction in trip.predictionAggregators {
-//                        //RouteRecorder.shared.randomForestManager.classify(prediction)
-//                    }
-//                    //trip.calculateAggregatePredictedActivityType()
 //                }))
             alertController.addAction(UIAlertAction(title: "Sync to Health App", style: UIAlertAction.Style.default, handler: { (_) in
                 var backgroundTaskID: UIBackgroundTaskIdentifier = UIBackgroundTaskIdentifier.invalid
@@ -17,13 +17,13 @@
                 return nil
             }
             
-            guard let firstReading = self.fetchFirstReading(afterDate:firstPrediction.startDate) else {
+            guard let firstReadingDate = self.firstReadingDate(onOrAfter: firstPrediction.startDate) else {
                 return nil
             }
             
             let context = CoreDataManager.shared.currentManagedObjectContext()
             let fetchedRequest = NSFetchRequest<NSFetchRequestResult>(entityName: "Location")
-            fetchedRequest.predicate = NSPredicate(format: "route == %@ AND (date >= %@)", route, firstReading.date as CVarArg)
+            fetchedRequest.predicate = NSPredicate(format: "route == %@ AND (date >= %@)", route, firstReadingDate as CVarArg)
             fetchedRequest.sortDescriptors = [NSSortDescriptor(key: "date", ascending: true)]
             fetchedRequest.fetchLimit = 1
             
@@ -689,14 +689,37 @@ class TripsViewController: UIViewController, UITableViewDataSource, UITableViewD
                 alertController.addAction(UIAlertAction(title: "〰 Re-simplifiy", style: UIAlertAction.Style.default, handler: { (_) in
                     route.resimplify()
                 }))
+                alertController.addAction(UIAlertAction(title: "〰 Compare Simplification", style: UIAlertAction.Style.default, handler: { (_) in
+                    let comparison = route.compareSimplification()
+                    let message = String(format: "%i locations\nWhole route: %i kept, off by up to %.6f° and %.1f m/s\nStreaming: %i kept, off by up to %.6f° and %.1f m/s",
+                                         comparison.locationCount,
+                                         comparison.keptCount, comparison.maximumDistance, comparison.maximumSpeedDifference,
+                                         comparison.streamingKeptCount, comparison.streamingMaximumDistance, comparison.streamingMaximumSpeedDifference)
+                    let comparisonAlertController = UIAlertController(title: "〰 Simplification", message: message, preferredStyle: UIAlertController.Style.alert)
+                    comparisonAlertController.addAction(UIAlertAction(title: "k", style: UIAlertAction.Style.cancel, handler: nil))
+                    self.present(comparisonAlertController, animated: true, completion: nil)
+                }))
                 alertController.addAction(UIAlertAction(title: "🏁 Simulate Ride End", style: UIAlertAction.Style.default, handler: { (_) in
                     trip.sendTripCompletionNotificationLocally(secondsFromNow:5.0)
                 }))
                 alertController.addAction(UIAlertAction(title: "⚙️ Re-Classify", style: UIAlertAction.Style.default, handler: { (_) in
-//                    for prediction in route.predictionAggregators {
-//                        RouteRecorder.shared.randomForestManager.classify(prediction)
-//                    }
-//                    route.calculateAggregatePredictedActivityType()
+                    // a one-off run, so there's nothing to resume and any identifier will do
+                    let reclassifier = PredictionReclassifier(modelIdentifier: UUID().uuidString, route: route) { () -> ConcurrentAccelerometerWindowClassifier? in
+                        let randomForestManager = RandomForestManager()
+                        randomForestManager.startup()
+                        return randomForestManager.canPredict ? randomForestManager : nil
+                    }
+                    reclassifier.start(completionHandler: { (progress) in
+                        guard progress.reclassifiedCount > 0 else {
+                            let failedAlertController = UIAlertController(title: "⚙️ Re-Classify", message: "Nothing was re-classified. Either the model isn't loaded or the trip has no readings.", preferredStyle: UIAlertController.Style.alert)
+                            failedAlertController.addAction(UIAlertAction(title: "k", style: UIAlertAction.Style.cancel, handler: nil))
+                            self.present(failedAlertController, animated: true, completion: nil)
+                            return
+                        }
+                        
+                        route.reclose()
+                        trip.activityType = route.activityType
+                    })
                 }))
                 
                 alertController.addAction(UIAlertAction(title: "❤️ Sync to Health App", style: UIAlertAction.Style.default, handler: { (_) in
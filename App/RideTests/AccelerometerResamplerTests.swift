@@ -0,0 +1,344 @@
+//
+//  AccelerometerResamplerTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+import RouteRecorder
+import CoreMotion
+import CocoaLumberjack
+
+@testable import RouteRecorder
+
+class AccelerometerResamplerTests: XCTestCase {
+    // a deterministic, continuous-time stand-in for a recorded session so every rate samples the same motion
+    struct SyntheticSession {
+        let name: String
+        let fundamental: Double // hz
+        let amplitude: Double // g's
+        let noise: Double // g's
+
+        func acceleration(at t: TimeInterval, seed: inout UInt64)->CMAcceleration {
+            let phase = 2 * Double.pi * self.fundamental * t
+            let bounce = self.amplitude * (sin(phase) + 0.3 * sin(2 * phase + 0.5))
+            let sway = 0.5 * self.amplitude * sin(phase / 2)
+
+            return CMAcceleration(x: sway + self.noise * AccelerometerResamplerTests.nextNoise(&seed),
+                                  y: -1.0 + bounce + self.noise * AccelerometerResamplerTests.nextNoise(&seed),
+                                  z: 0.2 * bounce + self.noise * AccelerometerResamplerTests.nextNoise(&seed))
+        }
+    }
+
+    static let sessions = [SyntheticSession(name: "walking", fundamental: 1.9, amplitude: 0.35, noise: 0.02),
+                           SyntheticSession(name: "cycling", fundamental: 1.3, amplitude: 0.12, noise: 0.05),
+                           SyntheticSession(name: "automotive", fundamental: 0.4, amplitude: 0.03, noise: 0.03),
+                           SyntheticSession(name: "stationary", fundamental: 0.1, amplitude: 0.002, noise: 0.002)]
+
+    static let sessionDuration: TimeInterval = 30
+    static let timestampJitter: TimeInterval = 0.002 // roughly what CoreMotion delivers in the background
+
+    // a walk recorded at the model rate, one of the misclassified walking trips, so the benchmarks run on real motion
+    static let recordedSessionTripUUID = "1862060e-3f19-407b-9ea6-7afccb5cbd70"
+
+    static func nextNoise(_ seed: inout UInt64)->Double {
+        seed = seed &* 6364136223846793005 &+ 1442695040888963407
+        return Double(seed >> 11) / Double(UInt64(1) << 53) * 2 - 1
+    }
+
+    override func setUp() {
+        DDLog.add(DDTTYLogger.sharedInstance)
+        RouteRecorderDatabaseManager.startup(true)
+
+        RouteRecorder.inject(motionManager: CMMotionManager(),
+                             locationManager: LocationManager(type: .gpx),
+                             routeManager: RouteManager(),
+                             randomForestManager: RandomForestManager(),
+                             classificationManager: TestClassificationManager())
+        RouteRecorder.shared.randomForestManager.startup()
+    }
+
+    override func tearDown() {
+    }
+
+    // samples a session the way CoreMotion would at the given rate, with jittered timestamps
+    func sample(_ session: SyntheticSession, rate: Double)->[(timestamp: TimeInterval, acceleration: CMAcceleration)] {
+        var seed: UInt64 = 42
+        var jitterSeed: UInt64 = UInt64(rate)
+        var samples: [(timestamp: TimeInterval, acceleration: CMAcceleration)] = []
+
+        let count = Int(AccelerometerResamplerTests.sessionDuration * rate)
+        for i in 0..<count {
+            let jitter = rate == SensorClassificationManager.modelSampleRate ? 0 : AccelerometerResamplerTests.timestampJitter * AccelerometerResamplerTests.nextNoise(&jitterSeed)
+            let timestamp = 1000 + Double(i) / rate + jitter
+            samples.append((timestamp: timestamp, acceleration: session.acceleration(at: timestamp, seed: &seed)))
+        }
+
+        return samples
+    }
+
+    // the recorded walk's accelerometer readings, in date order since they were uploaded out of it
+    func recordedSession()->[(timestamp: TimeInterval, acceleration: CMAcceleration)]? {
+        guard let path = Bundle(for: type(of: self)).path(forResource: "Misclassified Walking Trips", ofType: nil),
+            let tripData = try? Data(contentsOf: URL(fileURLWithPath: path).appendingPathComponent(AccelerometerResamplerTests.recordedSessionTripUUID + ".json")),
+            let trip = (try? JSONSerialization.jsonObject(with: tripData, options: [])) as? [String: Any],
+            let predictionAggregators = (trip["prediction_aggregators"] as? [String: Any])?["prediction_aggregators"] as? [[String: Any]] else {
+            XCTFail("Missing recorded session!")
+            return nil
+        }
+
+        var samples: [(timestamp: TimeInterval, acceleration: CMAcceleration)] = []
+        for predictionAggregator in predictionAggregators {
+            for reading in predictionAggregator["accelerometerReadings"] as? [[String: Any]] ?? [] {
+                guard let dateString = reading["date"] as? String, let date = Date.dateFromJSONString(dateString),
+                    let x = reading["x"] as? Double, let y = reading["y"] as? Double, let z = reading["z"] as? Double else {
+                    continue
+                }
+                samples.append((timestamp: date.timeIntervalSinceReferenceDate, acceleration: CMAcceleration(x: x, y: y, z: z)))
+            }
+        }
+
+        return samples.sorted { $0.timestamp < $1.timestamp }
+    }
+
+    // The recorded walk the way CoreMotion would have delivered it at the given rate: every few readings below the
+    // model rate, or with readings interpolated halfway between them above it. Played back end to end until it lasts
+    // duration, starting from the same timestamp as the synthetic sessions.
+    func recordedSession(rate: Double, duration: TimeInterval)->[(timestamp: TimeInterval, acceleration: CMAcceleration)]? {
+        guard let recording = self.recordedSession(), let firstTimestamp = recording.first?.timestamp, let lastTimestamp = recording.last?.timestamp else {
+            return nil
+        }
+
+        var readings: [(timestamp: TimeInterval, acceleration: CMAcceleration)] = []
+        if rate > SensorClassificationManager.modelSampleRate {
+            for (i, reading) in recording.enumerated() {
+                readings.append(reading)
+                if i + 1 < recording.count {
+                    let next = recording[i + 1]
+                    readings.append((timestamp: (reading.timestamp + next.timestamp) / 2,
+                                     acceleration: CMAcceleration(x: (reading.acceleration.x + next.acceleration.x) / 2, y: (reading.acceleration.y + next.acceleration.y) / 2, z: (reading.acceleration.z + next.acceleration.z) / 2)))
+                }
+            }
+        } else {
+            readings = stride(from: 0, to: recording.count, by: Int(SensorClassificationManager.modelSampleRate / rate)).map { recording[$0] }
+        }
+
+        let playbackDuration = lastTimestamp - firstTimestamp + 1 / SensorClassificationManager.modelSampleRate
+        var samples: [(timestamp: TimeInterval, acceleration: CMAcceleration)] = []
+        var playbackOffset: TimeInterval = 0
+        while playbackOffset < duration {
+            for reading in readings where reading.timestamp - firstTimestamp + playbackOffset < duration {
+                samples.append((timestamp: 1000 + reading.timestamp - firstTimestamp + playbackOffset, acceleration: reading.acceleration))
+            }
+            playbackOffset += playbackDuration
+        }
+
+        return samples
+    }
+
+    func resample(_ samples: [(timestamp: TimeInterval, acceleration: CMAcceleration)], rate: Double)->[(timestamp: TimeInterval, acceleration: CMAcceleration)] {
+        let resampler = AccelerometerResampler(inputSampleRate: rate, outputSampleRate: SensorClassificationManager.modelSampleRate)
+        var resampled: [(timestamp: TimeInterval, acceleration: CMAcceleration)] = []
+        for sample in samples {
+            resampled.append(contentsOf: resampler.resample(timestamp: sample.timestamp, acceleration: sample.acceleration))
+        }
+        resampled.append(contentsOf: resampler.flush())
+
+        return resampled
+    }
+
+    func topActivityType(_ samples: [(timestamp: TimeInterval, acceleration: CMAcceleration)])->ActivityType? {
+        guard let firstTimestamp = samples.first?.timestamp else {
+            return nil
+        }
+
+        let predictionAggregator = PredictionAggregator()
+        let referenceDate = Date()
+        for sample in samples {
+            let reading = AccelerometerReading(acceleration: sample.acceleration)
+            reading.date = referenceDate.addingTimeInterval(sample.timestamp - firstTimestamp)
+            reading.predictionAggregator = predictionAggregator
+        }
+
+        let prediction = Prediction()
+        prediction.startDate = referenceDate
+        prediction.predictionAggregator = predictionAggregator
+        RouteRecorderDatabaseManager.shared.saveContext()
+
+        RouteRecorder.shared.randomForestManager.classify(prediction)
+
+        return prediction.fetchTopPredictedActivity()?.activityType
+    }
+
+    // Classifies the samples the way a prediction session does: resampled to the model rate, written to a sample
+    // buffer and handed to the forest a window at a time, every sampleOffsetTimeInterval from half a second past
+    // origin so the resampler's run-up is left out. Returns each window's top activity.
+    func classifyWindows(_ samples: [(timestamp: TimeInterval, acceleration: CMAcceleration)], rate: Double, origin: TimeInterval, forest: RandomForestManager)->[ActivityType?] {
+        let modelRateSamples = rate == SensorClassificationManager.modelSampleRate ? samples : self.resample(samples, rate: rate)
+        let sampleBuffer = AccelerometerSampleBuffer(sampleRate: SensorClassificationManager.modelSampleRate)
+        XCTAssertTrue(sampleBuffer.write(modelRateSamples.map { (timestamp: sampleBuffer.referenceTimestamp + $0.timestamp - origin, acceleration: $0.acceleration) }))
+
+        var activityTypes: [ActivityType?] = []
+        var windowStartDate = sampleBuffer.referenceDate.addingTimeInterval(0.5)
+        while let activityType = sampleBuffer.withWindow(from: windowStartDate, duration: forest.desiredSessionDuration, { (window) in forest.predictedActivities(forWindow: window).first?.activityType }) {
+            activityTypes.append(activityType)
+            windowStartDate = windowStartDate.addingTimeInterval(PredictionAggregator.sampleOffsetTimeInterval)
+        }
+
+        return activityTypes
+    }
+
+    func testResampledRecordingIsClassifiedLikeTheRecording() {
+        let forest = RouteRecorder.shared.randomForestManager!
+        XCTAssertTrue(forest.canPredict, "The random forest model didn't load!")
+        guard let baselineSamples = self.recordedSession(rate: SensorClassificationManager.modelSampleRate, duration: AccelerometerResamplerTests.sessionDuration), let origin = baselineSamples.first?.timestamp else {
+            return
+        }
+        let baselineActivityTypes = self.classifyWindows(baselineSamples, rate: SensorClassificationManager.modelSampleRate, origin: origin, forest: forest)
+        XCTAssertGreaterThan(baselineActivityTypes.count, 50)
+
+        // 10hz aliases the walk's harmonics, so it's only held to a looser bound
+        for (rate, minimumAgreement) in [(100.0, 0.9), (25.0, 0.9), (10.0, 0.75)] {
+            guard let samples = self.recordedSession(rate: rate, duration: AccelerometerResamplerTests.sessionDuration) else {
+                return
+            }
+            let activityTypes = self.classifyWindows(samples, rate: rate, origin: origin, forest: forest)
+            let comparedCount = min(activityTypes.count, baselineActivityTypes.count)
+            let agreeingCount = zip(activityTypes, baselineActivityTypes).filter { $0.0 != nil && $0.0 == $0.1 }.count
+            let agreement = Double(agreeingCount) / Double(max(1, comparedCount))
+            print(String(format: "recorded walk at %.0fhz: %d windows, %.0f%% classified like the recording", rate, comparedCount, agreement * 100))
+
+            XCTAssertGreaterThanOrEqual(comparedCount, baselineActivityTypes.count - 2)
+            XCTAssertGreaterThanOrEqual(agreement, minimumAgreement)
+        }
+    }
+
+    func testResampledSessionsMatchModelRate() {
+        for session in AccelerometerResamplerTests.sessions {
+            let baselineActivityType = self.topActivityType(self.sample(session, rate: SensorClassificationManager.modelSampleRate))
+
+            for rate in AccelerometerResampler.supportedInputSampleRates {
+                let samples = self.sample(session, rate: rate)
+
+                let start = ProcessInfo.processInfo.systemUptime
+                let resampled = self.resample(samples, rate: rate)
+                let elapsed = ProcessInfo.processInfo.systemUptime - start
+
+                // the output should land on the model's grid and track the underlying motion
+                var seed: UInt64 = 7
+                var squaredError: Double = 0
+                for (i, output) in resampled.enumerated() {
+                    if i > 0 {
+                        XCTAssertEqual(output.timestamp - resampled[i - 1].timestamp, 1/SensorClassificationManager.modelSampleRate, accuracy: 1e-4)
+                    }
+                    let expected = SyntheticSession(name: session.name, fundamental: session.fundamental, amplitude: session.amplitude, noise: 0).acceleration(at: output.timestamp, seed: &seed)
+                    squaredError += pow(output.acceleration.y - expected.y, 2)
+                }
+                let rmsError = sqrt(squaredError / Double(max(1, resampled.count)))
+
+                let activityType = self.topActivityType(resampled)
+                print(String(format: "%@ at %.0fhz: %d samples in %.2fms, rms error %.4fg, classified %@ (baseline %@)", session.name, rate, resampled.count, elapsed * 1000, rmsError, activityType?.emoji ?? "-", baselineActivityType?.emoji ?? "-"))
+
+                XCTAssertEqual(Double(resampled.count), AccelerometerResamplerTests.sessionDuration * SensorClassificationManager.modelSampleRate, accuracy: 2)
+                XCTAssertLessThan(rmsError, 2 * session.noise + 0.02)
+                if rate >= 25 {
+                    // 10hz aliases walking harmonics, so only the faster rates are expected to always agree
+                    XCTAssertEqual(activityType, baselineActivityType)
+                }
+            }
+        }
+    }
+
+    func testResampledRecordingTracksTheRecording() {
+        guard let recording = self.recordedSession(), recording.count > 300 else {
+            XCTFail("Recorded session is too short!")
+            return
+        }
+        let duration = recording.last!.timestamp - recording.first!.timestamp
+        guard let reference = self.recordedSession(rate: SensorClassificationManager.modelSampleRate, duration: duration) else {
+            return
+        }
+
+        // 10hz aliases the walk's harmonics, so it's only held to a looser bound
+        for (rate, maximumError) in [(25.0, 0.05), (10.0, 0.15)] {
+            guard let samples = self.recordedSession(rate: rate, duration: duration) else {
+                return
+            }
+            let resampled = self.resample(samples, rate: rate)
+
+            // against the recording itself, interpolated onto each output, leaving out the filter's run-up at either end
+            var squaredError: Double = 0
+            var comparedCount = 0
+            var referenceIndex = 1
+            for output in resampled where output.timestamp > reference.first!.timestamp + 0.5 && output.timestamp < reference.last!.timestamp - 0.5 {
+                while reference[referenceIndex].timestamp < output.timestamp {
+                    referenceIndex += 1
+                }
+                let before = reference[referenceIndex - 1]
+                let after = reference[referenceIndex]
+                let weight = (output.timestamp - before.timestamp) / (after.timestamp - before.timestamp)
+                let expectedY = before.acceleration.y + weight * (after.acceleration.y - before.acceleration.y)
+                squaredError += pow(output.acceleration.y - expectedY, 2)
+                comparedCount += 1
+            }
+            let rmsError = sqrt(squaredError / Double(max(1, comparedCount)))
+            print(String(format: "recorded walk at %.0fhz: %d samples, rms error %.4fg", rate, resampled.count, rmsError))
+
+            XCTAssertGreaterThan(comparedCount, 300)
+            XCTAssertLessThan(rmsError, maximumError)
+        }
+    }
+
+    func measureResampling(rate: Double) {
+        guard let samples = self.recordedSession(rate: rate, duration: AccelerometerResamplerTests.sessionDuration) else {
+            return
+        }
+        XCTAssertEqual(Double(samples.count), AccelerometerResamplerTests.sessionDuration * rate, accuracy: rate)
+
+        self.measure {
+            _ = self.resample(samples, rate: rate)
+        }
+    }
+
+    // the whole path a prediction session takes at this rate: resampling, buffering and the forest
+    func measureClassification(rate: Double) {
+        let forest = RouteRecorder.shared.randomForestManager!
+        XCTAssertTrue(forest.canPredict, "The random forest model didn't load!")
+        guard let samples = self.recordedSession(rate: rate, duration: AccelerometerResamplerTests.sessionDuration), let origin = samples.first?.timestamp else {
+            return
+        }
+
+        self.measure {
+            XCTAssertGreaterThan(self.classifyWindows(samples, rate: rate, origin: origin, forest: forest).count, 0)
+        }
+    }
+
+    func testClassificationPerformance10hz() {
+        self.measureClassification(rate: 10)
+    }
+
+    func testClassificationPerformance25hz() {
+        self.measureClassification(rate: 25)
+    }
+
+    func testClassificationPerformance50hz() {
+        self.measureClassification(rate: SensorClassificationManager.modelSampleRate)
+    }
+
+    func testClassificationPerformance100hz() {
+        self.measureClassification(rate: 100)
+    }
+
+    func testResamplingPerformance10hz() {
+        self.measureResampling(rate: 10)
+    }
+
+    func testResamplingPerformance25hz() {
+        self.measureResampling(rate: 25)
+    }
+
+    func testResamplingPerformance100hz() {
+        self.measureResampling(rate: 100)
+    }
+}
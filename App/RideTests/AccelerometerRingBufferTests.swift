@@ -0,0 +1,153 @@
+//
+//  AccelerometerRingBufferTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+
+@testable import RouteRecorder
+
+class AccelerometerRingBufferTests: XCTestCase {
+    static let capacity = 16
+    static let maximumSpanCount = 4
+
+    var ringBuffer: OpaquePointer!
+
+    override func setUp() {
+        self.ringBuffer = createAccelerometerRingBuffer(Int32(AccelerometerRingBufferTests.capacity), Int32(AccelerometerRingBufferTests.maximumSpanCount))
+    }
+
+    override func tearDown() {
+        deleteAccelerometerRingBuffer(self.ringBuffer)
+    }
+
+    // Each sample carries its own sequence number, so whatever is read back can be checked against where it came from.
+    func samples(from sequence: Int64, count: Int)->[AccelerometerSample] {
+        return (0..<count).map { (i)->AccelerometerSample in
+            let value = Float(sequence + Int64(i))
+            return AccelerometerSample(t: value, x: value, y: 0, z: 0)
+        }
+    }
+
+    @discardableResult func write(_ ringBuffer: OpaquePointer, from sequence: Int64, count: Int)->Int {
+        return Int(accelerometerRingBufferWrite(ringBuffer, self.samples(from: sequence, count: count), Int32(count)))
+    }
+
+    func spanSequences(_ ringBuffer: OpaquePointer, from sequence: Int64, count: Int)->[Int64]? {
+        guard let span = accelerometerRingBufferSpan(ringBuffer, sequence, Int32(count)) else {
+            return nil
+        }
+        return UnsafeBufferPointer(start: span, count: count).map { Int64($0.x) }
+    }
+
+    func testCapacityIsRoundedUpToAPowerOfTwo() {
+        let ringBuffer = createAccelerometerRingBuffer(10, 4)!
+        defer { deleteAccelerometerRingBuffer(ringBuffer) }
+
+        XCTAssertEqual(self.write(ringBuffer, from: 0, count: 20), 16)
+        XCTAssertEqual(accelerometerRingBufferWriteSequence(ringBuffer), 16)
+        XCTAssertEqual(accelerometerRingBufferDroppedCount(ringBuffer), 4)
+    }
+
+    func testFullRingDropsAndCountsTheRest() {
+        XCTAssertEqual(self.write(self.ringBuffer, from: 0, count: AccelerometerRingBufferTests.capacity), AccelerometerRingBufferTests.capacity)
+        XCTAssertEqual(accelerometerRingBufferDroppedCount(self.ringBuffer), 0)
+
+        // nothing fits, and nothing already retained is overwritten
+        XCTAssertEqual(self.write(self.ringBuffer, from: 16, count: 3), 0)
+        XCTAssertEqual(accelerometerRingBufferDroppedCount(self.ringBuffer), 3)
+        XCTAssertEqual(accelerometerRingBufferWriteSequence(self.ringBuffer), 16)
+        XCTAssertEqual(self.spanSequences(self.ringBuffer, from: 0, count: 4)!, [0, 1, 2, 3])
+
+        // consuming makes room for exactly as many as were consumed
+        accelerometerRingBufferConsume(self.ringBuffer, 2)
+        XCTAssertEqual(self.write(self.ringBuffer, from: 16, count: 3), 2)
+        XCTAssertEqual(accelerometerRingBufferDroppedCount(self.ringBuffer), 4)
+        XCTAssertEqual(accelerometerRingBufferWriteSequence(self.ringBuffer), 18)
+        XCTAssertEqual(self.spanSequences(self.ringBuffer, from: 14, count: 4)!, [14, 15, 16, 17])
+    }
+
+    func testSpansAcrossTheWraparound() {
+        // writes in steps that don't divide the capacity, so every span straddles the end of the storage at some point
+        var writeSequence: Int64 = 0
+        for _ in 0..<40 {
+            XCTAssertEqual(self.write(self.ringBuffer, from: writeSequence, count: 5), 5)
+            writeSequence += 5
+            XCTAssertEqual(accelerometerRingBufferWriteSequence(self.ringBuffer), writeSequence)
+
+            let readSequence = accelerometerRingBufferReadSequence(self.ringBuffer)
+            var sequence = readSequence
+            while sequence + Int64(AccelerometerRingBufferTests.maximumSpanCount) <= writeSequence {
+                XCTAssertEqual(self.spanSequences(self.ringBuffer, from: sequence, count: AccelerometerRingBufferTests.maximumSpanCount)!, Array(sequence..<sequence + Int64(AccelerometerRingBufferTests.maximumSpanCount)))
+                sequence += 1
+            }
+
+            XCTAssertEqual(accelerometerRingBufferLowerBound(self.ringBuffer, Float(writeSequence) - 2.5), writeSequence - 2)
+            XCTAssertEqual(accelerometerRingBufferLowerBound(self.ringBuffer, Float(writeSequence) + 1), writeSequence)
+
+            accelerometerRingBufferConsume(self.ringBuffer, writeSequence - 3)
+        }
+        XCTAssertEqual(accelerometerRingBufferDroppedCount(self.ringBuffer), 0)
+    }
+
+    func testSpansOutsideTheRetainedSamplesAreRefused() {
+        self.write(self.ringBuffer, from: 0, count: 10)
+        accelerometerRingBufferConsume(self.ringBuffer, 3)
+
+        XCTAssertNil(accelerometerRingBufferSpan(self.ringBuffer, 2, 2)) // already consumed
+        XCTAssertNil(accelerometerRingBufferSpan(self.ringBuffer, 8, 3)) // not written yet
+        XCTAssertNil(accelerometerRingBufferSpan(self.ringBuffer, 3, Int32(AccelerometerRingBufferTests.maximumSpanCount + 1)))
+        XCTAssertNil(accelerometerRingBufferSpan(self.ringBuffer, 3, -1))
+        XCTAssertNotNil(accelerometerRingBufferSpan(self.ringBuffer, 6, 4))
+    }
+
+    func testConsumeNeverPassesTheWriteSequenceOrGoesBack() {
+        self.write(self.ringBuffer, from: 0, count: 10)
+
+        accelerometerRingBufferConsume(self.ringBuffer, 20)
+        XCTAssertEqual(accelerometerRingBufferReadSequence(self.ringBuffer), 10)
+
+        accelerometerRingBufferConsume(self.ringBuffer, 5)
+        XCTAssertEqual(accelerometerRingBufferReadSequence(self.ringBuffer), 10)
+        XCTAssertEqual(accelerometerRingBufferLowerBound(self.ringBuffer, 0), 10)
+    }
+
+    func testConcurrentProducerAndConsumer() {
+        let sampleCount: Int64 = 200000
+        let ringBuffer = createAccelerometerRingBuffer(64, 16)!
+        defer { deleteAccelerometerRingBuffer(ringBuffer) }
+
+        // the producer writes in runs that don't line up with the consumer's spans, retrying whatever didn't fit
+        let produced = self.expectation(description: "produced")
+        DispatchQueue.global(qos: .userInitiated).async {
+            var writeSequence: Int64 = 0
+            while writeSequence < sampleCount {
+                let count = Int(min(7, sampleCount - writeSequence))
+                writeSequence += Int64(self.write(ringBuffer, from: writeSequence, count: count))
+            }
+            produced.fulfill()
+        }
+
+        var readSequence: Int64 = 0
+        var mismatchCount = 0
+        while readSequence < sampleCount {
+            let writeSequence = accelerometerRingBufferWriteSequence(ringBuffer)
+            while readSequence < writeSequence {
+                // keep draining on a mismatch, or the producer would spin on a full ring
+                let count = Int(min(16, writeSequence - readSequence))
+                if self.spanSequences(ringBuffer, from: readSequence, count: count) ?? [] != Array(readSequence..<readSequence + Int64(count)) {
+                    mismatchCount += 1
+                }
+                readSequence += Int64(count)
+                accelerometerRingBufferConsume(ringBuffer, readSequence)
+            }
+        }
+
+        self.waitForExpectations(timeout: 10, handler: nil)
+        XCTAssertEqual(mismatchCount, 0)
+        XCTAssertEqual(accelerometerRingBufferWriteSequence(ringBuffer), sampleCount)
+        XCTAssertEqual(accelerometerRingBufferReadSequence(ringBuffer), sampleCount)
+    }
+}
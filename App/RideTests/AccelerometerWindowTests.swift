@@ -0,0 +1,235 @@
+//
+//  AccelerometerWindowTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+import RouteRecorder
+import CoreMotion
+import CocoaLumberjack
+
+@testable import RouteRecorder
+
+class AccelerometerWindowTests: XCTestCase {
+    var sampleBuffer: AccelerometerSampleBuffer!
+    var predictionAggregator: PredictionAggregator!
+    var predictionStartDates: [Date] = []
+    var desiredSessionDuration: TimeInterval = 0
+    
+    override func setUp() {
+        DDLog.add(DDTTYLogger.sharedInstance)
+        RouteRecorderDatabaseManager.startup(true)
+        
+        RouteRecorder.inject(motionManager: CMMotionManager(),
+                             locationManager: LocationManager(type: .gpx),
+                             routeManager: RouteManager(),
+                             randomForestManager: RandomForestManager(),
+                             classificationManager: TestClassificationManager())
+        RouteRecorder.shared.randomForestManager.startup()
+        
+        // a full prediction session: every prediction the aggregator could make before giving up
+        self.desiredSessionDuration = RouteRecorder.shared.randomForestManager.desiredSessionDuration
+        let sessionDuration = Double(PredictionAggregator.maximumSampleBeforeFailure - 1) * PredictionAggregator.sampleOffsetTimeInterval + self.desiredSessionDuration + 1
+        
+        self.sampleBuffer = AccelerometerSampleBuffer(sampleRate: SensorClassificationManager.modelSampleRate)
+        self.predictionAggregator = PredictionAggregator()
+        
+        var accelerations: [(timestamp: TimeInterval, acceleration: CMAcceleration)] = []
+        for i in 0..<Int(sessionDuration * SensorClassificationManager.modelSampleRate) {
+            let t = Double(i) / SensorClassificationManager.modelSampleRate
+            let phase = 2 * Double.pi * 1.9 * t // walking
+            accelerations.append((timestamp: self.sampleBuffer.referenceTimestamp + t, acceleration: CMAcceleration(x: 0.1 * sin(phase / 2), y: -1.0 + 0.35 * sin(phase), z: 0.07 * sin(phase))))
+        }
+        XCTAssertTrue(self.sampleBuffer.write(accelerations))
+        
+        self.sampleBuffer.persist { (samples) in
+            for sample in samples {
+                let reading = AccelerometerReading(acceleration: CMAcceleration(x: Double(sample.x), y: Double(sample.y), z: Double(sample.z)))
+                reading.date = self.sampleBuffer.date(of: sample)
+                reading.predictionAggregator = self.predictionAggregator
+                self.predictionAggregator.readingTimeIndex.append(reading.date)
+            }
+        }
+        RouteRecorderDatabaseManager.shared.saveContext()
+        
+        // offset slightly so no prediction starts exactly on a sample
+        self.predictionStartDates = (0..<PredictionAggregator.maximumSampleBeforeFailure).map { (i) in
+            self.sampleBuffer.referenceDate.addingTimeInterval(Double(i) * PredictionAggregator.sampleOffsetTimeInterval + 0.001)
+        }
+    }
+    
+    override func tearDown() {
+    }
+    
+    func prediction(startDate: Date)->Prediction {
+        let prediction = Prediction()
+        prediction.startDate = startDate
+        prediction.predictionAggregator = self.predictionAggregator
+        
+        return prediction
+    }
+    
+    // Does the same work on fetched readings as on a window and counts what it classified, so the benchmarks measure
+    // how samples get to a classifier rather than the forest itself, and fail if nothing reached it.
+    class SummingClassifier: AccelerometerWindowClassifier {
+        var classifiedCount = 0
+        var sum: Double = 0
+        
+        func classify(_ prediction: Prediction, readings: [AccelerometerReading]) {
+            for reading in readings {
+                self.sum += reading.x * reading.x + reading.y * reading.y + reading.z * reading.z
+            }
+            self.classifiedCount += 1
+        }
+        
+        func classify(_ prediction: Prediction, window: AccelerometerWindow) {
+            for sample in window.samples {
+                self.sum += Double(sample.x * sample.x + sample.y * sample.y + sample.z * sample.z)
+            }
+            self.classifiedCount += 1
+        }
+    }
+    
+    func fetchAndClassify(extractor: SpectralFeatureExtractor, classifier: SummingClassifier, predictions: [Prediction]) {
+        let classifiedCount = classifier.classifiedCount
+        for prediction in predictions {
+            let readings = prediction.fetchAccelerometerReadings(timeInterval: self.desiredSessionDuration)
+            prediction.spectralFeatures = extractor.features(forReadings: readings)
+            classifier.classify(prediction, readings: readings)
+        }
+        XCTAssertEqual(classifier.classifiedCount - classifiedCount, predictions.count)
+    }
+    
+    func viewAndClassify(extractor: SpectralFeatureExtractor, classifier: SummingClassifier, predictions: [Prediction]) {
+        let classifiedCount = classifier.classifiedCount
+        for prediction in predictions {
+            _ = self.sampleBuffer.withWindow(from: prediction.startDate, duration: self.desiredSessionDuration) { (window)->Void in
+                prediction.spectralFeatures = extractor.features(forWindow: window)
+                classifier.classify(prediction, window: window)
+            }
+        }
+        XCTAssertEqual(classifier.classifiedCount - classifiedCount, predictions.count)
+    }
+    
+    func testWindowsMatchPersistedReadings() {
+        let extractor = SpectralFeatureExtractor(sampleRate: SensorClassificationManager.modelSampleRate, windowDuration: self.desiredSessionDuration)
+        
+        for startDate in self.predictionStartDates {
+            let readings = self.prediction(startDate: startDate).fetchAccelerometerReadings(timeInterval: self.desiredSessionDuration)
+            let fetchedFeatures = extractor.features(forReadings: readings)
+            
+            let viewedFeatures = self.sampleBuffer.withWindow(from: startDate, duration: self.desiredSessionDuration) { (window)->[SpectralFeatures] in
+                XCTAssertEqual(window.startDate.timeIntervalSinceReferenceDate, readings.first!.date.timeIntervalSinceReferenceDate, accuracy: 1e-4)
+                XCTAssertEqual(window.duration, self.desiredSessionDuration, accuracy: 1/SensorClassificationManager.modelSampleRate)
+                return extractor.features(forWindow: window)
+            }
+            
+            XCTAssertNotNil(viewedFeatures)
+            for (fetched, viewed) in zip(fetchedFeatures, viewedFeatures ?? []) {
+                XCTAssertEqual(fetched.power, viewed.power, accuracy: 1e-4)
+                XCTAssertEqual(fetched.centroid, viewed.centroid, accuracy: 1e-4)
+                XCTAssertEqual(fetched.entropy, viewed.entropy, accuracy: 1e-4)
+            }
+        }
+    }
+    
+    func testForestClassifiesWindowsLikePersistedReadings() {
+        let forest = RouteRecorder.shared.randomForestManager!
+        XCTAssertTrue(forest.canPredict, "The random forest model didn't load!")
+        
+        for startDate in self.predictionStartDates {
+            let prediction = self.prediction(startDate: startDate)
+            forest.classify(prediction)
+            let fetchedActivity = prediction.predictedActivities.max { $0.confidence < $1.confidence }
+            
+            let viewedActivity = self.sampleBuffer.withWindow(from: startDate, duration: self.desiredSessionDuration) { (window) in
+                forest.predictedActivities(forWindow: window).first
+            }
+            
+            XCTAssertNotNil(fetchedActivity)
+            XCTAssertEqual(viewedActivity??.activityType, fetchedActivity?.activityType)
+            XCTAssertEqual(viewedActivity??.confidence ?? -1, fetchedActivity?.confidence ?? -1, accuracy: 0.05)
+        }
+    }
+    
+    func testWindowIsUnavailableUntilItHasArrived() {
+        let lastStartDate = self.predictionStartDates.last!.addingTimeInterval(10)
+        XCTAssertNil(self.sampleBuffer.withWindow(from: lastStartDate, duration: self.desiredSessionDuration) { (window) in window.samples.count })
+    }
+    
+    func testFetchAndClassifyPerformance() {
+        let extractor = SpectralFeatureExtractor(sampleRate: SensorClassificationManager.modelSampleRate, windowDuration: self.desiredSessionDuration)
+        let predictions = self.predictionStartDates.map { self.prediction(startDate: $0) }
+        
+        let classifier = SummingClassifier()
+        
+        self.measure {
+            self.fetchAndClassify(extractor: extractor, classifier: classifier, predictions: predictions)
+        }
+    }
+    
+    func testViewAndClassifyPerformance() {
+        let extractor = SpectralFeatureExtractor(sampleRate: SensorClassificationManager.modelSampleRate, windowDuration: self.desiredSessionDuration)
+        let predictions = self.predictionStartDates.map { self.prediction(startDate: $0) }
+        
+        let classifier = SummingClassifier()
+        
+        self.measure {
+            self.viewAndClassify(extractor: extractor, classifier: classifier, predictions: predictions)
+        }
+    }
+    
+    // The forest itself on either path. Its input is still an array of readings, so the window path hands it the
+    // pooled detached readings; these measure what a session costs end to end.
+    func testForestFetchAndClassifyPerformance() {
+        let forest = RouteRecorder.shared.randomForestManager!
+        XCTAssertTrue(forest.canPredict, "The random forest model didn't load!")
+        let predictions = self.predictionStartDates.map { self.prediction(startDate: $0) }
+        
+        self.measure {
+            for prediction in predictions {
+                forest.classify(prediction)
+            }
+        }
+        XCTAssertFalse(predictions.contains { $0.predictedActivities.isEmpty })
+    }
+    
+    func testForestViewAndClassifyPerformance() {
+        let forest = RouteRecorder.shared.randomForestManager!
+        XCTAssertTrue(forest.canPredict, "The random forest model didn't load!")
+        let predictions = self.predictionStartDates.map { self.prediction(startDate: $0) }
+        
+        self.measure {
+            for prediction in predictions {
+                _ = self.sampleBuffer.withWindow(from: prediction.startDate, duration: self.desiredSessionDuration) { (window)->Void in
+                    forest.classify(prediction, window: window)
+                }
+            }
+        }
+        XCTAssertFalse(predictions.contains { $0.predictedActivities.isEmpty })
+    }
+    
+    func testPooledReadingsDontCarryOverBetweenWindows() {
+        let forest = RouteRecorder.shared.randomForestManager!
+        XCTAssertTrue(forest.canPredict, "The random forest model didn't load!")
+        
+        // a window classified after a longer one sees only its own samples
+        let startDate = self.predictionStartDates[0]
+        let fullWindowActivity = self.sampleBuffer.withWindow(from: startDate, duration: self.desiredSessionDuration) { (window) in
+            forest.predictedActivities(forWindow: window).first
+        }
+        let longerWindowCount = self.sampleBuffer.withWindow(from: startDate, duration: self.desiredSessionDuration + 3) { (window)->Int in
+            _ = forest.predictedActivities(forWindow: window)
+            return window.samples.count
+        }
+        XCTAssertNotNil(longerWindowCount)
+        let repeatedActivity = self.sampleBuffer.withWindow(from: startDate, duration: self.desiredSessionDuration) { (window) in
+            forest.predictedActivities(forWindow: window).first
+        }
+        
+        XCTAssertEqual(repeatedActivity??.activityType, fullWindowActivity??.activityType)
+        XCTAssertEqual(repeatedActivity??.confidence ?? -1, fullWindowActivity??.confidence ?? -2)
+    }
+}
@@ -0,0 +1,85 @@
+//
+//  ActivitySegmenterTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+import CoreLocation
+
+@testable import RouteRecorder
+
+class ActivitySegmenterTests: XCTestCase {
+    var startDate: Date!
+
+    override func setUp() {
+        RouteRecorderDatabaseManager.startup(true)
+        self.startDate = Date(timeIntervalSinceReferenceDate: 600_000_000)
+    }
+
+    func addSpeeds(_ speed: CLLocationSpeed, from start: TimeInterval, duration: TimeInterval, to segmenter: ActivitySegmenter) {
+        for second in stride(from: start, to: start + duration, by: 1) {
+            segmenter.add(speed: speed, at: self.startDate.addingTimeInterval(second))
+        }
+    }
+
+    func addPredictions(_ activityType: ActivityType, from start: TimeInterval, duration: TimeInterval, to segmenter: ActivitySegmenter) {
+        for second in stride(from: start, to: start + duration, by: 30) {
+            let prediction = Prediction()
+            prediction.startDate = self.startDate.addingTimeInterval(second)
+            _ = PredictedActivity(activityType: activityType, confidence: 0.8, prediction: prediction)
+            _ = PredictedActivity(activityType: activityType == .cycling ? .automotive : .cycling, confidence: 0.2, prediction: prediction)
+            segmenter.add(prediction)
+        }
+    }
+
+    func testRideThatEndsInACarIsSplit() {
+        let segmenter = ActivitySegmenter(initialActivityType: .cycling)
+        self.addPredictions(.cycling, from: 0, duration: 1200, to: segmenter)
+        self.addSpeeds(5, from: 0, duration: 600, to: segmenter)
+        self.addSpeeds(0, from: 600, duration: 40, to: segmenter) // a light
+        self.addSpeeds(5, from: 640, duration: 560, to: segmenter)
+        self.addPredictions(.automotive, from: 1200, duration: 600, to: segmenter)
+        self.addSpeeds(20, from: 1200, duration: 600, to: segmenter)
+
+        let segments = segmenter.finish()
+        XCTAssertEqual(segments.map { $0.activityType }, [.cycling, .automotive])
+        XCTAssertEqual(segments[1].startDate.timeIntervalSince(self.startDate), 1200, accuracy: ActivitySegmenter.stepDuration)
+        XCTAssertEqual(segments.last!.endDate.timeIntervalSince(self.startDate), 1799, accuracy: 0.001)
+        XCTAssertEqual(segmenter.locationCount, 1800)
+    }
+
+    func testSlowRideBecomesWalk() {
+        let segmenter = ActivitySegmenter(initialActivityType: .cycling)
+        self.addSpeeds(1.3, from: 0, duration: 900, to: segmenter)
+
+        XCTAssertEqual(segmenter.finish().map { $0.activityType }, [.walking])
+    }
+
+    func testSlowRideAboveWalkingSpeedsBecomesWalk() {
+        // faster than the slowest runs used to be, but under the 2 m/s we used to reclassify bike trips as walks at
+        let segmenter = ActivitySegmenter(initialActivityType: .cycling)
+        self.addSpeeds(1.6, from: 0, duration: 900, to: segmenter)
+
+        XCTAssertEqual(segmenter.finish().map { $0.activityType }, [.walking])
+    }
+
+    func testPredictionsAddedLateAreUsed() {
+        let aggregator = PredictionAggregator()
+        for i in 0..<10 {
+            let prediction = Prediction()
+            prediction.startDate = self.startDate.addingTimeInterval(Double(i) * PredictionAggregator.sampleOffsetTimeInterval)
+            _ = PredictedActivity(activityType: .running, confidence: 0.9, prediction: prediction)
+            _ = PredictedActivity(activityType: .cycling, confidence: 0.1, prediction: prediction)
+            prediction.predictionAggregator = aggregator
+        }
+
+        // the aggregator joins the route after its first fixes, the way pending aggregators do
+        let segmenter = ActivitySegmenter(initialActivityType: .unknown)
+        self.addSpeeds(3, from: 5, duration: 300, to: segmenter)
+        segmenter.add(aggregator)
+
+        XCTAssertEqual(segmenter.finish().map { $0.activityType }, [.running])
+    }
+}
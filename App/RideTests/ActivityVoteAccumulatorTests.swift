@@ -0,0 +1,75 @@
+//
+//  ActivityVoteAccumulatorTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+
+@testable import RouteRecorder
+
+class ActivityVoteAccumulatorTests: XCTestCase {
+    override func setUp() {
+        RouteRecorderDatabaseManager.startup(true)
+        PredictionAggregator.stoppingRuleKind = .fixed // so the aggregate is the mean vote
+    }
+
+    override func tearDown() {
+        PredictionAggregator.stoppingRuleKind = .sequential
+    }
+
+    func prediction(_ activities: [(ActivityType, Float)], aggregator: PredictionAggregator)->Prediction {
+        let prediction = Prediction()
+        for (activityType, confidence) in activities {
+            _ = PredictedActivity(activityType: activityType, confidence: confidence, prediction: prediction)
+        }
+        prediction.predictionAggregator = aggregator
+        return prediction
+    }
+
+    func testAggregateTracksTopVote() {
+        let aggregator = PredictionAggregator()
+        aggregator.addToAggregatePredictedActivity(self.prediction([(.cycling, 0.6), (.walking, 0.4)], aggregator: aggregator))
+        XCTAssertEqual(aggregator.currentAggregateActivityType, .cycling)
+        XCTAssertEqual(aggregator.currentAggregateConfidence!, 0.6, accuracy: 0.0001)
+
+        aggregator.addToAggregatePredictedActivity(self.prediction([(.walking, 0.9), (.cycling, 0.1)], aggregator: aggregator))
+        XCTAssertEqual(aggregator.currentAggregateActivityType, .walking)
+        XCTAssertEqual(aggregator.currentAggregateConfidence!, 0.65, accuracy: 0.0001)
+
+        aggregator.addToAggregatePredictedActivity(self.prediction([(.other, 1.0)], aggregator: aggregator))
+        aggregator.addToAggregatePredictedActivity(self.prediction([(.other, 1.0)], aggregator: aggregator))
+        XCTAssertEqual(aggregator.currentAggregateActivityType, .other)
+        XCTAssertEqual(aggregator.currentAggregateConfidence!, 0.5, accuracy: 0.0001)
+    }
+
+    func testAggregateIsOnlyStoredWhenFinished() {
+        let aggregator = PredictionAggregator()
+        for _ in 0..<5 {
+            aggregator.addToAggregatePredictedActivity(self.prediction([(.automotive, 0.8), (.bus, 0.2)], aggregator: aggregator))
+        }
+        XCTAssertNil(aggregator.aggregatePredictedActivity)
+
+        aggregator.finishAggregatePredictedActivity()
+        XCTAssertEqual(aggregator.aggregatePredictedActivity?.activityType, .automotive)
+        XCTAssertEqual(aggregator.aggregatePredictedActivity!.confidence, 0.8, accuracy: 0.0001)
+    }
+
+    func testExistingPredictionsAreCounted() {
+        let aggregator = PredictionAggregator()
+        _ = self.prediction([(.running, 1.0)], aggregator: aggregator)
+        _ = self.prediction([(.running, 1.0)], aggregator: aggregator)
+
+        aggregator.addToAggregatePredictedActivity(self.prediction([(.walking, 1.0)], aggregator: aggregator))
+        XCTAssertEqual(aggregator.currentAggregateActivityType, .running)
+        XCTAssertEqual(aggregator.currentAggregateConfidence!, 2.0 / 3.0, accuracy: 0.0001)
+    }
+
+    func testNoPredictionsLeavesAggregateEmpty() {
+        let aggregator = PredictionAggregator()
+        aggregator.finishAggregatePredictedActivity()
+        XCTAssertNil(aggregator.aggregatePredictedActivity)
+        XCTAssertNil(aggregator.currentAggregateConfidence)
+    }
+}
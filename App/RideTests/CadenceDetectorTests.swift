@@ -0,0 +1,187 @@
+//
+//  CadenceDetectorTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+import CoreMotion
+
+@testable import RouteRecorder
+
+class CadenceDetectorTests: XCTestCase {
+    static let sampleRate: Double = 50
+    static let walkingStepPeriod: Float = 1 / 1.8 // 108 steps a minute
+    static let cyclingStrokePeriod: Float = 60.0 / 85 / 2 // 85 rpm
+
+    override func setUp() {
+        RouteRecorderDatabaseManager.startup(true)
+    }
+
+    override func tearDown() {
+        PredictionAggregator.stoppingRuleKind = .sequential
+    }
+
+    // Feeds the estimator a tenth of a second at a time, the way the sensor handler does, and returns every estimate.
+    func estimates(duration: TimeInterval, estimator: CadenceEstimator = CadenceEstimator(sampleRate: CadenceDetectorTests.sampleRate), acceleration: (TimeInterval)->CMAcceleration)->[(timestamp: TimeInterval, estimate: CadenceEstimate)] {
+        var estimates: [(timestamp: TimeInterval, estimate: CadenceEstimate)] = []
+        let chunkCount = Int(CadenceDetectorTests.sampleRate / 10)
+        for chunk in 0..<Int(duration * 10) {
+            let accelerations = (0..<chunkCount).map { (i)->(timestamp: TimeInterval, acceleration: CMAcceleration) in
+                let t = Double(chunk * chunkCount + i) / CadenceDetectorTests.sampleRate
+                return (timestamp: t, acceleration: acceleration(t))
+            }
+            if let estimate = estimator.estimate(afterAccelerations: accelerations) {
+                estimates.append((timestamp: accelerations.last!.timestamp, estimate: estimate))
+            }
+        }
+        return estimates
+    }
+
+    func walking(_ t: TimeInterval)->CMAcceleration {
+        // a step every period, and a weaker sway every stride
+        let phase = 2 * Double.pi * t / Double(CadenceDetectorTests.walkingStepPeriod)
+        return CMAcceleration(x: 0.1 * sin(phase / 2), y: -1 + 0.3 * sin(phase), z: 0.05 * sin(phase))
+    }
+
+    func cycling(_ t: TimeInterval)->CMAcceleration {
+        // a push on every stroke, one leg a little stronger than the other
+        let phase = 2 * Double.pi * t / Double(2 * CadenceDetectorTests.cyclingStrokePeriod)
+        return CMAcceleration(x: 0, y: -1 + 0.15 * sin(2 * phase) + 0.02 * sin(phase), z: 0)
+    }
+
+    //
+    // MARK: Detector
+    //
+
+    func testNothingIsEstimatedUntilTheWindowFills() {
+        let estimates = self.estimates(duration: 10, acceleration: self.walking)
+
+        XCTAssertGreaterThan(estimates.count, 0)
+        XCTAssertEqual(estimates.first!.timestamp, CadenceEstimator.windowDuration - 1 / CadenceDetectorTests.sampleRate, accuracy: 1e-6)
+        for (previous, next) in zip(estimates, estimates.dropFirst()) {
+            XCTAssertEqual(next.timestamp - previous.timestamp, CadenceEstimator.hopDuration, accuracy: 1e-6)
+        }
+    }
+
+    func testStepsAreFoundRatherThanStrides() {
+        for (_, estimate) in self.estimates(duration: 10, acceleration: self.walking) {
+            XCTAssertEqual(estimate.period, CadenceDetectorTests.walkingStepPeriod, accuracy: 0.01)
+            XCTAssertGreaterThan(estimate.confidence, 0.9)
+        }
+    }
+
+    func testPedalStrokesAreFoundRatherThanRevolutions() {
+        for (_, estimate) in self.estimates(duration: 10, acceleration: self.cycling) {
+            XCTAssertEqual(estimate.period, CadenceDetectorTests.cyclingStrokePeriod, accuracy: 0.01)
+            XCTAssertGreaterThan(estimate.confidence, 0.9)
+        }
+    }
+
+    func testNoiseHasNoConfidentCadence() {
+        var seed: UInt64 = 1
+        let noise = { ()->Double in
+            seed = seed &* 6364136223846793005 &+ 1442695040888963407
+            return Double(seed >> 11) / Double(UInt64(1) << 53) * 2 - 1
+        }
+
+        let estimates = self.estimates(duration: 10) { (_) in CMAcceleration(x: 0.3 * noise(), y: -1 + 0.3 * noise(), z: 0.3 * noise()) }
+        XCTAssertGreaterThan(estimates.count, 0)
+        for (_, estimate) in estimates {
+            XCTAssertLessThan(estimate.confidence, 0.4)
+        }
+    }
+
+    func testStillPhoneHasNoCadence() {
+        let estimates = self.estimates(duration: 10) { (_) in CMAcceleration(x: 0, y: -1, z: 0) }
+        XCTAssertGreaterThan(estimates.count, 0)
+        for (_, estimate) in estimates {
+            XCTAssertEqual(estimate.period, 0)
+            XCTAssertEqual(estimate.confidence, 0)
+        }
+    }
+
+    func testResetWaitsForAFreshWindow() {
+        let estimator = CadenceEstimator(sampleRate: CadenceDetectorTests.sampleRate)
+        XCTAssertGreaterThan(self.estimates(duration: 5, estimator: estimator, acceleration: self.walking).count, 0)
+
+        estimator.reset()
+        let estimates = self.estimates(duration: 5, estimator: estimator, acceleration: self.cycling)
+        XCTAssertEqual(estimates.first?.timestamp ?? 0, CadenceEstimator.windowDuration - 1 / CadenceDetectorTests.sampleRate, accuracy: 1e-6)
+        XCTAssertEqual(estimates.first?.estimate.period ?? 0, CadenceDetectorTests.cyclingStrokePeriod, accuracy: 0.01)
+    }
+
+    func testEstimatesFitTheirModesPeriodRange() {
+        for (_, estimate) in self.estimates(duration: 10, acceleration: self.walking) {
+            XCTAssertTrue(PredictionAggregator.cadencePeriodRanges[.walking]!.contains(estimate.period))
+            XCTAssertFalse(PredictionAggregator.cadencePeriodRanges[.cycling]!.contains(estimate.period))
+        }
+        for (_, estimate) in self.estimates(duration: 10, acceleration: self.cycling) {
+            XCTAssertTrue(PredictionAggregator.cadencePeriodRanges[.cycling]!.contains(estimate.period))
+            XCTAssertFalse(PredictionAggregator.cadencePeriodRanges[.walking]!.contains(estimate.period))
+        }
+    }
+
+    //
+    // MARK: Early Stop
+    //
+
+    // Adds predictions until the aggregator is complete, or it would have given up. Returns how many it took.
+    func predictionCountToComplete(_ aggregator: PredictionAggregator, activities: [(ActivityType, Float)], cadence: [CadenceEstimate])->Int {
+        // the fixed rule can't decide before minimumSampleCountForSuccess, so anything earlier is the cadence
+        PredictionAggregator.stoppingRuleKind = .fixed
+        aggregator.cadenceEstimates = cadence
+
+        var predictionCount = 0
+        while !aggregator.aggregatePredictionIsComplete() && predictionCount < PredictionAggregator.maximumSampleBeforeFailure {
+            let prediction = Prediction()
+            prediction.startDate = Date().addingTimeInterval(Double(predictionCount) * PredictionAggregator.sampleOffsetTimeInterval)
+            for (activityType, confidence) in activities {
+                _ = PredictedActivity(activityType: activityType, confidence: confidence, prediction: prediction)
+            }
+            prediction.predictionAggregator = aggregator
+            aggregator.addToAggregatePredictedActivity(prediction)
+            predictionCount += 1
+        }
+        return predictionCount
+    }
+
+    func steadyCadence(period: Float)->[CadenceEstimate] {
+        return [CadenceEstimate(period: period, confidence: 0.9), CadenceEstimate(period: period * 1.02, confidence: 0.95), CadenceEstimate(period: period, confidence: 0.92)]
+    }
+
+    func testMatchingCadenceFinishesEarly() {
+        let walking = PredictionAggregator()
+        XCTAssertEqual(self.predictionCountToComplete(walking, activities: [(.walking, 0.8), (.cycling, 0.2)], cadence: self.steadyCadence(period: CadenceDetectorTests.walkingStepPeriod)), PredictionAggregator.minimumSampleCountForCadenceSuccess + 1)
+
+        let cycling = PredictionAggregator()
+        XCTAssertEqual(self.predictionCountToComplete(cycling, activities: [(.cycling, 0.8), (.walking, 0.2)], cadence: self.steadyCadence(period: CadenceDetectorTests.cyclingStrokePeriod)), PredictionAggregator.minimumSampleCountForCadenceSuccess + 1)
+
+        cycling.finishAggregatePredictedActivity()
+        XCTAssertEqual(cycling.aggregatePredictedActivity?.activityType, .cycling)
+    }
+
+    func testCadenceOfAnotherModeDoesntFinishEarly() {
+        // predicted walking, but pedalling
+        let aggregator = PredictionAggregator()
+        XCTAssertGreaterThan(self.predictionCountToComplete(aggregator, activities: [(.walking, 0.8), (.cycling, 0.2)], cadence: self.steadyCadence(period: CadenceDetectorTests.cyclingStrokePeriod)), PredictionAggregator.minimumSampleCountForSuccess)
+    }
+
+    func testCadenceDoesntLowerTheConfidenceBar() {
+        let aggregator = PredictionAggregator()
+        XCTAssertGreaterThan(self.predictionCountToComplete(aggregator, activities: [(.walking, 0.65), (.cycling, 0.35)], cadence: self.steadyCadence(period: CadenceDetectorTests.walkingStepPeriod)), PredictionAggregator.minimumSampleCountForSuccess)
+    }
+
+    func testUnsteadyOrWeakCadenceDoesntFinishEarly() {
+        let period = CadenceDetectorTests.walkingStepPeriod
+        let unsteady = [CadenceEstimate(period: period, confidence: 0.9), CadenceEstimate(period: period * 1.3, confidence: 0.9), CadenceEstimate(period: period, confidence: 0.9)]
+        XCTAssertGreaterThan(self.predictionCountToComplete(PredictionAggregator(), activities: [(.walking, 0.8), (.cycling, 0.2)], cadence: unsteady), PredictionAggregator.minimumSampleCountForSuccess)
+
+        let weak = [CadenceEstimate(period: period, confidence: 0.9), CadenceEstimate(period: period, confidence: 0.5), CadenceEstimate(period: period, confidence: 0.9)]
+        XCTAssertGreaterThan(self.predictionCountToComplete(PredictionAggregator(), activities: [(.walking, 0.8), (.cycling, 0.2)], cadence: weak), PredictionAggregator.minimumSampleCountForSuccess)
+
+        // stationary has no cadence to back it up
+        XCTAssertGreaterThan(self.predictionCountToComplete(PredictionAggregator(), activities: [(.stationary, 0.8), (.walking, 0.2)], cadence: self.steadyCadence(period: period)), PredictionAggregator.minimumSampleCountForSuccess)
+    }
+}
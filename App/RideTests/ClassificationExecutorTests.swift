@@ -0,0 +1,56 @@
+//
+//  ClassificationExecutorTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+
+@testable import RouteRecorder
+
+class ClassificationExecutorTests: XCTestCase {
+    func testJobsRunInOrderOnTheWorkerThread() {
+        let executor = ClassificationExecutor(capacity: 16)
+        var order: [Int] = []
+        let ran = self.expectation(description: "ran")
+        for i in 0..<10 {
+            XCTAssertTrue(executor.submit {
+                XCTAssertFalse(Thread.isMainThread)
+                XCTAssertTrue(executor.isCurrentThread)
+                order.append(i)
+                if i == 9 {
+                    ran.fulfill()
+                }
+            })
+        }
+
+        self.waitForExpectations(timeout: 5, handler: nil)
+        XCTAssertEqual(order, Array(0..<10))
+        XCTAssertEqual(executor.statistics.completedJobCount, 10)
+        XCTAssertEqual(executor.statistics.rejectedJobCount, 0)
+    }
+
+    func testFullQueueTurnsJobsAway() {
+        let executor = ClassificationExecutor(capacity: 2)
+        let started = DispatchSemaphore(value: 0)
+        let proceed = DispatchSemaphore(value: 0)
+        executor.submit {
+            started.signal()
+            proceed.wait()
+        }
+        started.wait()
+
+        // the first job is running, so the queue has room for exactly two more
+        let ran = self.expectation(description: "ran")
+        XCTAssertTrue(executor.submit {})
+        XCTAssertTrue(executor.submit { ran.fulfill() })
+        XCTAssertFalse(executor.submit { XCTFail("Job ran after being turned away!") })
+        XCTAssertEqual(executor.pendingJobCount, 2)
+
+        proceed.signal()
+        self.waitForExpectations(timeout: 5, handler: nil)
+        XCTAssertEqual(executor.statistics.rejectedJobCount, 1)
+        XCTAssertGreaterThan(executor.statistics.maximumQueueLatency, 0)
+    }
+}
@@ -0,0 +1,180 @@
+//
+//  GroupCommitSchedulerTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+import UIKit
+import CoreData
+import CoreMotion
+
+@testable import RouteRecorder
+
+class GroupCommitSchedulerTests: XCTestCase {
+    static let maximumLatency: TimeInterval = 0.05
+    static let maximumBatchSize = 5
+
+    var commitCount = 0
+    var hasChanges = true // what the commit reports, as moc.hasChanges would
+    var committed: XCTestExpectation?
+
+    override func setUp() {
+        self.commitCount = 0
+        self.hasChanges = true
+        self.committed = nil
+    }
+
+    func scheduler(maximumLatency: TimeInterval = GroupCommitSchedulerTests.maximumLatency)->GroupCommitScheduler {
+        return GroupCommitScheduler(maximumLatency: maximumLatency, maximumBatchSize: GroupCommitSchedulerTests.maximumBatchSize) { [unowned self] in
+            guard self.hasChanges else {
+                return false
+            }
+            self.commitCount += 1
+            self.committed?.fulfill()
+            return true
+        }
+    }
+
+    // Runs the main queue for a while, so any commit timer that is due fires.
+    func runMainQueue(for duration: TimeInterval = 4 * GroupCommitSchedulerTests.maximumLatency) {
+        RunLoop.main.run(until: Date().addingTimeInterval(duration))
+    }
+
+    //
+    // MARK: Batching
+    //
+
+    func testFullBatchCommitsRightAway() {
+        let scheduler = self.scheduler()
+        for _ in 0..<GroupCommitSchedulerTests.maximumBatchSize - 1 {
+            scheduler.enqueue()
+        }
+        XCTAssertEqual(self.commitCount, 0)
+        XCTAssertEqual(scheduler.pendingCount, GroupCommitSchedulerTests.maximumBatchSize - 1)
+
+        scheduler.enqueue()
+        XCTAssertEqual(self.commitCount, 1)
+        XCTAssertEqual(scheduler.pendingCount, 0)
+        XCTAssertEqual(scheduler.metrics.maximumBatchSize, GroupCommitSchedulerTests.maximumBatchSize)
+
+        // the batch's timer went with it
+        self.runMainQueue()
+        XCTAssertEqual(self.commitCount, 1)
+    }
+
+    func testLargeEnqueueIsOneCommit() {
+        let scheduler = self.scheduler()
+        scheduler.enqueue(recordCount: 3 * GroupCommitSchedulerTests.maximumBatchSize)
+
+        XCTAssertEqual(self.commitCount, 1)
+        XCTAssertEqual(scheduler.metrics.recordCount, 3 * GroupCommitSchedulerTests.maximumBatchSize)
+        XCTAssertEqual(scheduler.metrics.maximumBatchSize, 3 * GroupCommitSchedulerTests.maximumBatchSize)
+    }
+
+    func testSmallBatchCommitsAfterTheLatency() {
+        let scheduler = self.scheduler()
+        self.committed = self.expectation(description: "committed")
+
+        scheduler.enqueue()
+        scheduler.enqueue(recordCount: 2)
+        XCTAssertEqual(self.commitCount, 0)
+
+        self.waitForExpectations(timeout: 20 * GroupCommitSchedulerTests.maximumLatency, handler: nil)
+        XCTAssertEqual(self.commitCount, 1)
+        XCTAssertEqual(scheduler.pendingCount, 0)
+        XCTAssertEqual(scheduler.metrics.commitCount, 1)
+        XCTAssertEqual(scheduler.metrics.recordCount, 3)
+        XCTAssertGreaterThanOrEqual(scheduler.metrics.maximumFlushLatency, 0.9 * GroupCommitSchedulerTests.maximumLatency)
+    }
+
+    func testLatencyRunsFromTheFirstRecord() {
+        // later records join the pending batch rather than pushing its commit back. A longer latency leaves room for
+        // the run loop to overshoot.
+        let maximumLatency: TimeInterval = 1
+        let scheduler = self.scheduler(maximumLatency: maximumLatency)
+        scheduler.enqueue()
+        self.runMainQueue(for: 0.5 * maximumLatency)
+        XCTAssertEqual(self.commitCount, 0)
+        scheduler.enqueue()
+
+        self.runMainQueue(for: 0.75 * maximumLatency)
+        XCTAssertEqual(self.commitCount, 1)
+        XCTAssertEqual(scheduler.metrics.maximumBatchSize, 2)
+    }
+
+    //
+    // MARK: Barrier
+    //
+
+    func testFlushCommitsBeforeReturning() {
+        let scheduler = self.scheduler()
+        scheduler.enqueue(recordCount: 2)
+
+        scheduler.flush()
+        XCTAssertEqual(self.commitCount, 1)
+        XCTAssertEqual(scheduler.pendingCount, 0)
+
+        // and the pending timer doesn't commit again
+        self.runMainQueue()
+        XCTAssertEqual(self.commitCount, 1)
+        XCTAssertEqual(scheduler.metrics.recordCount, 2)
+    }
+
+    func testFlushWithNothingToCommit() {
+        let scheduler = self.scheduler()
+        self.hasChanges = false
+        scheduler.enqueue(recordCount: 2)
+
+        scheduler.flush()
+        XCTAssertEqual(scheduler.pendingCount, 0)
+        XCTAssertEqual(scheduler.metrics.commitCount, 0)
+        XCTAssertEqual(scheduler.metrics.recordCount, 0)
+    }
+
+    func testBarrierOnlyChangesCountAsABatchOfOne() {
+        let scheduler = self.scheduler()
+        scheduler.flush()
+
+        XCTAssertEqual(self.commitCount, 1)
+        XCTAssertEqual(scheduler.metrics.recordCount, 1)
+        XCTAssertEqual(scheduler.metrics.maximumBatchSize, 1)
+    }
+
+    //
+    // MARK: Database Manager
+    //
+
+    func addUnsavedChange()->NSManagedObjectContext {
+        RouteRecorderDatabaseManager.startup(true)
+        _ = AccelerometerReading(acceleration: CMAcceleration(x: 0, y: -1, z: 0))
+        RouteRecorderDatabaseManager.shared.scheduleSave()
+
+        let context = RouteRecorderDatabaseManager.shared.currentManagedObjectContext()
+        XCTAssertTrue(context.hasChanges)
+        XCTAssertGreaterThan(RouteRecorderDatabaseManager.shared.writeScheduler.pendingCount, 0)
+        return context
+    }
+
+    func testSaveContextIsABarrier() {
+        let context = self.addUnsavedChange()
+
+        RouteRecorderDatabaseManager.shared.saveContext()
+        XCTAssertFalse(context.hasChanges)
+        XCTAssertEqual(RouteRecorderDatabaseManager.shared.writeScheduler.pendingCount, 0)
+    }
+
+    func testBackgroundAndTerminateFlushPendingChanges() {
+        for name in [UIApplication.didEnterBackgroundNotification, UIApplication.willTerminateNotification] {
+            let context = self.addUnsavedChange()
+            let commitCount = RouteRecorderDatabaseManager.shared.writeScheduler.metrics.commitCount
+
+            // posted on the main queue, so the observer has run by the time this returns
+            NotificationCenter.default.post(name: name, object: nil)
+            XCTAssertFalse(context.hasChanges, name.rawValue)
+            XCTAssertEqual(RouteRecorderDatabaseManager.shared.writeScheduler.pendingCount, 0, name.rawValue)
+            XCTAssertEqual(RouteRecorderDatabaseManager.shared.writeScheduler.metrics.commitCount, commitCount + 1, name.rawValue)
+        }
+    }
+}
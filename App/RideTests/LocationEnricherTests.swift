@@ -0,0 +1,139 @@
+//
+//  LocationEnricherTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+import CoreLocation
+
+@testable import RouteRecorder
+
+class LocationEnricherTests: XCTestCase {
+    var startDate: Date!
+
+    var directoryURL: URL!
+    var store: RawSensorStore!
+
+    override func setUp() {
+        RouteRecorderDatabaseManager.startup(true)
+        self.startDate = Date(timeIntervalSinceReferenceDate: 600_000_000)
+        self.directoryURL = URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent(UUID().uuidString)
+        self.store = RawSensorStore(directoryURL: self.directoryURL)
+    }
+
+    override func tearDown() {
+        self.store = nil
+        try? FileManager.default.removeItem(at: self.directoryURL)
+    }
+
+    func locations(count: Int, route: Route = Route())->[Location] {
+        return (0..<count).map { Location(recordedLocation: CLLocation(coordinate: CLLocationCoordinate2D(latitude: 45.52, longitude: -122.68), altitude: 20, horizontalAccuracy: 5, verticalAccuracy: 5, course: 90, speed: 5, timestamp: self.startDate.addingTimeInterval(Double($0) + 0.5)), isActiveGPS: true, route: route) }
+    }
+
+    // 50hz samples for each second, at rest apart from a steady extra pull of intensity g's
+    func writeAccelerometer(seconds: CountableRange<Int>, intensity: Float) {
+        var samples = [AccelerometerSample](repeating: AccelerometerSample(), count: 50)
+        for second in seconds {
+            for i in 0..<samples.count {
+                samples[i] = AccelerometerSample(t: Float(second) + Float(i) / 50, x: 0, y: -1 - intensity, z: 0)
+            }
+            samples.withUnsafeBufferPointer { self.store.append($0, referenceDate: self.startDate) }
+        }
+        self.store.sync()
+    }
+
+    func testHeartRateIsInterpolatedAtEachFix() {
+        let locations = self.locations(count: 600)
+
+        // every 5 seconds, newest first the way HealthKit returns them, with a gap in the middle
+        var heartRates: [(date: Date, beatsPerMinute: Double)] = []
+        for second in stride(from: 0, to: 600, by: 5) where second < 200 || second > 400 {
+            heartRates.append((date: self.startDate.addingTimeInterval(Double(second)), beatsPerMinute: 100 + Double(second) / 10))
+        }
+        heartRates.reverse()
+
+        let enrichments = LocationEnricher(sensorStore: self.store).enrich(locations, heartRates: heartRates)
+        XCTAssertEqual(enrichments.count, locations.count)
+        for (index, enrichment) in enrichments.enumerated() {
+            XCTAssert(enrichment.location === locations[index])
+        }
+
+        XCTAssertEqual(enrichments[12].heartRate!, 101.25, accuracy: 0.001)
+        XCTAssertEqual(enrichments[150].heartRate!, 115.05, accuracy: 0.001)
+
+        // more than the tolerance from any sample
+        XCTAssertNil(enrichments[300].heartRate)
+
+        // within the tolerance of the last sample before the gap, and past the end
+        XCTAssertEqual(enrichments[230].heartRate!, 119.5, accuracy: 0.001)
+        XCTAssertEqual(enrichments[599].heartRate!, 159.5, accuracy: 0.001)
+    }
+
+    func testNoHeartRates() {
+        let enrichments = LocationEnricher(sensorStore: self.store).enrich(self.locations(count: 10), heartRates: [])
+        XCTAssertEqual(enrichments.count, 10)
+        XCTAssertNil(enrichments[0].heartRate)
+        XCTAssertNil(enrichments[0].motionIntensity)
+    }
+
+    func testMotionIntensityIsAveragedAroundEachFix() {
+        let locations = self.locations(count: 600)
+
+        // stronger for a while, then nothing recorded for the rest of the route
+        self.writeAccelerometer(seconds: 0..<300, intensity: 0.25)
+        self.writeAccelerometer(seconds: 300..<400, intensity: 0.5)
+
+        let enrichments = LocationEnricher(sensorStore: self.store).enrich(locations, heartRates: [])
+        XCTAssertEqual(enrichments.count, locations.count)
+        for (index, enrichment) in enrichments.enumerated() {
+            XCTAssert(enrichment.location === locations[index])
+            XCTAssertNil(enrichment.heartRate)
+        }
+
+        XCTAssertEqual(enrichments[0].motionIntensity!, 0.25, accuracy: 0.0001)
+        XCTAssertEqual(enrichments[100].motionIntensity!, 0.25, accuracy: 0.0001)
+        XCTAssertEqual(enrichments[350].motionIntensity!, 0.5, accuracy: 0.0001)
+        XCTAssertEqual(enrichments[399].motionIntensity!, 0.5, accuracy: 0.0001)
+
+        // straddling the change, and past the last sample
+        XCTAssertGreaterThan(enrichments[299].motionIntensity!, 0.25)
+        XCTAssertLessThan(enrichments[299].motionIntensity!, 0.5)
+        XCTAssertNil(enrichments[450].motionIntensity)
+        XCTAssertNil(enrichments[599].motionIntensity)
+    }
+
+    func testSamplesOutsideTheRouteAreIgnored() {
+        let locations = self.locations(count: 100)
+
+        // all of them well clear of the route on either side
+        self.writeAccelerometer(seconds: -600..<(-10), intensity: 2)
+        self.writeAccelerometer(seconds: 110..<200, intensity: 2)
+        let heartRates = [-600.0, -300, 200, 500].map { (date: self.startDate.addingTimeInterval($0), beatsPerMinute: 150.0) }
+
+        let enrichments = LocationEnricher(sensorStore: self.store).enrich(locations, heartRates: heartRates)
+        XCTAssertEqual(enrichments.count, locations.count)
+        XCTAssertFalse(enrichments.contains { $0.heartRate != nil || $0.motionIntensity != nil })
+    }
+
+    func testNoLocations() {
+        self.writeAccelerometer(seconds: 0..<10, intensity: 0.25)
+        XCTAssertTrue(LocationEnricher(sensorStore: self.store).enrich([], heartRates: [(date: self.startDate, beatsPerMinute: 100)]).isEmpty)
+    }
+
+    func testLocationsOutOfOrder() {
+        let locations = self.locations(count: 10)
+        XCTAssertTrue(LocationEnricher(sensorStore: self.store).enrich(locations.reversed(), heartRates: []).isEmpty)
+    }
+
+    func testRouteEnrichesItsOwnFixes() {
+        let route = Route()
+        let locations = self.locations(count: 30, route: route)
+        let heartRates = (0..<30).map { (date: self.startDate.addingTimeInterval(Double($0)), beatsPerMinute: 120.0) }
+
+        let enrichments = route.enrichedLocations(heartRates: heartRates)
+        XCTAssertEqual(enrichments.map { $0.location.date }, locations.map { $0.date })
+        XCTAssertFalse(enrichments.contains { $0.heartRate != 120 })
+    }
+}
@@ -0,0 +1,145 @@
+//
+//  PredictionReclassifierTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+import CoreMotion
+
+@testable import RouteRecorder
+
+class PredictionReclassifierTests: XCTestCase {
+    static let windowDuration: TimeInterval = 2
+    static let heavyUserAggregatorsPerDay = 40 // a few long commutes and plenty of errands
+    static let yearOfAggregatorsTarget: TimeInterval = 5 * 60
+
+    var route: Route!
+
+    override func setUp() {
+        RouteRecorderDatabaseManager.startup(true)
+        self.route = Route() // keeps each test to its own aggregators
+    }
+
+    class StubClassifier: ConcurrentAccelerometerWindowClassifier {
+        let confidence: Float
+
+        init(confidence: Float = 0.95) {
+            self.confidence = confidence
+        }
+
+        func predictedActivities(forWindow window: AccelerometerWindow)->[(activityType: ActivityType, confidence: Float)] {
+            XCTAssertEqual(window.samples.count, Int(PredictionReclassifierTests.windowDuration * SensorClassificationManager.modelSampleRate))
+            return [(activityType: .cycling, confidence: self.confidence), (activityType: .walking, confidence: 1 - self.confidence)]
+        }
+    }
+
+    // an aggregator that was classified as walking by an older model, with seconds of readings at the model rate
+    func addAggregator(seconds: Int)->PredictionAggregator {
+        let aggregator = PredictionAggregator()
+        aggregator.route = self.route
+        let startDate = Date()
+        let prediction = Prediction()
+        prediction.startDate = startDate
+        prediction.activityPredictionModelIdentifier = "old"
+        prediction.predictionAggregator = aggregator
+        _ = PredictedActivity(activityType: .walking, confidence: 0.9, prediction: prediction)
+        aggregator.aggregatePredictedActivity = PredictedActivity(activityType: .walking, confidence: 0.9, prediction: nil)
+
+        let sampleRate = SensorClassificationManager.modelSampleRate
+        for i in 0..<(seconds * Int(sampleRate)) {
+            let reading = AccelerometerReading(acceleration: CMAcceleration(x: 0.3 * sin(Double(i) / 10), y: 0, z: 1))
+            reading.date = startDate.addingTimeInterval(Double(i) / sampleRate)
+            reading.predictionAggregator = aggregator
+        }
+
+        return aggregator
+    }
+
+    func reclassify(workerCount: Int = 4, windowDuration: TimeInterval = PredictionReclassifierTests.windowDuration, timeout: TimeInterval = 10, classifierFactory: @escaping ()->ConcurrentAccelerometerWindowClassifier? = { StubClassifier() })->PredictionReclassifier.Progress {
+        let reclassifier = PredictionReclassifier(modelIdentifier: "new", route: self.route, workerCount: workerCount, windowDuration: windowDuration, classifierFactory: classifierFactory)
+
+        var finalProgress = PredictionReclassifier.Progress()
+        let finished = self.expectation(description: "finished")
+        reclassifier.start(completionHandler: { (progress) in
+            finalProgress = progress
+            finished.fulfill()
+        })
+        self.waitForExpectations(timeout: timeout, handler: nil)
+
+        return finalProgress
+    }
+
+    func testAggregatorsAreReclassifiedAndStamped() {
+        let aggregators = (0..<10).map { (_) in self.addAggregator(seconds: 10) }
+        let tooShort = self.addAggregator(seconds: 1)
+
+        let progress = self.reclassify()
+        XCTAssertEqual(progress.aggregatorCount, 11)
+        XCTAssertEqual(progress.reclassifiedCount, 10)
+        XCTAssertEqual(progress.skippedCount, 1)
+
+        for aggregator in aggregators {
+            XCTAssertEqual(aggregator.aggregatePredictedActivity?.activityType, .cycling)
+            XCTAssertFalse(aggregator.predictions.isEmpty)
+            XCTAssertTrue(aggregator.predictions.allSatisfy { $0.activityPredictionModelIdentifier == "new" })
+        }
+        XCTAssertEqual(tooShort.aggregatePredictedActivity?.activityType, .walking)
+    }
+
+    func testRerunSkipsWhatIsAlreadyDone() {
+        _ = self.addAggregator(seconds: 10)
+        XCTAssertEqual(self.reclassify().reclassifiedCount, 1)
+
+        _ = self.addAggregator(seconds: 10)
+        let progress = self.reclassify(workerCount: 1)
+        XCTAssertEqual(progress.aggregatorCount, 1)
+        XCTAssertEqual(progress.reclassifiedCount, 1)
+        XCTAssertEqual(progress.skippedCount, 0)
+    }
+
+    func testYearOfAggregatorsPerformance() {
+        let forest = RandomForestManager()
+        forest.startup()
+        XCTAssertTrue(forest.canPredict, "The random forest model didn't load!")
+        
+        // a week of a heavy user's aggregators, each with readings for the longest session a prediction could take
+        let dayCount = 7
+        let aggregatorCount = dayCount * PredictionReclassifierTests.heavyUserAggregatorsPerDay
+        let sessionSeconds = Int(ceil(Double(PredictionAggregator.maximumSampleBeforeFailure - 1) * PredictionAggregator.sampleOffsetTimeInterval + forest.desiredSessionDuration))
+        for _ in 0..<aggregatorCount {
+            _ = self.addAggregator(seconds: sessionSeconds)
+        }
+        
+        let progress = self.reclassify(workerCount: ProcessInfo.processInfo.activeProcessorCount, windowDuration: forest.desiredSessionDuration, timeout: PredictionReclassifierTests.yearOfAggregatorsTarget) { () -> ConcurrentAccelerometerWindowClassifier? in
+            let randomForestManager = RandomForestManager()
+            randomForestManager.startup()
+            return randomForestManager
+        }
+        XCTAssertEqual(progress.reclassifiedCount, aggregatorCount)
+        
+        let yearDuration = progress.elapsedTime * 365 / Double(dayCount)
+        print(String(format: "Reclassified %d aggregators (%d windows) in %.1fs, a year would take %.1f minutes", progress.reclassifiedCount, progress.windowCount, progress.elapsedTime, yearDuration / 60))
+        XCTAssertLessThan(yearDuration, PredictionReclassifierTests.yearOfAggregatorsTarget)
+    }
+    
+    func testWindowsSkipGapsInTheReadings() {
+        let sampleRate = SensorClassificationManager.modelSampleRate
+        var samples: [AccelerometerSample] = []
+        for i in 0..<(3 * Int(sampleRate)) {
+            samples.append(AccelerometerSample(t: Float(Double(i) / sampleRate), x: 0, y: 0, z: 1))
+        }
+        for i in 0..<(3 * Int(sampleRate)) {
+            samples.append(AccelerometerSample(t: Float(10 + Double(i) / sampleRate), x: 0, y: 0, z: 1))
+        }
+
+        // not confident enough for the rule to stop early
+        let classified = PredictionReclassifier.classify(samples: samples, startDate: Date(), sampleRate: sampleRate, windowDuration: PredictionReclassifierTests.windowDuration, stoppingRuleKind: .fixed, classifier: StubClassifier(confidence: 0.6))
+
+        // five windows fit in each run, none across the gap
+        XCTAssertEqual(classified.windows.count, 10)
+        XCTAssertEqual(classified.windows[5].startDate.timeIntervalSince(classified.windows[0].startDate), 10, accuracy: 0.01)
+        XCTAssertEqual(classified.aggregatePredictedActivity?.activityType, .cycling)
+    }
+}
@@ -0,0 +1,128 @@
+//
+//  PredictionSchedulerTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+
+@testable import RouteRecorder
+
+class PredictionSchedulerTests: XCTestCase {
+    var startDate: Date!
+
+    override func setUp() {
+        RouteRecorderDatabaseManager.startup(true)
+        self.startDate = Date(timeIntervalSinceReferenceDate: 600_000_000)
+    }
+
+    func scheduler(sensorSecondsPerHour: TimeInterval, confidentResultLifetime: TimeInterval = 300, sampleRates: [Double] = [50])->PredictionScheduler {
+        let configuration = PredictionSchedulerConfiguration(sensorSecondsPerHour: sensorSecondsPerHour, referenceSampleRate: 50, minimumSessionDuration: 4, maximumSessionDuration: 20, minimumInterval: 15, maximumInterval: 120, movingSpeed: 2, highConfidence: 0.75, confidentResultLifetime: confidentResultLifetime)
+        return PredictionScheduler(configuration: configuration, sampleRates: sampleRates)
+    }
+
+    func date(_ seconds: TimeInterval)->Date {
+        return self.startDate.addingTimeInterval(seconds)
+    }
+
+    func testSpentBudgetShortensThenDeclinesSessions() {
+        let scheduler = self.scheduler(sensorSecondsPerHour: 50)
+        for start in [0.0, 40.0] {
+            let decision = scheduler.decide(at: self.date(start), speed: 5)
+            XCTAssertTrue(decision.shouldSample)
+            XCTAssertEqual(decision.sessionDuration, 20)
+            scheduler.recordResult(at: self.date(start + 20), sensorDuration: 20, sampleRate: 50, predictedActivity: nil)
+        }
+
+        let shortened = scheduler.decide(at: self.date(80), speed: 5)
+        XCTAssertTrue(shortened.shouldSample)
+        XCTAssertEqual(shortened.sessionDuration, 10.83, accuracy: 0.01)
+        scheduler.recordResult(at: self.date(80 + shortened.sessionDuration), sensorDuration: shortened.sessionDuration, sampleRate: 50, predictedActivity: nil)
+
+        let declined = scheduler.decide(at: self.date(120), speed: 5)
+        XCTAssertFalse(declined.shouldSample)
+        XCTAssertEqual(declined.retryDate.timeIntervalSince(self.startDate), 368, accuracy: 0.5)
+    }
+
+    func testSpentBudgetStepsDownTheSampleRate() {
+        let scheduler = self.scheduler(sensorSecondsPerHour: 30, sampleRates: [10, 50, 25])
+
+        let first = scheduler.decide(at: self.date(0), speed: 5)
+        XCTAssertEqual(first.sampleRate, 50)
+        scheduler.recordResult(at: self.date(20), sensorDuration: 20, sampleRate: 50, predictedActivity: nil)
+
+        let second = scheduler.decide(at: self.date(40), speed: 5)
+        XCTAssertEqual(second.sampleRate, 25)
+        scheduler.recordResult(at: self.date(60), sensorDuration: 20, sampleRate: 25, predictedActivity: nil)
+
+        XCTAssertFalse(scheduler.decide(at: self.date(80), speed: 5).shouldSample)
+    }
+
+    func testStationaryResultsBackOffUntilAFastFix() {
+        let scheduler = self.scheduler(sensorSecondsPerHour: 600, confidentResultLifetime: 0)
+        let stationary = PredictedActivity(activityType: .stationary, confidence: 0.9, prediction: nil)
+
+        XCTAssertTrue(scheduler.decide(at: self.date(0), speed: 0.5).shouldSample)
+        scheduler.recordResult(at: self.date(5), sensorDuration: 5, sampleRate: 50, predictedActivity: stationary)
+
+        let backedOff = scheduler.decide(at: self.date(20), speed: 0.5)
+        XCTAssertFalse(backedOff.shouldSample)
+        XCTAssertEqual(backedOff.declineReason, PredictionSchedulerDeclineReasonInterval)
+        XCTAssertEqual(backedOff.retryDate, self.date(35))
+
+        XCTAssertTrue(scheduler.decide(at: self.date(35), speed: 0.5).shouldSample)
+        scheduler.recordResult(at: self.date(40), sensorDuration: 5, sampleRate: 50, predictedActivity: stationary)
+        XCTAssertEqual(scheduler.decide(at: self.date(45), speed: 0.5).retryDate, self.date(100))
+
+        // a fast fix puts the interval back to the minimum
+        XCTAssertEqual(scheduler.decide(at: self.date(50), speed: 5).retryDate, self.date(55))
+        XCTAssertTrue(scheduler.decide(at: self.date(55), speed: 5).shouldSample)
+    }
+
+    func testConfidentResultStandsWhileTheSpeedAgrees() {
+        let scheduler = self.scheduler(sensorSecondsPerHour: 600)
+        XCTAssertTrue(scheduler.decide(at: self.date(0), speed: 0.5).shouldSample)
+        scheduler.recordResult(at: self.date(5), sensorDuration: 5, sampleRate: 50, predictedActivity: PredictedActivity(activityType: .stationary, confidence: 0.9, prediction: nil))
+
+        let slow = scheduler.decide(at: self.date(100), speed: 0.5)
+        XCTAssertFalse(slow.shouldSample)
+        XCTAssertEqual(slow.declineReason, PredictionSchedulerDeclineReasonConfidentResult)
+        XCTAssertEqual(slow.retryDate, self.date(305))
+        XCTAssertEqual(scheduler.standingResult?.activityType, .stationary)
+        XCTAssertEqual(scheduler.standingResult?.confidence, 0.9)
+        XCTAssertTrue(scheduler.decide(at: self.date(100), speed: 5).shouldSample)
+        
+        // an unknown result says nothing, so the confident one still stands
+        scheduler.recordResult(at: self.date(110), sensorDuration: 10, sampleRate: 50, predictedActivity: nil)
+        XCTAssertEqual(scheduler.standingResult?.activityType, .stationary)
+    }
+
+    func testSimulationTradesDetectionForSensorTime() {
+        // two hours of fixes every ten seconds, moving for ten minutes in the middle
+        var fixTimes: [Double] = []
+        var fixSpeeds: [Float] = []
+        var labelTimes: [Double] = []
+        var labelIsStationary: [Bool] = []
+        for t in stride(from: 0, to: 7200, by: 10) {
+            let isMoving = t >= 3600 && t < 4200
+            fixTimes.append(Double(t))
+            fixSpeeds.append(isMoving ? 6 : 0.3)
+            labelTimes.append(Double(t) + 5)
+            labelIsStationary.append(!isMoving)
+        }
+        let labelConfidences = [Float](repeating: 0.9, count: labelTimes.count)
+
+        let generous = self.scheduler(sensorSecondsPerHour: 600).simulate(fixTimes: fixTimes, fixSpeeds: fixSpeeds, labelTimes: labelTimes, labelIsStationary: labelIsStationary, labelConfidences: labelConfidences)
+        let frugal = self.scheduler(sensorSecondsPerHour: 30).simulate(fixTimes: fixTimes, fixSpeeds: fixSpeeds, labelTimes: labelTimes, labelIsStationary: labelIsStationary, labelConfidences: labelConfidences)
+
+        XCTAssertEqual(generous.requestCount, 720)
+        XCTAssertEqual(generous.movingEpisodeCount, 1)
+        XCTAssertEqual(generous.detectedEpisodeCount, 1)
+        XCTAssertEqual(generous.meanDetectionDelay, 5, accuracy: 0.01)
+        XCTAssertEqual(generous.budgetDeclinedCount, 0)
+
+        XCTAssertGreaterThan(frugal.budgetDeclinedCount, 0)
+        XCTAssertLessThan(frugal.sensorSeconds, generous.sensorSeconds)
+    }
+}
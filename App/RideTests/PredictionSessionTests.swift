@@ -0,0 +1,156 @@
+//
+//  PredictionSessionTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+import CoreMotion
+
+@testable import RouteRecorder
+
+class PredictionSessionTests: XCTestCase {
+    static let sampleRate: Double = 50
+
+    override func setUp() {
+        RouteRecorderDatabaseManager.startup(true)
+    }
+
+    class StubClassifier: ConcurrentAccelerometerWindowClassifier {
+        var classifiedOnMainThread = false
+
+        func predictedActivities(forWindow window: AccelerometerWindow)->[(activityType: ActivityType, confidence: Float)] {
+            if Thread.isMainThread {
+                self.classifiedOnMainThread = true
+            }
+            return [(activityType: .cycling, confidence: 0.9), (activityType: .walking, confidence: 0.1)]
+        }
+    }
+
+    func session(windowSchedule: (startDate: Date, duration: TimeInterval, offset: TimeInterval)? = nil, windowClassifier: ConcurrentAccelerometerWindowClassifier? = nil)->PredictionSession {
+        return PredictionSession(predictionAggregator: PredictionAggregator(), sampleRate: PredictionSessionTests.sampleRate, persistBatchDuration: 0.5, windowSchedule: windowSchedule, windowClassifier: windowClassifier)
+    }
+
+    // a second of pedalling-like readings
+    func accelerations(second: Int)->[(timestamp: TimeInterval, acceleration: CMAcceleration)] {
+        let timestamp = ProcessInfo.processInfo.systemUptime
+        return (0..<Int(PredictionSessionTests.sampleRate)).map {
+            let t = Double(second) + Double($0) / PredictionSessionTests.sampleRate
+            return (timestamp: timestamp + t, acceleration: CMAcceleration(x: 0.3 * sin(2 * Double.pi * 1.4 * t), y: 0, z: 1))
+        }
+    }
+
+    func testSessionCompletesOnceTheHandlerHasEnough() {
+        let session = self.session()
+        var handledCount = 0
+        let finished = self.expectation(description: "finished")
+        session.onFinish { (session) in
+            XCTAssertEqual(session.outcome, .completed)
+            finished.fulfill()
+        }
+        session.start(timeout: 10, remainingSamplesHandler: { (_) in }, updateHandler: { (_, update) -> Bool in
+            XCTAssertEqual(update.samples.count, Int(PredictionSessionTests.sampleRate))
+            handledCount += 1
+            return handledCount == 5
+        })
+
+        DispatchQueue.global().async {
+            for second in 0..<10 {
+                session.feed(self.accelerations(second: second))
+            }
+        }
+
+        self.waitForExpectations(timeout: 5, handler: nil)
+        XCTAssertEqual(handledCount, 5)
+        XCTAssertFalse(session.isBuffering)
+    }
+
+    func testWindowsAreClassifiedOffTheMainQueue() {
+        let classifier = StubClassifier()
+        let session = self.session(windowSchedule: (startDate: Date(), duration: 2, offset: 1), windowClassifier: classifier)
+        var windows: [PredictionSession.Window] = []
+        let finished = self.expectation(description: "finished")
+        session.onFinish { (_) in
+            finished.fulfill()
+        }
+        session.start(timeout: 10, remainingSamplesHandler: { (_) in }, updateHandler: { (_, update) -> Bool in
+            windows.append(contentsOf: update.windows)
+            return windows.count >= 3
+        })
+
+        DispatchQueue.global().async {
+            for second in 0..<10 {
+                session.feed(self.accelerations(second: second))
+            }
+        }
+
+        self.waitForExpectations(timeout: 5, handler: nil)
+        XCTAssertFalse(classifier.classifiedOnMainThread)
+        XCTAssertEqual(windows[0].predictedActivities?.first?.activityType, .cycling)
+        XCTAssertEqual(windows[0].spectralFeatures.count, Int(SpectralChannelCount.rawValue))
+        XCTAssertTrue(windows[0].samples.isEmpty)
+        XCTAssertEqual(windows[1].startDate.timeIntervalSince(windows[0].startDate), 1, accuracy: 0.05)
+    }
+
+    func testCancelledSessionLetsGoOfItsBuffers() {
+        let session = self.session()
+        var finishCount = 0
+        session.onFinish { (_) in
+            finishCount += 1
+        }
+        session.start(timeout: 10, remainingSamplesHandler: { (_) in }, updateHandler: { (_, _) -> Bool in
+            XCTFail("Cancelled session handled samples!")
+            return false
+        })
+
+        session.cancel()
+        session.cancel()
+        XCTAssertEqual(session.outcome, .cancelled)
+        XCTAssertEqual(finishCount, 1)
+        XCTAssertFalse(session.isBuffering)
+
+        // late samples are dropped, and handlers added after the fact are called right away
+        session.feed(self.accelerations(second: 0))
+        let drained = self.expectation(description: "drained")
+        DispatchQueue.main.async {
+            session.onFinish { (_) in
+                finishCount += 1
+            }
+            drained.fulfill()
+        }
+        self.waitForExpectations(timeout: 5, handler: nil)
+        XCTAssertEqual(finishCount, 2)
+    }
+
+    func testSessionTimesOutAtItsDeadline() {
+        let session = self.session()
+        var remainingSampleCount = 0
+        session.start(timeout: 0.5, remainingSamplesHandler: { (samples) in
+            remainingSampleCount = samples.count
+        }, updateHandler: { (_, _) -> Bool in
+            return false
+        })
+        session.feed(Array(self.accelerations(second: 0).prefix(10))) // less than a batch
+
+        let waited = self.expectation(description: "waited")
+        DispatchQueue.global().async {
+            XCTAssertNil(session.wait(until: .now() + 0.05))
+            XCTAssertEqual(session.wait(until: .now() + 5), .timedOut)
+            waited.fulfill()
+        }
+
+        self.waitForExpectations(timeout: 10, handler: nil)
+        XCTAssertFalse(session.isBuffering)
+
+        // the leftovers come back after the executor has drained them
+        let drained = self.expectation(description: "drained")
+        session.executor.submit {
+            DispatchQueue.main.async {
+                drained.fulfill()
+            }
+        }
+        self.waitForExpectations(timeout: 5, handler: nil)
+        XCTAssertEqual(remainingSampleCount, 10)
+    }
+}
@@ -0,0 +1,107 @@
+//
+//  PredictionStoppingRuleTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+
+@testable import RouteRecorder
+
+class PredictionStoppingRuleTests: XCTestCase {
+    override func setUp() {
+        RouteRecorderDatabaseManager.startup(true)
+    }
+
+    func window(_ activities: [(ActivityType, Float)])->[Float] {
+        var window = [Float](repeating: 0, count: ActivityVoteAccumulator.classCount)
+        for (activityType, confidence) in activities {
+            window[Int(ActivityVoteAccumulator.classIndex(activityType))] = confidence
+        }
+        return window
+    }
+
+    func prediction(_ activities: [(ActivityType, Float)], aggregator: PredictionAggregator)->Prediction {
+        let prediction = Prediction()
+        prediction.startDate = Date().addingTimeInterval(Double(aggregator.predictions.count) * PredictionAggregator.sampleOffsetTimeInterval)
+        for (activityType, confidence) in activities {
+            _ = PredictedActivity(activityType: activityType, confidence: confidence, prediction: prediction)
+        }
+        prediction.predictionAggregator = aggregator
+        return prediction
+    }
+
+    func testSequentialRuleDecidesConsistentSessionEarly() {
+        let aggregator = PredictionAggregator()
+        var windowCount = 0
+        while !aggregator.aggregatePredictionIsComplete() {
+            aggregator.addToAggregatePredictedActivity(self.prediction([(.cycling, 0.8), (.walking, 0.2)], aggregator: aggregator))
+            windowCount += 1
+        }
+        XCTAssertLessThan(windowCount, PredictionAggregator.minimumSampleCountForSuccess)
+        XCTAssertEqual(aggregator.stoppingRule?.decision, PredictionStoppingDecisionDecided)
+
+        // the confidence is the mean vote, not the rule's posterior
+        aggregator.finishAggregatePredictedActivity()
+        XCTAssertEqual(aggregator.aggregatePredictedActivity?.activityType, .cycling)
+        XCTAssertEqual(aggregator.aggregatePredictedActivity!.confidence, 0.8, accuracy: 0.001)
+        XCTAssertGreaterThanOrEqual(aggregator.aggregatePredictedActivity!.confidence, PredictionAggregator.highConfidence)
+    }
+
+    func testAmbiguousSessionRunsOutUndecided() {
+        let aggregator = PredictionAggregator()
+        for i in 0..<PredictionAggregator.maximumSampleBeforeFailure {
+            XCTAssertFalse(aggregator.aggregatePredictionIsComplete())
+            aggregator.addToAggregatePredictedActivity(self.prediction(i % 2 == 0 ? [(.automotive, 0.55), (.bus, 0.45)] : [(.bus, 0.55), (.automotive, 0.45)], aggregator: aggregator))
+        }
+        XCTAssertTrue(aggregator.aggregatePredictionIsComplete())
+        XCTAssertEqual(aggregator.stoppingRule?.decision, PredictionStoppingDecisionUndecided)
+
+        // falls back to the mean vote, which isn't confident enough to act on
+        aggregator.finishAggregatePredictedActivity()
+        XCTAssertLessThan(aggregator.aggregatePredictedActivity!.confidence, PredictionAggregator.highConfidence)
+    }
+
+    func testEvaluatorComparesRules() {
+        var sessions: [PredictionStoppingRuleEvaluator.Session] = []
+        for _ in 0..<20 {
+            sessions.append(PredictionStoppingRuleEvaluator.Session(windows: (0..<15).map { $0 % 4 == 3 ? self.window([(.walking, 0.6), (.running, 0.4)]) : self.window([(.running, 0.9), (.walking, 0.1)]) }, label: .running))
+        }
+        sessions.append(PredictionStoppingRuleEvaluator.Session(windows: (0..<15).map { _ in self.window([(.rail, 0.5), (.tram, 0.5)]) }, label: .tram))
+        let evaluator = PredictionStoppingRuleEvaluator(sessions: sessions)
+
+        let fixed = evaluator.evaluate(PredictionStoppingRule(kind: .fixed))
+        let sequential = evaluator.evaluate(PredictionStoppingRule(kind: .sequential))
+        XCTAssertEqual(fixed.sessionCount, 21)
+        XCTAssertEqual(fixed.decidedCount, 20)
+        XCTAssertEqual(fixed.decidedCorrectCount, 20)
+        XCTAssertEqual(sequential.decidedCount, 20)
+        XCTAssertEqual(sequential.decidedCorrectCount, 20)
+        XCTAssertLessThan(sequential.meanWindowCount, fixed.meanWindowCount)
+    }
+
+    func testEvaluatorReadsRecordedAggregators() {
+        // only the route the user confirmed has ground truth. the others predicted cycling too, but that's no label.
+        let confirmedRoute = Route()
+        var aggregators: [PredictionAggregator] = []
+        for route in [confirmedRoute, Route(), nil] {
+            let aggregator = PredictionAggregator()
+            aggregator.route = route
+            for _ in 0..<10 {
+                _ = self.prediction([(.cycling, 0.9), (.running, 0.1)], aggregator: aggregator)
+            }
+            aggregator.aggregatePredictedActivity = PredictedActivity(activityType: .cycling, confidence: 0.9, prediction: nil)
+            aggregators.append(aggregator)
+        }
+
+        let evaluator = PredictionStoppingRuleEvaluator()
+        evaluator.addSessions(from: aggregators + [PredictionAggregator()]) { (route) in
+            return route === confirmedRoute ? .cycling : nil
+        }
+        XCTAssertEqual(evaluator.sessions.count, 1)
+        XCTAssertEqual(evaluator.sessions.first?.windows.count, 10)
+        XCTAssertEqual(evaluator.sessions.first?.label, .cycling)
+        XCTAssertEqual(evaluator.evaluate(PredictionStoppingRule(kind: .sequential)).decidedCorrectCount, 1)
+    }
+}
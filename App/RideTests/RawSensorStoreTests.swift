@@ -0,0 +1,195 @@
+//
+//  RawSensorStoreTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+import CoreLocation
+
+@testable import RouteRecorder
+
+class RawSensorStoreTests: XCTestCase {
+    static let dayCount = 30
+    static let recordingDurationPerDay: TimeInterval = 30 * 60 // a couple of commutes
+    static let sampleRate: Double = 50
+    
+    var directoryURL: URL!
+    var store: RawSensorStore!
+    var monthStartDate: Date!
+    
+    override func setUp() {
+        self.directoryURL = URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent(UUID().uuidString)
+        self.store = RawSensorStore(directoryURL: self.directoryURL)
+        
+        // recordings start at 23:45 so every one of them straddles a day boundary
+        let startOfDay = floor(Date().timeIntervalSinceReferenceDate / (24 * 60 * 60)) * 24 * 60 * 60
+        self.monthStartDate = Date(timeIntervalSinceReferenceDate: startOfDay - Double(RawSensorStoreTests.dayCount + 1) * 24 * 60 * 60 + (23 * 60 + 45) * 60)
+    }
+    
+    override func tearDown() {
+        self.store = nil
+        try? FileManager.default.removeItem(at: self.directoryURL)
+    }
+    
+    func recordingStartDate(day: Int)->Date {
+        return self.monthStartDate.addingTimeInterval(Double(day) * 24 * 60 * 60)
+    }
+    
+    // a month of simulated 50hz recordings, appended a second at a time like the sensor pipeline does
+    func writeMonth() {
+        let samplesPerSecond = Int(RawSensorStoreTests.sampleRate)
+        var samples = [AccelerometerSample](repeating: AccelerometerSample(), count: samplesPerSecond)
+        
+        for day in 0..<RawSensorStoreTests.dayCount {
+            let startDate = self.recordingStartDate(day: day)
+            for second in 0..<Int(RawSensorStoreTests.recordingDurationPerDay) {
+                for i in 0..<samplesPerSecond {
+                    let t = Double(second) + Double(i) / RawSensorStoreTests.sampleRate
+                    samples[i] = AccelerometerSample(t: Float(t), x: Float(day), y: -1 + 0.3 * Float(sin(2 * Double.pi * 1.9 * t)), z: 0)
+                }
+                samples.withUnsafeBufferPointer { self.store.append($0, referenceDate: startDate) }
+                
+                if second % 10 == 0 {
+                    self.store.append([CLLocation(coordinate: CLLocationCoordinate2D(latitude: 45.52, longitude: -122.68), altitude: 20, horizontalAccuracy: 5, verticalAccuracy: 5, course: 90, speed: 5, timestamp: startDate.addingTimeInterval(Double(second)))])
+                }
+            }
+        }
+        self.store.sync()
+    }
+    
+    // a second of 50hz samples per second of the recording, each with the second it was recorded in as x
+    func writeRecording(seconds: CountableRange<Int>, startDate: Date) {
+        let samplesPerSecond = Int(RawSensorStoreTests.sampleRate)
+        var samples = [AccelerometerSample](repeating: AccelerometerSample(), count: samplesPerSecond)
+        
+        for second in seconds {
+            for i in 0..<samplesPerSecond {
+                samples[i] = AccelerometerSample(t: Float(Double(second) + Double(i) / RawSensorStoreTests.sampleRate), x: Float(second), y: -1, z: 0)
+            }
+            samples.withUnsafeBufferPointer { self.store.append($0, referenceDate: startDate) }
+        }
+        self.store.sync()
+    }
+    
+    func assertRecordingReadsBack(seconds: CountableRange<Int>, startDate: Date) {
+        let records = self.store.accelerometerRecords(from: startDate.addingTimeInterval(Double(seconds.lowerBound)), to: startDate.addingTimeInterval(Double(seconds.upperBound)))
+        XCTAssertEqual(records.count, seconds.count * Int(RawSensorStoreTests.sampleRate))
+        for (i, record) in records.enumerated() {
+            XCTAssertEqual(record.x, Float(seconds.lowerBound + i / Int(RawSensorStoreTests.sampleRate)))
+            XCTAssertEqual(record.y, -1)
+        }
+    }
+    
+    func segmentURLs()->[URL] {
+        let segmentDirectoryURL = self.directoryURL.appendingPathComponent("accelerometer")
+        let names = (try? FileManager.default.contentsOfDirectory(atPath: segmentDirectoryURL.path)) ?? []
+        return names.filter { $0.hasSuffix(".seg") }.map { segmentDirectoryURL.appendingPathComponent($0) }
+    }
+    
+    func testAppendingAfterATornRecord() {
+        let startDate = self.recordingStartDate(day: 0)
+        self.writeRecording(seconds: 0..<10, startDate: startDate)
+        self.store = nil
+        
+        // a crash part way through writing a record
+        XCTAssertEqual(self.segmentURLs().count, 1)
+        let segment = try! FileHandle(forWritingTo: self.segmentURLs()[0])
+        segment.seekToEndOfFile()
+        segment.write(Data([0x01, 0x02, 0x03, 0x04, 0x05]))
+        segment.closeFile()
+        
+        self.store = RawSensorStore(directoryURL: self.directoryURL)
+        self.writeRecording(seconds: 10..<20, startDate: startDate)
+        self.assertRecordingReadsBack(seconds: 0..<20, startDate: startDate)
+    }
+    
+    func testInterruptedCompaction() {
+        let startDate = self.recordingStartDate(day: 0)
+        self.writeRecording(seconds: 0..<(30 * 60), startDate: startDate)
+        let written = self.store.statistics
+        self.store = nil
+        
+        // a crash after the merged segment was renamed into place, but before the segments it merged were unlinked
+        let asideURL = self.directoryURL.appendingPathComponent("aside")
+        try! FileManager.default.createDirectory(at: asideURL, withIntermediateDirectories: true, attributes: nil)
+        let segmentURLs = self.segmentURLs()
+        for url in segmentURLs {
+            try! FileManager.default.copyItem(at: url, to: asideURL.appendingPathComponent(url.lastPathComponent))
+        }
+        self.store = RawSensorStore(directoryURL: self.directoryURL)
+        XCTAssertGreaterThan(self.store.compact(before: Date()), 0)
+        for url in segmentURLs where !FileManager.default.fileExists(atPath: url.path) {
+            try! FileManager.default.copyItem(at: asideURL.appendingPathComponent(url.lastPathComponent), to: url)
+        }
+        
+        self.store = RawSensorStore(directoryURL: self.directoryURL)
+        self.assertRecordingReadsBack(seconds: 0..<(30 * 60), startDate: startDate)
+        
+        self.store.compact(before: Date())
+        XCTAssertEqual(self.store.statistics.recordCount, written.recordCount)
+        self.assertRecordingReadsBack(seconds: 0..<(30 * 60), startDate: startDate)
+    }
+    
+    func testRecordingsReadBackInOrder() {
+        self.writeMonth()
+        
+        let startDate = self.recordingStartDate(day: 3)
+        let records = self.store.accelerometerRecords(from: startDate, to: startDate.addingTimeInterval(RawSensorStoreTests.recordingDurationPerDay))
+        XCTAssertEqual(records.count, Int(RawSensorStoreTests.recordingDurationPerDay * RawSensorStoreTests.sampleRate))
+        XCTAssertEqual(records.first?.x, 3)
+        XCTAssertEqual(records.first!.t, startDate.timeIntervalSinceReferenceDate, accuracy: 0.001)
+        for (i, record) in records.enumerated().dropFirst() {
+            XCTAssertGreaterThanOrEqual(record.t, records[i - 1].t)
+        }
+        
+        let locations = self.store.locationRecords(from: startDate, to: startDate.addingTimeInterval(RawSensorStoreTests.recordingDurationPerDay))
+        XCTAssertEqual(locations.count, Int(RawSensorStoreTests.recordingDurationPerDay / 10))
+    }
+    
+    func testCompactionAndRetention() {
+        let writeStart = ProcessInfo.processInfo.systemUptime
+        self.writeMonth()
+        let writeDuration = ProcessInfo.processInfo.systemUptime - writeStart
+        
+        let written = self.store.statistics
+        
+        let compactStart = ProcessInfo.processInfo.systemUptime
+        let mergedCount = self.store.compact(before: Date())
+        let compactDuration = ProcessInfo.processInfo.systemUptime - compactStart
+        
+        let compacted = self.store.statistics
+        XCTAssertEqual(compacted.recordCount, written.recordCount)
+        XCTAssertEqual(compacted.segmentCount, written.segmentCount - mergedCount)
+        
+        // every day's recording now lives in at most one segment per kind
+        let startDate = self.recordingStartDate(day: 10)
+        XCTAssertEqual(self.store.accelerometerRecords(from: startDate, to: startDate.addingTimeInterval(RawSensorStoreTests.recordingDurationPerDay)).count, Int(RawSensorStoreTests.recordingDurationPerDay * RawSensorStoreTests.sampleRate))
+        
+        let expireStart = ProcessInfo.processInfo.systemUptime
+        let expiredCount = self.store.expire(before: Date().addingTimeInterval(-1 * RawSensorStore.retentionInterval))
+        let expireDuration = ProcessInfo.processInfo.systemUptime - expireStart
+        
+        let expired = self.store.statistics
+        XCTAssertEqual(expired.segmentCount, compacted.segmentCount - expiredCount)
+        XCTAssertGreaterThan(expiredCount, 0)
+        XCTAssertLessThan(expired.recordCount, compacted.recordCount)
+        
+        print(String(format: "Wrote %lld records (%.1fMB, %d segments) in %.0fms, merged %d segments in %.0fms, expired %d segments in %.1fms",
+                     written.recordCount, Double(written.byteCount) / 1_000_000, written.segmentCount, writeDuration * 1000,
+                     mergedCount, compactDuration * 1000, expiredCount, expireDuration * 1000))
+    }
+    
+    func testExpiryPerformance() {
+        self.writeMonth()
+        self.store.compact(before: Date())
+        
+        // keep shrinking the retention window so every iteration drops a day of segments
+        var retainedDayCount = RawSensorStoreTests.dayCount
+        self.measure {
+            retainedDayCount -= 1
+            self.store.expire(before: Date().addingTimeInterval(-Double(retainedDayCount) * 24 * 60 * 60))
+        }
+    }
+}
@@ -0,0 +1,138 @@
+//
+//  ReadingTimeIndexTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+import CoreMotion
+
+@testable import RouteRecorder
+
+// The index stands in for the sorted Core Data fetches behind a prediction's window, so every answer is checked
+// against the fetch it replaces.
+class ReadingTimeIndexTests: XCTestCase {
+    static let sampleInterval: TimeInterval = 0.02
+
+    var predictionAggregator: PredictionAggregator!
+    var readingDates: [Date] = [] // in the order they were appended
+    var startDate = Date()
+
+    override func setUp() {
+        RouteRecorderDatabaseManager.startup(true)
+        self.predictionAggregator = PredictionAggregator()
+        self.readingDates = []
+        self.startDate = Date()
+    }
+
+    func addReading(at date: Date) {
+        let reading = AccelerometerReading(acceleration: CMAcceleration(x: 0, y: -1, z: 0))
+        reading.date = date
+        reading.predictionAggregator = self.predictionAggregator
+        self.predictionAggregator.readingTimeIndex.append(date)
+        self.readingDates.append(date)
+    }
+
+    // Ten seconds of readings, with every seventh reading duplicated and every eleventh pair arriving swapped.
+    func addIrregularReadings() {
+        var i = 0
+        while i < 500 {
+            let date = self.startDate.addingTimeInterval(Double(i) * ReadingTimeIndexTests.sampleInterval)
+            if i % 11 == 0 && i + 1 < 500 {
+                self.addReading(at: date.addingTimeInterval(ReadingTimeIndexTests.sampleInterval))
+                self.addReading(at: date)
+                i += 2
+                continue
+            }
+
+            self.addReading(at: date)
+            if i % 7 == 0 {
+                self.addReading(at: date)
+            }
+            i += 1
+        }
+        RouteRecorderDatabaseManager.shared.saveContext()
+    }
+
+    // on every reading, just either side of it, and outside the readings altogether
+    func queryDates()->[Date] {
+        var dates = [self.startDate.addingTimeInterval(-1), self.startDate.addingTimeInterval(20)]
+        for date in self.readingDates {
+            dates.append(contentsOf: [date, date.addingTimeInterval(-0.005), date.addingTimeInterval(0.005)])
+        }
+        return dates
+    }
+
+    func assertIndexMatchesFetch(file: StaticString = #file, line: UInt = #line) {
+        let index = self.predictionAggregator.readingTimeIndex
+        XCTAssertEqual(index.count, self.readingDates.count, file: file, line: line)
+        XCTAssertEqual(index.firstDate, self.readingDates.min(), file: file, line: line)
+        XCTAssertEqual(index.lastDate, self.predictionAggregator.fetchLastReading()?.date, file: file, line: line)
+
+        for date in self.queryDates() {
+            XCTAssertEqual(index.firstDate(onOrAfter: date), self.predictionAggregator.fetchFirstReading(afterDate: date)?.date, "\(date.timeIntervalSince(self.startDate))", file: file, line: line)
+        }
+    }
+
+    func testEmptyIndexHasNoDates() {
+        let index = ReadingTimeIndex()
+        XCTAssertTrue(index.isEmpty)
+        XCTAssertNil(index.firstDate)
+        XCTAssertNil(index.lastDate)
+        XCTAssertNil(index.firstDate(onOrAfter: self.startDate))
+    }
+
+    func testInOrderReadingsMatchTheFetch() {
+        for i in 0..<200 {
+            self.addReading(at: self.startDate.addingTimeInterval(Double(i) * ReadingTimeIndexTests.sampleInterval))
+        }
+        RouteRecorderDatabaseManager.shared.saveContext()
+
+        self.assertIndexMatchesFetch()
+    }
+
+    func testDuplicateAndOutOfOrderReadingsMatchTheFetch() {
+        self.addIrregularReadings()
+
+        self.assertIndexMatchesFetch()
+    }
+
+    func testLateReadingBeforeEverythingElse() {
+        for i in 1..<50 {
+            self.addReading(at: self.startDate.addingTimeInterval(Double(i) * ReadingTimeIndexTests.sampleInterval))
+        }
+        self.addReading(at: self.startDate)
+        RouteRecorderDatabaseManager.shared.saveContext()
+
+        XCTAssertEqual(self.predictionAggregator.readingTimeIndex.firstDate, self.startDate)
+        self.assertIndexMatchesFetch()
+    }
+
+    func testWindowsMatchTheFetchedWindows() {
+        self.addIrregularReadings()
+        let index = self.predictionAggregator.readingTimeIndex
+
+        // windows starting on a reading, between readings and before any
+        var windows: [(startDate: Date, readingDates: [Date])] = []
+        for startOffset in stride(from: -0.5, to: 8, by: 0.37) {
+            let prediction = Prediction()
+            prediction.startDate = self.startDate.addingTimeInterval(startOffset)
+            prediction.predictionAggregator = self.predictionAggregator
+            windows.append((startDate: prediction.startDate, readingDates: prediction.fetchAccelerometerReadings(timeInterval: 1).map { $0.date }))
+        }
+
+        // again, with the aggregator falling back to fetching the first reading
+        self.predictionAggregator.readingTimeIndex = ReadingTimeIndex()
+        for (startDate, indexedReadingDates) in windows {
+            let prediction = Prediction()
+            prediction.startDate = startDate
+            prediction.predictionAggregator = self.predictionAggregator
+            let fetchedReadingDates = prediction.fetchAccelerometerReadings(timeInterval: 1).map { $0.date }
+
+            XCTAssertFalse(fetchedReadingDates.isEmpty)
+            XCTAssertEqual(indexedReadingDates, fetchedReadingDates, "\(startDate.timeIntervalSince(self.startDate))")
+            XCTAssertEqual(indexedReadingDates.first, index.firstDate(onOrAfter: startDate))
+        }
+    }
+}
@@ -0,0 +1,93 @@
+//
+//  RecordingClassifierTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+
+@testable import RouteRecorder
+
+class RecordingClassifierTests: XCTestCase {
+    static let windowDuration: TimeInterval = 2
+
+    // calls anything that swings more than a quarter g cycling, and anything gentler walking
+    class AmplitudeClassifier: ConcurrentAccelerometerWindowClassifier {
+        func predictedActivities(forWindow window: AccelerometerWindow)->[(activityType: ActivityType, confidence: Float)] {
+            XCTAssertFalse(Thread.isMainThread)
+            let amplitude = window.samples.map { abs($0.x) }.max() ?? 0
+            if amplitude > 0.25 {
+                return [(activityType: .cycling, confidence: 0.8), (activityType: .walking, confidence: 0.2)]
+            }
+            return [(activityType: .walking, confidence: 0.7), (activityType: .cycling, confidence: 0.3)]
+        }
+    }
+
+    // A third of the duration on a table, a third cycling, then a ten second gap and a third walking with a brief
+    // burst of something faster in the middle of it.
+    func classify(duration: TimeInterval)->(segments: [RecordingClassifier.Segment], statistics: RecordingClassifierStatistics, startDate: Date) {
+        let classifier = RecordingClassifier(windowDuration: RecordingClassifierTests.windowDuration, workerCount: 4) { () -> ConcurrentAccelerometerWindowClassifier? in
+            return AmplitudeClassifier()
+        }!
+
+        let startDate = Date()
+        let sampleRate = classifier.sampleRate
+        let third = duration / 3
+        var batch: [AccelerometerSample] = []
+        var batchStart: TimeInterval = 0
+        for i in 0..<Int(duration * sampleRate) {
+            let t = Double(i) / sampleRate
+            if t >= 2 * third && t < 2 * third + 10 {
+                continue
+            }
+            if batch.isEmpty {
+                batchStart = t
+            }
+
+            var x: Double
+            if t < third {
+                x = 0.001 * sin(Double(i))
+            } else if t < 2 * third {
+                x = 0.4 * sin(2 * Double.pi * 1.4 * t)
+            } else {
+                let isBurst = t >= 2.5 * third && t < 2.5 * third + 20
+                x = (isBurst ? 0.4 : 0.1) * sin(2 * Double.pi * 2 * t)
+            }
+            batch.append(AccelerometerSample(t: Float(t - batchStart), x: Float(x), y: 0, z: Float(1 + abs(x) / 4)))
+
+            if batch.count == 1000 {
+                batch.withUnsafeBufferPointer { classifier.append($0, referenceDate: startDate.addingTimeInterval(batchStart)) }
+                batch.removeAll(keepingCapacity: true)
+            }
+        }
+        batch.withUnsafeBufferPointer { classifier.append($0, referenceDate: startDate.addingTimeInterval(batchStart)) }
+
+        return (segments: classifier.finish(), statistics: classifier.statistics, startDate: startDate)
+    }
+
+    func testRecordingBecomesATimelineOfSegments() {
+        let duration: TimeInterval = 3 * 60 * 60
+        let result = self.classify(duration: duration)
+
+        XCTAssertEqual(result.segments.map { $0.activityType }, [.stationary, .cycling, .walking])
+        XCTAssertEqual(result.segments[1].startDate.timeIntervalSince(result.startDate), duration / 3, accuracy: RecordingClassifierTests.windowDuration)
+        XCTAssertEqual(result.segments[1].endDate.timeIntervalSince(result.startDate), 2 * duration / 3, accuracy: RecordingClassifierTests.windowDuration)
+        XCTAssertEqual(result.segments[2].startDate.timeIntervalSince(result.startDate), 2 * duration / 3 + 10, accuracy: 0.1)
+        XCTAssertEqual(result.segments[1].confidence, 0.8, accuracy: 0.01)
+
+        XCTAssertEqual(result.statistics.gapCount, 1)
+        XCTAssertLessThan(result.statistics.scoredWindowCount, result.statistics.windowCount) // the still third wasn't scored
+    }
+
+    func testMemoryDoesNotGrowWithTheRecording() {
+        let short = self.classify(duration: 30 * 60)
+        let long = self.classify(duration: 4 * 60 * 60)
+
+        XCTAssertEqual(short.segments.count, long.segments.count)
+        let chunkSampleCount = Int32((RecordingClassifier.chunkDuration + RecordingClassifierTests.windowDuration) * SensorClassificationManager.modelSampleRate)
+        let inFlightLimit = Int32(4 * 2 + 1) * chunkSampleCount
+        XCTAssertLessThanOrEqual(short.statistics.peakBufferedSampleCount, inFlightLimit)
+        XCTAssertLessThanOrEqual(long.statistics.peakBufferedSampleCount, inFlightLimit)
+    }
+}
@@ -0,0 +1,103 @@
+//
+//  RouteJournalTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+import CoreLocation
+
+@testable import RouteRecorder
+
+class RouteJournalTests: XCTestCase {
+    var fileURL: URL!
+    var journal: RouteJournal!
+    
+    override func setUp() {
+        RouteRecorderDatabaseManager.startup(true)
+        
+        self.fileURL = URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent(UUID().uuidString + ".log")
+        self.journal = RouteJournal(fileURL: self.fileURL)
+    }
+    
+    override func tearDown() {
+        self.journal = nil
+        try? FileManager.default.removeItem(at: self.fileURL)
+    }
+    
+    func reopenJournal() {
+        self.journal = nil
+        self.journal = RouteJournal(fileURL: self.fileURL)
+    }
+    
+    func locations(count: Int, startDate: Date)->[CLLocation] {
+        return (0..<count).map { CLLocation(coordinate: CLLocationCoordinate2D(latitude: 45.52, longitude: -122.68), altitude: 20, horizontalAccuracy: 5, verticalAccuracy: 5, course: 90, speed: 5, timestamp: startDate.addingTimeInterval(Double($0))) }
+    }
+    
+    func testNewJournalIsIncompleteUntilCheckpointed() {
+        XCTAssertFalse(self.journal.isComplete)
+        self.journal.checkpoint()
+        
+        self.reopenJournal()
+        XCTAssertTrue(self.journal.isComplete)
+        XCTAssertEqual(self.journal.openRoutes.count, 0)
+    }
+    
+    func testOpenRoutesSurviveRelaunch() {
+        self.journal.checkpoint()
+        
+        let closedRoute = Route()
+        let openRoute = Route()
+        let startDate = Date()
+        self.journal.recordOpen(closedRoute, locationCount: 0)
+        self.journal.recordOpen(openRoute, locationCount: 1)
+        self.journal.recordLocations(self.locations(count: 10, startDate: startDate), for: openRoute)
+        self.journal.recordLocations(self.locations(count: 10, startDate: startDate.addingTimeInterval(10)), for: closedRoute)
+        self.journal.recordClose(routeUUID: closedRoute.uuid)
+        
+        self.reopenJournal()
+        XCTAssertTrue(self.journal.isComplete)
+        XCTAssertEqual(self.journal.openRoutes.count, 1)
+        XCTAssertEqual(self.journal.openRoutes.first?.uuid, openRoute.uuid)
+        XCTAssertEqual(self.journal.openRoutes.first?.locationCount, 11)
+        XCTAssertEqual(self.journal.openRoutes.first!.lastLocationDate!.timeIntervalSince1970, startDate.addingTimeInterval(9).timeIntervalSince1970, accuracy: 0.001)
+    }
+    
+    func testTornTailIsDiscarded() {
+        self.journal.checkpoint()
+        
+        let route = Route()
+        self.journal.recordOpen(route, locationCount: 0)
+        self.journal.recordLocations(self.locations(count: 5, startDate: Date()), for: route)
+        self.journal = nil
+        
+        // lose the middle of the last frame, like a crash mid-write would
+        let handle = try! FileHandle(forUpdating: self.fileURL)
+        handle.truncateFile(atOffset: handle.seekToEndOfFile() - 4)
+        handle.closeFile()
+        
+        self.journal = RouteJournal(fileURL: self.fileURL)
+        XCTAssertTrue(self.journal.isComplete)
+        XCTAssertEqual(self.journal.openRoutes.first?.uuid, route.uuid)
+        XCTAssertEqual(self.journal.openRoutes.first?.locationCount, 0)
+    }
+    
+    func testRecoveryPerformance() {
+        self.journal.checkpoint()
+        
+        // a long day of recording, a batch of locations a second
+        let route = Route()
+        self.journal.recordOpen(route, locationCount: 0)
+        let batch = self.locations(count: 1, startDate: Date())
+        for _ in 0..<(8 * 60 * 60) {
+            self.journal.recordLocations(batch, for: route)
+        }
+        self.journal = nil
+        
+        self.measure {
+            self.reopenJournal()
+            XCTAssertEqual(self.journal.openRoutes.first?.locationCount, 8 * 60 * 60)
+        }
+    }
+}
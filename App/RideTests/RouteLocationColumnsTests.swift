@@ -0,0 +1,125 @@
+//
+//  RouteLocationColumnsTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+import CoreLocation
+
+@testable import RouteRecorder
+
+class RouteLocationColumnsTests: XCTestCase {
+    static let routeDuration: TimeInterval = 4 * 60 * 60 // a long day out, at one fix a second
+    
+    var fileURL: URL!
+    var columns: RouteLocationColumns!
+    var startDate: Date!
+    
+    override func setUp() {
+        self.fileURL = URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent(UUID().uuidString).appendingPathComponent("route.loc")
+        self.columns = RouteLocationColumns(fileURL: self.fileURL)
+        self.startDate = Date(timeIntervalSinceReferenceDate: 600_000_000)
+    }
+    
+    override func tearDown() {
+        self.columns = nil
+        try? FileManager.default.removeItem(at: self.fileURL.deletingLastPathComponent())
+    }
+    
+    func location(at second: Int)->CLLocation {
+        let t = Double(second)
+        return CLLocation(coordinate: CLLocationCoordinate2D(latitude: 45.52 + 0.00004 * t, longitude: -122.68 + 0.00003 * sin(t / 60)),
+                          altitude: 20 + 5 * sin(t / 300), horizontalAccuracy: second % 50 == 0 ? 65 : 5, verticalAccuracy: 8,
+                          course: 45, speed: 5 + sin(t / 30), timestamp: self.startDate.addingTimeInterval(t))
+    }
+    
+    // appended in the same small batches the location manager delivers
+    func writeRoute() {
+        var batch: [CLLocation] = []
+        for second in 0..<Int(RouteLocationColumnsTests.routeDuration) {
+            batch.append(self.location(at: second))
+            if batch.count == 5 {
+                self.columns.append(batch, source: .activeGPS)
+                batch.removeAll()
+            }
+        }
+        self.columns.append(batch, source: .activeGPS)
+        self.columns.sync()
+    }
+    
+    func testRouteReadsBack() {
+        self.writeRoute()
+        
+        var second = 0
+        self.columns.forEachChunk { (records) in
+            for record in records {
+                let location = self.location(at: second)
+                XCTAssertEqual(record.t, location.timestamp.timeIntervalSinceReferenceDate, accuracy: 0.001)
+                XCTAssertEqual(record.latitude, location.coordinate.latitude, accuracy: 1e-7)
+                XCTAssertEqual(record.longitude, location.coordinate.longitude, accuracy: 1e-7)
+                XCTAssertEqual(record.speed, location.speed, accuracy: 0.01)
+                XCTAssertEqual(record.horizontalAccuracy, location.horizontalAccuracy, accuracy: 0.01)
+                XCTAssertEqual(record.source, LocationSource.activeGPS.rawValue)
+                second += 1
+            }
+        }
+        XCTAssertEqual(second, Int(RouteLocationColumnsTests.routeDuration))
+        XCTAssertTrue(self.columns.isSorted)
+        
+        let attributes = try? FileManager.default.attributesOfItem(atPath: self.fileURL.path)
+        print(String(format: "%d locations in %d bytes", second, attributes?[FileAttributeKey.size] as? Int ?? 0))
+    }
+    
+    func testReopenContinuesPartialChunk() {
+        self.columns.append((0..<1500).map { self.location(at: $0) }, source: .activeGPS)
+        self.columns = nil
+        
+        self.columns = RouteLocationColumns(fileURL: self.fileURL)
+        XCTAssertEqual(self.columns.rowCount, 1500)
+        self.columns.append((1500..<2048).map { self.location(at: $0) }, source: .activeGPS)
+        
+        var chunkRowCounts: [Int] = []
+        self.columns.forEachChunk { chunkRowCounts.append($0.count) }
+        XCTAssertEqual(chunkRowCounts, [1024, 1024])
+    }
+    
+    func testChunkStatisticsSkipChunks() {
+        self.writeRoute()
+        
+        // only the last hour
+        let startTime = self.startDate.addingTimeInterval(RouteLocationColumnsTests.routeDuration - 60 * 60).timeIntervalSinceReferenceDate
+        var decodedCount = 0
+        self.columns.forEachChunk(including: { $0.endTime >= startTime }) { (records) in
+            decodedCount += records.count
+        }
+        XCTAssertLessThan(decodedCount, Int(RouteLocationColumnsTests.routeDuration) / 3)
+        XCTAssertGreaterThanOrEqual(decodedCount, 60 * 60)
+    }
+    
+    func testOutOfOrderAppendIsNoticed() {
+        self.columns.append([self.location(at: 10)], source: .activeGPS)
+        self.columns.append([self.location(at: 5)], source: .geofence)
+        XCTAssertFalse(self.columns.isSorted)
+    }
+    
+    func testScanPerformance() {
+        self.writeRoute()
+        
+        self.measure {
+            var length: CLLocationDistance = 0
+            var lastLocation: CLLocation? = nil
+            self.columns.forEachChunk { (records) in
+                for record in records where record.horizontalAccuracy <= Location.acceptableLocationAccuracy {
+                    let location = CLLocation(latitude: record.latitude, longitude: record.longitude)
+                    if let lastLocation = lastLocation {
+                        length += lastLocation.distance(from: location)
+                    }
+                    lastLocation = location
+                }
+            }
+            XCTAssertGreaterThan(length, 0)
+        }
+    }
+}
@@ -0,0 +1,253 @@
+//
+//  RouteSimplifierTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+import CoreLocation
+import CoreMotion
+
+@testable import RouteRecorder
+
+class RouteSimplifierTests: XCTestCase {
+    var startDate: Date!
+    var route: Route!
+
+    override func setUp() {
+        RouteRecorderDatabaseManager.startup(true)
+        self.startDate = Date(timeIntervalSinceReferenceDate: 600_000_000)
+        self.route = Route()
+    }
+
+    // one fix a second, heading north unless east is given
+    func recordedLocations(count: Int, north: (Int)->Double = { Double($0) }, east: (Int)->Double = { _ in 0 }, speed: (Int)->Double = { _ in 5 })->[CLLocation] {
+        return (0..<count).map { (i) in
+            let coordinate = CLLocationCoordinate2D(latitude: 45.52 + 0.00005 * north(i), longitude: -122.68 + 0.00005 * east(i))
+            return CLLocation(coordinate: coordinate, altitude: 20, horizontalAccuracy: 5, verticalAccuracy: 5, course: 0, speed: speed(i), timestamp: self.startDate.addingTimeInterval(Double(i)))
+        }
+    }
+    
+    func addLocations(count: Int, north: (Int)->Double = { Double($0) }, east: (Int)->Double = { _ in 0 }, speed: (Int)->Double = { _ in 5 }, isActiveGPS: (Int)->Bool = { _ in true })->[Location] {
+        return self.recordedLocations(count: count, north: north, east: east, speed: speed).enumerated().map { (i, location) in
+            return Location(recordedLocation: location, isActiveGPS: isActiveGPS(i), route: self.route)
+        }
+    }
+
+    func simplify(_ locations: [Location])->IndexSet {
+        let simplifier = RouteSimplifier(episilon: self.route.simplificationEpisilon, speedEpisilon: self.route.simplificationSpeedEpisilon)
+        simplifier.append(locations)
+        return simplifier.simplify()
+    }
+
+    func testStraightLineKeepsItsEnds() {
+        XCTAssertEqual(self.simplify(self.addLocations(count: 100)), IndexSet([0, 99]))
+    }
+
+    func testCornerIsKept() {
+        let locations = self.addLocations(count: 100, north: { Double(min($0, 50)) }, east: { Double(max($0 - 50, 0)) })
+        XCTAssertEqual(self.simplify(locations), IndexSet([0, 50, 99]))
+    }
+
+    func testStopAndStartAreKept() {
+        let isStopped = { (i: Int) in i >= 40 && i < 60 }
+        let locations = self.addLocations(count: 100, north: { Double(isStopped($0) ? 40 : $0) }, speed: { isStopped($0) ? 0 : 5 })
+
+        let kept = self.simplify(locations)
+        XCTAssertTrue(kept.contains(40))
+        XCTAssertTrue(kept.contains(60))
+    }
+
+    func testNonGPSLocationsAreKeptWithTheOneAfter() {
+        let locations = self.addLocations(count: 100, isActiveGPS: { $0 != 40 })
+        XCTAssertEqual(self.simplify(locations), IndexSet([0, 40, 41, 99]))
+    }
+
+    func testRouteSimplifiesWithoutRecursion() {
+        // deep enough that splitting one corner at a time would have blown the stack
+        let locations = self.addLocations(count: 20_000, east: { Double($0 % 2) * 10 })
+        self.route.simplify()
+
+        let simplifiedLocations = self.route.fetchOrderedLocations(simplified: true, includingInferred: true)
+        XCTAssertEqual(simplifiedLocations.count, locations.count)
+    }
+
+    func testStreamingSettlesAsLocationsComeIn() {
+        // a zigzag with a corner every 50 fixes
+        let locations = self.addLocations(count: 1000, east: { Double(($0 / 50) % 2 == 0 ? $0 % 50 : 50 - $0 % 50) })
+
+        let simplifier = StreamingRouteSimplifier(episilon: self.route.simplificationEpisilon, speedEpisilon: self.route.simplificationSpeedEpisilon)
+        var settledLocations: [Location] = []
+        for batchStart in stride(from: 0, to: locations.count, by: 5) {
+            settledLocations.append(contentsOf: simplifier.append(Array(locations[batchStart..<min(batchStart + 5, locations.count)])))
+        }
+        XCTAssertGreaterThan(settledLocations.count, 10)
+
+        let finishedLocations = simplifier.finish()
+        XCTAssertLessThanOrEqual(finishedLocations.count, StreamingRouteSimplifier.lookaheadCount + 1)
+        settledLocations.append(contentsOf: finishedLocations)
+
+        XCTAssert(settledLocations.first === locations.first)
+        XCTAssert(settledLocations.last === locations.last)
+        XCTAssertEqual(settledLocations.map { $0.date }, settledLocations.map { $0.date }.sorted())
+        XCTAssertEqual(Set(settledLocations.map { ObjectIdentifier($0) }).count, settledLocations.count)
+    }
+
+    func testRecordedRouteFinishesTheLiveSimplification() {
+        RouteRecorder.inject(motionManager: CMMotionManager(),
+                             locationManager: LocationManager(type: .coreLocation),
+                             routeManager: RouteManager(),
+                             randomForestManager: RandomForestManager(),
+                             classificationManager: SensorClassificationManager())
+        RouteRecorderStore.store().lastArrivalLocation = nil
+        
+        // opened the way RouteManager opens a route, with the aggregator that predicted it, whose locations came in
+        // before GPS did and out of date order
+        self.route.open()
+        let aggregatedLocations = [40.0, 10.0, 25.0].map { (secondsBefore: Double)->Location in
+            let location = CLLocation(coordinate: CLLocationCoordinate2D(latitude: 45.519, longitude: -122.68), altitude: 20, horizontalAccuracy: 65, verticalAccuracy: 10, course: -1, speed: -1, timestamp: self.startDate.addingTimeInterval(-secondsBefore))
+            return Location(recordedLocation: location, isActiveGPS: false)
+        }
+        self.route.addPredictionAggregator(PredictionAggregator(locations: aggregatedLocations))
+        
+        // a zigzag with a corner every 50 fixes, delivered a few at a time
+        let locations = self.recordedLocations(count: 600, east: { Double(($0 / 50) % 2 == 0 ? $0 % 50 : 50 - $0 % 50) })
+        for batchStart in stride(from: 0, to: locations.count, by: 5) {
+            RouteRecorder.shared.routeManager.processGPSLocations(Array(locations[batchStart..<min(batchStart + 5, locations.count)]), forRoute: self.route)
+        }
+        self.route.close()
+        
+        XCTAssertTrue(self.route.wasSimplifiedLive)
+        let simplifiedDates = Set(self.route.fetchOrderedLocations(simplified: true, includingInferred: true).map { $0.date })
+        for location in aggregatedLocations {
+            XCTAssertTrue(simplifiedDates.contains(location.date))
+        }
+        XCTAssertTrue(simplifiedDates.contains(locations.first!.timestamp))
+        XCTAssertTrue(simplifiedDates.contains(locations.last!.timestamp))
+        XCTAssertLessThan(simplifiedDates.count, locations.count / 4)
+    }
+    
+    // the accurate fixes of the recorded route in 1.archive, in date order
+    func recordedRouteLocations(isActiveGPS: (Int)->Bool = { _ in true })->[Location]? {
+        guard let path = Bundle(for: type(of: self)).path(forResource: "1", ofType: "archive"),
+            let recordedLocations = NSKeyedUnarchiver.unarchiveObject(withFile: path) as? [CLLocation] else {
+            XCTFail("Missing recorded route!")
+            return nil
+        }
+
+        return recordedLocations.sorted { $0.timestamp < $1.timestamp }.filter { $0.horizontalAccuracy <= Location.acceptableLocationAccuracy }.enumerated().map {
+            Location(recordedLocation: $0.element, isActiveGPS: isActiveGPS($0.offset), route: self.route)
+        }
+    }
+
+    // The recursive Ramer–Douglas–Peucker that Route used before simplification went native, kept as the reference
+    // the native one has to match.
+    func recursivelySimplify(_ locations: [Location], range: ClosedRange<Int>, keptIndexes: inout IndexSet) {
+        let episilon = self.route.simplificationEpisilon
+        let speedEpisilon = self.route.simplificationSpeedEpisilon
+        let startLoc = locations[range.lowerBound]
+        let endLoc = locations[range.upperBound]
+
+        guard range.count > 2 else {
+            keptIndexes.insert(range.lowerBound)
+            keptIndexes.insert(range.upperBound)
+            return
+        }
+
+        var maximumDistance: CLLocationDegrees = 0
+        var indexOfMaximumDistance = range.lowerBound
+        var maximumSpeedDifference: CLLocationSpeed = 0
+        var indexOfMaximumSpeedDifference = range.lowerBound
+        var currentlyStopped = startLoc.speed >= 0 && startLoc.speed < Location.minimumMovingSpeed
+
+        for index in (range.lowerBound + 1)..<range.upperBound {
+            let loc = locations[index]
+
+            // twice the area of the triangle over the length of its base
+            let doubleArea = abs(startLoc.longitude * (endLoc.latitude - loc.latitude) + endLoc.longitude * (loc.latitude - startLoc.latitude) + loc.longitude * (startLoc.latitude - endLoc.latitude))
+            let distance = doubleArea / sqrt(pow(startLoc.longitude - endLoc.longitude, 2) + pow(startLoc.latitude - endLoc.latitude, 2))
+            if distance > maximumDistance {
+                indexOfMaximumDistance = index
+                maximumDistance = distance
+            }
+
+            let speedSlope = (endLoc.speed - startLoc.speed) / endLoc.date.timeIntervalSince(startLoc.date)
+            if startLoc.speed >= 0 && endLoc.speed >= 0 && loc.speed >= 0 {
+                let expectedSpeed = startLoc.speed + speedSlope * loc.date.timeIntervalSince(startLoc.date)
+                let speedDifference = fabs(expectedSpeed - loc.speed)
+                if speedDifference > maximumSpeedDifference {
+                    indexOfMaximumSpeedDifference = index
+                    maximumSpeedDifference = speedDifference
+                } else if !currentlyStopped && loc.speed < Location.minimumMovingSpeed {
+                    currentlyStopped = true
+                    indexOfMaximumSpeedDifference = index
+                    maximumSpeedDifference = Double.greatestFiniteMagnitude
+                } else if currentlyStopped && loc.speed >= Location.minimumMovingSpeed {
+                    currentlyStopped = false
+                    indexOfMaximumSpeedDifference = index
+                    maximumSpeedDifference = Double.greatestFiniteMagnitude
+                }
+            }
+        }
+
+        if maximumDistance > episilon || maximumSpeedDifference > speedEpisilon {
+            var cutOffIndex = indexOfMaximumSpeedDifference
+            if maximumDistance > episilon && maximumSpeedDifference < Double.greatestFiniteMagnitude {
+                cutOffIndex = indexOfMaximumDistance
+            }
+            self.recursivelySimplify(locations, range: range.lowerBound...cutOffIndex, keptIndexes: &keptIndexes)
+            self.recursivelySimplify(locations, range: cutOffIndex...range.upperBound, keptIndexes: &keptIndexes)
+        } else {
+            keptIndexes.insert(range.lowerBound)
+            for index in range where locations[index].source != .activeGPS {
+                keptIndexes.insert(index)
+                if index < range.upperBound {
+                    keptIndexes.insert(index + 1)
+                }
+            }
+            keptIndexes.insert(range.upperBound)
+        }
+    }
+
+    func testBatchMatchesTheRecursiveSimplificationOnARecordedRoute() {
+        guard let locations = self.recordedRouteLocations() else {
+            return
+        }
+
+        var expectedIndexes = IndexSet()
+        self.recursivelySimplify(locations, range: 0...(locations.count - 1), keptIndexes: &expectedIndexes)
+        let keptIndexes = self.simplify(locations)
+        XCTAssertEqual(keptIndexes, expectedIndexes)
+
+        // pinned, so a change that moved both of them would still show up
+        XCTAssertEqual(locations.count, 455)
+        XCTAssertEqual(keptIndexes, IndexSet([0, 5, 14, 23, 49, 58, 62, 64, 66, 70, 73, 80, 95, 111, 139, 183, 188, 194, 196, 219, 242, 271, 274, 282, 309, 315, 317, 334, 337, 343, 345, 362, 377, 379, 394, 396, 401, 454]))
+    }
+
+    func testBatchMatchesTheRecursiveSimplificationWithNonGPSLocations() {
+        guard let locations = self.recordedRouteLocations(isActiveGPS: { $0 % 37 != 0 }) else {
+            return
+        }
+
+        var expectedIndexes = IndexSet()
+        self.recursivelySimplify(locations, range: 0...(locations.count - 1), keptIndexes: &expectedIndexes)
+        XCTAssertEqual(self.simplify(locations), expectedIndexes)
+        XCTAssertEqual(expectedIndexes.count, 61)
+    }
+
+    func testStreamingIsAsAccurateAsWholeRouteOnARecordedRoute() {
+        guard let locations = self.recordedRouteLocations() else {
+            return
+        }
+
+        let comparison = StreamingRouteSimplifier.compare(locations, episilon: self.route.simplificationEpisilon, speedEpisilon: self.route.simplificationSpeedEpisilon)
+
+        // each stretch between kept locations is held to the same bounds, the lookahead only costs a few more of them
+        XCTAssertLessThanOrEqual(comparison.streamingMaximumDistance, self.route.simplificationEpisilon * 1.001)
+        XCTAssertLessThanOrEqual(comparison.streamingMaximumSpeedDifference, self.route.simplificationSpeedEpisilon * 1.001)
+        XCTAssertLessThanOrEqual(comparison.maximumDistance, self.route.simplificationEpisilon * 1.001)
+        XCTAssertLessThanOrEqual(comparison.streamingKeptCount, comparison.keptCount * 5 / 4)
+        XCTAssertLessThan(comparison.streamingKeptCount, comparison.locationCount / 4)
+    }
+}
@@ -0,0 +1,185 @@
+//
+//  RouteUploadSpoolTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+
+@testable import RouteRecorder
+
+class RouteUploadSpoolTests: XCTestCase {
+    var directoryURL: URL!
+    var spool: RouteUploadSpool!
+    
+    override func setUp() {
+        self.directoryURL = URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent(UUID().uuidString)
+        self.spool = RouteUploadSpool(directoryURL: self.directoryURL, maximumSegmentSize: 4096)
+    }
+    
+    override func tearDown() {
+        self.spool = nil
+        try? FileManager.default.removeItem(at: self.directoryURL)
+    }
+    
+    func reopenSpool() {
+        self.spool = nil
+        self.spool = RouteUploadSpool(directoryURL: self.directoryURL, maximumSegmentSize: 4096)
+    }
+    
+    func body(_ index: Int)->Data {
+        return Data(repeating: UInt8(index % 256), count: 1000 + index)
+    }
+    
+    func segmentURLs(_ kind: RouteUploadSpool.Kind)->[URL] {
+        let contents = (try? FileManager.default.contentsOfDirectory(at: self.directoryURL.appendingPathComponent(kind.rawValue), includingPropertiesForKeys: nil)) ?? []
+        return contents.filter { $0.pathExtension == "spool" }.sorted { $0.lastPathComponent < $1.lastPathComponent }
+    }
+    
+    func testEntriesAreDeliveredInOrderUntilAcknowledged() {
+        for i in 0..<10 {
+            XCTAssertTrue(self.spool.enqueue(self.body(i), routeUUID: "route-\(i)", kind: .summary))
+        }
+        XCTAssertEqual(self.spool.pendingCount(.summary), 10)
+        XCTAssertEqual(self.spool.pendingCount(.full), 0)
+        XCTAssertNil(self.spool.nextEntry(.full))
+        
+        for i in 0..<10 {
+            guard let entry = self.spool.nextEntry(.summary) else {
+                XCTFail("Missing entry")
+                return
+            }
+            XCTAssertEqual(entry.routeUUID, "route-\(i)")
+            XCTAssertEqual(entry.body, self.body(i))
+            
+            // unacknowledged entries are delivered again
+            XCTAssertEqual(self.spool.nextEntry(.summary)?.sequence, entry.sequence)
+            self.spool.acknowledge(entry)
+        }
+        XCTAssertNil(self.spool.nextEntry(.summary))
+    }
+    
+    func testUnacknowledgedEntriesSurviveRelaunchWithTheirIdempotencyKey() {
+        for i in 0..<3 {
+            self.spool.enqueue(self.body(i), routeUUID: "route-\(i)", kind: .full)
+        }
+        let first = self.spool.nextEntry(.full)!
+        self.spool.acknowledge(first)
+        let second = self.spool.nextEntry(.full)!
+        
+        self.reopenSpool()
+        let reopened = self.spool.nextEntry(.full)!
+        XCTAssertEqual(reopened.sequence, second.sequence)
+        XCTAssertEqual(reopened.idempotencyKey, second.idempotencyKey)
+        XCTAssertEqual(reopened.body, second.body)
+        XCTAssertEqual(self.spool.pendingCount(.full), 2)
+        
+        // sequences keep counting up, past the acknowledged ones
+        self.spool.enqueue(self.body(3), routeUUID: "route-3", kind: .full)
+        self.spool.acknowledge(reopened)
+        self.spool.acknowledge(self.spool.nextEntry(.full)!)
+        XCTAssertEqual(self.spool.nextEntry(.full)?.routeUUID, "route-3")
+        XCTAssertGreaterThan(self.spool.nextEntry(.full)!.sequence, reopened.sequence)
+    }
+    
+    func testTornEntryIsDroppedOnRelaunch() {
+        for i in 0..<2 {
+            self.spool.enqueue(self.body(i), routeUUID: "route-\(i)", kind: .summary)
+        }
+        self.spool = nil
+        
+        let lastSegmentURL = self.segmentURLs(.summary).last!
+        let handle = try! FileHandle(forUpdating: lastSegmentURL)
+        handle.truncateFile(atOffset: handle.seekToEndOfFile() - 100)
+        handle.closeFile()
+        
+        self.reopenSpool()
+        XCTAssertEqual(self.spool.pendingCount(.summary), 1)
+        XCTAssertEqual(self.spool.nextEntry(.summary)?.routeUUID, "route-0")
+        
+        self.spool.enqueue(self.body(2), routeUUID: "route-2", kind: .summary)
+        self.reopenSpool()
+        XCTAssertEqual(self.spool.pendingCount(.summary), 2)
+    }
+    
+    func testUploadedRoutesAreSkipped() {
+        for i in 0..<4 {
+            self.spool.enqueue(self.body(i), routeUUID: "route-\(i)", kind: .summary)
+        }
+        
+        // a full upload of route-0 and route-1 went up, so their summaries are stale. route-3's is behind one that
+        // still has to go, and waits its turn.
+        let uploadedRouteUUIDs: Set<String> = ["route-0", "route-1", "route-3"]
+        let isUploaded = { (entry: RouteUploadSpool.Entry) in uploadedRouteUUIDs.contains(entry.routeUUID) }
+        XCTAssertEqual(self.spool.nextEntry(.summary, skipping: isUploaded)?.routeUUID, "route-2")
+        XCTAssertEqual(self.spool.pendingCount(.summary), 2)
+        
+        self.spool.acknowledge(self.spool.nextEntry(.summary)!)
+        self.spool.acknowledgeEntries(.summary, while: isUploaded)
+        XCTAssertNil(self.spool.nextEntry(.summary))
+        XCTAssertEqual(self.spool.pendingCount(.summary), 0)
+    }
+    
+    func testSummaryOfAFullyUploadedRouteIsSkipped() {
+        RouteRecorderDatabaseManager.startup(true)
+        let route = Route()
+        route.isClosed = true
+        route.isSummaryUploaded = true
+        route.isUploaded = true
+        let pendingRoute = Route()
+        pendingRoute.isClosed = true
+        
+        self.spool.enqueue(self.body(0), routeUUID: route.uuid, kind: .summary)
+        self.spool.enqueue(self.body(1), routeUUID: pendingRoute.uuid, kind: .summary)
+        self.spool.enqueue(self.body(2), routeUUID: UUID().uuidString, kind: .summary)
+        
+        XCTAssertEqual(self.spool.nextEntry(.summary, skipping: RouteUploadSpool.routeIsUploaded)?.routeUUID, pendingRoute.uuid)
+        XCTAssertEqual(self.spool.pendingCount(.summary), 2)
+        
+        // a route that's gone still gets its upload
+        self.spool.acknowledge(self.spool.nextEntry(.summary)!)
+        XCTAssertNotNil(self.spool.nextEntry(.summary, skipping: RouteUploadSpool.routeIsUploaded))
+    }
+    
+    func testEntriesUnderARetiredUUIDAreDropped() {
+        self.spool.enqueue(self.body(0), routeUUID: "route-0", kind: .summary)
+        self.spool.enqueue(self.body(1), routeUUID: "route-1", kind: .full)
+        self.spool.enqueue(self.body(2), routeUUID: "route-0", kind: .full)
+        self.spool.enqueue(self.body(3), routeUUID: "route-2", kind: .full)
+        
+        // route-0's summary conflicted and was acknowledged. its full upload is behind route-1's and goes once it
+        // reaches the head.
+        self.spool.acknowledge(self.spool.nextEntry(.summary)!)
+        self.spool.retireRouteUUID("route-0")
+        XCTAssertEqual(self.spool.pendingCount(.full), 3)
+        
+        let isUploaded = { (entry: RouteUploadSpool.Entry) in false }
+        self.spool.acknowledge(self.spool.nextEntry(.full, skipping: isUploaded)!)
+        XCTAssertEqual(self.spool.nextEntry(.full, skipping: isUploaded)?.routeUUID, "route-2")
+        XCTAssertEqual(self.spool.pendingCount(.full), 1)
+        
+        // a retired UUID at the head is dropped right away
+        self.spool.enqueue(self.body(4), routeUUID: "route-2", kind: .summary)
+        self.spool.retireRouteUUID("route-2")
+        XCTAssertNil(self.spool.nextEntry(.full))
+        XCTAssertNil(self.spool.nextEntry(.summary))
+    }
+    
+    func testAcknowledgedSegmentsAreRemoved() {
+        for i in 0..<12 {
+            self.spool.enqueue(self.body(i), routeUUID: "route-\(i)", kind: .summary)
+        }
+        let segmentCount = self.segmentURLs(.summary).count
+        XCTAssertGreaterThan(segmentCount, 2)
+        
+        for _ in 0..<6 {
+            self.spool.acknowledge(self.spool.nextEntry(.summary)!)
+        }
+        XCTAssertLessThan(self.segmentURLs(.summary).count, segmentCount)
+        
+        self.spool.removeAll()
+        XCTAssertEqual(self.spool.pendingCount(.summary), 0)
+        XCTAssertEqual(self.segmentURLs(.summary).count, 0)
+    }
+}
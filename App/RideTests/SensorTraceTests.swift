@@ -0,0 +1,124 @@
+//
+//  SensorTraceTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+import SwiftyJSON
+
+@testable import RouteRecorder
+
+class SensorTraceTests: XCTestCase {
+    static let sessionDuration = 30 * 60 // seconds of 20Hz accelerometer readings, with a fix a second
+
+    var fileURL: URL!
+    var startDate: Date!
+
+    override func setUp() {
+        self.fileURL = URL(fileURLWithPath: NSTemporaryDirectory()).appendingPathComponent(UUID().uuidString + ".trace")
+        self.startDate = Date(timeIntervalSinceReferenceDate: 600_000_000)
+    }
+
+    override func tearDown() {
+        try? FileManager.default.removeItem(at: self.fileURL)
+    }
+
+    // appended the way sensors deliver them, a second of readings then the fix that landed in the middle of it
+    func writeSession() {
+        let writer = SensorTraceWriter(fileURL: self.fileURL)!
+        let t0 = self.startDate.timeIntervalSinceReferenceDate
+        for second in 0..<SensorTraceTests.sessionDuration {
+            let t = t0 + Double(second)
+            XCTAssertTrue(writer.append(accelerometerRecords: (0..<20).map { SensorTraceAccelerometerRecord(t: t + Double($0) / 20, x: Float(sin(Double($0))), y: 0, z: 1) }))
+            XCTAssertTrue(writer.append(locationRecords: [SensorTraceLocationRecord(t: t + 0.5, latitude: 45.52 + 0.00004 * Double(second), longitude: -122.68, altitude: 20, speed: 5, course: 45, horizontalAccuracy: 5, verticalAccuracy: 8, source: 1)]))
+            if second % 10 == 0 {
+                XCTAssertTrue(writer.append(predictionRecords: [SensorTracePredictionRecord(t: t, activityType: ActivityType.cycling.rawValue, confidence: 0.9)]))
+            }
+        }
+        XCTAssertTrue(writer.finish())
+    }
+
+    func testRecordsAreReadBackInTimeOrder() {
+        self.writeSession()
+
+        let reader = SensorTraceReader(fileURL: self.fileURL)!
+        let expectedCount = SensorTraceTests.sessionDuration * 21 + SensorTraceTests.sessionDuration / 10
+        XCTAssertEqual(reader.recordCount, expectedCount)
+        XCTAssertGreaterThan(reader.chunkCount, 1)
+        XCTAssertEqual(reader.startDate, self.startDate)
+
+        var count = 0
+        var locationCount = 0
+        var lastTime = -Double.infinity
+        while let record = reader.next() {
+            XCTAssertGreaterThanOrEqual(record.time, lastTime)
+            lastTime = record.time
+            if record.type == SensorTraceRecordTypeLocation {
+                XCTAssertEqual(record.location.latitude, 45.52 + 0.00004 * Double(locationCount), accuracy: 1e-9)
+                locationCount += 1
+            }
+            count += 1
+        }
+        XCTAssertEqual(count, expectedCount)
+        XCTAssertEqual(locationCount, SensorTraceTests.sessionDuration)
+
+        let size = (try! FileManager.default.attributesOfItem(atPath: self.fileURL.path)[FileAttributeKey.size] as! NSNumber).intValue
+        XCTAssertLessThan(size, expectedCount * 12)
+    }
+
+    func testSeekStartsAtFirstRecordAtOrAfterTheDate() {
+        self.writeSession()
+
+        let reader = SensorTraceReader(fileURL: self.fileURL)!
+        XCTAssertTrue(reader.seek(to: self.startDate.addingTimeInterval(900.5)))
+        let record = reader.next()!
+        XCTAssertEqual(record.type, SensorTraceRecordTypeAccelerometer)
+        XCTAssertEqual(record.time, self.startDate.addingTimeInterval(900.5).timeIntervalSinceReferenceDate, accuracy: 1e-6)
+
+        reader.seek(to: self.startDate.addingTimeInterval(Double(SensorTraceTests.sessionDuration)))
+        XCTAssertNil(reader.next())
+    }
+
+    func testAppendEarlierThanWrittenChunkIsRejected() {
+        let writer = SensorTraceWriter(fileURL: self.fileURL)!
+        let t0 = self.startDate.timeIntervalSinceReferenceDate
+        XCTAssertTrue(writer.append(accelerometerRecords: (0..<20_000).map { SensorTraceAccelerometerRecord(t: t0 + Double($0) / 20, x: 0, y: 0, z: 1) }))
+        XCTAssertFalse(writer.append(locationRecords: [SensorTraceLocationRecord(t: t0, latitude: 45.52, longitude: -122.68, altitude: 20, speed: 5, course: 45, horizontalAccuracy: 5, verticalAccuracy: 8, source: 1)]))
+    }
+
+    func testUnfinishedTraceIsReadable() {
+        self.writeSession()
+
+        // as if the writer never got to write its index
+        let handle = try! FileHandle(forUpdating: self.fileURL)
+        handle.truncateFile(atOffset: handle.seekToEndOfFile() - 8)
+        handle.closeFile()
+
+        let reader = SensorTraceReader(fileURL: self.fileURL)!
+        XCTAssertEqual(reader.recordCount, SensorTraceTests.sessionDuration * 21 + SensorTraceTests.sessionDuration / 10)
+        XCTAssertTrue(reader.seek(to: self.startDate.addingTimeInterval(600)))
+        XCTAssertEqual(reader.next()?.time, self.startDate.addingTimeInterval(600).timeIntervalSinceReferenceDate)
+    }
+
+    func testConvertsJSONDump() {
+        let json = JSON([
+            "accelerometerReadings": (0..<40).map { ["date": self.startDate.addingTimeInterval(Double($0) / 20).JSONString(includingMilliseconds: true), "x": 0.1, "y": 0.2, "z": 0.98] },
+            "locations": (0..<2).map { ["date": self.startDate.addingTimeInterval(Double($0)).JSONString(includingMilliseconds: true), "latitude": 45.52, "longitude": -122.68, "speed": 5.0, "course": 45.0, "horizontalAccuracy": 5.0, "source": 1] },
+            "predictions": [["startDate": self.startDate.JSONString(includingMilliseconds: true), "predictedActivities": [["activityType": 2, "confidence": 0.7], ["activityType": 3, "confidence": 0.3]]]]
+        ])
+        XCTAssertTrue(SensorTraceWriter.convert(JSON: json, to: self.fileURL))
+
+        let reader = SensorTraceReader(fileURL: self.fileURL)!
+        XCTAssertEqual(reader.recordCount, 44)
+        var predictionCount = 0
+        while let record = reader.next() {
+            if record.type == SensorTraceRecordTypePrediction {
+                XCTAssertEqual(record.time, self.startDate.timeIntervalSinceReferenceDate, accuracy: 1e-3)
+                predictionCount += 1
+            }
+        }
+        XCTAssertEqual(predictionCount, 2)
+    }
+}
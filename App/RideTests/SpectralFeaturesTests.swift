@@ -0,0 +1,116 @@
+//
+//  SpectralFeaturesTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+
+@testable import RouteRecorder
+
+class SpectralFeaturesTests: XCTestCase {
+    static let sampleRate: Double = 50
+    static let windowDuration: TimeInterval = 6
+    static let amplitude: Double = 0.2
+
+    // one tone in the middle of each band: 0.5-1.5, 1.5-3, 3-6 and 6hz-nyquist
+    static let bandTones: [Double] = [1, 2.5, 4.5, 10]
+
+    var extractor: SpectralFeatureExtractor!
+
+    override func setUp() {
+        RouteRecorderDatabaseManager.startup(true)
+        self.extractor = SpectralFeatureExtractor(sampleRate: SpectralFeaturesTests.sampleRate, windowDuration: SpectralFeaturesTests.windowDuration)
+    }
+
+    func readings(duration: TimeInterval = SpectralFeaturesTests.windowDuration, acceleration: (TimeInterval)->(x: Double, y: Double, z: Double))->[AccelerometerReading] {
+        let startDate = Date()
+        return (0..<Int(duration * SpectralFeaturesTests.sampleRate)).map { (i)->AccelerometerReading in
+            let t = Double(i) / SpectralFeaturesTests.sampleRate
+            let (x, y, z) = acceleration(t)
+            return AccelerometerReading(detachedSample: AccelerometerSample(t: Float(t), x: Float(x), y: Float(y), z: Float(z)), date: startDate.addingTimeInterval(t))
+        }
+    }
+
+    // a tone on x, and the same tone on top of gravity on y so the magnitude carries it too
+    func tone(_ frequency: Double, duration: TimeInterval = SpectralFeaturesTests.windowDuration)->[SpectralFeatures] {
+        return self.extractor.features(forReadings: self.readings(duration: duration) { (t) in
+            let wave = SpectralFeaturesTests.amplitude * sin(2 * Double.pi * frequency * t)
+            return (x: wave, y: -1 + wave, z: 0)
+        })
+    }
+
+    func bandEnergies(_ features: SpectralFeatures)->[Float] {
+        let bands = features.bandEnergies
+        return [bands.0, bands.1, bands.2, bands.3]
+    }
+
+    func testToneLandsInItsBand() {
+        for (band, frequency) in SpectralFeaturesTests.bandTones.enumerated() {
+            let features = self.tone(frequency)
+            for channel in [SpectralChannelX, SpectralChannelY, SpectralChannelMagnitude] {
+                let channelFeatures = features[Int(channel.rawValue)]
+                let bandEnergies = self.bandEnergies(channelFeatures)
+                XCTAssertGreaterThan(bandEnergies[band], 0.95, "\(frequency)hz on channel \(channel.rawValue)")
+                XCTAssertEqual(bandEnergies.reduce(0, +), 1, accuracy: 1e-3)
+            }
+
+            // z is flat, so it has nothing to report
+            XCTAssertEqual(features[Int(SpectralChannelZ.rawValue)].power, 0)
+            XCTAssertEqual(self.bandEnergies(features[Int(SpectralChannelZ.rawValue)]), [0, 0, 0, 0])
+        }
+    }
+
+    func testCentroidIsAtTheTone() {
+        for frequency in SpectralFeaturesTests.bandTones {
+            let features = self.tone(frequency)
+            XCTAssertEqual(Double(features[Int(SpectralChannelX.rawValue)].centroid), frequency, accuracy: 0.05)
+            XCTAssertEqual(Double(features[Int(SpectralChannelMagnitude.rawValue)].centroid), frequency, accuracy: 0.05)
+        }
+    }
+
+    func testPowerIsTheSignalsMeanSquare() {
+        let features = self.tone(2.5)
+        XCTAssertEqual(features[Int(SpectralChannelX.rawValue)].power, Float(SpectralFeaturesTests.amplitude * SpectralFeaturesTests.amplitude / 2), accuracy: 1e-3)
+    }
+
+    func testToneHasLowEntropyAndNoiseHasHigh() {
+        for frequency in SpectralFeaturesTests.bandTones {
+            let features = self.tone(frequency)[Int(SpectralChannelX.rawValue)]
+            XCTAssertLessThan(features.entropy, 0.3)
+            XCTAssertLessThan(features.flatness, 0.01)
+        }
+
+        var seed: UInt64 = 1
+        let noise = { ()->Double in
+            seed = seed &* 6364136223846793005 &+ 1442695040888963407
+            return Double(seed >> 11) / Double(UInt64(1) << 53) * 2 - 1
+        }
+        let features = self.extractor.features(forReadings: self.readings { (_) in (x: 0.2 * noise(), y: -1 + 0.2 * noise(), z: 0.2 * noise()) })
+        for channelFeatures in features {
+            XCTAssertGreaterThan(channelFeatures.entropy, 0.85)
+            XCTAssertGreaterThan(channelFeatures.flatness, 0.4)
+            XCTAssertGreaterThan(channelFeatures.centroid, 6)
+        }
+    }
+
+    func testStillPhoneHasNoFeatures() {
+        let features = self.extractor.features(forReadings: self.readings { (_) in (x: 0, y: -1, z: 0) })
+        for channelFeatures in features {
+            XCTAssertEqual(channelFeatures.power, 0)
+            XCTAssertEqual(self.bandEnergies(channelFeatures), [0, 0, 0, 0])
+            XCTAssertEqual(channelFeatures.centroid, 0)
+            XCTAssertEqual(channelFeatures.entropy, 0)
+            XCTAssertEqual(channelFeatures.flatness, 0)
+        }
+    }
+
+    func testShortWindowIsZeroPadded() {
+        // half a window still puts the tone in its band, just with more leakage
+        let features = self.tone(4.5, duration: SpectralFeaturesTests.windowDuration / 2)[Int(SpectralChannelX.rawValue)]
+        XCTAssertGreaterThan(self.bandEnergies(features)[2], 0.9)
+        XCTAssertEqual(features.centroid, 4.5, accuracy: 0.1)
+        XCTAssertLessThan(features.entropy, 0.5)
+    }
+}
@@ -0,0 +1,151 @@
+//
+//  StationaryDetectorTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+import CoreMotion
+
+@testable import RouteRecorder
+
+class StationaryDetectorTests: XCTestCase {
+    static let sampleRate: Double = 50
+    static let windowSampleCount = Int(StationaryDetector.windowDuration * StationaryDetectorTests.sampleRate)
+    static let holdSampleCount = Int(StationaryDetector.holdDuration * StationaryDetectorTests.sampleRate)
+
+    var detector: StationaryDetector!
+    var seed: UInt64 = 1
+
+    override func setUp() {
+        self.detector = StationaryDetector(sampleRate: StationaryDetectorTests.sampleRate)
+        self.seed = 1
+    }
+
+    func noise()->Double {
+        self.seed = self.seed &* 6364136223846793005 &+ 1442695040888963407
+        return Double(self.seed >> 11) / Double(UInt64(1) << 53) * 2 - 1
+    }
+
+    // a phone on a table, well under the stationary threshold
+    func still(_ t: TimeInterval)->Double {
+        return 0.002 * self.noise()
+    }
+
+    func walking(_ t: TimeInterval)->Double {
+        return 0.3 * sin(2 * Double.pi * 1.9 * t)
+    }
+
+    // a standard deviation of about 0.015g, between the two thresholds
+    func borderline(_ t: TimeInterval)->Double {
+        return 0.021 * sin(2 * Double.pi * 1.9 * t)
+    }
+
+    // Feeds one sample at a time, each stretch a duration of motion on top of gravity, and returns the state after
+    // every sample.
+    func feed(_ stretches: [(duration: TimeInterval, motion: (TimeInterval)->Double)])->[Bool] {
+        var states: [Bool] = []
+        for (duration, motion) in stretches {
+            for _ in 0..<Int(duration * StationaryDetectorTests.sampleRate) {
+                let t = Double(states.count) / StationaryDetectorTests.sampleRate
+                let acceleration = CMAcceleration(x: 0, y: -1 + motion(t), z: 0)
+                states.append(self.detector.isStationary(afterAccelerations: [(timestamp: t, acceleration: acceleration)]))
+            }
+        }
+        return states
+    }
+
+    func testStillPhoneIsStationaryOnceTheWindowFillsAndHolds() {
+        XCTAssertLessThan(self.detector.standardDeviation, 0)
+
+        let states = self.feed([(duration: 10, motion: self.still)])
+        XCTAssertEqual(states.index(of: true), StationaryDetectorTests.windowSampleCount + StationaryDetectorTests.holdSampleCount - 2)
+        XCTAssertFalse(states.suffix(from: states.index(of: true)!).contains(false))
+        XCTAssertLessThan(self.detector.standardDeviation, StationaryDetector.stationaryThreshold)
+    }
+
+    func testMovingPhoneIsNeverStationary() {
+        XCTAssertFalse(self.feed([(duration: 10, motion: self.walking)]).contains(true))
+        XCTAssertGreaterThan(self.detector.standardDeviation, StationaryDetector.movingThreshold)
+    }
+
+    func testMovingLeavesStationaryRightAway() {
+        let states = self.feed([(duration: 5, motion: self.still), (duration: 5, motion: self.walking)])
+        let movingIndex = Int(5 * StationaryDetectorTests.sampleRate)
+        XCTAssertTrue(states[movingIndex - 1])
+
+        let leftIndex = states.suffix(from: movingIndex).index(of: false)
+        XCTAssertNotNil(leftIndex)
+        XCTAssertLessThan((leftIndex ?? Int.max) - movingIndex, 10)
+        XCTAssertFalse(states.suffix(from: leftIndex ?? states.count).contains(true))
+    }
+
+    func testStoppingIsStationaryOnlyAfterTheMotionLeavesTheWindowAndHolds() {
+        let states = self.feed([(duration: 5, motion: self.walking), (duration: 5, motion: self.still)])
+        let stillIndex = Int(5 * StationaryDetectorTests.sampleRate)
+
+        let stationaryIndex = states.index(of: true)
+        XCTAssertNotNil(stationaryIndex)
+        XCTAssertGreaterThanOrEqual(stationaryIndex ?? 0, stillIndex + StationaryDetectorTests.holdSampleCount)
+        XCTAssertLessThan(stationaryIndex ?? Int.max, stillIndex + StationaryDetectorTests.windowSampleCount + StationaryDetectorTests.holdSampleCount)
+    }
+
+    func testBorderlineMotionHoldsWhicheverStateItFinds() {
+        // the hysteresis band keeps a stationary phone stationary...
+        let fromStill = self.feed([(duration: 5, motion: self.still), (duration: 10, motion: self.borderline)])
+        XCTAssertFalse(fromStill.suffix(from: Int(5 * StationaryDetectorTests.sampleRate)).contains(false))
+        XCTAssertGreaterThan(self.detector.standardDeviation, StationaryDetector.stationaryThreshold)
+        XCTAssertLessThan(self.detector.standardDeviation, StationaryDetector.movingThreshold)
+
+        // ...and a moving one moving
+        self.detector.reset()
+        let fromWalking = self.feed([(duration: 5, motion: self.walking), (duration: 10, motion: self.borderline)])
+        XCTAssertFalse(fromWalking.contains(true))
+    }
+
+    func testBorderlineMotionRestartsTheHold() {
+        // quiet stretches shorter than the hold, broken up by borderline motion, never add up to stationary
+        let quietDuration = StationaryDetector.holdDuration / 2
+        var stretches: [(duration: TimeInterval, motion: (TimeInterval)->Double)] = [(duration: 5, motion: self.walking)]
+        for _ in 0..<6 {
+            stretches.append((duration: StationaryDetector.windowDuration, motion: self.borderline))
+            stretches.append((duration: quietDuration, motion: self.still))
+        }
+        XCTAssertFalse(self.feed(stretches).contains(true))
+    }
+
+    func testResetStartsOver() {
+        XCTAssertTrue(self.feed([(duration: 5, motion: self.still)]).last!)
+
+        self.detector.reset()
+        XCTAssertLessThan(self.detector.standardDeviation, 0)
+        XCTAssertFalse(self.detector.isStationary(afterAccelerations: [(timestamp: 0, acceleration: CMAcceleration(x: 0, y: -1, z: 0))]))
+    }
+
+    func testBatchesAreTheSameAsSingleSamples() {
+        // the gate takes four samples at a time where it can, so odd batch sizes exercise the tail too
+        let accelerations = (0..<500).map { (i)->(timestamp: TimeInterval, acceleration: CMAcceleration) in
+            let t = Double(i) / StationaryDetectorTests.sampleRate
+            return (timestamp: t, acceleration: CMAcceleration(x: 0.01 * self.noise(), y: -1 + (i < 250 ? self.walking(t) : self.still(t)), z: 0.01 * self.noise()))
+        }
+
+        var singleStates: [Bool] = []
+        for acceleration in accelerations {
+            singleStates.append(self.detector.isStationary(afterAccelerations: [acceleration]))
+        }
+        let singleDeviation = self.detector.standardDeviation
+
+        let batchedDetector = StationaryDetector(sampleRate: StationaryDetectorTests.sampleRate)
+        let batchCounts = [7, 4, 1, 13, 3]
+        var start = 0
+        var batch = 0
+        while start < accelerations.count {
+            let end = min(start + batchCounts[batch % batchCounts.count], accelerations.count)
+            XCTAssertEqual(batchedDetector.isStationary(afterAccelerations: Array(accelerations[start..<end])), singleStates[end - 1])
+            start = end
+            batch += 1
+        }
+        XCTAssertEqual(batchedDetector.standardDeviation, singleDeviation, accuracy: 1e-4)
+    }
+}
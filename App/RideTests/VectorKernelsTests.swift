@@ -0,0 +1,132 @@
+//
+//  VectorKernelsTests.swift
+//  Ride Report Tests
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import XCTest
+
+@testable import RouteRecorder
+
+class VectorKernelsTests: XCTestCase {
+    // lengths that leave a tail after every vector width, and some that are shorter than one vector
+    static let counts = [0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 33, 64, 1003]
+    static let instructionSets = [VectorInstructionSetBaseline, VectorInstructionSetAVX2, VectorInstructionSetAVX512]
+
+    var u: [Float]!
+    var v: [Float]!
+    var w: [Float]!
+
+    override func setUp() {
+        let count = VectorKernelsTests.counts.max()!
+        var seed: UInt32 = 2
+        let random = { ()->Float in
+            seed = seed &* 1664525 &+ 1013904223
+            return Float(seed >> 8) / Float(1 << 24) - 0.5
+        }
+        self.u = (0..<count).map { _ in random() }
+        self.v = (0..<count).map { _ in random() }
+        self.w = (0..<count).map { _ in random() + 0.5 }
+    }
+
+    override func tearDown() {
+        // back to the widest the CPU supports
+        vectorKernelsSetInstructionSet(VectorInstructionSetAVX512)
+    }
+
+    // Runs the checks once with the kernels pinned to each instruction set the CPU can run.
+    func forEachInstructionSet(_ check: (VectorInstructionSet, Int)->Void) {
+        var checkedInstructionSets: [VectorInstructionSet] = []
+        for instructionSet in VectorKernelsTests.instructionSets {
+            let pinnedInstructionSet = vectorKernelsSetInstructionSet(instructionSet)
+            XCTAssertEqual(vectorKernelsInstructionSet(), pinnedInstructionSet)
+            guard !checkedInstructionSets.contains(pinnedInstructionSet) else {
+                continue
+            }
+            checkedInstructionSets.append(pinnedInstructionSet)
+
+            for count in VectorKernelsTests.counts {
+                check(pinnedInstructionSet, count)
+            }
+        }
+    }
+
+    func assertEqual(_ values: [Float], _ expectedValues: [Float], accuracy: Float, _ message: String) {
+        XCTAssertEqual(values.count, expectedValues.count, message)
+        for (value, expectedValue) in zip(values, expectedValues) {
+            XCTAssertEqual(value, expectedValue, accuracy: accuracy, message)
+        }
+    }
+
+    func testSums() {
+        self.forEachInstructionSet { (instructionSet, count) in
+            let message = "instruction set \(instructionSet.rawValue), count \(count)"
+            let values = Array(self.u.prefix(count))
+
+            var sum: Float = 0
+            var sumOfSquares: Float = 0
+            vectorKernelsSumAndSumOfSquares(values, Int32(count), &sum, &sumOfSquares)
+            XCTAssertEqual(vectorKernelsSum(values, Int32(count)), values.reduce(0, +), accuracy: 1e-3, message)
+            XCTAssertEqual(sum, values.reduce(0, +), accuracy: 1e-3, message)
+            XCTAssertEqual(sumOfSquares, values.reduce(0) { $0 + $1 * $1 }, accuracy: 1e-3, message)
+        }
+    }
+
+    func testElementwiseKernels() {
+        self.forEachInstructionSet { (instructionSet, count) in
+            let message = "instruction set \(instructionSet.rawValue), count \(count)"
+            let u = Array(self.u.prefix(count))
+            let v = Array(self.v.prefix(count))
+            let w = Array(self.w.prefix(count))
+            var dst = [Float](repeating: -1, count: count)
+
+            vectorKernelsMagnitude3(u, v, w, &dst, Int32(count))
+            self.assertEqual(dst, (0..<count).map { sqrt(u[$0] * u[$0] + v[$0] * v[$0] + w[$0] * w[$0]) }, accuracy: 1e-5, message)
+
+            vectorKernelsSquare(u, &dst, Int32(count), 0.01)
+            self.assertEqual(dst, u.map { max($0 * $0, 0.01) }, accuracy: 1e-6, message)
+
+            vectorKernelsSubtractAndMultiply(u, 0.1, w, &dst, Int32(count))
+            self.assertEqual(dst, (0..<count).map { (u[$0] - 0.1) * w[$0] }, accuracy: 1e-6, message)
+
+            let ones = vectorKernelsLessOrEqual(u, v, &dst, Int32(count))
+            let expectedOnes = (0..<count).map { u[$0] <= v[$0] ? Float(1) : Float(0) }
+            XCTAssertEqual(Int(ones), expectedOnes.filter { $0 == 1 }.count, message)
+            self.assertEqual(dst, expectedOnes, accuracy: 0, message)
+        }
+    }
+
+    func testAbsLinear() {
+        self.forEachInstructionSet { (instructionSet, count) in
+            let message = "instruction set \(instructionSet.rawValue), count \(count)"
+            let u = Array(self.u.prefix(count))
+            let v = Array(self.v.prefix(count))
+            var dst = [Float](repeating: -1, count: count)
+
+            // mixed signs, so the absolute value matters as much as the line
+            let (a, b, c): (Float, Float, Float) = (0.75, -1.25, 0.05)
+            vectorKernelsAbsLinear(u, v, a, b, c, &dst, Int32(count))
+            self.assertEqual(dst, (0..<count).map { abs(a * u[$0] + b * v[$0] + c) }, accuracy: 1e-6, message)
+            XCTAssertFalse(dst.contains { $0 < 0 }, message)
+        }
+    }
+
+    func testAbsLinearScansAChordLikeTheSimplifier() {
+        // points relative to the start of a chord, the way RouteSimplifier packs them, so |a*u + b*v + c| is the
+        // distance from the chord scaled by its length
+        let chord: (u: Float, v: Float) = (0.003, 0.004)
+        let u = (0..<37).map { Float($0) / 36 * chord.u }
+        let v = u.enumerated().map { $0.element * chord.v / chord.u + ($0.offset == 20 ? 0.0001 : 0) }
+
+        self.forEachInstructionSet { (instructionSet, _) in
+            var dst = [Float](repeating: -1, count: u.count)
+            vectorKernelsAbsLinear(u, v, chord.v, -chord.u, 0, &dst, Int32(u.count))
+
+            let length = (chord.u * chord.u + chord.v * chord.v).squareRoot()
+            XCTAssertEqual(dst.index(of: dst.max()!), 20, "instruction set \(instructionSet.rawValue)")
+            XCTAssertEqual(dst[20] / length, 0.0001 * chord.u / length, accuracy: 1e-7)
+            XCTAssertEqual(dst[0], 0, accuracy: 1e-9)
+        }
+    }
+}
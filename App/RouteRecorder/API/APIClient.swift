@@ -387,37 +387,8 @@ public class APIClient {
         }
      }
     
-    @discardableResult public func uploadRoute(_ route: Route, includeFullLocations: Bool)->AuthenticatedAPIRequest {        
-        guard (route.isClosed) else {
-            DDLogWarn("Tried to upload route info on unclosed route!")
-            
-            return AuthenticatedAPIRequest(clientAbortedWithResponse: AuthenticatedAPIRequest.clientAbortedResponse())
-        }
-        
-        guard !(route.isUploaded) else {
-            DDLogWarn("Tried to upload route that was already uploaded!")
-            
-            return AuthenticatedAPIRequest(clientAbortedWithResponse: AuthenticatedAPIRequest.clientAbortedResponse())
-        }
-        
-        if let existingRequest = self.routeRequests[route] {
-            // if an existing API request is in flight and we have local changes, wait to upload until after it completes
-            
-            if !route.isUploaded {
-                existingRequest.requestCompletetionBlock = {
-                    // we need to reset isUploaded since the changes were made after the request went out.
-                    self.uploadRoute(route, includeFullLocations: includeFullLocations)
-                }
-                return existingRequest
-            } else {
-                // if we dont have local changes, simply skip this
-                return AuthenticatedAPIRequest(clientAbortedWithResponse: AuthenticatedAPIRequest.clientAbortedResponse())
-            }
-        }
-        
-        let routeURL = "routes/" + route.uuid
-        
-        let method = Alamofire.HTTPMethod.put
+    // The body of a route upload. Returns nil if the route doesn't have the locations to upload yet.
+    class func routeUploadParameters(for route: Route, includeFullLocations: Bool)->[String: Any]? {
         var routeDict = [
             "activityType": route.activityType.numberValue,
             "creationDate": route.creationDate.JSONString(includingMilliseconds: true)
@@ -430,7 +401,7 @@ public class APIClient {
         let summaryLocs = route.fetchOrGenerateSummaryLocations()
         
         if summaryLocs.count == 0 {
-            return AuthenticatedAPIRequest(clientAbortedWithResponse: AuthenticatedAPIRequest.clientAbortedResponse())
+            return nil
         }
         
         var summaryLocations : [Any?] = []
@@ -443,7 +414,7 @@ public class APIClient {
         if includeFullLocations {
             guard route.locationCount() > 0 else {
                 DDLogWarn("No locations found when syncing route locations!")
-                return AuthenticatedAPIRequest(clientAbortedWithResponse: AuthenticatedAPIRequest.clientAbortedResponse())
+                return nil
             }
             
             var locations : [Any?] = []
@@ -455,11 +426,53 @@ public class APIClient {
             routeDict["locations"] = locations
         }
         
+        if route.activitySegments.count > 0 {
+            routeDict["activitySegments"] = route.activitySegments.map { $0.jsonDictionary() }
+        }
+        
         routeDict["length"] = route.length
+        
+        return routeDict
+    }
+    
+    @discardableResult public func uploadRoute(_ route: Route, includeFullLocations: Bool)->AuthenticatedAPIRequest {        
+        guard (route.isClosed) else {
+            DDLogWarn("Tried to upload route info on unclosed route!")
+            
+            return AuthenticatedAPIRequest(clientAbortedWithResponse: AuthenticatedAPIRequest.clientAbortedResponse())
+        }
+        
+        guard !(route.isUploaded) else {
+            DDLogWarn("Tried to upload route that was already uploaded!")
+            
+            return AuthenticatedAPIRequest(clientAbortedWithResponse: AuthenticatedAPIRequest.clientAbortedResponse())
+        }
+        
+        if let existingRequest = self.routeRequests[route] {
+            // if an existing API request is in flight and we have local changes, wait to upload until after it completes
+            
+            if !route.isUploaded {
+                existingRequest.requestCompletetionBlock = {
+                    // we need to reset isUploaded since the changes were made after the request went out.
+                    self.uploadRoute(route, includeFullLocations: includeFullLocations)
+                }
+                return existingRequest
+            } else {
+                // if we dont have local changes, simply skip this
+                return AuthenticatedAPIRequest(clientAbortedWithResponse: AuthenticatedAPIRequest.clientAbortedResponse())
+            }
+        }
+        
+        let routeURL = "routes/" + route.uuid
+        
+        let method = Alamofire.HTTPMethod.put
+        guard let routeDict = APIClient.routeUploadParameters(for: route, includeFullLocations: includeFullLocations) else {
+            return AuthenticatedAPIRequest(clientAbortedWithResponse: AuthenticatedAPIRequest.clientAbortedResponse())
+        }
 
         DDLogInfo("Uploading route…")
         
-        self.routeRequests[route] = AuthenticatedAPIRequest(client: self, method: method, route: routeURL, parameters: routeDict as [String : Any]?) { (response) in
+        self.routeRequests[route] = AuthenticatedAPIRequest(client: self, method: method, route: routeURL, parameters: routeDict) { (response) in
             self.routeRequests[route] = nil
             switch response.result {
             case .success(_):
@@ -485,6 +498,49 @@ public class APIClient {
         return self.routeRequests[route]!
     }
     
+    // Sends a route upload exactly as it was spooled when the route closed, and acknowledges it once the server has it.
+    @discardableResult func uploadSpooledRoute(_ entry: RouteUploadSpool.Entry)->AuthenticatedAPIRequest {
+        let routeURL = "routes/" + entry.routeUUID
+        
+        DDLogInfo("Uploading spooled route…")
+        
+        return AuthenticatedAPIRequest(client: self, method: .put, route: routeURL, encoding: GZippedBodyEncoding(body: entry.body), idempotencyKey: entry.idempotencyKey) { (response) in
+            switch response.result {
+            case .success(_):
+                DDLogInfo("Uploaded route")
+                
+                RouteUploadSpool.shared?.acknowledge(entry)
+                if let route = Route.findRoute(withUUID: entry.routeUUID), route.isClosed {
+                    // a reopened route is spooled again when it closes
+                    route.isSummaryUploaded = true
+                    if entry.kind == .full {
+                        route.isUploaded = true
+                    }
+                    
+                    RouteRecorderDatabaseManager.shared.saveContext()
+                }
+                if entry.kind == .full {
+                    // the full upload carries the summary too, so a summary still spooled for it is stale
+                    RouteUploadSpool.shared?.acknowledgeEntries(.summary, while: RouteUploadSpool.routeIsUploaded)
+                }
+            case .failure(let error):
+                DDLogWarn(String(format: "Error syncing route: %@", error as CVarArg))
+                
+                if let httpResponse = response.response, httpResponse.statusCode == 409 {
+                    // a route with that UUID exists. spool it again under a new one; any other entries still under
+                    // the old UUID would conflict too, so they're dropped.
+                    RouteUploadSpool.shared?.acknowledge(entry)
+                    RouteUploadSpool.shared?.retireRouteUUID(entry.routeUUID)
+                    if let route = Route.findRoute(withUUID: entry.routeUUID) {
+                        route.generateUUID()
+                        RouteRecorderDatabaseManager.shared.saveContext()
+                        RouteUploadSpool.shared?.enqueue(route)
+                    }
+                }
+            }
+        }
+    }
+    
     public func triggerGreenLight(for zone: TriggerZoneCircularRegion, locations: [Location]) {
         let greenLightRouteURL = "trigger_zones/" + zone.uuid + "/hit"
         var params: [String : Any] = [:]
@@ -0,0 +1,85 @@
+//
+//  AccelerometerResampler.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+import CoreMotion
+
+// Normalizes accelerometer data recorded at any supported rate to the rate the classifier was trained at.
+// Not thread safe; feed it from a single serial queue.
+class AccelerometerResampler {
+    static let supportedInputSampleRates: [Double] = [10, 25, 50, 100]
+
+    let inputSampleRate: Double
+    let outputSampleRate: Double
+
+    private var resampler: OpaquePointer!
+    private var outputBuffer: [AccelerometerSample]
+    private let outputCapacity: Int32
+    private var referenceTimestamp: TimeInterval?
+
+    init(inputSampleRate: Double, outputSampleRate: Double) {
+        self.inputSampleRate = inputSampleRate
+        self.outputSampleRate = outputSampleRate
+        let resampler = createPolyphaseResampler(Float(inputSampleRate), Float(outputSampleRate))
+        self.resampler = resampler
+        self.outputCapacity = polyphaseResamplerMaximumOutputCount(resampler)
+        self.outputBuffer = [AccelerometerSample](repeating: AccelerometerSample(), count: Int(self.outputCapacity))
+    }
+
+    deinit {
+        deletePolyphaseResampler(self.resampler)
+    }
+
+    var latency: TimeInterval {
+        return TimeInterval(polyphaseResamplerLatency(self.resampler))
+    }
+
+    func reset() {
+        polyphaseResamplerReset(self.resampler)
+        self.referenceTimestamp = nil
+    }
+
+    // Returns the resampled accelerations (if any) that became available with this reading.
+    // Timestamps are in the same time base as CMLogItem.timestamp.
+    func resample(_ accelerometerData: CMAccelerometerData)->[(timestamp: TimeInterval, acceleration: CMAcceleration)] {
+        return self.resample(timestamp: accelerometerData.timestamp, acceleration: accelerometerData.acceleration)
+    }
+
+    func resample(timestamp: TimeInterval, acceleration: CMAcceleration)->[(timestamp: TimeInterval, acceleration: CMAcceleration)] {
+        if self.referenceTimestamp == nil {
+            // keep native timestamps small so they fit in a float without losing precision
+            self.referenceTimestamp = timestamp
+        }
+
+        let sample = AccelerometerSample(t: Float(timestamp - self.referenceTimestamp!), x: Float(acceleration.x), y: Float(acceleration.y), z: Float(acceleration.z))
+        let count = Int(polyphaseResamplerPush(self.resampler, sample, &self.outputBuffer, self.outputCapacity))
+
+        return self.resampledAccelerations(count: count)
+    }
+
+    func flush()->[(timestamp: TimeInterval, acceleration: CMAcceleration)] {
+        let count = Int(polyphaseResamplerFlush(self.resampler, &self.outputBuffer, self.outputCapacity))
+        let accelerations = self.resampledAccelerations(count: count)
+        self.referenceTimestamp = nil
+
+        return accelerations
+    }
+
+    private func resampledAccelerations(count: Int)->[(timestamp: TimeInterval, acceleration: CMAcceleration)] {
+        guard count > 0, let referenceTimestamp = self.referenceTimestamp else {
+            return []
+        }
+
+        var accelerations: [(timestamp: TimeInterval, acceleration: CMAcceleration)] = []
+        accelerations.reserveCapacity(count)
+        for sample in self.outputBuffer[0..<count] {
+            accelerations.append((timestamp: referenceTimestamp + TimeInterval(sample.t), acceleration: CMAcceleration(x: Double(sample.x), y: Double(sample.y), z: Double(sample.z))))
+        }
+
+        return accelerations
+    }
+}
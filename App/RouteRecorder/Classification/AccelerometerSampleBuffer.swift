@@ -0,0 +1,119 @@
+//
+//  AccelerometerSampleBuffer.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+import CoreMotion
+
+// Holds a sensor session's resampled accelerations in native memory between the motion queue and the main queue,
+// so the motion callback never touches Core Data. Safe for exactly one writing queue and one reading queue.
+//
+// The reading side has two cursors: samples stay in the buffer until they have been persisted
+// and, once retainSamples(from:) has been called, until they fall before the start of the window the classifier
+// still needs.
+class AccelerometerSampleBuffer {
+    static let capacity = 4096 // about 80 seconds at 50hz
+    static let maximumSpanCount = 1024 // the longest window that can be borrowed
+
+    let sampleRate: Double
+
+    // Sample times are kept relative to when the buffer was created so they fit in a float.
+    let referenceTimestamp: TimeInterval // same time base as CMLogItem.timestamp
+    let referenceDate: Date
+
+    private var ringBuffer: OpaquePointer!
+    private var samples: [AccelerometerSample] = []
+
+    // reading side only
+    private var persistedSequence: Int64 = 0
+    private var retainedSequence: Int64?
+
+    init(sampleRate: Double) {
+        self.sampleRate = sampleRate
+
+        // CMLogItem timestamps are relative to boot. Use the uptime rather than a reading's age, since
+        // resampled readings arrive one filter latency late.
+        self.referenceTimestamp = ProcessInfo.processInfo.systemUptime
+        self.referenceDate = Date()
+        self.ringBuffer = createAccelerometerRingBuffer(Int32(AccelerometerSampleBuffer.capacity), Int32(AccelerometerSampleBuffer.maximumSpanCount))
+    }
+
+    deinit {
+        deleteAccelerometerRingBuffer(self.ringBuffer)
+    }
+
+    func date(of sample: AccelerometerSample)->Date {
+        return self.referenceDate.addingTimeInterval(TimeInterval(sample.t))
+    }
+
+    //
+    // MARK: Writing
+    //
+
+    // Returns false if the buffer was full and some accelerations were dropped.
+    @discardableResult func write(_ accelerations: [(timestamp: TimeInterval, acceleration: CMAcceleration)])->Bool {
+        self.samples.removeAll(keepingCapacity: true)
+        for (timestamp, acceleration) in accelerations {
+            self.samples.append(AccelerometerSample(t: Float(timestamp - self.referenceTimestamp), x: Float(acceleration.x), y: Float(acceleration.y), z: Float(acceleration.z)))
+        }
+
+        return Int(accelerometerRingBufferWrite(self.ringBuffer, self.samples, Int32(self.samples.count))) == self.samples.count
+    }
+
+    //
+    // MARK: Reading
+    //
+
+    var droppedSampleCount: Int {
+        return Int(accelerometerRingBufferDroppedCount(self.ringBuffer))
+    }
+
+    var unpersistedSampleCount: Int {
+        return Int(accelerometerRingBufferWriteSequence(self.ringBuffer) - self.persistedSequence)
+    }
+
+    // Hands every sample that hasn't been persisted yet to body, in order and without copying.
+    // Returns the number of samples handed over.
+    @discardableResult func persist(_ body: (UnsafeBufferPointer<AccelerometerSample>)->Void)->Int {
+        let endSequence = accelerometerRingBufferWriteSequence(self.ringBuffer)
+        let startSequence = self.persistedSequence
+
+        while self.persistedSequence < endSequence {
+            let count = Int32(min(endSequence - self.persistedSequence, Int64(AccelerometerSampleBuffer.maximumSpanCount)))
+            guard let span = accelerometerRingBufferSpan(self.ringBuffer, self.persistedSequence, count) else {
+                break
+            }
+            body(UnsafeBufferPointer(start: span, count: Int(count)))
+            self.persistedSequence += Int64(count)
+        }
+        self.release()
+
+        return Int(self.persistedSequence - startSequence)
+    }
+
+    // Lets go of everything before date that no longer needs persisting.
+    func retainSamples(from date: Date) {
+        self.retainedSequence = accelerometerRingBufferLowerBound(self.ringBuffer, Float(date.timeIntervalSince(self.referenceDate)))
+        self.release()
+    }
+
+    // Borrows the first duration's worth of samples at or after date, or returns nil if they haven't all arrived.
+    func withWindow<Result>(from date: Date, duration: TimeInterval, _ body: (AccelerometerWindow)->Result)->Result? {
+        let count = Int32(duration * self.sampleRate)
+        let sequence = accelerometerRingBufferLowerBound(self.ringBuffer, Float(date.timeIntervalSince(self.referenceDate)))
+        guard let span = accelerometerRingBufferSpan(self.ringBuffer, sequence, count) else {
+            return nil
+        }
+
+        let window = AccelerometerWindow(samples: UnsafeBufferPointer(start: span, count: Int(count)), sampleRate: self.sampleRate, startDate: self.date(of: span.pointee))
+        return body(window)
+    }
+
+    private func release() {
+        let sequence = min(self.retainedSequence ?? self.persistedSequence, self.persistedSequence)
+        accelerometerRingBufferConsume(self.ringBuffer, sequence)
+    }
+}
@@ -0,0 +1,32 @@
+//
+//  AccelerometerWindow.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+
+// A borrowed, contiguous run of evenly spaced samples. Only valid for the duration of the call it is handed to,
+// so copy out anything that needs to outlive it.
+public struct AccelerometerWindow {
+    public let samples: UnsafeBufferPointer<AccelerometerSample>
+    public let sampleRate: Double
+    public let startDate: Date
+
+    public var duration: TimeInterval {
+        return Double(self.samples.count) / self.sampleRate
+    }
+}
+
+// A classifier that can read its input straight out of the sample buffer instead of fetching persisted
+// readings for the prediction.
+public protocol AccelerometerWindowClassifier {
+    func classify(_ prediction: Prediction, window: AccelerometerWindow)
+}
+
+// A classifier that hands back its predictions instead of writing them to a Prediction, so it can run on the
+// classification executor's thread rather than the main queue.
+public protocol ConcurrentAccelerometerWindowClassifier {
+    func predictedActivities(forWindow window: AccelerometerWindow)->[(activityType: ActivityType, confidence: Float)]
+}
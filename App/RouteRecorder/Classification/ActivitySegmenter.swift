@@ -0,0 +1,163 @@
+//
+//  ActivitySegmenter.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+import CoreLocation
+import CocoaLumberjack
+
+public struct RouteActivitySegment {
+    public let startDate: Date
+    public let endDate: Date
+    public let activityType: ActivityType
+
+    public func jsonDictionary() -> [String: Any] {
+        return [
+            "activityType": self.activityType.numberValue,
+            "startDate": self.startDate.JSONString(includingMilliseconds: true),
+            "endDate": self.endDate.JSONString(includingMilliseconds: true)
+        ]
+    }
+}
+
+// Splits a route into stretches of one activity type as its predictions and GPS fixes come in, so a ride that
+// ends in a car or a walk is labelled that way without any re-classification when the route closes.
+// Not thread safe.
+class ActivitySegmenter {
+    static let stepDuration: TimeInterval = 5
+    static let lagStepCount = 24 // two minutes
+    static let reorderWindow: TimeInterval = 20 * 60 // pending aggregators join a route as much as 18 minutes late
+    static let switchProbability: Float = 0.001
+    static let windowEvidenceWeight: Float = 0.5
+    static let probabilityFloor: Float = 0.02
+    static let slowSpeedProbability: Float = 0.8 // same for every mode, so a stop at a light doesn't favor one
+    static let fastSpeedProbability: Float = 0.05
+    static let uncommonActivityTypeWeight: Float = 0.1
+
+    // the speed below which a mode is usually stopped rather than moving, and the fastest it goes, in m/s
+    static let speedModels: [ActivityType: (typicalMinimumSpeed: Float, maximumSpeed: Float)] = [
+        .stationary: (0, 1.5),
+        .walking: (0, 2.5),
+        .wheelchair: (0, 3),
+        .running: (2.5, 7), // no overlap with walking, or speed alone can't tell a slow ride's walk from a run
+        .skateboarding: (1.5, 10),
+        .cycling: (2, 13), // a little over the 25 mph we used to reclassify bike trips at
+        .kick_scooter: (2, 11),
+        .skiing: (2, 30),
+        .snowboarding: (2, 30),
+        .automotive: (2.5, 70),
+        .motorcycle: (2.5, 80),
+        .bus: (2.5, 35),
+        .tram: (2.5, 25),
+        .rail: (2.5, 95),
+        .maritime: (1, 30),
+        .helicopter: (10, 90),
+        .aviation: (25, 300)
+    ]
+
+    static let commonActivityTypes: [ActivityType] = [.stationary, .walking, .running, .cycling, .automotive, .bus, .rail, .tram, .motorcycle, .kick_scooter]
+
+    private var segmenter: OpaquePointer!
+    private(set) var locationCount = 0
+
+    init(initialActivityType: ActivityType) {
+        let classCount = ActivityVoteAccumulator.classCount
+        self.segmenter = createActivitySegmenter(Int32(classCount), ActivitySegmenter.stepDuration, Int32(ActivitySegmenter.lagStepCount), ActivitySegmenter.reorderWindow, ActivitySegmenter.switchProbability)
+        activitySegmenterSetWindowEvidence(self.segmenter, ActivitySegmenter.windowEvidenceWeight, ActivitySegmenter.probabilityFloor)
+
+        // unknown is never a stretch of a route, and the uncommon modes take more evidence to switch into
+        var weights = [Float](repeating: ActivitySegmenter.uncommonActivityTypeWeight, count: classCount)
+        weights[Int(ActivityVoteAccumulator.classIndex(.unknown))] = 0
+        for activityType in ActivitySegmenter.commonActivityTypes {
+            weights[Int(ActivityVoteAccumulator.classIndex(activityType))] = 1
+        }
+
+        var matrix = [Float](repeating: 0, count: classCount * classCount)
+        for from in 0..<classCount {
+            let otherWeight = weights.reduce(0, +) - weights[from]
+            for to in 0..<classCount {
+                matrix[from * classCount + to] = from == to ? 1 - ActivitySegmenter.switchProbability : ActivitySegmenter.switchProbability * weights[to] / otherWeight
+            }
+        }
+        activitySegmenterSetTransitionMatrix(self.segmenter, matrix)
+
+        var initialProbabilities = weights.map { $0 / weights.reduce(0, +) }
+        if initialActivityType != .unknown {
+            initialProbabilities = initialProbabilities.map { $0 / 2 }
+            initialProbabilities[Int(ActivityVoteAccumulator.classIndex(initialActivityType))] += 0.5
+        }
+        activitySegmenterSetInitialProbabilities(self.segmenter, initialProbabilities)
+
+        for (activityType, model) in ActivitySegmenter.speedModels {
+            activitySegmenterSetSpeedModel(self.segmenter, ActivityVoteAccumulator.classIndex(activityType), model.typicalMinimumSpeed, model.maximumSpeed, ActivitySegmenter.slowSpeedProbability, ActivitySegmenter.fastSpeedProbability)
+        }
+    }
+
+    deinit {
+        deleteActivitySegmenter(self.segmenter)
+    }
+
+    func add(_ predictionAggregator: PredictionAggregator) {
+        for prediction in predictionAggregator.predictions.sorted(by: { $0.startDate < $1.startDate }) {
+            self.add(prediction)
+        }
+    }
+
+    func add(_ prediction: Prediction) {
+        // a session that gave up says nothing about the mode
+        guard prediction.predictedActivities.contains(where: { $0.activityType != .unknown }) else {
+            return
+        }
+
+        if !activitySegmenterAddWindow(self.segmenter, prediction.startDate.timeIntervalSinceReferenceDate, PredictionStoppingRule.probabilities(of: prediction)) {
+            DDLogVerbose("Prediction too late for activity segmentation, skipping.")
+        }
+    }
+
+    // Every fix counts toward locationCount, even the ones without a speed.
+    func add(_ locations: [CLLocation]) {
+        for location in locations {
+            self.add(speed: location.speed, at: location.timestamp)
+        }
+    }
+
+    func add(_ locations: [Location]) {
+        for location in locations.sorted(by: { $0.date < $1.date }) where !location.source.isInferred {
+            self.add(speed: location.speed, at: location.date)
+        }
+    }
+
+    func add(speed: CLLocationSpeed, at date: Date) {
+        self.locationCount += 1
+        if speed >= 0 {
+            activitySegmenterAddSpeed(self.segmenter, date.timeIntervalSinceReferenceDate, Float(speed))
+        }
+    }
+
+    var currentActivityType: ActivityType? {
+        let activityClass = activitySegmenterCurrentClass(self.segmenter)
+        return activityClass >= 0 ? ActivityVoteAccumulator.activityType(activityClass) : nil
+    }
+
+    // Every segment, once nothing more will be added.
+    func finish()->[RouteActivitySegment] {
+        activitySegmenterFinish(self.segmenter)
+
+        var segments: [RouteActivitySegment] = []
+        var buffer = [ActivitySegment](repeating: ActivitySegment(), count: 64)
+        while true {
+            let count = Int(activitySegmenterReadSegments(self.segmenter, &buffer, Int32(buffer.count)))
+            if count == 0 {
+                break
+            }
+            for segment in buffer[0..<count] {
+                segments.append(RouteActivitySegment(startDate: Date(timeIntervalSinceReferenceDate: segment.startTime), endDate: Date(timeIntervalSinceReferenceDate: segment.endTime), activityType: ActivityVoteAccumulator.activityType(segment.activityClass)))
+            }
+        }
+
+        return segments
+    }
+}
@@ -0,0 +1,76 @@
+//
+//  ActivityVoteAccumulator.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+
+// The aggregate of a session's predictions, kept up to date one prediction at a time.
+// Not thread safe.
+class ActivityVoteAccumulator {
+    // one slot per activity type by raw value, with .other's 999 folded into the last one
+    static let classCount = Int(ActivityType.kick_scooter.rawValue) + 2
+
+    private var accumulator: OpaquePointer!
+    private var classes: [Int32] = []
+    private var confidences: [Float] = []
+
+    init() {
+        self.accumulator = createActivityVoteAccumulator(Int32(ActivityVoteAccumulator.classCount))
+    }
+
+    deinit {
+        deleteActivityVoteAccumulator(self.accumulator)
+    }
+
+    class func classIndex(_ activityType: ActivityType)->Int32 {
+        return activityType == .other ? Int32(ActivityVoteAccumulator.classCount - 1) : Int32(activityType.rawValue)
+    }
+
+    class func activityType(_ classIndex: Int32)->ActivityType {
+        return classIndex == Int32(ActivityVoteAccumulator.classCount - 1) ? .other : (ActivityType(rawValue: Int16(classIndex)) ?? .unknown)
+    }
+
+    func reset() {
+        activityVoteAccumulatorReset(self.accumulator)
+    }
+
+    func add(_ prediction: Prediction) {
+        self.add(prediction.predictedActivities.map { (activityType: $0.activityType, confidence: $0.confidence) })
+    }
+
+    // For predictions that were never written to a Prediction, like those classified off the main queue.
+    func add(_ predictedActivities: [(activityType: ActivityType, confidence: Float)]) {
+        self.classes.removeAll(keepingCapacity: true)
+        self.confidences.removeAll(keepingCapacity: true)
+        for predictedActivity in predictedActivities {
+            self.classes.append(ActivityVoteAccumulator.classIndex(predictedActivity.activityType))
+            self.confidences.append(predictedActivity.confidence)
+        }
+
+        activityVoteAccumulatorAddPrediction(self.accumulator, self.classes, self.confidences, Int32(self.classes.count))
+    }
+
+    var predictionCount: Int {
+        return Int(activityVoteAccumulatorPredictionCount(self.accumulator))
+    }
+
+    var activityType: ActivityType {
+        return ActivityVoteAccumulator.activityType(activityVoteAccumulatorTopClass(self.accumulator))
+    }
+
+    var confidence: Float {
+        return activityVoteAccumulatorTopConfidence(self.accumulator)
+    }
+
+    // The activity type's mean vote, the same measure as confidence for whichever type it is.
+    func confidence(of activityType: ActivityType)->Float {
+        guard self.predictionCount > 0 else {
+            return 0
+        }
+
+        return activityVoteAccumulatorVotes(self.accumulator, ActivityVoteAccumulator.classIndex(activityType)) / Float(self.predictionCount)
+    }
+}
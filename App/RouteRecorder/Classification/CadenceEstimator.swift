@@ -0,0 +1,60 @@
+//
+//  CadenceEstimator.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+import CoreMotion
+
+// Periodically estimates the step or pedalling cadence from the most recent readings.
+// Not thread safe; feed it from a single serial queue.
+class CadenceEstimator {
+    static let windowDuration: TimeInterval = 4 // long enough to hold a few revolutions at a slow cadence
+    static let hopDuration: TimeInterval = 0.5
+    static let minimumPeriod: TimeInterval = 0.25 // 240 steps a minute
+    static let maximumPeriod: TimeInterval = 1.5 // 40 pedal strokes a minute
+
+    private var detector: OpaquePointer!
+    private var samples: [AccelerometerSample] = []
+    private let hopSampleCount: Int
+    private var samplesSinceEstimate = 0
+
+    init(sampleRate: Double) {
+        self.detector = createCadenceDetector(Float(sampleRate), Int32(CadenceEstimator.windowDuration * sampleRate), Float(CadenceEstimator.minimumPeriod), Float(CadenceEstimator.maximumPeriod))
+        self.hopSampleCount = Int(CadenceEstimator.hopDuration * sampleRate)
+    }
+
+    deinit {
+        deleteCadenceDetector(self.detector)
+    }
+
+    func reset() {
+        cadenceDetectorReset(self.detector)
+        self.samplesSinceEstimate = 0
+    }
+
+    // Returns a new estimate once per hop, after the window has filled.
+    func estimate(afterAccelerations accelerations: [(timestamp: TimeInterval, acceleration: CMAcceleration)])->CadenceEstimate? {
+        self.samples.removeAll(keepingCapacity: true)
+        for (_, acceleration) in accelerations {
+            // the detector assumes a uniform sample rate, so the timestamp is left out
+            self.samples.append(AccelerometerSample(t: 0, x: Float(acceleration.x), y: Float(acceleration.y), z: Float(acceleration.z)))
+        }
+        cadenceDetectorPush(self.detector, self.samples, Int32(self.samples.count))
+
+        self.samplesSinceEstimate += accelerations.count
+        guard self.samplesSinceEstimate >= self.hopSampleCount else {
+            return nil
+        }
+        self.samplesSinceEstimate = 0
+
+        var estimate = CadenceEstimate()
+        guard cadenceDetectorEstimate(self.detector, &estimate) else {
+            return nil
+        }
+
+        return estimate
+    }
+}
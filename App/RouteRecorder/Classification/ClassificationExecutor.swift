@@ -0,0 +1,115 @@
+//
+//  ClassificationExecutor.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+
+// A dedicated thread that classification work runs on, one job at a time in the order it was submitted, so
+// buffering, feature extraction and the forest never hold up the main queue. The queue is bounded: once the worker
+// falls capacity jobs behind, submit(_:) turns new jobs away rather than letting them pile up, and the caller
+// decides what to drop.
+class ClassificationExecutor {
+    static let shared = ClassificationExecutor(capacity: 256) // about five seconds of motion callbacks at 50hz
+
+    struct Statistics {
+        var completedJobCount = 0
+        var rejectedJobCount = 0
+        var totalQueueLatency: TimeInterval = 0 // from submitting a job to starting it
+        var maximumQueueLatency: TimeInterval = 0
+        var totalRunTime: TimeInterval = 0
+
+        var meanQueueLatency: TimeInterval {
+            return self.completedJobCount > 0 ? self.totalQueueLatency / Double(self.completedJobCount) : 0
+        }
+
+        var meanRunTime: TimeInterval {
+            return self.completedJobCount > 0 ? self.totalRunTime / Double(self.completedJobCount) : 0
+        }
+    }
+
+    let capacity: Int
+
+    private let condition = NSCondition()
+    private var jobs: [(submittedTime: TimeInterval, job: ()->Void)?]
+    private var headIndex = 0
+    private var jobCount = 0
+    private var _statistics = Statistics()
+    private var thread: Thread!
+
+    init(capacity: Int) {
+        self.capacity = max(capacity, 1)
+        self.jobs = [(submittedTime: TimeInterval, job: ()->Void)?](repeating: nil, count: self.capacity)
+
+        // the executor lives as long as its thread does, which is as long as the app
+        self.thread = Thread { [unowned self] in
+            self.run()
+        }
+        self.thread.name = "RouteRecorder Classification"
+        self.thread.qualityOfService = .userInitiated
+        self.thread.start()
+    }
+
+    var statistics: Statistics {
+        self.condition.lock()
+        defer { self.condition.unlock() }
+        return self._statistics
+    }
+
+    var pendingJobCount: Int {
+        self.condition.lock()
+        defer { self.condition.unlock() }
+        return self.jobCount
+    }
+
+    var isCurrentThread: Bool {
+        return Thread.current == self.thread
+    }
+
+    // Any thread. Returns false without queueing the job if the worker is too far behind.
+    @discardableResult func submit(_ job: @escaping ()->Void)->Bool {
+        self.condition.lock()
+        defer { self.condition.unlock() }
+
+        guard self.jobCount < self.capacity else {
+            self._statistics.rejectedJobCount += 1
+            return false
+        }
+
+        self.jobs[(self.headIndex + self.jobCount) % self.capacity] = (submittedTime: ProcessInfo.processInfo.systemUptime, job: job)
+        self.jobCount += 1
+        self.condition.signal()
+
+        return true
+    }
+
+    private func run() {
+        while true {
+            self.condition.lock()
+            while self.jobCount == 0 {
+                self.condition.wait()
+            }
+            let entry = self.jobs[self.headIndex]!
+            self.jobs[self.headIndex] = nil
+            self.headIndex = (self.headIndex + 1) % self.capacity
+            self.jobCount -= 1
+            self.condition.unlock()
+
+            let startTime = ProcessInfo.processInfo.systemUptime
+            autoreleasepool {
+                entry.job()
+            }
+            let endTime = ProcessInfo.processInfo.systemUptime
+
+            self.condition.lock()
+            let queueLatency = startTime - entry.submittedTime
+            self._statistics.completedJobCount += 1
+            self._statistics.totalQueueLatency += queueLatency
+            self._statistics.maximumQueueLatency = max(self._statistics.maximumQueueLatency, queueLatency)
+            self._statistics.totalRunTime += endTime - startTime
+            self.condition.unlock()
+        }
+    }
+}
@@ -0,0 +1,340 @@
+//
+//  PredictionReclassifier.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+import CoreData
+import CocoaLumberjack
+
+// Re-classifies stored prediction aggregators from their accelerometer readings, for when the model changes.
+//
+// Readings are fetched a batch of aggregators at a time on a private queue context, as plain samples rather than
+// managed objects, and each aggregator is scored on a pool of worker threads. A classifier isn't safe to share, so
+// every worker gets its own from classifierFactory. New predictions replace the old ones on the main queue and go
+// out with the rest of the app's writes through the group commit scheduler.
+//
+// Every new prediction is stamped with modelIdentifier, which is what makes a run resumable: aggregators whose
+// predictions all carry it are skipped, so a run that was cancelled or killed picks up after its last commit.
+// Aggregators without enough readings for a window are left as they were.
+public class PredictionReclassifier {
+    static let batchSize = 64
+    static let inFlightAggregatorCountPerWorker = 4 // bounds how many aggregators' readings are held at once
+
+    public struct Progress {
+        public internal(set) var aggregatorCount = 0 // left to reclassify when the run started
+        public internal(set) var reclassifiedCount = 0
+        public internal(set) var skippedCount = 0
+        public internal(set) var windowCount = 0
+        public internal(set) var elapsedTime: TimeInterval = 0
+    }
+
+    struct Result {
+        let aggregatorID: NSManagedObjectID
+        let windows: [(startDate: Date, predictedActivities: [(activityType: ActivityType, confidence: Float)])]
+        let aggregatePredictedActivity: (activityType: ActivityType, confidence: Float)?
+    }
+
+    public let modelIdentifier: String
+    public let route: Route?
+    let workerCount: Int
+    let windowDuration: TimeInterval
+    let sampleRate: Double
+    private let stoppingRuleKind: PredictionStoppingRule.Kind
+    private let classifierFactory: ()->ConcurrentAccelerometerWindowClassifier?
+
+    // main queue only
+    public private(set) var progress = Progress()
+    private var startUptime: TimeInterval = 0
+    private var progressHandler: ((Progress)->Void)?
+
+    // shared with the reader and the workers
+    private let lock = NSLock()
+    private var _isCancelled = false
+    private var idleClassifiers: [ConcurrentAccelerometerWindowClassifier] = []
+
+    private let readerContext: NSManagedObjectContext
+    private let workQueue: OperationQueue
+    private let inFlight: DispatchSemaphore
+
+    // Readings were persisted after resampling, so they're at the model rate. Without a route, every stored
+    // aggregator is reclassified.
+    public init(modelIdentifier: String, route: Route? = nil, workerCount: Int = ProcessInfo.processInfo.activeProcessorCount, windowDuration: TimeInterval = RouteRecorder.shared.randomForestManager.desiredSessionDuration, classifierFactory: @escaping ()->ConcurrentAccelerometerWindowClassifier?) {
+        self.modelIdentifier = modelIdentifier
+        self.route = route
+        self.workerCount = max(workerCount, 1)
+        self.windowDuration = windowDuration
+        self.sampleRate = SensorClassificationManager.modelSampleRate
+        self.stoppingRuleKind = PredictionAggregator.stoppingRuleKind
+        self.classifierFactory = classifierFactory
+
+        self.readerContext = NSManagedObjectContext(concurrencyType: .privateQueueConcurrencyType)
+        self.readerContext.persistentStoreCoordinator = RouteRecorderDatabaseManager.shared.persistentStoreCoordinator
+        self.readerContext.undoManager = nil
+
+        self.workQueue = OperationQueue()
+        self.workQueue.name = "RouteRecorder Reclassification"
+        self.workQueue.maxConcurrentOperationCount = self.workerCount
+        self.workQueue.qualityOfService = .utility
+        self.inFlight = DispatchSemaphore(value: self.workerCount * PredictionReclassifier.inFlightAggregatorCountPerWorker)
+    }
+
+    public var isCancelled: Bool {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self._isCancelled
+    }
+
+    // Handlers are called on the main queue, the progress handler after every aggregator.
+    public func start(progressHandler: @escaping (Progress)->Void = { (_) in }, completionHandler: @escaping (Progress)->Void) {
+        guard let classifier = self.classifierFactory() else {
+            DDLogWarn("No classifier to reclassify with!")
+            completionHandler(self.progress)
+            return
+        }
+        self.idleClassifiers = [classifier]
+        self.progressHandler = progressHandler
+        self.startUptime = ProcessInfo.processInfo.systemUptime
+
+        // anything not yet committed wouldn't be seen by the reader
+        RouteRecorderDatabaseManager.shared.saveContext()
+
+        self.readerContext.perform {
+            let aggregatorIDs = self.fetchPendingAggregatorIDs()
+            DispatchQueue.main.async {
+                self.progress.aggregatorCount = aggregatorIDs.count
+                DDLogInfo(String(format: "Reclassifying %d prediction aggregators with %d workers", aggregatorIDs.count, self.workerCount))
+            }
+
+            for batchStart in stride(from: 0, to: aggregatorIDs.count, by: PredictionReclassifier.batchSize) {
+                if self.isCancelled {
+                    break
+                }
+
+                let batch = Array(aggregatorIDs[batchStart..<min(batchStart + PredictionReclassifier.batchSize, aggregatorIDs.count)])
+                self.readBatch(batch) { (aggregatorID, startDate, samples) in
+                    self.inFlight.wait()
+                    self.workQueue.addOperation {
+                        self.classifyAndApply(aggregatorID: aggregatorID, startDate: startDate, samples: samples)
+                    }
+                }
+                self.readerContext.reset()
+            }
+
+            self.workQueue.waitUntilAllOperationsAreFinished()
+            DispatchQueue.main.async {
+                self.finish(completionHandler: completionHandler)
+            }
+        }
+    }
+
+    // Stops handing out work. Aggregators already being classified are still written back.
+    public func cancel() {
+        self.lock.lock()
+        self._isCancelled = true
+        self.lock.unlock()
+    }
+
+    //
+    // MARK: Reading
+    //
+
+    private func fetchPendingAggregatorIDs()->[NSManagedObjectID] {
+        let request = NSFetchRequest<NSManagedObjectID>(entityName: "PredictionAggregator")
+        request.resultType = .managedObjectIDResultType
+        var predicate = NSPredicate(format: "accelerometerReadings.@count > 0 AND (predictions.@count == 0 OR SUBQUERY(predictions, $prediction, $prediction.activityPredictionModelIdentifier == nil OR $prediction.activityPredictionModelIdentifier != %@).@count > 0)", self.modelIdentifier)
+        if let route = self.route {
+            predicate = NSCompoundPredicate(andPredicateWithSubpredicates: [predicate, NSPredicate(format: "route == %@", route.objectID)])
+        }
+        request.predicate = predicate
+
+        do {
+            return try self.readerContext.fetch(request)
+        } catch let error {
+            DDLogWarn(String(format: "Error fetching prediction aggregators to reclassify: %@", error as NSError))
+            return []
+        }
+    }
+
+    // One fetch for the whole batch's readings, as dictionaries so none of them become managed objects. Sample
+    // times are relative to each aggregator's first reading.
+    private func readBatch(_ aggregatorIDs: [NSManagedObjectID], handler: (NSManagedObjectID, Date, [AccelerometerSample])->Void) {
+        let request = NSFetchRequest<NSDictionary>(entityName: "AccelerometerReading")
+        request.resultType = .dictionaryResultType
+        request.propertiesToFetch = ["date", "x", "y", "z", "predictionAggregator"]
+        request.predicate = NSPredicate(format: "predictionAggregator IN %@", aggregatorIDs)
+        request.sortDescriptors = [NSSortDescriptor(key: "date", ascending: true)]
+
+        let rows: [NSDictionary]
+        do {
+            rows = try self.readerContext.fetch(request)
+        } catch let error {
+            DDLogWarn(String(format: "Error fetching accelerometer readings to reclassify: %@", error as NSError))
+            return
+        }
+
+        var readings: [NSManagedObjectID: (startDate: Date, samples: [AccelerometerSample])] = [:]
+        for row in rows {
+            guard let aggregatorID = row["predictionAggregator"] as? NSManagedObjectID, let date = row["date"] as? Date,
+                let x = row["x"] as? Double, let y = row["y"] as? Double, let z = row["z"] as? Double else {
+                continue
+            }
+
+            let startDate = readings[aggregatorID]?.startDate ?? date
+            if readings[aggregatorID] == nil {
+                readings[aggregatorID] = (startDate: date, samples: [])
+            }
+            readings[aggregatorID]!.samples.append(AccelerometerSample(t: Float(date.timeIntervalSince(startDate)), x: Float(x), y: Float(y), z: Float(z)))
+        }
+
+        for aggregatorID in aggregatorIDs {
+            if let aggregatorReadings = readings.removeValue(forKey: aggregatorID) {
+                handler(aggregatorID, aggregatorReadings.startDate, aggregatorReadings.samples)
+            }
+        }
+    }
+
+    //
+    // MARK: Classifying
+    //
+
+    private func classifyAndApply(aggregatorID: NSManagedObjectID, startDate: Date, samples: [AccelerometerSample]) {
+        guard !self.isCancelled, let classifier = self.checkOutClassifier() else {
+            self.inFlight.signal()
+            return
+        }
+
+        let classified = PredictionReclassifier.classify(samples: samples, startDate: startDate, sampleRate: self.sampleRate, windowDuration: self.windowDuration, stoppingRuleKind: self.stoppingRuleKind, classifier: classifier)
+        self.checkInClassifier(classifier)
+        self.inFlight.signal()
+
+        let result = Result(aggregatorID: aggregatorID, windows: classified.windows, aggregatePredictedActivity: classified.aggregatePredictedActivity)
+        DispatchQueue.main.async {
+            self.apply(result)
+        }
+    }
+
+    // Windows are cut the way a live session cuts them, one every sampleOffsetTimeInterval from the first reading,
+    // and stop where the live session would have stopped. Windows spanning a gap in the readings are skipped.
+    class func classify(samples: [AccelerometerSample], startDate: Date, sampleRate: Double, windowDuration: TimeInterval, stoppingRuleKind: PredictionStoppingRule.Kind, classifier: ConcurrentAccelerometerWindowClassifier)->(windows: [(startDate: Date, predictedActivities: [(activityType: ActivityType, confidence: Float)])], aggregatePredictedActivity: (activityType: ActivityType, confidence: Float)?) {
+        let windowSampleCount = Int((windowDuration * sampleRate).rounded())
+        let maximumWindowSpan = Float(windowDuration + 1 / sampleRate)
+        let halfSampleInterval = Float(0.5 / sampleRate)
+        let voteAccumulator = ActivityVoteAccumulator()
+        let stoppingRule = PredictionStoppingRule(kind: stoppingRuleKind)
+
+        var windows: [(startDate: Date, predictedActivities: [(activityType: ActivityType, confidence: Float)])] = []
+        guard windowSampleCount > 0 else {
+            return (windows: windows, aggregatePredictedActivity: nil)
+        }
+
+        samples.withUnsafeBufferPointer { (buffer) in
+            var windowStart: Float = 0
+            var index = 0
+            while windows.count < PredictionAggregator.maximumSampleBeforeFailure {
+                while index < buffer.count && buffer[index].t < windowStart - halfSampleInterval {
+                    index += 1
+                }
+                guard index + windowSampleCount <= buffer.count else {
+                    break
+                }
+                windowStart += Float(PredictionAggregator.sampleOffsetTimeInterval)
+
+                if buffer[index + windowSampleCount - 1].t - buffer[index].t > maximumWindowSpan {
+                    continue
+                }
+
+                let window = AccelerometerWindow(samples: UnsafeBufferPointer(rebasing: buffer[index..<(index + windowSampleCount)]), sampleRate: sampleRate, startDate: startDate.addingTimeInterval(Double(buffer[index].t)))
+                let predictedActivities = classifier.predictedActivities(forWindow: window)
+                windows.append((startDate: window.startDate, predictedActivities: predictedActivities))
+
+                voteAccumulator.add(predictedActivities)
+                if stoppingRule.add(predictedActivities) != PredictionStoppingDecisionContinue {
+                    break
+                }
+            }
+        }
+
+        // the same aggregate finishAggregatePredictedActivity() would have written
+        guard voteAccumulator.predictionCount > 0 else {
+            return (windows: windows, aggregatePredictedActivity: nil)
+        }
+        if stoppingRule.decision == PredictionStoppingDecisionDecided {
+            return (windows: windows, aggregatePredictedActivity: (activityType: stoppingRule.activityType, confidence: voteAccumulator.confidence(of: stoppingRule.activityType)))
+        }
+
+        return (windows: windows, aggregatePredictedActivity: (activityType: voteAccumulator.activityType, confidence: voteAccumulator.confidence))
+    }
+
+    // At most workerCount operations run at once, so there are never more classifiers than workers.
+    private func checkOutClassifier()->ConcurrentAccelerometerWindowClassifier? {
+        self.lock.lock()
+        let classifier = self.idleClassifiers.popLast()
+        self.lock.unlock()
+
+        return classifier ?? self.classifierFactory()
+    }
+
+    private func checkInClassifier(_ classifier: ConcurrentAccelerometerWindowClassifier) {
+        self.lock.lock()
+        self.idleClassifiers.append(classifier)
+        self.lock.unlock()
+    }
+
+    //
+    // MARK: Writing
+    //
+
+    private func apply(_ result: Result) {
+        let context = RouteRecorderDatabaseManager.shared.currentManagedObjectContext()
+        guard let aggregatePredictedActivity = result.aggregatePredictedActivity,
+            let aggregator = (try? context.existingObject(with: result.aggregatorID)) as? PredictionAggregator,
+            aggregator.currentPrediction == nil else {
+            // too few readings, deleted since, or in the middle of a live session
+            self.progress.skippedCount += 1
+            self.reportProgress()
+            return
+        }
+
+        for prediction in aggregator.predictions {
+            context.delete(prediction)
+        }
+        if let oldAggregatePredictedActivity = aggregator.aggregatePredictedActivity {
+            context.delete(oldAggregatePredictedActivity)
+        }
+
+        for window in result.windows {
+            let prediction = Prediction()
+            prediction.startDate = window.startDate
+            prediction.activityPredictionModelIdentifier = self.modelIdentifier
+            prediction.predictionAggregator = aggregator
+            for predictedActivity in window.predictedActivities {
+                _ = PredictedActivity(activityType: predictedActivity.activityType, confidence: predictedActivity.confidence, prediction: prediction)
+            }
+        }
+        aggregator.aggregatePredictedActivity = PredictedActivity(activityType: aggregatePredictedActivity.activityType, confidence: aggregatePredictedActivity.confidence, prediction: nil)
+        aggregator.voteAccumulator = nil
+        aggregator.stoppingRule = nil
+        RouteRecorderDatabaseManager.shared.scheduleSave(recordCount: result.windows.count + 1)
+
+        self.progress.reclassifiedCount += 1
+        self.progress.windowCount += result.windows.count
+        self.reportProgress()
+    }
+
+    private func reportProgress() {
+        self.progress.elapsedTime = ProcessInfo.processInfo.systemUptime - self.startUptime
+        self.progressHandler?(self.progress)
+    }
+
+    private func finish(completionHandler: (Progress)->Void) {
+        RouteRecorderDatabaseManager.shared.saveContext()
+        self.progress.elapsedTime = ProcessInfo.processInfo.systemUptime - self.startUptime
+        self.progressHandler = nil
+
+        DDLogInfo(String(format: "Reclassified %d prediction aggregators (%d windows, %d skipped) in %.1fs%@", self.progress.reclassifiedCount, self.progress.windowCount, self.progress.skippedCount, self.progress.elapsedTime, self.isCancelled ? ", cancelled" : ""))
+        completionHandler(self.progress)
+    }
+}
@@ -0,0 +1,127 @@
+//
+//  PredictionScheduler.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+import CoreLocation
+
+// Decides which prediction requests get the accelerometer, for how long and at what rate, so that a day of
+// location updates spends a bounded amount of sensor time. Stationary results back requests off; a fast fix or a
+// moving result brings them right back. Not thread safe.
+class PredictionScheduler {
+    static let sensorSecondsPerHour: TimeInterval = 300 // at the model rate
+    static let minimumInterval: TimeInterval = 15
+    static let maximumInterval: TimeInterval = 10 * 60
+    static let movingSpeed: Float = 2 // the same speed RouteManager keeps monitoring at
+    static let confidentResultLifetime: TimeInterval = 5 * 60
+
+    struct Decision {
+        let shouldSample: Bool
+        let sessionDuration: TimeInterval
+        let sampleRate: Double
+        let retryDate: Date
+        let declineReason: PredictionSchedulerDeclineReason
+    }
+
+    let configuration: PredictionSchedulerConfiguration
+    let sampleRates: [Double]
+    private var scheduler: OpaquePointer!
+    
+    // The last known result, which is what a request declined with PredictionSchedulerDeclineReasonConfidentResult
+    // still stands on.
+    private(set) var standingResult: (activityType: ActivityType, confidence: Float)?
+
+    // A session needs at least one whole window plus the windows it takes to decide, and never needs more than the
+    // longest a prediction can take.
+    convenience init(windowDuration: TimeInterval, sampleRates: [Double], sensorSecondsPerHour: TimeInterval = PredictionScheduler.sensorSecondsPerHour) {
+        let minimumSessionDuration = Double(PredictionAggregator.minimumSampleCountForSuccess) * PredictionAggregator.sampleOffsetTimeInterval + windowDuration
+        let maximumSessionDuration = Double(PredictionAggregator.maximumSampleBeforeFailure - 1) * PredictionAggregator.sampleOffsetTimeInterval + Double(PredictionAggregator.maximumSampleBeforeFailure) * windowDuration + 2
+        let configuration = PredictionSchedulerConfiguration(sensorSecondsPerHour: sensorSecondsPerHour, referenceSampleRate: SensorClassificationManager.modelSampleRate, minimumSessionDuration: minimumSessionDuration, maximumSessionDuration: maximumSessionDuration, minimumInterval: PredictionScheduler.minimumInterval, maximumInterval: PredictionScheduler.maximumInterval, movingSpeed: PredictionScheduler.movingSpeed, highConfidence: PredictionAggregator.highConfidence, confidentResultLifetime: PredictionScheduler.confidentResultLifetime)
+
+        self.init(configuration: configuration, sampleRates: sampleRates)
+    }
+
+    init(configuration: PredictionSchedulerConfiguration, sampleRates: [Double]) {
+        self.configuration = configuration
+        self.sampleRates = sampleRates
+        self.scheduler = createPredictionScheduler(configuration)
+        predictionSchedulerSetSampleRates(self.scheduler, sampleRates, Int32(sampleRates.count))
+    }
+
+    deinit {
+        deletePredictionScheduler(self.scheduler)
+    }
+
+    // A negative speed is an unknown one, like CLLocation's. A granted request is a session in progress until its
+    // result is recorded.
+    func decide(at date: Date = Date(), speed: CLLocationSpeed)->Decision {
+        let decision = predictionSchedulerDecide(self.scheduler, date.timeIntervalSinceReferenceDate, Float(speed))
+
+        return Decision(shouldSample: decision.shouldSample, sessionDuration: decision.sessionDuration, sampleRate: decision.sampleRate, retryDate: Date(timeIntervalSinceReferenceDate: decision.retryTime), declineReason: decision.declineReason)
+    }
+
+    // nil for an unknown result
+    func recordResult(at date: Date = Date(), sensorDuration: TimeInterval, sampleRate: Double, predictedActivity: PredictedActivity?) {
+        let isKnown = predictedActivity != nil && predictedActivity!.activityType != .unknown
+        let isStationary = isKnown && predictedActivity!.activityType == .stationary
+        let confidence = isKnown ? predictedActivity!.confidence : 0
+        if isKnown && confidence > 0 {
+            self.standingResult = (activityType: predictedActivity!.activityType, confidence: confidence)
+        }
+
+        predictionSchedulerRecordResult(self.scheduler, date.timeIntervalSinceReferenceDate, sensorDuration, sampleRate, isStationary, confidence)
+    }
+
+    func recordUsage(at date: Date = Date(), sensorDuration: TimeInterval, sampleRate: Double) {
+        predictionSchedulerRecordUsage(self.scheduler, date.timeIntervalSinceReferenceDate, sensorDuration, sampleRate)
+    }
+
+    // in seconds at the model rate
+    func availableBudget(at date: Date = Date())->TimeInterval {
+        return predictionSchedulerAvailableBudget(self.scheduler, date.timeIntervalSinceReferenceDate)
+    }
+
+    // Replays a recorded trace through a fresh scheduler with this one's configuration, treating every location
+    // record as a request and the top class of each window of prediction records as what a session then would
+    // have said.
+    func simulate(traceAt fileURL: URL)->PredictionSchedulerSimulation? {
+        guard let reader = SensorTraceReader(fileURL: fileURL) else {
+            return nil
+        }
+
+        var fixTimes: [Double] = []
+        var fixSpeeds: [Float] = []
+        var labelTimes: [Double] = []
+        var labelIsStationary: [Bool] = []
+        var labelConfidences: [Float] = []
+        while let record = reader.next() {
+            if record.type == SensorTraceRecordTypeLocation {
+                fixTimes.append(record.time)
+                fixSpeeds.append(record.location.speed)
+            } else if record.type == SensorTraceRecordTypePrediction {
+                let activityType = ActivityType(rawValue: record.prediction.activityType) ?? .unknown
+                if labelTimes.last != record.time {
+                    labelTimes.append(record.time)
+                    labelIsStationary.append(activityType == .stationary)
+                    labelConfidences.append(activityType == .unknown ? 0 : record.prediction.confidence)
+                } else if record.prediction.confidence > labelConfidences[labelConfidences.count - 1] && activityType != .unknown {
+                    labelIsStationary[labelIsStationary.count - 1] = activityType == .stationary
+                    labelConfidences[labelConfidences.count - 1] = record.prediction.confidence
+                }
+            }
+        }
+
+        return self.simulate(fixTimes: fixTimes, fixSpeeds: fixSpeeds, labelTimes: labelTimes, labelIsStationary: labelIsStationary, labelConfidences: labelConfidences)
+    }
+
+    func simulate(fixTimes: [Double], fixSpeeds: [Float], labelTimes: [Double], labelIsStationary: [Bool], labelConfidences: [Float])->PredictionSchedulerSimulation {
+        let replay = PredictionScheduler(configuration: self.configuration, sampleRates: self.sampleRates)
+        var simulation = PredictionSchedulerSimulation()
+        predictionSchedulerSimulate(replay.scheduler, fixTimes, fixSpeeds, Int32(fixTimes.count), labelTimes, labelIsStationary, labelConfidences, Int32(labelTimes.count), &simulation)
+
+        return simulation
+    }
+}
@@ -0,0 +1,316 @@
+//
+//  PredictionSession.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+import CoreMotion
+import CocoaLumberjack
+
+// One request for the current activity type, from start(timeout:remainingSamplesHandler:updateHandler:) to the moment
+// it finishes. The session finishes exactly once: when its update handler has what it needs, or when it is cancelled,
+// runs past its deadline, or outlives its background task.
+//
+// Accelerations fed to the session are buffered, checked for stillness and cadence, cut into prediction windows and,
+// if the classifier allows it, classified, all on the classification executor's thread. The main queue only gets the
+// results. A finished session stops doing any of that and lets go of its buffers as soon as the executor is done with
+// whatever it was in the middle of, so any number of sessions can come and go without holding on to sensor memory.
+//
+// feed(_:) is for the motion queue and wait(until:) for any queue but the main one. Everything else, including the
+// handlers, is on the main queue.
+class PredictionSession {
+    enum Outcome {
+        case completed
+        case cancelled
+        case timedOut
+        case expired // the app ran out of background time
+        case failed
+    }
+
+    // A prediction window cut out of the buffer, with its features and, if the classifier runs on the executor,
+    // its predictions.
+    struct Window {
+        let startDate: Date
+        let spectralFeatures: [SpectralFeatures]
+        let predictedActivities: [(activityType: ActivityType, confidence: Float)]?
+        let samples: [AccelerometerSample] // only kept for a classifier that has to run on the main queue
+    }
+
+    // What the executor made of a batch of accelerations.
+    struct Update {
+        var isStationary = false
+        var cadenceEstimate: CadenceEstimate?
+        var samples: [AccelerometerSample] = [] // ready to persist, in order, with times relative to referenceDate
+        var windows: [Window] = []
+    }
+
+    // Returns true once the session has what it needs.
+    typealias UpdateHandler = (_ session: PredictionSession, _ update: Update)->Bool
+
+    // Everything the executor thread works on. Only ever touched from there.
+    private class Pipeline {
+        let sampleBuffer: AccelerometerSampleBuffer
+        let stationaryDetector: StationaryDetector
+        let cadenceEstimator: CadenceEstimator
+        let persistBatchCount: Int
+        let windowDuration: TimeInterval
+        let windowOffset: TimeInterval
+        let spectralFeatureExtractor: SpectralFeatureExtractor?
+        let windowClassifier: ConcurrentAccelerometerWindowClassifier?
+        var nextWindowStartDate: Date?
+
+        init(sampleRate: Double, persistBatchDuration: TimeInterval, windowSchedule: (startDate: Date, duration: TimeInterval, offset: TimeInterval)?, windowClassifier: ConcurrentAccelerometerWindowClassifier?) {
+            self.sampleBuffer = AccelerometerSampleBuffer(sampleRate: sampleRate)
+            self.stationaryDetector = StationaryDetector(sampleRate: sampleRate)
+            self.cadenceEstimator = CadenceEstimator(sampleRate: sampleRate)
+            self.persistBatchCount = max(Int(persistBatchDuration * sampleRate), 1)
+            self.windowDuration = windowSchedule?.duration ?? 0
+            self.windowOffset = windowSchedule?.offset ?? 0
+            self.spectralFeatureExtractor = windowSchedule.map { SpectralFeatureExtractor(sampleRate: sampleRate, windowDuration: $0.duration) }
+            self.windowClassifier = windowClassifier
+            self.nextWindowStartDate = windowSchedule?.startDate
+
+            if let startDate = self.nextWindowStartDate {
+                self.sampleBuffer.retainSamples(from: startDate)
+            }
+        }
+
+        func process(_ accelerations: [(timestamp: TimeInterval, acceleration: CMAcceleration)])->Update {
+            var update = Update()
+
+            self.sampleBuffer.write(accelerations)
+            update.isStationary = self.stationaryDetector.isStationary(afterAccelerations: accelerations)
+            update.cadenceEstimate = self.cadenceEstimator.estimate(afterAccelerations: accelerations)
+
+            if self.sampleBuffer.unpersistedSampleCount >= self.persistBatchCount {
+                update.samples = self.unpersistedSamples()
+            }
+
+            while let startDate = self.nextWindowStartDate, let window = self.sampleBuffer.withWindow(from: startDate, duration: self.windowDuration, { self.window(for: $0) }) {
+                update.windows.append(window)
+
+                let nextStartDate = startDate.addingTimeInterval(self.windowOffset)
+                self.nextWindowStartDate = nextStartDate
+                self.sampleBuffer.retainSamples(from: nextStartDate)
+            }
+
+            return update
+        }
+
+        func unpersistedSamples()->[AccelerometerSample] {
+            var samples: [AccelerometerSample] = []
+            self.sampleBuffer.persist { (span) in
+                samples.append(contentsOf: span)
+            }
+
+            return samples
+        }
+
+        private func window(for window: AccelerometerWindow)->Window {
+            let spectralFeatures = self.spectralFeatureExtractor?.features(forWindow: window) ?? []
+            if let windowClassifier = self.windowClassifier {
+                return Window(startDate: window.startDate, spectralFeatures: spectralFeatures, predictedActivities: windowClassifier.predictedActivities(forWindow: window), samples: [])
+            }
+
+            return Window(startDate: window.startDate, spectralFeatures: spectralFeatures, predictedActivities: nil, samples: Array(window.samples))
+        }
+    }
+
+    let predictionAggregator: PredictionAggregator
+    let sampleRate: Double
+    let referenceDate: Date
+    let executor: ClassificationExecutor
+    private(set) var startDate: Date?
+    private(set) var deadline: DispatchTime?
+
+    // shared with the executor and waiting queues
+    private let lock = NSLock()
+    private var pipeline: Pipeline?
+    private var _outcome: Outcome?
+    private var _rejectedBatchCount = 0
+
+    private var updateHandler: UpdateHandler?
+    private var remainingSamplesHandler: (([AccelerometerSample])->Void)?
+    private var finishHandlers: [(PredictionSession)->Void] = []
+    private let finished = DispatchGroup()
+    private var timeoutBlock: DispatchWorkItem?
+    private var backgroundTaskID = UIBackgroundTaskIdentifier.invalid
+
+    // Windows are cut from windowSchedule's start date, one every offset, once a whole duration of samples is in.
+    // Without a schedule the caller classifies from persisted readings instead. Without a windowClassifier each
+    // window's samples are handed over for classifying on the main queue.
+    init(predictionAggregator: PredictionAggregator, sampleRate: Double, persistBatchDuration: TimeInterval, windowSchedule: (startDate: Date, duration: TimeInterval, offset: TimeInterval)?, windowClassifier: ConcurrentAccelerometerWindowClassifier?, executor: ClassificationExecutor = ClassificationExecutor.shared) {
+        self.predictionAggregator = predictionAggregator
+        self.sampleRate = sampleRate
+        self.executor = executor
+
+        let pipeline = Pipeline(sampleRate: sampleRate, persistBatchDuration: persistBatchDuration, windowSchedule: windowSchedule, windowClassifier: windowClassifier)
+        self.pipeline = pipeline
+        self.referenceDate = pipeline.sampleBuffer.referenceDate
+        self.finished.enter()
+    }
+
+    var outcome: Outcome? {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self._outcome
+    }
+
+    var isFinished: Bool {
+        return self.outcome != nil
+    }
+
+    // false once the session has finished and handed its buffers back
+    var isBuffering: Bool {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self.pipeline != nil
+    }
+
+    // batches of accelerations dropped because the executor was too far behind
+    var rejectedBatchCount: Int {
+        self.lock.lock()
+        defer { self.lock.unlock() }
+        return self._rejectedBatchCount
+    }
+
+    // Whatever is still buffered when the session finishes goes to remainingSamplesHandler, after the finish handlers.
+    func start(timeout: TimeInterval, remainingSamplesHandler: @escaping ([AccelerometerSample])->Void, updateHandler: @escaping UpdateHandler) {
+        guard self.startDate == nil, !self.isFinished else {
+            return
+        }
+
+        self.startDate = Date()
+        self.updateHandler = updateHandler
+        self.remainingSamplesHandler = remainingSamplesHandler
+
+        self.backgroundTaskID = UIApplication.shared.beginBackgroundTask(expirationHandler: { () -> Void in
+            DDLogInfo("Prediction session background task expired!")
+            self.finish(.expired)
+        })
+
+        let deadline = DispatchTime.now() + timeout
+        let timeoutBlock = DispatchWorkItem {
+            DDLogInfo("Prediction session ran past its deadline, canceling!")
+            self.finish(.timedOut)
+        }
+        self.deadline = deadline
+        self.timeoutBlock = timeoutBlock
+        DispatchQueue.main.asyncAfter(deadline: deadline, execute: timeoutBlock)
+    }
+
+    // Called with the session once it finishes, or right away if it already has.
+    func onFinish(_ handler: @escaping (PredictionSession)->Void) {
+        if self.isFinished {
+            handler(self)
+        } else {
+            self.finishHandlers.append(handler)
+        }
+    }
+
+    func cancel() {
+        self.finish(.cancelled)
+    }
+
+    func fail() {
+        self.finish(.failed)
+    }
+
+    // Returns nil if the deadline passes first. Sessions finish on the main queue, so calling this there would
+    // wait out the whole deadline.
+    func wait(until deadline: DispatchTime)->Outcome? {
+        guard self.finished.wait(timeout: deadline) == .success else {
+            return nil
+        }
+
+        return self.outcome
+    }
+
+    // Motion queue. Accelerations fed before the session starts are buffered but not handled; after it finishes
+    // they are dropped.
+    func feed(_ accelerations: [(timestamp: TimeInterval, acceleration: CMAcceleration)]) {
+        guard self.isBuffering else {
+            return
+        }
+
+        let didSubmit = self.executor.submit {
+            self.lock.lock()
+            let pipeline = self.pipeline
+            self.lock.unlock()
+
+            guard let update = pipeline?.process(accelerations) else {
+                return
+            }
+
+            DispatchQueue.main.async {
+                guard !self.isFinished, let updateHandler = self.updateHandler else {
+                    return
+                }
+
+                if updateHandler(self, update) {
+                    self.finish(.completed)
+                }
+            }
+        }
+
+        if !didSubmit {
+            self.lock.lock()
+            self._rejectedBatchCount += 1
+            self.lock.unlock()
+        }
+    }
+
+    private func finish(_ outcome: Outcome) {
+        guard !self.isFinished else {
+            return
+        }
+
+        // queued batches see there's no pipeline and do nothing
+        self.lock.lock()
+        self._outcome = outcome
+        let pipeline = self.pipeline
+        self.pipeline = nil
+        self.lock.unlock()
+
+        self.timeoutBlock?.cancel()
+        self.timeoutBlock = nil
+        self.updateHandler = nil
+
+        let finishHandlers = self.finishHandlers
+        self.finishHandlers = []
+        for handler in finishHandlers {
+            handler(self)
+        }
+
+        if self.rejectedBatchCount > 0 {
+            DDLogInfo(String(format: "Classification executor fell behind, dropped %d batches of accelerations", self.rejectedBatchCount))
+        }
+
+        if let pipeline = pipeline, let remainingSamplesHandler = self.remainingSamplesHandler {
+            // the last reference to the pipeline, so its buffers go as soon as this has run
+            let didSubmit = self.executor.submit {
+                if pipeline.sampleBuffer.droppedSampleCount > 0 {
+                    DDLogInfo(String(format: "Accelerometer sample buffer overflowed, dropped %d samples", pipeline.sampleBuffer.droppedSampleCount))
+                }
+
+                let samples = pipeline.unpersistedSamples()
+                DispatchQueue.main.async {
+                    remainingSamplesHandler(samples)
+                }
+            }
+            if !didSubmit {
+                DDLogInfo("Classification executor fell behind, dropping the session's remaining samples.")
+            }
+        }
+        self.remainingSamplesHandler = nil
+
+        if (self.backgroundTaskID != UIBackgroundTaskIdentifier.invalid) {
+            UIApplication.shared.endBackgroundTask(self.backgroundTaskID)
+            self.backgroundTaskID = UIBackgroundTaskIdentifier.invalid
+        }
+
+        self.finished.leave()
+    }
+}
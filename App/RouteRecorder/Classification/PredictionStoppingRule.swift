@@ -0,0 +1,91 @@
+//
+//  PredictionStoppingRule.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+
+// Decides when a prediction session has classified enough windows to settle on an activity type.
+// Not thread safe.
+class PredictionStoppingRule {
+    enum Kind {
+        case fixed // more than minimumSampleCountForSuccess windows with a mean confidence above highConfidence
+        case sequential // as soon as the posterior of the top class is high enough
+    }
+
+    static let sequentialMinimumWindowCount = 1
+    static let sequentialErrorRate: Float = 0.05
+    static let sequentialEvidenceWeight: Float = 0.5 // consecutive windows overlap by all but sampleOffsetTimeInterval
+    static let sequentialProbabilityFloor: Float = 0.02
+
+    let kind: Kind
+    private var rule: OpaquePointer!
+
+    init(kind: Kind) {
+        self.kind = kind
+        let classCount = Int32(ActivityVoteAccumulator.classCount)
+        let maximumWindowCount = Int32(PredictionAggregator.maximumSampleBeforeFailure)
+        switch kind {
+        case .fixed:
+            self.rule = createFixedPredictionStoppingRule(classCount, Int32(PredictionAggregator.minimumSampleCountForSuccess), maximumWindowCount, PredictionAggregator.highConfidence)
+        case .sequential:
+            self.rule = createSequentialPredictionStoppingRule(classCount, Int32(PredictionStoppingRule.sequentialMinimumWindowCount), maximumWindowCount, PredictionStoppingRule.sequentialErrorRate, PredictionStoppingRule.sequentialEvidenceWeight, PredictionStoppingRule.sequentialProbabilityFloor)
+        }
+    }
+
+    deinit {
+        deletePredictionStoppingRule(self.rule)
+    }
+
+    func reset() {
+        predictionStoppingRuleReset(self.rule)
+    }
+
+    // A window's confidence for each class, indexed the same way as ActivityVoteAccumulator.
+    class func probabilities(of prediction: Prediction)->[Float] {
+        return self.probabilities(of: prediction.predictedActivities.map { (activityType: $0.activityType, confidence: $0.confidence) })
+    }
+
+    class func probabilities(of predictedActivities: [(activityType: ActivityType, confidence: Float)])->[Float] {
+        var probabilities = [Float](repeating: 0, count: ActivityVoteAccumulator.classCount)
+        for predictedActivity in predictedActivities {
+            probabilities[Int(ActivityVoteAccumulator.classIndex(predictedActivity.activityType))] += predictedActivity.confidence
+        }
+
+        return probabilities
+    }
+
+    @discardableResult func add(_ prediction: Prediction)->PredictionStoppingDecision {
+        return predictionStoppingRuleAddWindow(self.rule, PredictionStoppingRule.probabilities(of: prediction))
+    }
+
+    // For predictions that were never written to a Prediction, like those classified off the main queue.
+    @discardableResult func add(_ predictedActivities: [(activityType: ActivityType, confidence: Float)])->PredictionStoppingDecision {
+        return predictionStoppingRuleAddWindow(self.rule, PredictionStoppingRule.probabilities(of: predictedActivities))
+    }
+
+    var decision: PredictionStoppingDecision {
+        return predictionStoppingRuleDecision(self.rule)
+    }
+
+    var windowCount: Int {
+        return Int(predictionStoppingRuleWindowCount(self.rule))
+    }
+
+    var activityType: ActivityType {
+        return ActivityVoteAccumulator.activityType(predictionStoppingRuleTopClass(self.rule))
+    }
+
+    var confidence: Float {
+        return predictionStoppingRuleConfidence(self.rule)
+    }
+
+    // windows holds each session's windows of probabilities end to end.
+    func evaluate(windows: [Float], windowCounts: [Int32], labels: [Int32])->PredictionStoppingRuleEvaluation {
+        var evaluation = PredictionStoppingRuleEvaluation()
+        predictionStoppingRuleEvaluate(self.rule, windows, windowCounts, labels, Int32(windowCounts.count), &evaluation)
+        return evaluation
+    }
+}
@@ -0,0 +1,92 @@
+//
+//  PredictionStoppingRuleEvaluator.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+import CocoaLumberjack
+
+// Replays recorded prediction sessions through each kind of stopping rule, to compare how many windows they take
+// and how often the class they stop on is the right one.
+class PredictionStoppingRuleEvaluator {
+    struct Session {
+        let windows: [[Float]] // class probabilities, indexed the same way as ActivityVoteAccumulator
+        let label: ActivityType
+    }
+
+    private(set) var sessions: [Session] = []
+
+    init(sessions: [Session] = []) {
+        self.sessions = sessions
+    }
+
+    // Labelled only with ground truth: the activity type the user confirmed or corrected each aggregator's route to,
+    // which groundTruthActivityType gives for the routes that have one. Anything else is skipped, since labelling a
+    // session with what it predicted would grade the rules against themselves.
+    func addSessions(from predictionAggregators: [PredictionAggregator], groundTruthActivityType: (Route)->ActivityType?) {
+        for aggregator in predictionAggregators {
+            guard let route = aggregator.route, let label = groundTruthActivityType(route), label != .unknown else {
+                continue
+            }
+
+            let predictions = aggregator.predictions.filter { !$0.predictedActivities.isEmpty }.sorted { $0.startDate < $1.startDate }
+            if predictions.isEmpty {
+                continue
+            }
+            self.sessions.append(Session(windows: predictions.map { PredictionStoppingRule.probabilities(of: $0) }, label: label))
+        }
+    }
+
+    // A trace's prediction records are grouped into windows by time. Traces don't record what the activity really
+    // was, so the label has to come from whoever recorded it.
+    @discardableResult func addSession(fromTraceAt fileURL: URL, label: ActivityType)->Bool {
+        guard label != .unknown, let reader = SensorTraceReader(fileURL: fileURL) else {
+            return false
+        }
+
+        var windows: [[Float]] = []
+        var windowTime = -Double.infinity
+        while let record = reader.next() {
+            guard record.type == SensorTraceRecordTypePrediction else {
+                continue
+            }
+            if record.time != windowTime {
+                windows.append([Float](repeating: 0, count: ActivityVoteAccumulator.classCount))
+                windowTime = record.time
+            }
+            let classIndex = Int(ActivityVoteAccumulator.classIndex(ActivityType(rawValue: record.prediction.activityType) ?? .unknown))
+            windows[windows.count - 1][classIndex] += record.prediction.confidence
+        }
+
+        guard !windows.isEmpty else {
+            return false
+        }
+
+        self.sessions.append(Session(windows: windows, label: label))
+        return true
+    }
+
+    func evaluate(_ rule: PredictionStoppingRule)->PredictionStoppingRuleEvaluation {
+        var windows: [Float] = []
+        var windowCounts: [Int32] = []
+        var labels: [Int32] = []
+        for session in self.sessions {
+            for window in session.windows {
+                windows.append(contentsOf: window)
+            }
+            windowCounts.append(Int32(session.windows.count))
+            labels.append(ActivityVoteAccumulator.classIndex(session.label))
+        }
+
+        return rule.evaluate(windows: windows, windowCounts: windowCounts, labels: labels)
+    }
+
+    func logEvaluations() {
+        for kind in [PredictionStoppingRule.Kind.fixed, PredictionStoppingRule.Kind.sequential] {
+            let evaluation = self.evaluate(PredictionStoppingRule(kind: kind))
+            DDLogInfo(String(format: "%@ stopping rule: %i of %i sessions decided, %i correctly, %.2f windows on average", String(describing: kind), evaluation.decidedCount, evaluation.sessionCount, evaluation.decidedCorrectCount, evaluation.meanWindowCount))
+        }
+    }
+}
@@ -0,0 +1,61 @@
+//
+//  RandomForestManager+AccelerometerWindow.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+
+// The forest takes its input from Prediction.fetchAccelerometerReadings, so a window is handed to it as detached
+// readings in place of the fetch. Nothing is fetched or inserted, and a detached prediction keeps its class
+// confidences to itself, so predictedActivities(forWindow:) is safe to call off the main queue.
+extension RandomForestManager: AccelerometerWindowClassifier, ConcurrentAccelerometerWindowClassifier {
+    static let detachedReadingPoolKey = "RandomForestManagerDetachedReadingPool"
+    
+    // The detached readings a thread hands the forest, overwritten by each window instead of allocated for it. Each
+    // thread that classifies (main, the executor, reclassifier workers) has its own, so they never share a reading.
+    private class DetachedReadingPool {
+        var readings: [AccelerometerReading] = []
+    }
+    
+    private func detachedReadings(for window: AccelerometerWindow)->ArraySlice<AccelerometerReading> {
+        let threadDictionary = Thread.current.threadDictionary
+        let pool: DetachedReadingPool
+        if let existingPool = threadDictionary[RandomForestManager.detachedReadingPoolKey] as? DetachedReadingPool {
+            pool = existingPool
+        } else {
+            pool = DetachedReadingPool()
+            threadDictionary[RandomForestManager.detachedReadingPoolKey] = pool
+        }
+        
+        while pool.readings.count < window.samples.count {
+            pool.readings.append(AccelerometerReading(detachedSample: AccelerometerSample(), date: window.startDate))
+        }
+        for (i, sample) in window.samples.enumerated() {
+            pool.readings[i].update(withDetachedSample: sample, date: window.startDate.addingTimeInterval(Double(i) / window.sampleRate))
+        }
+        
+        return pool.readings[0..<window.samples.count]
+    }
+    
+    public func classify(_ prediction: Prediction, window: AccelerometerWindow) {
+        prediction.withReadingsInHand(Array(self.detachedReadings(for: window))) {
+            self.classify(prediction)
+        }
+    }
+    
+    public func predictedActivities(forWindow window: AccelerometerWindow)->[(activityType: ActivityType, confidence: Float)] {
+        let prediction = Prediction(detachedWithStartDate: window.startDate)
+        self.classify(prediction, window: window)
+        
+        var predictedActivities: [(activityType: ActivityType, confidence: Float)] = []
+        for (classInt, confidence) in prediction.detachedClassConfidences ?? [:] {
+            if let activityType = ActivityType(rawValue: Int16(classInt)) {
+                predictedActivities.append((activityType: activityType, confidence: confidence))
+            }
+        }
+        
+        return predictedActivities.sorted { $0.confidence > $1.confidence }
+    }
+}
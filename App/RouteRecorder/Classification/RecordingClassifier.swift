@@ -0,0 +1,167 @@
+//
+//  RecordingClassifier.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+import CoreMotion
+import CocoaLumberjack
+
+extension CMSensorDataList: Sequence {
+    func makeIterator()->NSFastEnumerationIterator {
+        return NSFastEnumerationIterator(self)
+    }
+}
+
+// Classifies hours of recorded accelerometer history, like what CMSensorRecorder hands back, into a timeline of
+// activity segments, so past activity can be classified without keeping the sensors running. Recordings are taken to
+// be at the model rate, which is CMSensorRecorder's. Windows are scored on workerCount threads, each with its own
+// classifier from classifierFactory, and memory stays flat however long the recording is.
+// Not thread safe. append blocks while the workers catch up, so keep it off the main queue.
+class RecordingClassifier {
+    static let chunkDuration: TimeInterval = 2 * 60 // of windows per worker hand-off
+    static let maximumGap: TimeInterval = 1
+    static let minimumSegmentDuration: TimeInterval = 60
+    static let appendBatchSize = 1024
+
+    struct Segment {
+        let startDate: Date
+        let endDate: Date
+        let activityType: ActivityType
+        let confidence: Float
+    }
+
+    // Shared with the scorer, which is called on the native workers' threads.
+    private class ScorerContext {
+        let classifiers: [ConcurrentAccelerometerWindowClassifier]
+        let sampleRate: Double
+
+        init(classifiers: [ConcurrentAccelerometerWindowClassifier], sampleRate: Double) {
+            self.classifiers = classifiers
+            self.sampleRate = sampleRate
+        }
+    }
+
+    let sampleRate: Double
+    private var classifier: OpaquePointer!
+    private let scorerContext: ScorerContext
+    private var samples: [AccelerometerSample] = []
+
+    init?(windowDuration: TimeInterval, workerCount: Int = ProcessInfo.processInfo.activeProcessorCount, classifierFactory: ()->ConcurrentAccelerometerWindowClassifier?) {
+        var classifiers: [ConcurrentAccelerometerWindowClassifier] = []
+        for _ in 0..<max(workerCount, 1) {
+            guard let classifier = classifierFactory() else {
+                DDLogWarn("No classifier to classify the recording with!")
+                return nil
+            }
+            classifiers.append(classifier)
+        }
+
+        self.sampleRate = SensorClassificationManager.modelSampleRate
+        self.scorerContext = ScorerContext(classifiers: classifiers, sampleRate: self.sampleRate)
+
+        let windowOffsetSampleCount = Int32(PredictionAggregator.sampleOffsetTimeInterval * self.sampleRate)
+        let configuration = RecordingClassifierConfiguration(sampleRate: Float(self.sampleRate),
+                                                             windowSampleCount: Int32(windowDuration * self.sampleRate),
+                                                             windowOffsetSampleCount: windowOffsetSampleCount,
+                                                             chunkWindowCount: Int32(RecordingClassifier.chunkDuration / PredictionAggregator.sampleOffsetTimeInterval),
+                                                             workerCount: Int32(classifiers.count),
+                                                             classCount: Int32(ActivityVoteAccumulator.classCount),
+                                                             computesSpectralFeatures: false,
+                                                             stationaryClass: ActivityVoteAccumulator.classIndex(.stationary),
+                                                             stationaryThreshold: StationaryDetector.stationaryThreshold,
+                                                             maximumGap: Float(RecordingClassifier.maximumGap),
+                                                             minimumSegmentDuration: Float(RecordingClassifier.minimumSegmentDuration))
+
+        let scorer: RecordingWindowScorer = { (context, workerIndex, windowStartTime, samples, sampleCount, _, probabilities) in
+            guard let context = context, let samples = samples, let probabilities = probabilities else {
+                return
+            }
+
+            let scorerContext = Unmanaged<ScorerContext>.fromOpaque(context).takeUnretainedValue()
+            let window = AccelerometerWindow(samples: UnsafeBufferPointer(start: samples, count: Int(sampleCount)), sampleRate: scorerContext.sampleRate, startDate: Date(timeIntervalSinceReferenceDate: windowStartTime))
+            for predictedActivity in scorerContext.classifiers[Int(workerIndex)].predictedActivities(forWindow: window) {
+                probabilities[Int(ActivityVoteAccumulator.classIndex(predictedActivity.activityType))] += predictedActivity.confidence
+            }
+        }
+
+        // the context is owned by self, which outlives the native classifier
+        guard let classifier = createRecordingClassifier(configuration, scorer, Unmanaged.passUnretained(self.scorerContext).toOpaque()) else {
+            return nil
+        }
+        self.classifier = classifier
+        self.samples.reserveCapacity(RecordingClassifier.appendBatchSize)
+    }
+
+    deinit {
+        deleteRecordingClassifier(self.classifier)
+    }
+
+    // Sample times are relative to referenceDate.
+    func append(_ samples: UnsafeBufferPointer<AccelerometerSample>, referenceDate: Date) {
+        recordingClassifierAppend(self.classifier, referenceDate.timeIntervalSinceReferenceDate, samples.baseAddress, Int32(samples.count))
+    }
+
+    func append(recordedData: CMSensorDataList) {
+        var referenceTime: TimeInterval = 0
+        for data in recordedData {
+            guard let data = data as? CMRecordedAccelerometerData else {
+                continue
+            }
+
+            let time = data.startDate.timeIntervalSinceReferenceDate
+            if self.samples.isEmpty {
+                referenceTime = time
+            }
+            self.samples.append(AccelerometerSample(t: Float(time - referenceTime), x: Float(data.acceleration.x), y: Float(data.acceleration.y), z: Float(data.acceleration.z)))
+
+            if self.samples.count == RecordingClassifier.appendBatchSize {
+                self.flushSamples(referenceTime: referenceTime)
+            }
+        }
+        self.flushSamples(referenceTime: referenceTime)
+    }
+
+    // Reads history straight out of CMSensorRecorder, a batch at a time.
+    func appendRecordedData(from startDate: Date, to endDate: Date) {
+        guard CMSensorRecorder.isAccelerometerRecordingAvailable(), let recordedData = CMSensorRecorder().accelerometerData(from: startDate, to: endDate) else {
+            DDLogInfo("No recorded accelerometer data to classify!")
+            return
+        }
+
+        self.append(recordedData: recordedData)
+    }
+
+    func finish()->[Segment] {
+        recordingClassifierFinish(self.classifier)
+
+        let statistics = self.statistics
+        DDLogInfo(String(format: "Classified a recording of %lld samples: %d windows, %d scored, %d gaps, at most %d samples buffered", statistics.sampleCount, statistics.windowCount, statistics.scoredWindowCount, statistics.gapCount, statistics.peakBufferedSampleCount))
+
+        return self.segments
+    }
+
+    var segments: [Segment] {
+        var segments = [RecordingSegment](repeating: RecordingSegment(), count: Int(recordingClassifierSegmentCount(self.classifier)))
+        let count = recordingClassifierCopySegments(self.classifier, &segments, Int32(segments.count))
+
+        return segments.prefix(Int(count)).map {
+            Segment(startDate: Date(timeIntervalSinceReferenceDate: $0.startTime), endDate: Date(timeIntervalSinceReferenceDate: $0.endTime), activityType: ActivityVoteAccumulator.activityType($0.activityClass), confidence: $0.confidence)
+        }
+    }
+
+    var statistics: RecordingClassifierStatistics {
+        return recordingClassifierStatistics(self.classifier)
+    }
+
+    private func flushSamples(referenceTime: TimeInterval) {
+        guard !self.samples.isEmpty else {
+            return
+        }
+
+        recordingClassifierAppend(self.classifier, referenceTime, self.samples, Int32(self.samples.count))
+        self.samples.removeAll(keepingCapacity: true)
+    }
+}
@@ -0,0 +1,44 @@
+//
+//  SpectralFeatureExtractor.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+
+// Band energies, centroid, entropy and flatness of a prediction window, for x, y, z and the magnitude.
+class SpectralFeatureExtractor {
+    let windowSampleCount: Int
+
+    private var analyzer: OpaquePointer!
+    private var samples: [AccelerometerSample] = []
+    private var features = [SpectralFeatures](repeating: SpectralFeatures(), count: Int(SpectralChannelCount.rawValue))
+
+    init(sampleRate: Double, windowDuration: TimeInterval) {
+        self.windowSampleCount = Int(windowDuration * sampleRate)
+        self.analyzer = createSpectralAnalyzer(Float(sampleRate), Int32(self.windowSampleCount))
+    }
+
+    deinit {
+        deleteSpectralAnalyzer(self.analyzer)
+    }
+
+    func features(forReadings readings: [AccelerometerReading])->[SpectralFeatures] {
+        self.samples.removeAll(keepingCapacity: true)
+        for reading in readings.prefix(self.windowSampleCount) {
+            self.samples.append(AccelerometerSample(t: 0, x: Float(reading.x), y: Float(reading.y), z: Float(reading.z)))
+        }
+
+        spectralAnalyzerCompute(self.analyzer, self.samples, Int32(self.samples.count), &self.features)
+
+        return self.features
+    }
+
+    // Reads the window in place.
+    func features(forWindow window: AccelerometerWindow)->[SpectralFeatures] {
+        spectralAnalyzerCompute(self.analyzer, window.samples.baseAddress, Int32(min(window.samples.count, self.windowSampleCount)), &self.features)
+
+        return self.features
+    }
+}
@@ -0,0 +1,49 @@
+//
+//  StationaryDetector.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+import CoreMotion
+
+// Cheap check for a phone sitting still, run on raw samples before any features are extracted.
+// Not thread safe; feed it from a single serial queue.
+class StationaryDetector {
+    static let windowDuration: TimeInterval = 2
+    static let holdDuration: TimeInterval = 1 // how long the window has to stay quiet before we believe it
+
+    // standard deviation of the acceleration magnitude, in g's. A phone on a table is well under 0.005.
+    static let stationaryThreshold: Float = 0.01
+    static let movingThreshold: Float = 0.02
+
+    private var gate: OpaquePointer!
+    private var samples: [AccelerometerSample] = []
+
+    init(sampleRate: Double) {
+        self.gate = createStationaryGate(Int32(StationaryDetector.windowDuration * sampleRate), Int32(StationaryDetector.holdDuration * sampleRate), StationaryDetector.stationaryThreshold, StationaryDetector.movingThreshold)
+    }
+
+    deinit {
+        deleteStationaryGate(self.gate)
+    }
+
+    var standardDeviation: Float {
+        return stationaryGateStandardDeviation(self.gate)
+    }
+
+    func reset() {
+        stationaryGateReset(self.gate)
+    }
+
+    func isStationary(afterAccelerations accelerations: [(timestamp: TimeInterval, acceleration: CMAcceleration)])->Bool {
+        self.samples.removeAll(keepingCapacity: true)
+        for (_, acceleration) in accelerations {
+            // the gate only looks at the magnitude, so the timestamp is left out
+            self.samples.append(AccelerometerSample(t: 0, x: Float(acceleration.x), y: Float(acceleration.y), z: Float(acceleration.z)))
+        }
+
+        return stationaryGatePush(self.gate, self.samples, Int32(self.samples.count)) == StationaryGateStateStationary
+    }
+}
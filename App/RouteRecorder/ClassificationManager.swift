@@ -22,7 +22,9 @@ public protocol ClassificationManager {
         
     func startup(handler: @escaping ()->Void)
     func predictCurrentActivityType(predictionAggregator:PredictionAggregator, withHandler handler:@escaping (_: PredictionAggregator) -> Void)
+    func cancelPrediction(predictionAggregator: PredictionAggregator)
     func setTestPredictionsTemplates(testPredictions: [PredictedActivity])
+    func classifyRecordedActivity()
     
     func gatherSensorData(predictionAggregator: PredictionAggregator)
     func stopGatheringSensorData()
@@ -32,27 +34,100 @@ extension ClassificationManager {
     public func setTestPredictionsTemplates(testPredictions: [PredictedActivity]) {
         
     }
+    
+    public func cancelPrediction(predictionAggregator: PredictionAggregator) {
+        
+    }
+    
+    public func classifyRecordedActivity() {
+        
+    }
 }
 
 public class SensorClassificationManager : ClassificationManager {
     public var routeRecorder: RouteRecorder!
     
+    public static let modelSampleRate: Double = 50 // 50hz, the native rate for CMSensorRecorder and the rate our models are trained at
+    
+    // Readings are resampled to modelSampleRate before they are classified, so the accelerometer can run at a lower rate
+    // (for example on low-battery devices) without retraining. Must be one of AccelerometerResampler.supportedInputSampleRates.
+    public var accelerometerSampleRate: Double = SensorClassificationManager.modelSampleRate {
+        didSet {
+            assert(AccelerometerResampler.supportedInputSampleRates.contains(accelerometerSampleRate), "Unsupported accelerometer sample rate!")
+            if let routeRecorder = self.routeRecorder {
+                routeRecorder.motionManager.accelerometerUpdateInterval = 1/accelerometerSampleRate
+            }
+        }
+    }
+    
+    // Readings wait in the sample buffer and are written out (to the raw sensor store, and to Core Data if
+    // persistsAccelerometerReadings) in batches of this length, rather than one managed object and save per motion callback.
+    public static let accelerometerPersistenceBatchDuration: TimeInterval = 0.5
+    
+    // Persisted readings are only needed to upload prediction aggregators for training, as long as the classifier can
+    // read its windows straight out of the sample buffer. Turn this off to classify without writing any readings.
+    public var persistsAccelerometerReadings = true
+    
     private var motionQueue: OperationQueue!
+    private var bufferingSession: (sampleBuffer: AccelerometerSampleBuffer, predictionAggregator: PredictionAggregator, persistsReadings: Bool)?
     
     public static var authorizationStatus : ClassificationManagerAuthorizationStatus = .notDetermined
     
     private var backgroundTaskID = UIBackgroundTaskIdentifier.invalid
-    var cancelTimedoutPredictionBlock: DispatchWorkItem?
-
+    
+    // Every prediction that hasn't finished, all fed from one stream of motion updates. Only changed on the main
+    // queue; the motion queue reads it under the lock.
+    private var predictionSessions: [PredictionSession] = []
+    private let predictionSessionsLock = NSLock()
 
     private var isGatheringMotionData: Bool = false
+    private var gatheringStartDate: Date?
+    
+    // Decides which requests get the accelerometer, and at what rate. Requests that come in while a session is
+    // already running share its motion updates, so they cost nothing and skip the scheduler.
+    private var predictionScheduler: PredictionScheduler?
+    private var predictionRetries: [(predictionAggregator: PredictionAggregator, workItem: DispatchWorkItem, handler: (PredictionAggregator)->Void)] = []
+    private var spectralFeatureExtractor: SpectralFeatureExtractor?
+    private var executorRandomForestManager: RandomForestManager?
+    
+    // CMSensorRecorder records for at most this long per request, so recording is re-armed each time the recorded
+    // history is classified. Only the history since the last classification is read back.
+    public static let accelerometerRecordingDuration: TimeInterval = 12 * 60 * 60
+    private var sensorRecorder: CMSensorRecorder?
+    private var isClassifyingRecordedActivity = false
+    
+    private(set) var recordedActivitySegments: [RecordingClassifier.Segment] = []
+    
+    public var recordedActivityClassifiedUntilDate: Date? {
+        return UserDefaults.standard.object(forKey: "RecordedActivityClassifiedUntilDate") as? Date
+    }
+    
+    // How often the stationary gate ends a prediction before the random forest runs, kept across launches
+    // so we can tell how much sensor time it saves.
+    public var stationaryGateEvaluationCount: Int {
+        return UserDefaults.standard.integer(forKey: "StationaryGateEvaluationCount")
+    }
+    
+    public var stationaryGateShortCircuitCount: Int {
+        return UserDefaults.standard.integer(forKey: "StationaryGateShortCircuitCount")
+    }
+    
+    // estimated against the shortest time a full prediction could have taken
+    public var stationaryGateSavedSensorTime: TimeInterval {
+        return UserDefaults.standard.double(forKey: "StationaryGateSavedSensorTime")
+    }
     
     public init () {
         self.motionQueue = OperationQueue()
+        self.motionQueue.maxConcurrentOperationCount = 1 // resampling needs readings in order
     }
     
     public func startup(handler: @escaping ()->Void = {() in }) {
-        routeRecorder.motionManager.accelerometerUpdateInterval = 1/50 // 50hz, the native rate for CMSensorRecorder
+        routeRecorder.motionManager.accelerometerUpdateInterval = 1/self.accelerometerSampleRate
+        
+        let sampleRates = AccelerometerResampler.supportedInputSampleRates.filter { $0 <= SensorClassificationManager.modelSampleRate }
+        self.predictionScheduler = PredictionScheduler(windowDuration: self.routeRecorder.randomForestManager.desiredSessionDuration, sampleRates: sampleRates)
+        self.startRecordingAccelerometer()
         
         handler()
     }
@@ -61,6 +136,12 @@ public class SensorClassificationManager : ClassificationManager {
         self.isGatheringMotionData = false
         self.stopMotionUpdates()
         
+        if let startDate = self.gatheringStartDate {
+            self.predictionScheduler?.recordUsage(sensorDuration: Date().timeIntervalSince(startDate), sampleRate: self.accelerometerSampleRate)
+            self.gatheringStartDate = nil
+        }
+        self.persistAccelerometerSamples()
+        
         if (self.backgroundTaskID != UIBackgroundTaskIdentifier.invalid) {
             DDLogInfo("Ending GatherSensorData background task!")
             
@@ -79,16 +160,33 @@ public class SensorClassificationManager : ClassificationManager {
             })
         }
         
+        // gathering takes over the motion updates, so nothing would feed them
+        for session in self.predictionSessions {
+            session.cancel()
+        }
+        
         self.isGatheringMotionData = true
+        if self.gatheringStartDate == nil {
+            self.gatheringStartDate = Date()
+        }
         
+        self.routeRecorder.motionManager.accelerometerUpdateInterval = 1/self.accelerometerSampleRate
+        let resampler = AccelerometerResampler(inputSampleRate: self.accelerometerSampleRate, outputSampleRate: SensorClassificationManager.modelSampleRate)
+        let sampleBuffer = self.beginBufferingAccelerometerSamples(predictionAggregator: predictionAggregator, persistsReadings: true)
         self.routeRecorder.motionManager.startAccelerometerUpdates(to: self.motionQueue) { (data, error) in
             guard let accelerometerData = data else {
                 return
             }
             
+            let accelerations = resampler.resample(accelerometerData)
+            guard accelerations.count > 0 else {
+                return
+            }
+            
+            sampleBuffer.write(accelerations)
+            
             DispatchQueue.main.async {
-                let reading = self.accelerometerReading(forAccelerometerData: accelerometerData,  predictionAggregator: predictionAggregator)
-                reading.predictionAggregator = predictionAggregator
+                self.persistAccelerometerSamplesIfNeeded(sampleBuffer: sampleBuffer, predictionAggregator: predictionAggregator, persistsReadings: true)
             }
         }
     }
@@ -101,59 +199,238 @@ public class SensorClassificationManager : ClassificationManager {
             return
         }
         
-        if (self.backgroundTaskID == UIBackgroundTaskIdentifier.invalid) {
-            DDLogInfo("Beginning Query Activity Type background task!")
-            self.backgroundTaskID = UIApplication.shared.beginBackgroundTask(expirationHandler: { () -> Void in
-                DDLogInfo("Query Activity Type Background task expired!")
-                predictionAggregator.addUnknownTypePrediction()
-                handler(predictionAggregator)
-                UIApplication.shared.endBackgroundTask(self.backgroundTaskID)
-                self.backgroundTaskID = UIBackgroundTaskIdentifier.invalid
-            })
-            
-            // schedule an early bailer if we're not done yet
-            let maximumTimeNeeded = Double(PredictionAggregator.maximumSampleBeforeFailure - 1) * PredictionAggregator.sampleOffsetTimeInterval + Double(PredictionAggregator.maximumSampleBeforeFailure) * self.routeRecorder.randomForestManager.desiredSessionDuration
-            let timeoutPredictionInterval = maximumTimeNeeded + 2 // plus a generous buffer
-            
-            let timeoutPredictionBlock = DispatchWorkItem {
-                self.cancelTimedoutPredictionBlock = nil
-                predictionAggregator.currentPrediction = nil
-                
-                DDLogInfo("Prediction attempt expired, canceling!")
-                predictionAggregator.addUnknownTypePrediction()
-                handler(predictionAggregator)
-                self.stopMotionUpdates()
-            }
-            cancelTimedoutPredictionBlock = timeoutPredictionBlock
-            DispatchQueue.main.asyncAfter(deadline: .now() + timeoutPredictionInterval, execute: timeoutPredictionBlock)
-        } else {
-            DDLogInfo("Could not query activity type, background task already in process!")
+        if self.isGatheringMotionData || self.predictionSessions.contains(where: { $0.predictionAggregator === predictionAggregator }) {
+            DDLogInfo("Could not query activity type, sensor session already in process!")
             predictionAggregator.addUnknownTypePrediction()
             handler(predictionAggregator)
             return
         }
+        
+        var decision: PredictionScheduler.Decision? = nil
+        if let predictionScheduler = self.predictionScheduler, self.predictionSessions.isEmpty {
+            let speed = predictionAggregator.locations.max(by: { $0.date < $1.date })?.speed ?? -1
+            let scheduledDecision = predictionScheduler.decide(speed: speed)
+            guard scheduledDecision.shouldSample else {
+                if scheduledDecision.declineReason == PredictionSchedulerDeclineReasonConfidentResult, let standingResult = predictionScheduler.standingResult {
+                    DDLogInfo(String(format: "Skipping prediction, last result still stands: %@ confidence: %f", standingResult.activityType.emoji, standingResult.confidence))
+                    predictionAggregator.addStandingPrediction(activityType: standingResult.activityType, confidence: standingResult.confidence)
+                    handler(predictionAggregator)
+                } else if scheduledDecision.retryDate.timeIntervalSinceNow <= PredictionScheduler.maximumInterval {
+                    DDLogInfo(String(format: "Skipping prediction, scheduler declined until %@. Retrying then.", scheduledDecision.retryDate as CVarArg))
+                    self.retryPrediction(predictionAggregator: predictionAggregator, at: scheduledDecision.retryDate, withHandler: handler)
+                } else {
+                    DDLogInfo(String(format: "Skipping prediction, scheduler declined until %@", scheduledDecision.retryDate as CVarArg))
+                    predictionAggregator.addUnknownTypePrediction()
+                    handler(predictionAggregator)
+                }
+                return
+            }
+            decision = scheduledDecision
+        }
 
         let prediction = Prediction()
         prediction.predictionAggregator = predictionAggregator
         
         predictionAggregator.currentPrediction = prediction
-        RouteRecorderDatabaseManager.shared.saveContext()
+        RouteRecorderDatabaseManager.shared.scheduleSave()
+        
+        let sampleRate = min(decision?.sampleRate ?? self.accelerometerSampleRate, self.accelerometerSampleRate)
+        let session = self.beginPredictionSession(predictionAggregator: predictionAggregator, sampleRate: sampleRate, timeout: decision?.sessionDuration)
+        session.onFinish { (session) in
+            if decision != nil, let startDate = session.startDate {
+                let predictedActivity = session.outcome == .completed ? predictionAggregator.aggregatePredictedActivity : nil
+                self.predictionScheduler?.recordResult(sensorDuration: Date().timeIntervalSince(startDate), sampleRate: sampleRate, predictedActivity: predictedActivity)
+            }
+            
+            if session.outcome != .completed {
+                DDLogInfo("Prediction session ended without a prediction, finishing with what it has.")
+                predictionAggregator.currentPrediction = nil
+                predictionAggregator.finishAggregatePredictedActivity()
+                predictionAggregator.addUnknownTypePrediction()
+            }
+            handler(predictionAggregator)
+        }
+    }
+    
+    // Ends the aggregator's prediction early. Its handler is still called, with whatever the aggregator has so far.
+    public func cancelPrediction(predictionAggregator: PredictionAggregator) {
+        for session in self.predictionSessions where session.predictionAggregator === predictionAggregator {
+            session.cancel()
+        }
         
-        beginMotionUpdates(predictionAggregator: predictionAggregator, withHandler: handler)
+        for retry in self.predictionRetries where retry.predictionAggregator === predictionAggregator {
+            retry.workItem.cancel()
+            predictionAggregator.addUnknownTypePrediction()
+            retry.handler(predictionAggregator)
+        }
+        self.predictionRetries = self.predictionRetries.filter { $0.predictionAggregator !== predictionAggregator }
+    }
+    
+    // Classifies the accelerometer history CMSensorRecorder kept since the last time into recordedActivitySegments,
+    // scoring it with a random forest per core off the main queue.
+    public func classifyRecordedActivity() {
+        guard CMSensorRecorder.isAccelerometerRecordingAvailable(), !self.isClassifyingRecordedActivity else {
+            return
+        }
+        
+        let endDate = Date()
+        let earliestStartDate = endDate.addingTimeInterval(-SensorClassificationManager.accelerometerRecordingDuration)
+        let startDate = max(self.recordedActivityClassifiedUntilDate ?? earliestStartDate, earliestStartDate)
+        let windowDuration = self.routeRecorder.randomForestManager.desiredSessionDuration
+        guard endDate.timeIntervalSince(startDate) >= windowDuration else {
+            return
+        }
+        
+        self.isClassifyingRecordedActivity = true
+        DispatchQueue.global(qos: .utility).async {
+            let recordingClassifier = RecordingClassifier(windowDuration: windowDuration) { ()->ConcurrentAccelerometerWindowClassifier? in
+                let randomForestManager = RandomForestManager()
+                randomForestManager.startup()
+                return randomForestManager.canPredict ? randomForestManager : nil
+            }
+            
+            var segments: [RecordingClassifier.Segment] = []
+            if let recordingClassifier = recordingClassifier {
+                recordingClassifier.appendRecordedData(from: startDate, to: endDate)
+                segments = recordingClassifier.finish()
+            }
+            
+            DispatchQueue.main.async {
+                self.isClassifyingRecordedActivity = false
+                guard recordingClassifier != nil else {
+                    return
+                }
+                
+                DDLogInfo(String(format: "Classified recorded activity from %@ to %@ into %i segments", startDate as CVarArg, endDate as CVarArg, segments.count))
+                self.recordedActivitySegments = segments
+                UserDefaults.standard.set(endDate, forKey: "RecordedActivityClassifiedUntilDate")
+                self.startRecordingAccelerometer()
+            }
+        }
     }
     
     //
     // MARK: Helper Functions
     //
     
-    private func accelerometerReading(forAccelerometerData accelerometerData:CMAccelerometerData, predictionAggregator: PredictionAggregator)->AccelerometerReading {
-        let accelerometerReading = AccelerometerReading(accelerometerData: accelerometerData)
-        if predictionAggregator.referenceBootDate == nil {
-            predictionAggregator.referenceBootDate = Date(timeIntervalSinceNow: -1 * accelerometerData.timestamp)
+    // Asks again once the scheduler would grant the request. Fixes that come in meanwhile join the aggregator, so the
+    // retry decides on the latest speed.
+    private func retryPrediction(predictionAggregator: PredictionAggregator, at date: Date, withHandler handler:@escaping (_: PredictionAggregator) -> Void) {
+        let workItem = DispatchWorkItem { [weak self] in
+            guard let strongSelf = self else {
+                return
+            }
+            
+            strongSelf.predictionRetries = strongSelf.predictionRetries.filter { $0.predictionAggregator !== predictionAggregator }
+            strongSelf.predictCurrentActivityType(predictionAggregator: predictionAggregator, withHandler: handler)
+        }
+        
+        self.predictionRetries.append((predictionAggregator: predictionAggregator, workItem: workItem, handler: handler))
+        DispatchQueue.main.asyncAfter(deadline: .now() + max(date.timeIntervalSinceNow, 0), execute: workItem)
+    }
+    
+    private func startRecordingAccelerometer() {
+        guard CMSensorRecorder.isAccelerometerRecordingAvailable() else {
+            return
+        }
+        
+        if self.sensorRecorder == nil {
+            self.sensorRecorder = CMSensorRecorder()
+        }
+        self.sensorRecorder?.recordAccelerometer(forDuration: SensorClassificationManager.accelerometerRecordingDuration)
+    }
+    
+    // The forest takes its windows straight out of a session's sample buffer, on the executor thread. That thread gets
+    // its own forest, like the reclassifier's and the recording classifier's workers, so it never shares one with the
+    // main queue. Every session runs on the shared executor one job at a time, so they all use this one.
+    private var concurrentWindowClassifier: ConcurrentAccelerometerWindowClassifier? {
+        if self.executorRandomForestManager == nil {
+            let randomForestManager = RandomForestManager()
+            randomForestManager.startup()
+            guard randomForestManager.canPredict else {
+                return nil
+            }
+            self.executorRandomForestManager = randomForestManager
+        }
+        
+        return self.executorRandomForestManager
+    }
+    
+    private func beginBufferingAccelerometerSamples(predictionAggregator: PredictionAggregator, persistsReadings: Bool)->AccelerometerSampleBuffer {
+        // anything still buffered from an earlier session belongs to that session's aggregator
+        self.persistAccelerometerSamples()
+        
+        let sampleBuffer = AccelerometerSampleBuffer(sampleRate: SensorClassificationManager.modelSampleRate)
+        self.bufferingSession = (sampleBuffer: sampleBuffer, predictionAggregator: predictionAggregator, persistsReadings: persistsReadings)
+        
+        return sampleBuffer
+    }
+    
+    // Returns true if a batch of readings was added to Core Data.
+    @discardableResult private func persistAccelerometerSamplesIfNeeded(sampleBuffer: AccelerometerSampleBuffer, predictionAggregator: PredictionAggregator, persistsReadings: Bool)->Bool {
+        let batchCount = Int(SensorClassificationManager.accelerometerPersistenceBatchDuration * SensorClassificationManager.modelSampleRate)
+        guard sampleBuffer.unpersistedSampleCount >= batchCount else {
+            return false
+        }
+        
+        return self.persistAccelerometerSamples(sampleBuffer: sampleBuffer, predictionAggregator: predictionAggregator, persistsReadings: persistsReadings)
+    }
+    
+    @discardableResult private func persistAccelerometerSamples(sampleBuffer: AccelerometerSampleBuffer, predictionAggregator: PredictionAggregator, persistsReadings: Bool)->Bool {
+        let count = sampleBuffer.persist { (samples) in
+            self.addAccelerometerSamples(samples, referenceDate: sampleBuffer.referenceDate, predictionAggregator: predictionAggregator, persistsReadings: persistsReadings)
+        }
+        
+        guard count > 0 && persistsReadings else {
+            return false
+        }
+        
+        RouteRecorderDatabaseManager.shared.scheduleSave(recordCount: count)
+        
+        return true
+    }
+    
+    // Samples a prediction session has already copied out of its buffer.
+    @discardableResult private func persistAccelerometerSamples(_ samples: [AccelerometerSample], referenceDate: Date, predictionAggregator: PredictionAggregator, persistsReadings: Bool)->Bool {
+        samples.withUnsafeBufferPointer { (samples) in
+            self.addAccelerometerSamples(samples, referenceDate: referenceDate, predictionAggregator: predictionAggregator, persistsReadings: persistsReadings)
+        }
+        
+        guard samples.count > 0 && persistsReadings else {
+            return false
+        }
+        
+        RouteRecorderDatabaseManager.shared.scheduleSave(recordCount: samples.count)
+        
+        return true
+    }
+    
+    private func addAccelerometerSamples(_ samples: UnsafeBufferPointer<AccelerometerSample>, referenceDate: Date, predictionAggregator: PredictionAggregator, persistsReadings: Bool) {
+        RawSensorStore.shared?.append(samples, referenceDate: referenceDate)
+        
+        guard persistsReadings else {
+            return
         }
         
-        accelerometerReading.date =  Date(timeInterval: accelerometerData.timestamp, since: predictionAggregator.referenceBootDate)
-        return accelerometerReading
+        for sample in samples {
+            let reading = AccelerometerReading(acceleration: CMAcceleration(x: Double(sample.x), y: Double(sample.y), z: Double(sample.z)))
+            reading.date = referenceDate.addingTimeInterval(TimeInterval(sample.t))
+            reading.predictionAggregator = predictionAggregator
+            predictionAggregator.readingTimeIndex.append(reading.date)
+        }
+    }
+    
+    private func persistAccelerometerSamples() {
+        guard let session = self.bufferingSession else {
+            return
+        }
+        
+        if session.sampleBuffer.droppedSampleCount > 0 {
+            DDLogInfo(String(format: "Accelerometer sample buffer overflowed, dropped %d samples", session.sampleBuffer.droppedSampleCount))
+        }
+        
+        self.persistAccelerometerSamples(sampleBuffer: session.sampleBuffer, predictionAggregator: session.predictionAggregator, persistsReadings: session.persistsReadings)
+        self.bufferingSession = nil
     }
     
     private func stopMotionUpdates() {
@@ -162,63 +439,184 @@ public class SensorClassificationManager : ClassificationManager {
         }
         
         self.routeRecorder.motionManager.stopAccelerometerUpdates()
+    }
+    
+    
+    
+    private func finishStationaryPrediction(predictionAggregator: PredictionAggregator, sessionStartDate: Date)->Bool {
+        guard let prediction = predictionAggregator.currentPrediction else {
+            return false
+        }
+        
+        _ = PredictedActivity(activityType: .stationary, confidence: 1.0, prediction: prediction)
+        predictionAggregator.aggregatePredictedActivity = PredictedActivity(activityType: .stationary, confidence: 1.0, prediction: nil)
+        predictionAggregator.currentPrediction = nil
+        RouteRecorderDatabaseManager.shared.scheduleSave()
         
-        if let timedoutPredictionBlock = self.cancelTimedoutPredictionBlock {
-            timedoutPredictionBlock.cancel()
-            self.cancelTimedoutPredictionBlock = nil
+        let minimumTimeNeeded = Double(PredictionAggregator.minimumSampleCountForSuccess) * PredictionAggregator.sampleOffsetTimeInterval + self.routeRecorder.randomForestManager.desiredSessionDuration
+        let savedSensorTime = max(0, minimumTimeNeeded - Date().timeIntervalSince(sessionStartDate))
+        
+        UserDefaults.standard.set(self.stationaryGateShortCircuitCount + 1, forKey: "StationaryGateShortCircuitCount")
+        UserDefaults.standard.set(self.stationaryGateSavedSensorTime + savedSensorTime, forKey: "StationaryGateSavedSensorTime")
+        DDLogInfo(String(format: "Stationary gate ended prediction early, saving %.1fs", savedSensorTime))
+        
+        return true
+    }
+    
+    // A window the session's executor cut and classified.
+    private func finishPredictionIfPossible(window: PredictionSession.Window, predictionAggregator: PredictionAggregator)->Bool {
+        guard let prediction = predictionAggregator.currentPrediction else {
+            return false
         }
         
-        if (self.backgroundTaskID != UIBackgroundTaskIdentifier.invalid) {
-            DDLogInfo("Ending background task with Stop Motion Updates!")
-            
-            UIApplication.shared.endBackgroundTask(self.backgroundTaskID)
-            self.backgroundTaskID = UIBackgroundTaskIdentifier.invalid
+        prediction.spectralFeatures = window.spectralFeatures
+        for predictedActivity in window.predictedActivities ?? [] {
+            _ = PredictedActivity(activityType: predictedActivity.activityType, confidence: predictedActivity.confidence, prediction: prediction)
         }
+        
+        return self.finishPredictionOrStartNext(prediction, predictionAggregator: predictionAggregator)
     }
     
-    
-    
+    // For a classifier that reads persisted readings rather than windows.
     private func runPredictionsAndFinishIfPossible(predictionAggregator: PredictionAggregator)->Bool {
         guard let prediction = predictionAggregator.currentPrediction else {
             return false
         }
         
-        guard let firstReadingDate = predictionAggregator.fetchFirstReading(afterDate: prediction.startDate)?.date, let lastReadingDate = predictionAggregator.fetchLastReading()?.date else {
+        let desiredSessionDuration = self.routeRecorder.randomForestManager.desiredSessionDuration
+        guard let firstReadingDate = predictionAggregator.firstReadingDate(onOrAfter: prediction.startDate), let lastReadingDate = predictionAggregator.lastReadingDate,
+            lastReadingDate.timeIntervalSince(firstReadingDate as Date) >= desiredSessionDuration else {
             return false
         }
         
-        if lastReadingDate.timeIntervalSince(firstReadingDate as Date) >= self.routeRecorder.randomForestManager.desiredSessionDuration {
+        let spectralFeatureExtractor = self.spectralFeatureExtractor ?? SpectralFeatureExtractor(sampleRate: SensorClassificationManager.modelSampleRate, windowDuration: desiredSessionDuration)
+        self.spectralFeatureExtractor = spectralFeatureExtractor
+        
+        // the trace's features and the forest share one fetch
+        let readings = prediction.fetchAccelerometerReadings(timeInterval: desiredSessionDuration)
+        prediction.spectralFeatures = spectralFeatureExtractor.features(forReadings: readings)
+        prediction.withReadingsInHand(readings) {
             self.routeRecorder.randomForestManager.classify(prediction)
-            predictionAggregator.updateAggregatePredictedActivity()
+        }
+        
+        return self.finishPredictionOrStartNext(prediction, predictionAggregator: predictionAggregator)
+    }
+    
+    private func finishPredictionOrStartNext(_ prediction: Prediction, predictionAggregator: PredictionAggregator)->Bool {
+        predictionAggregator.addToAggregatePredictedActivity(prediction)
+        
+        if predictionAggregator.aggregatePredictionIsComplete() {
+            predictionAggregator.currentPrediction = nil
+            predictionAggregator.finishAggregatePredictedActivity()
             
-            if predictionAggregator.aggregatePredictionIsComplete() {
-                predictionAggregator.currentPrediction = nil
-                
-                return true // caller will call stopMotionUpdates after it has a chance to call the handler
-            } else {
-                // start a new prediction and keep going
-                let newPrediction = Prediction()
-                newPrediction.startDate = prediction.startDate.addingTimeInterval(PredictionAggregator.sampleOffsetTimeInterval)
-                newPrediction.predictionAggregator = predictionAggregator
-                
-                predictionAggregator.currentPrediction = newPrediction
-                RouteRecorderDatabaseManager.shared.saveContext()
-            }
+            return true // the session calls the handler once it has finished
+        } else {
+            // start a new prediction and keep going. The session has already moved its next window along by the same offset.
+            let newPrediction = Prediction()
+            newPrediction.startDate = prediction.startDate.addingTimeInterval(PredictionAggregator.sampleOffsetTimeInterval)
+            newPrediction.predictionAggregator = predictionAggregator
+            
+            predictionAggregator.currentPrediction = newPrediction
+            RouteRecorderDatabaseManager.shared.scheduleSave()
         }
         
         return false
     }
     
+    private func feedingPredictionSessions()->[PredictionSession] {
+        self.predictionSessionsLock.lock()
+        defer { self.predictionSessionsLock.unlock() }
+        return self.predictionSessions
+    }
+    
+    private func setPredictionSessions(_ sessions: [PredictionSession]) {
+        self.predictionSessionsLock.lock()
+        self.predictionSessions = sessions
+        self.predictionSessionsLock.unlock()
+    }
+    
+    // sampleRate is the accelerometer rate to run motion updates at, if this is the first session; timeout defaults
+    // to the longest a prediction could take.
+    private func beginPredictionSession(predictionAggregator: PredictionAggregator, sampleRate inputSampleRate: Double, timeout: TimeInterval?)->PredictionSession {
+        let concurrentWindowClassifier = self.concurrentWindowClassifier
+        let persistsReadings = self.persistsAccelerometerReadings || concurrentWindowClassifier == nil
+        
+        var windowSchedule: (startDate: Date, duration: TimeInterval, offset: TimeInterval)? = nil
+        if let prediction = predictionAggregator.currentPrediction, concurrentWindowClassifier != nil {
+            windowSchedule = (startDate: prediction.startDate, duration: self.routeRecorder.randomForestManager.desiredSessionDuration, offset: PredictionAggregator.sampleOffsetTimeInterval)
+        }
+        
+        let sampleRate = SensorClassificationManager.modelSampleRate
+        let session = PredictionSession(predictionAggregator: predictionAggregator, sampleRate: sampleRate, persistBatchDuration: SensorClassificationManager.accelerometerPersistenceBatchDuration, windowSchedule: windowSchedule, windowClassifier: concurrentWindowClassifier)
+        UserDefaults.standard.set(self.stationaryGateEvaluationCount + 1, forKey: "StationaryGateEvaluationCount")
+        
+        // registered first, so motion updates stop before the caller hears about the session finishing
+        session.onFinish { (session) in
+            self.setPredictionSessions(self.predictionSessions.filter { $0 !== session })
+            if self.predictionSessions.isEmpty {
+                self.stopMotionUpdates()
+            }
+            
+            let statistics = session.executor.statistics
+            DDLogVerbose(String(format: "Classification executor: %d jobs, %.1fms mean wait, %.1fms longest wait, %.1fms mean run, %d turned away", statistics.completedJobCount, statistics.meanQueueLatency * 1000, statistics.maximumQueueLatency * 1000, statistics.meanRunTime * 1000, statistics.rejectedJobCount))
+        }
+        
+        let maximumTimeNeeded = Double(PredictionAggregator.maximumSampleBeforeFailure - 1) * PredictionAggregator.sampleOffsetTimeInterval + Double(PredictionAggregator.maximumSampleBeforeFailure) * self.routeRecorder.randomForestManager.desiredSessionDuration
+        let maximumTimeout = maximumTimeNeeded + 2 // plus a generous buffer
+        
+        session.start(timeout: min(timeout ?? maximumTimeout, maximumTimeout), remainingSamplesHandler: { (samples) in
+            self.persistAccelerometerSamples(samples, referenceDate: session.referenceDate, predictionAggregator: predictionAggregator, persistsReadings: persistsReadings)
+        }, updateHandler: { (session, update) -> Bool in
+            guard let startDate = session.startDate else {
+                return false
+            }
+            
+            if let estimate = update.cadenceEstimate {
+                predictionAggregator.cadenceEstimates.append(estimate)
+            }
+            
+            if update.isStationary {
+                // confident enough to skip feature extraction and the forest entirely
+                return self.finishStationaryPrediction(predictionAggregator: predictionAggregator, sessionStartDate: startDate)
+            }
+            
+            let didPersist = self.persistAccelerometerSamples(update.samples, referenceDate: session.referenceDate, predictionAggregator: predictionAggregator, persistsReadings: persistsReadings)
+            
+            if windowSchedule == nil {
+                // the classifier reads persisted readings, so there's nothing new for it until a batch lands
+                return didPersist && self.runPredictionsAndFinishIfPossible(predictionAggregator: predictionAggregator)
+            }
+            
+            for window in update.windows {
+                if self.finishPredictionIfPossible(window: window, predictionAggregator: predictionAggregator) {
+                    return true
+                }
+            }
+            
+            return false
+        })
+        
+        let isFirstSession = self.predictionSessions.isEmpty
+        self.setPredictionSessions(self.predictionSessions + [session])
+        if isFirstSession {
+            self.beginMotionUpdates(sampleRate: inputSampleRate)
+        }
+        
+        return session
+    }
     
-    private func beginMotionUpdates(predictionAggregator: PredictionAggregator, withHandler handler:@escaping (_: PredictionAggregator) -> Void) {
+    private func beginMotionUpdates(sampleRate: Double) {
+        self.routeRecorder.motionManager.accelerometerUpdateInterval = 1/sampleRate
+        let resampler = AccelerometerResampler(inputSampleRate: sampleRate, outputSampleRate: SensorClassificationManager.modelSampleRate)
+        
         self.routeRecorder.motionManager.startAccelerometerUpdates(to: self.motionQueue) { (motion, error) in
             guard error == nil else {
-                DDLogInfo("Error reading accelerometer data! Ending early…")
-                predictionAggregator.currentPrediction = nil
-                
-                predictionAggregator.addUnknownTypePrediction()
-                handler(predictionAggregator)
-                self.stopMotionUpdates()
+                DispatchQueue.main.async {
+                    DDLogInfo("Error reading accelerometer data! Ending early…")
+                    for session in self.predictionSessions {
+                        session.fail()
+                    }
+                }
                 
                 return
             }
@@ -227,16 +625,14 @@ public class SensorClassificationManager : ClassificationManager {
                 return
             }
             
-            DispatchQueue.main.async {
-                let reading = self.accelerometerReading(forAccelerometerData: accelerometerData, predictionAggregator: predictionAggregator)
-                reading.predictionAggregator = predictionAggregator
-                
-                RouteRecorderDatabaseManager.shared.saveContext()
-                
-                if self.runPredictionsAndFinishIfPossible(predictionAggregator: predictionAggregator) {
-                    handler(predictionAggregator)
-                    self.stopMotionUpdates()
-                }
+            let accelerations = resampler.resample(accelerometerData)
+            guard accelerations.count > 0 else {
+                return
+            }
+            
+            // everything past resampling happens on the classification executor
+            for session in self.feedingPredictionSessions() {
+                session.feed(accelerations)
             }
         }
     }
@@ -211,6 +211,10 @@ enum CpuFeatures {
 #      define CV_FMA3 1
 #    endif
 #  endif
+#  if defined __AVX512F__
+#    include <immintrin.h>
+#    define CV_AVX_512F 1
+#  endif
 #endif
 
 #if (defined WIN32 || defined _WIN32) && defined(_M_ARM)
@@ -302,6 +302,16 @@ template <typename T> struct V_SIMD128Traits
 
 #endif
 
+// wide float types, when the whole translation unit is built for the instruction set. Runtime-dispatched
+// code includes these headers directly under a target pragma instead.
+#if CV_AVX2
+#include "opencv2/core/hal/intrin_avx.hpp"
+#endif
+
+#if CV_AVX_512F
+#include "opencv2/core/hal/intrin_avx512.hpp"
+#endif
+
 //! @addtogroup core_hal_intrin
 //! @{
 
@@ -315,6 +325,16 @@ template <typename T> struct V_SIMD128Traits
 #define CV_SIMD128_64F 0
 #endif
 
+#ifndef CV_SIMD256
+//! Set to 1 if native 256-bit float vectors (v_float32x8) are available
+#define CV_SIMD256 0
+#endif
+
+#ifndef CV_SIMD512
+//! Set to 1 if native 512-bit float vectors (v_float32x16) are available
+#define CV_SIMD512 0
+#endif
+
 //! @}
 
 #endif
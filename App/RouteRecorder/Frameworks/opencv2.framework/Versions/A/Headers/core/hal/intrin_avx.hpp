@@ -0,0 +1,204 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                          License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Copyright (C) 2013, OpenCV Foundation, all rights reserved.
+// Copyright (C) 2015, Itseez Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+// 256-bit float extension of the universal intrinsics, added for the RouteRecorder batch kernels.
+// The API follows the 128-bit types: v256_load/v256_setall_f32 construct, everything else is overloaded
+// on v_float32x8. Translation units compiled without AVX2 can still include this header after enabling
+// the instruction set with a target pragma, see RouteRecorder/Native/VectorKernels_avx2.cpp.
+
+#ifndef __OPENCV_HAL_AVX_HPP__
+#define __OPENCV_HAL_AVX_HPP__
+
+#include <immintrin.h>
+
+#undef CV_SIMD256
+#define CV_SIMD256 1
+
+namespace cv
+{
+
+//! @cond IGNORED
+
+struct v_float32x8
+{
+    typedef float lane_type;
+    enum { nlanes = 8 };
+
+    v_float32x8() {}
+    explicit v_float32x8(__m256 v) : val(v) {}
+    v_float32x8(float v0, float v1, float v2, float v3, float v4, float v5, float v6, float v7)
+    {
+        val = _mm256_setr_ps(v0, v1, v2, v3, v4, v5, v6, v7);
+    }
+    float get0() const
+    {
+        return _mm_cvtss_f32(_mm256_castps256_ps128(val));
+    }
+    __m256 val;
+};
+
+inline v_float32x8 v256_setzero_f32() { return v_float32x8(_mm256_setzero_ps()); }
+inline v_float32x8 v256_setall_f32(float v) { return v_float32x8(_mm256_set1_ps(v)); }
+
+inline v_float32x8 v256_load(const float* ptr) { return v_float32x8(_mm256_loadu_ps(ptr)); }
+inline v_float32x8 v256_load_aligned(const float* ptr) { return v_float32x8(_mm256_load_ps(ptr)); }
+inline void v_store(float* ptr, const v_float32x8& a) { _mm256_storeu_ps(ptr, a.val); }
+inline void v_store_aligned(float* ptr, const v_float32x8& a) { _mm256_store_ps(ptr, a.val); }
+
+#define OPENCV_HAL_IMPL_AVX_BIN_OP(bin_op, _Tpvec, intrin) \
+    inline _Tpvec operator bin_op (const _Tpvec& a, const _Tpvec& b) \
+    { \
+        return _Tpvec(intrin(a.val, b.val)); \
+    } \
+    inline _Tpvec& operator bin_op##= (_Tpvec& a, const _Tpvec& b) \
+    { \
+        a.val = intrin(a.val, b.val); \
+        return a; \
+    }
+
+OPENCV_HAL_IMPL_AVX_BIN_OP(+, v_float32x8, _mm256_add_ps)
+OPENCV_HAL_IMPL_AVX_BIN_OP(-, v_float32x8, _mm256_sub_ps)
+OPENCV_HAL_IMPL_AVX_BIN_OP(*, v_float32x8, _mm256_mul_ps)
+OPENCV_HAL_IMPL_AVX_BIN_OP(/, v_float32x8, _mm256_div_ps)
+OPENCV_HAL_IMPL_AVX_BIN_OP(&, v_float32x8, _mm256_and_ps)
+OPENCV_HAL_IMPL_AVX_BIN_OP(|, v_float32x8, _mm256_or_ps)
+OPENCV_HAL_IMPL_AVX_BIN_OP(^, v_float32x8, _mm256_xor_ps)
+
+inline v_float32x8 operator ~ (const v_float32x8& a)
+{
+    return v_float32x8(_mm256_xor_ps(a.val, _mm256_castsi256_ps(_mm256_set1_epi32(-1))));
+}
+
+#define OPENCV_HAL_IMPL_AVX_CMP_OP(cmp_op, predicate) \
+    inline v_float32x8 operator cmp_op (const v_float32x8& a, const v_float32x8& b) \
+    { \
+        return v_float32x8(_mm256_cmp_ps(a.val, b.val, predicate)); \
+    }
+
+OPENCV_HAL_IMPL_AVX_CMP_OP(==, _CMP_EQ_OQ)
+OPENCV_HAL_IMPL_AVX_CMP_OP(!=, _CMP_NEQ_UQ)
+OPENCV_HAL_IMPL_AVX_CMP_OP(<, _CMP_LT_OQ)
+OPENCV_HAL_IMPL_AVX_CMP_OP(<=, _CMP_LE_OQ)
+OPENCV_HAL_IMPL_AVX_CMP_OP(>, _CMP_GT_OQ)
+OPENCV_HAL_IMPL_AVX_CMP_OP(>=, _CMP_GE_OQ)
+
+inline v_float32x8 v_min(const v_float32x8& a, const v_float32x8& b) { return v_float32x8(_mm256_min_ps(a.val, b.val)); }
+inline v_float32x8 v_max(const v_float32x8& a, const v_float32x8& b) { return v_float32x8(_mm256_max_ps(a.val, b.val)); }
+inline v_float32x8 v_sqrt(const v_float32x8& x) { return v_float32x8(_mm256_sqrt_ps(x.val)); }
+
+inline v_float32x8 v_invsqrt(const v_float32x8& x)
+{
+    const __m256 _0_5 = _mm256_set1_ps(0.5f), _1_5 = _mm256_set1_ps(1.5f);
+    __m256 t = x.val;
+    __m256 h = _mm256_mul_ps(t, _0_5);
+    t = _mm256_rsqrt_ps(t);
+    t = _mm256_mul_ps(t, _mm256_sub_ps(_1_5, _mm256_mul_ps(_mm256_mul_ps(t, t), h)));
+    return v_float32x8(t);
+}
+
+inline v_float32x8 v_abs(const v_float32x8& x)
+{
+    return v_float32x8(_mm256_and_ps(x.val, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff))));
+}
+
+// a * b + c, fused when the target has FMA3
+inline v_float32x8 v_fma(const v_float32x8& a, const v_float32x8& b, const v_float32x8& c)
+{
+#if defined __FMA__ || CV_FMA3
+    return v_float32x8(_mm256_fmadd_ps(a.val, b.val, c.val));
+#else
+    return v_float32x8(_mm256_add_ps(_mm256_mul_ps(a.val, b.val), c.val));
+#endif
+}
+
+inline v_float32x8 v_muladd(const v_float32x8& a, const v_float32x8& b, const v_float32x8& c)
+{
+    return v_fma(a, b, c);
+}
+
+inline v_float32x8 v_magnitude(const v_float32x8& a, const v_float32x8& b)
+{
+    return v_sqrt(v_fma(a, a, b * b));
+}
+
+inline v_float32x8 v_sqr_magnitude(const v_float32x8& a, const v_float32x8& b)
+{
+    return v_fma(a, a, b * b);
+}
+
+// lanes of mask are all ones or all zeros, as produced by the comparison operators
+inline v_float32x8 v_select(const v_float32x8& mask, const v_float32x8& a, const v_float32x8& b)
+{
+    return v_float32x8(_mm256_blendv_ps(b.val, a.val, mask.val));
+}
+
+inline float v_reduce_sum(const v_float32x8& a)
+{
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(a.val), _mm256_extractf128_ps(a.val, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+#define OPENCV_HAL_IMPL_AVX_REDUCE_OP(func, intrin) \
+    inline float v_reduce_##func(const v_float32x8& a) \
+    { \
+        __m128 s = intrin(_mm256_castps256_ps128(a.val), _mm256_extractf128_ps(a.val, 1)); \
+        s = intrin(s, _mm_movehl_ps(s, s)); \
+        s = intrin(s, _mm_shuffle_ps(s, s, 1)); \
+        return _mm_cvtss_f32(s); \
+    }
+
+OPENCV_HAL_IMPL_AVX_REDUCE_OP(min, _mm_min_ps)
+OPENCV_HAL_IMPL_AVX_REDUCE_OP(max, _mm_max_ps)
+
+inline int v_signmask(const v_float32x8& a) { return _mm256_movemask_ps(a.val); }
+inline bool v_check_all(const v_float32x8& a) { return _mm256_movemask_ps(a.val) == 0xff; }
+inline bool v_check_any(const v_float32x8& a) { return _mm256_movemask_ps(a.val) != 0; }
+
+//! @endcond
+
+}
+
+#endif
@@ -0,0 +1,197 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                          License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Copyright (C) 2013, OpenCV Foundation, all rights reserved.
+// Copyright (C) 2015, Itseez Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+// 512-bit float extension of the universal intrinsics, added for the RouteRecorder batch kernels.
+// Only AVX-512F is required. Comparisons return an all-ones/all-zeros vector like the narrower types
+// rather than a k-mask, so kernels can be written once for every width.
+
+#ifndef __OPENCV_HAL_AVX512_HPP__
+#define __OPENCV_HAL_AVX512_HPP__
+
+#include <immintrin.h>
+
+#undef CV_SIMD512
+#define CV_SIMD512 1
+
+namespace cv
+{
+
+//! @cond IGNORED
+
+struct v_float32x16
+{
+    typedef float lane_type;
+    enum { nlanes = 16 };
+
+    v_float32x16() {}
+    explicit v_float32x16(__m512 v) : val(v) {}
+    float get0() const
+    {
+        return _mm_cvtss_f32(_mm512_castps512_ps128(val));
+    }
+    __m512 val;
+};
+
+inline v_float32x16 v512_setzero_f32() { return v_float32x16(_mm512_setzero_ps()); }
+inline v_float32x16 v512_setall_f32(float v) { return v_float32x16(_mm512_set1_ps(v)); }
+
+inline v_float32x16 v512_load(const float* ptr) { return v_float32x16(_mm512_loadu_ps(ptr)); }
+inline v_float32x16 v512_load_aligned(const float* ptr) { return v_float32x16(_mm512_load_ps(ptr)); }
+inline void v_store(float* ptr, const v_float32x16& a) { _mm512_storeu_ps(ptr, a.val); }
+inline void v_store_aligned(float* ptr, const v_float32x16& a) { _mm512_store_ps(ptr, a.val); }
+
+#define OPENCV_HAL_IMPL_AVX512_BIN_OP(bin_op, intrin) \
+    inline v_float32x16 operator bin_op (const v_float32x16& a, const v_float32x16& b) \
+    { \
+        return v_float32x16(intrin(a.val, b.val)); \
+    } \
+    inline v_float32x16& operator bin_op##= (v_float32x16& a, const v_float32x16& b) \
+    { \
+        a.val = intrin(a.val, b.val); \
+        return a; \
+    }
+
+OPENCV_HAL_IMPL_AVX512_BIN_OP(+, _mm512_add_ps)
+OPENCV_HAL_IMPL_AVX512_BIN_OP(-, _mm512_sub_ps)
+OPENCV_HAL_IMPL_AVX512_BIN_OP(*, _mm512_mul_ps)
+OPENCV_HAL_IMPL_AVX512_BIN_OP(/, _mm512_div_ps)
+
+// float bitwise ops are AVX-512DQ, so go through the integer domain
+#define OPENCV_HAL_IMPL_AVX512_LOGIC_OP(bin_op, intrin) \
+    inline v_float32x16 operator bin_op (const v_float32x16& a, const v_float32x16& b) \
+    { \
+        return v_float32x16(_mm512_castsi512_ps(intrin(_mm512_castps_si512(a.val), _mm512_castps_si512(b.val)))); \
+    } \
+    inline v_float32x16& operator bin_op##= (v_float32x16& a, const v_float32x16& b) \
+    { \
+        a = a bin_op b; \
+        return a; \
+    }
+
+OPENCV_HAL_IMPL_AVX512_LOGIC_OP(&, _mm512_and_si512)
+OPENCV_HAL_IMPL_AVX512_LOGIC_OP(|, _mm512_or_si512)
+OPENCV_HAL_IMPL_AVX512_LOGIC_OP(^, _mm512_xor_si512)
+
+inline v_float32x16 operator ~ (const v_float32x16& a)
+{
+    return v_float32x16(_mm512_castsi512_ps(_mm512_xor_si512(_mm512_castps_si512(a.val), _mm512_set1_epi32(-1))));
+}
+
+#define OPENCV_HAL_IMPL_AVX512_CMP_OP(cmp_op, predicate) \
+    inline v_float32x16 operator cmp_op (const v_float32x16& a, const v_float32x16& b) \
+    { \
+        __mmask16 k = _mm512_cmp_ps_mask(a.val, b.val, predicate); \
+        return v_float32x16(_mm512_castsi512_ps(_mm512_maskz_set1_epi32(k, -1))); \
+    }
+
+OPENCV_HAL_IMPL_AVX512_CMP_OP(==, _CMP_EQ_OQ)
+OPENCV_HAL_IMPL_AVX512_CMP_OP(!=, _CMP_NEQ_UQ)
+OPENCV_HAL_IMPL_AVX512_CMP_OP(<, _CMP_LT_OQ)
+OPENCV_HAL_IMPL_AVX512_CMP_OP(<=, _CMP_LE_OQ)
+OPENCV_HAL_IMPL_AVX512_CMP_OP(>, _CMP_GT_OQ)
+OPENCV_HAL_IMPL_AVX512_CMP_OP(>=, _CMP_GE_OQ)
+
+inline v_float32x16 v_min(const v_float32x16& a, const v_float32x16& b) { return v_float32x16(_mm512_min_ps(a.val, b.val)); }
+inline v_float32x16 v_max(const v_float32x16& a, const v_float32x16& b) { return v_float32x16(_mm512_max_ps(a.val, b.val)); }
+inline v_float32x16 v_sqrt(const v_float32x16& x) { return v_float32x16(_mm512_sqrt_ps(x.val)); }
+
+inline v_float32x16 v_invsqrt(const v_float32x16& x)
+{
+    const __m512 _0_5 = _mm512_set1_ps(0.5f), _1_5 = _mm512_set1_ps(1.5f);
+    __m512 t = x.val;
+    __m512 h = _mm512_mul_ps(t, _0_5);
+    t = _mm512_rsqrt14_ps(t);
+    t = _mm512_mul_ps(t, _mm512_sub_ps(_1_5, _mm512_mul_ps(_mm512_mul_ps(t, t), h)));
+    return v_float32x16(t);
+}
+
+inline v_float32x16 v_abs(const v_float32x16& x)
+{
+    return v_float32x16(_mm512_castsi512_ps(_mm512_and_si512(_mm512_castps_si512(x.val), _mm512_set1_epi32(0x7fffffff))));
+}
+
+inline v_float32x16 v_fma(const v_float32x16& a, const v_float32x16& b, const v_float32x16& c)
+{
+    return v_float32x16(_mm512_fmadd_ps(a.val, b.val, c.val));
+}
+
+inline v_float32x16 v_muladd(const v_float32x16& a, const v_float32x16& b, const v_float32x16& c)
+{
+    return v_fma(a, b, c);
+}
+
+inline v_float32x16 v_magnitude(const v_float32x16& a, const v_float32x16& b)
+{
+    return v_sqrt(v_fma(a, a, b * b));
+}
+
+inline v_float32x16 v_sqr_magnitude(const v_float32x16& a, const v_float32x16& b)
+{
+    return v_fma(a, a, b * b);
+}
+
+inline __mmask16 v512_mask(const v_float32x16& a)
+{
+    // a lane is set if its sign bit is, which covers the all-ones masks from the comparisons
+    return _mm512_cmplt_epi32_mask(_mm512_castps_si512(a.val), _mm512_setzero_si512());
+}
+
+inline v_float32x16 v_select(const v_float32x16& mask, const v_float32x16& a, const v_float32x16& b)
+{
+    return v_float32x16(_mm512_mask_blend_ps(v512_mask(mask), b.val, a.val));
+}
+
+inline float v_reduce_sum(const v_float32x16& a) { return _mm512_reduce_add_ps(a.val); }
+inline float v_reduce_min(const v_float32x16& a) { return _mm512_reduce_min_ps(a.val); }
+inline float v_reduce_max(const v_float32x16& a) { return _mm512_reduce_max_ps(a.val); }
+
+inline int v_signmask(const v_float32x16& a) { return (int)v512_mask(a); }
+inline bool v_check_all(const v_float32x16& a) { return v512_mask(a) == 0xffff; }
+inline bool v_check_any(const v_float32x16& a) { return v512_mask(a) != 0; }
+
+//! @endcond
+
+}
+
+#endif
@@ -370,6 +370,10 @@ typedef v_reg<double, 2> v_float64x2;
 typedef v_reg<uint64, 2> v_uint64x2;
 /** @brief Two 64-bit signed integer values */
 typedef v_reg<int64, 2> v_int64x2;
+/** @brief Eight 32-bit floating point values, emulated where there is no native 256-bit type */
+typedef v_reg<float, 8> v_float32x8;
+/** @brief Sixteen 32-bit floating point values, emulated where there is no native 512-bit type */
+typedef v_reg<float, 16> v_float32x16;
 
 //! @brief Helper macro
 //! @ingroup core_hal_intrin_impl
@@ -757,6 +761,16 @@ inline v_reg<_Tp, n> v_muladd(const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b,
     return d;
 }
 
+/** @brief Fused multiply and add
+
+Same as v_muladd, named to match the 256 and 512-bit types. */
+template<typename _Tp, int n>
+inline v_reg<_Tp, n> v_fma(const v_reg<_Tp, n>& a, const v_reg<_Tp, n>& b,
+                           const v_reg<_Tp, n>& c)
+{
+    return v_muladd(a, b, c);
+}
+
 /** @brief Dot product of elements
 
 Multiply values in two registers and sum adjacent result pairs.
@@ -1506,6 +1520,19 @@ OPENCV_HAL_IMPL_C_INIT_VAL(v_uint64x2, uint64, u64)
 OPENCV_HAL_IMPL_C_INIT_VAL(v_int64x2, int64, s64)
 //! @}
 
+//! @name Wide float vectors
+//! @{
+//! @brief Same constructors as the native 256 and 512-bit headers, so wide kernels build everywhere
+inline v_float32x8 v256_setzero_f32() { return v_float32x8::zero(); }
+inline v_float32x8 v256_setall_f32(float val) { return v_float32x8::all(val); }
+inline v_float32x8 v256_load(const float* ptr) { return v_float32x8(ptr); }
+inline v_float32x8 v256_load_aligned(const float* ptr) { return v_float32x8(ptr); }
+inline v_float32x16 v512_setzero_f32() { return v_float32x16::zero(); }
+inline v_float32x16 v512_setall_f32(float val) { return v_float32x16::all(val); }
+inline v_float32x16 v512_load(const float* ptr) { return v_float32x16(ptr); }
+inline v_float32x16 v512_load_aligned(const float* ptr) { return v_float32x16(ptr); }
+//! @}
+
 //! @brief Helper macro
 //! @ingroup core_hal_intrin_impl
 #define OPENCV_HAL_IMPL_C_REINTERPRET(_Tpvec, _Tp, suffix) \
@@ -0,0 +1,99 @@
+//
+//  GroupCommitScheduler.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+import CocoaLumberjack
+
+public struct GroupCommitMetrics {
+    public internal(set) var commitCount = 0
+    public internal(set) var recordCount = 0 // records enqueued by the commits so far
+    public internal(set) var maximumBatchSize = 0
+    public internal(set) var totalCommitDuration: TimeInterval = 0 // time spent inside the commit itself
+    public internal(set) var maximumCommitDuration: TimeInterval = 0
+    public internal(set) var maximumFlushLatency: TimeInterval = 0 // from the oldest enqueued record to its commit
+
+    public var averageBatchSize: Double {
+        return self.commitCount > 0 ? Double(self.recordCount) / Double(self.commitCount) : 0
+    }
+}
+
+// Coalesces many small writes into one commit. Writers enqueue records as they make changes, and the changes are
+// committed once maximumBatchSize records are pending or maximumLatency after the first of them, whichever comes
+// first. flush() is a durability barrier: it commits everything pending before it returns.
+// Not thread safe; use it from the queue the commit has to run on.
+class GroupCommitScheduler {
+    let maximumLatency: TimeInterval
+    let maximumBatchSize: Int
+
+    private(set) var metrics = GroupCommitMetrics()
+
+    private let queue: DispatchQueue
+    private let commit: ()->Bool // returns false if there was nothing to commit
+    private var pendingRecordCount = 0
+    private var oldestPendingUptime: TimeInterval?
+    private var flushWorkItem: DispatchWorkItem?
+
+    init(maximumLatency: TimeInterval, maximumBatchSize: Int, queue: DispatchQueue = DispatchQueue.main, commit: @escaping ()->Bool) {
+        self.maximumLatency = maximumLatency
+        self.maximumBatchSize = maximumBatchSize
+        self.queue = queue
+        self.commit = commit
+    }
+
+    var pendingCount: Int {
+        return self.pendingRecordCount
+    }
+
+    func enqueue(recordCount: Int = 1) {
+        self.pendingRecordCount += recordCount
+        if self.oldestPendingUptime == nil {
+            self.oldestPendingUptime = ProcessInfo.processInfo.systemUptime
+        }
+
+        if self.pendingRecordCount >= self.maximumBatchSize {
+            self.flush()
+        } else if self.flushWorkItem == nil {
+            let flushWorkItem = DispatchWorkItem { [weak self] in
+                self?.flushWorkItem = nil
+                self?.flush()
+            }
+            self.flushWorkItem = flushWorkItem
+            self.queue.asyncAfter(deadline: .now() + self.maximumLatency, execute: flushWorkItem)
+        }
+    }
+
+    func flush() {
+        if let flushWorkItem = self.flushWorkItem {
+            flushWorkItem.cancel()
+            self.flushWorkItem = nil
+        }
+
+        let start = ProcessInfo.processInfo.systemUptime
+        guard self.commit() else {
+            self.pendingRecordCount = 0
+            self.oldestPendingUptime = nil
+            return
+        }
+        let end = ProcessInfo.processInfo.systemUptime
+
+        // changes made without enqueueing (barrier-only writers) still count as a batch of one
+        let batchSize = max(1, self.pendingRecordCount)
+        self.metrics.commitCount += 1
+        self.metrics.recordCount += batchSize
+        self.metrics.maximumBatchSize = max(self.metrics.maximumBatchSize, batchSize)
+        self.metrics.totalCommitDuration += end - start
+        self.metrics.maximumCommitDuration = max(self.metrics.maximumCommitDuration, end - start)
+        self.metrics.maximumFlushLatency = max(self.metrics.maximumFlushLatency, end - (self.oldestPendingUptime ?? start))
+
+        self.pendingRecordCount = 0
+        self.oldestPendingUptime = nil
+    }
+
+    func logMetrics() {
+        DDLogInfo(String(format: "Group commit: %d commits, %.1f records per commit (max %d), %.1fms average commit, %.1fms max flush latency", self.metrics.commitCount, self.metrics.averageBatchSize, self.metrics.maximumBatchSize, self.metrics.commitCount > 0 ? 1000 * self.metrics.totalCommitDuration / Double(self.metrics.commitCount) : 0, 1000 * self.metrics.maximumFlushLatency))
+    }
+}
@@ -4,24 +4,40 @@ import Gzip
 public struct GZipEncoding: ParameterEncoding {
     public static var `default`: GZipEncoding { return GZipEncoding() }
     
+    public static func gzippedBody(with parameters: Parameters) throws -> Data {
+        do {
+            let data = try JSONSerialization.data(withJSONObject: parameters, options: [])
+            return try data.gzipped()
+        } catch {
+            throw AFError.parameterEncodingFailed(reason: .jsonEncodingFailed(error: error))
+        }
+    }
+    
     public func encode(_ urlRequest: URLRequestConvertible, with parameters: Parameters?) throws -> URLRequest {
         var urlRequest = try urlRequest.asURLRequest()
         
         guard let parameters = parameters else { return urlRequest }
         
-        do {
-            let data = try JSONSerialization.data(withJSONObject: parameters, options: [])
-            let gzipedData = try data.gzipped()
-            
-            urlRequest.httpBody = gzipedData
+        urlRequest.httpBody = try GZipEncoding.gzippedBody(with: parameters)
+        urlRequest.setValue("gzip", forHTTPHeaderField: "Content-Encoding")
+        
+        return urlRequest
+    }
+}
 
-            if urlRequest.httpBody != nil {
-                urlRequest.setValue("gzip", forHTTPHeaderField: "Content-Encoding")
-            }
-            
-        } catch {
-            throw AFError.parameterEncodingFailed(reason: .jsonEncodingFailed(error: error))
-        }
+// Sends a body that was already made by GZipEncoding.gzippedBody(with:), ignoring the request's parameters.
+public struct GZippedBodyEncoding: ParameterEncoding {
+    public let body: Data
+    
+    public init(body: Data) {
+        self.body = body
+    }
+    
+    public func encode(_ urlRequest: URLRequestConvertible, with parameters: Parameters?) throws -> URLRequest {
+        var urlRequest = try urlRequest.asURLRequest()
+        
+        urlRequest.httpBody = self.body
+        urlRequest.setValue("gzip", forHTTPHeaderField: "Content-Encoding")
         
         return urlRequest
     }
@@ -21,11 +21,30 @@ public class AccelerometerReading : NSManagedObject {
     }
     
     convenience init(accelerometerData: CMAccelerometerData) {
+        self.init(acceleration: accelerometerData.acceleration)
+    }
+    
+    convenience init(acceleration: CMAcceleration) {
         let context = RouteRecorderDatabaseManager.shared.currentManagedObjectContext()
         self.init(entity: NSEntityDescription.entity(forEntityName: "AccelerometerReading", in: context)!, insertInto: context)
         
-        self.x = accelerometerData.acceleration.x
-        self.y = accelerometerData.acceleration.y
-        self.z = accelerometerData.acceleration.z
+        self.x = acceleration.x
+        self.y = acceleration.y
+        self.z = acceleration.z
+    }
+    
+    // A reading outside of any context, for handing a sample to the classifier without persisting it.
+    convenience init(detachedSample sample: AccelerometerSample, date: Date) {
+        self.init(entity: RouteRecorderDatabaseManager.shared.managedObjectModel.entitiesByName["AccelerometerReading"]!, insertInto: nil)
+        
+        self.update(withDetachedSample: sample, date: date)
+    }
+    
+    // Reuses a detached reading for another sample.
+    func update(withDetachedSample sample: AccelerometerSample, date: Date) {
+        self.date = date
+        self.x = Double(sample.x)
+        self.y = Double(sample.y)
+        self.z = Double(sample.z)
     }
 }
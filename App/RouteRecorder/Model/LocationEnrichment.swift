@@ -0,0 +1,109 @@
+//
+//  LocationEnrichment.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+import CocoaLumberjack
+
+// A route's location fix with what the other sensors were reading at the time.
+public struct LocationEnrichment {
+    public let location: Location
+    public let heartRate: Double? // beats per minute
+    public let motionIntensity: Double? // mean deviation of the acceleration magnitude from 1g, in g's
+}
+
+// Aligns a route's fixes with heart rate samples and the raw accelerometer store in a single streaming pass, reading
+// the accelerometer a block at a time so a multi-hour ride at 50Hz never has to be in memory at once.
+class LocationEnricher {
+    static let heartRateTolerance: TimeInterval = 60 // watches sample every few seconds in a workout, much less otherwise
+    static let motionIntensityWindow: TimeInterval = 1 // either side of the fix
+    static let accelerometerBlockDuration: TimeInterval = 10 * 60
+    static let readBatchSize = 512
+
+    private enum Stream: Int32 {
+        case heartRate = 0
+        case motionIntensity
+    }
+
+    private var join: OpaquePointer!
+    private let sensorStore: RawSensorStore?
+
+    init(sensorStore: RawSensorStore? = RawSensorStore.shared) {
+        self.sensorStore = sensorStore
+        self.join = createTimeSeriesJoin(2)
+        timeSeriesJoinConfigureStream(self.join, Stream.heartRate.rawValue, TimeSeriesJoinMethodLinear, LocationEnricher.heartRateTolerance)
+        timeSeriesJoinConfigureStream(self.join, Stream.motionIntensity.rawValue, TimeSeriesJoinMethodMean, LocationEnricher.motionIntensityWindow)
+    }
+
+    deinit {
+        deleteTimeSeriesJoin(self.join)
+    }
+
+    // Heart rates may be in any order. Locations must be in date order.
+    func enrich(_ locations: [Location], heartRates: [(date: Date, beatsPerMinute: Double)])->[LocationEnrichment] {
+        guard let firstLocation = locations.first, let lastLocation = locations.last else {
+            return []
+        }
+
+        var enrichments: [LocationEnrichment] = []
+        enrichments.reserveCapacity(locations.count)
+
+        var times = [Double](repeating: 0, count: LocationEnricher.readBatchSize)
+        var values = [Float](repeating: 0, count: LocationEnricher.readBatchSize * 2)
+        let readRows = {
+            while true {
+                let rowCount = Int(timeSeriesJoinRead(self.join, &times, &values, Int32(LocationEnricher.readBatchSize)))
+                if rowCount == 0 {
+                    break
+                }
+                for row in 0..<rowCount {
+                    let heartRate = values[2 * row + Int(Stream.heartRate.rawValue)]
+                    let motionIntensity = values[2 * row + Int(Stream.motionIntensity.rawValue)]
+                    enrichments.append(LocationEnrichment(location: locations[enrichments.count],
+                                                          heartRate: heartRate.isNaN ? nil : Double(heartRate),
+                                                          motionIntensity: motionIntensity.isNaN ? nil : Double(motionIntensity)))
+                }
+            }
+        }
+
+        // keys go in first, so the join can drop accelerometer samples as soon as the fixes around them are read
+        guard timeSeriesJoinAppendKeys(self.join, locations.map { $0.date.timeIntervalSinceReferenceDate }, Int32(locations.count)) else {
+            DDLogWarn("Locations out of order when enriching route!")
+            return []
+        }
+
+        let sortedHeartRates = heartRates.sorted { $0.date < $1.date }
+        timeSeriesJoinAppendSamples(self.join, Stream.heartRate.rawValue, sortedHeartRates.map { $0.date.timeIntervalSinceReferenceDate }, sortedHeartRates.map { Float($0.beatsPerMinute) }, Int32(sortedHeartRates.count))
+        timeSeriesJoinFinishStream(self.join, Stream.heartRate.rawValue)
+
+        if let store = self.sensorStore {
+            var blockStartDate = firstLocation.date.addingTimeInterval(-LocationEnricher.motionIntensityWindow)
+            let endDate = lastLocation.date.addingTimeInterval(LocationEnricher.motionIntensityWindow)
+            while blockStartDate < endDate {
+                let blockEndDate = min(blockStartDate.addingTimeInterval(LocationEnricher.accelerometerBlockDuration), endDate)
+                let records = store.accelerometerRecords(from: blockStartDate, to: blockEndDate)
+                let intensities = records.map { abs(sqrt($0.x * $0.x + $0.y * $0.y + $0.z * $0.z) - 1) }
+                if !timeSeriesJoinAppendSamples(self.join, Stream.motionIntensity.rawValue, records.map { $0.t }, intensities, Int32(records.count)) {
+                    DDLogWarn("Accelerometer samples out of order when enriching route!")
+                }
+                readRows()
+
+                blockStartDate = blockEndDate
+            }
+        }
+        timeSeriesJoinFinishStream(self.join, Stream.motionIntensity.rawValue)
+        readRows()
+
+        return enrichments
+    }
+}
+
+extension Route {
+    // Every fix with the heart rate and motion intensity around it.
+    public func enrichedLocations(heartRates: [(date: Date, beatsPerMinute: Double)])->[LocationEnrichment] {
+        return LocationEnricher().enrich(self.fetchOrderedLocations(includingInferred: false), heartRates: heartRates)
+    }
+}
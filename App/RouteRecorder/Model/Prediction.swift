@@ -12,28 +12,53 @@ import CoreMotion
 import CocoaLumberjack
 
 public class Prediction: NSManagedObject {    
+    internal var spectralFeatures: [SpectralFeatures]?
+    
+    // handed to the classifier in place of a fetch, while classifying readings that are already in hand
+    private var readingsInHand: [AccelerometerReading]?
+    
+    // a detached prediction's class confidences, since it can't make PredictedActivity objects
+    private(set) var detachedClassConfidences: [Int: Float]?
+    
     convenience init() {
         let context = RouteRecorderDatabaseManager.shared.currentManagedObjectContext()
         self.init(entity: NSEntityDescription.entity(forEntityName: "Prediction", in: context)!, insertInto: context)
         self.startDate = Date()
     }
     
+    // A prediction outside of any context, which can be classified off the main queue.
+    convenience init(detachedWithStartDate startDate: Date) {
+        self.init(entity: RouteRecorderDatabaseManager.shared.managedObjectModel.entitiesByName["Prediction"]!, insertInto: nil)
+        self.startDate = startDate
+    }
+    
+    // Calls classify with fetchAccelerometerReadings answering from readings instead of Core Data.
+    func withReadingsInHand(_ readings: [AccelerometerReading], classify: ()->Void) {
+        self.readingsInHand = readings
+        classify()
+        self.readingsInHand = nil
+    }
+    
     public func addUnknownTypePredictedActivity() {
         _ = PredictedActivity(activityType: .unknown, confidence: 1.0, prediction: self)
     }
     
     public func fetchAccelerometerReadings(timeInterval: TimeInterval)-> [AccelerometerReading] {
+        if let readings = self.readingsInHand {
+            return readings
+        }
+        
         guard let predictionAggregator = self.predictionAggregator else {
             return []
         }
         
-        guard let firstReading = predictionAggregator.fetchFirstReading(afterDate: self.startDate) else {
+        guard let firstReadingDate = predictionAggregator.firstReadingDate(onOrAfter: self.startDate) else {
             return []
         }
         
         let context = RouteRecorderDatabaseManager.shared.currentManagedObjectContext()
         let fetchedRequest = NSFetchRequest<NSFetchRequestResult>(entityName: "AccelerometerReading")
-        fetchedRequest.predicate = NSPredicate(format: "predictionAggregator = %@ AND date >= %@ AND date <= %@", predictionAggregator, firstReading.date as CVarArg, firstReading.date.addingTimeInterval(timeInterval + 0.1) as CVarArg) // padd an extra 0.1
+        fetchedRequest.predicate = NSPredicate(format: "predictionAggregator = %@ AND date >= %@ AND date <= %@", predictionAggregator, firstReadingDate as CVarArg, firstReadingDate.addingTimeInterval(timeInterval + 0.1) as CVarArg) // padd an extra 0.1
         fetchedRequest.sortDescriptors = [NSSortDescriptor(key: "date", ascending: true)]
         
         let results: [AnyObject]?
@@ -89,6 +114,20 @@ public class Prediction: NSManagedObject {
         
         dict["predictedActivities"] = predictionsArray
         
+        if let spectralFeatures = self.spectralFeatures {
+            var featuresArray : [Any] = []
+            for f in spectralFeatures {
+                featuresArray.append([
+                    "power": f.power,
+                    "bandEnergies": [f.bandEnergies.0, f.bandEnergies.1, f.bandEnergies.2, f.bandEnergies.3],
+                    "centroid": f.centroid,
+                    "entropy": f.entropy,
+                    "flatness": f.flatness
+                ])
+            }
+            dict["spectralFeatures"] = featuresArray // x, y, z, magnitude
+        }
+        
         return dict
     }
     
@@ -97,6 +136,11 @@ public class Prediction: NSManagedObject {
     }
     
     func setPredictedActivities(forClassConfidences classConfidences:[Int: Float]) {
+        guard self.managedObjectContext != nil else {
+            self.detachedClassConfidences = classConfidences
+            return
+        }
+        
         self.predictedActivities = Set<PredictedActivity>()
 
         for (classInt, confidence) in classConfidences {
@@ -17,7 +17,26 @@ public class PredictionAggregator : NSManagedObject {
     public static let sampleOffsetTimeInterval: TimeInterval = 0.25
     public static let minimumSampleCountForSuccess = 8
     public static let maximumSampleBeforeFailure = 15
-    internal var referenceBootDate: Date!
+    static var stoppingRuleKind = PredictionStoppingRule.Kind.sequential
+    
+    // A strong, steady cadence that fits the predicted mode lets a confident walking, running or cycling prediction
+    // finish with fewer samples
+    public static let minimumSampleCountForCadenceSuccess = 3
+    public static let minimumCadenceConfidence: Float = 0.6
+    public static let minimumCadenceEstimateCount = 3
+    public static let maximumCadencePeriodVariation: Float = 0.1
+    
+    // the period CadenceDetector reports for each mode, in seconds: a step, or a single pedal stroke
+    public static let cadencePeriodRanges: [ActivityType: ClosedRange<Float>] = [
+        .walking: 0.45...0.8, // 75 to 130 steps a minute
+        .running: 0.25...0.45, // 130 to 240 steps a minute
+        .cycling: 0.27...0.55 // 55 to 110 rpm
+    ]
+    
+    internal var cadenceEstimates: [CadenceEstimate] = []
+    internal var readingTimeIndex = ReadingTimeIndex() // dates of the readings persisted by the sensor pipeline
+    internal var voteAccumulator: ActivityVoteAccumulator? // votes of the predictions classified this session
+    internal var stoppingRule: PredictionStoppingRule?
 
     convenience init() {
         let context = RouteRecorderDatabaseManager.shared.currentManagedObjectContext()
@@ -95,6 +114,24 @@ public class PredictionAggregator : NSManagedObject {
         return reading
     }
     
+    // Window boundaries are looked up on every sample, so they're answered from the in-memory index whenever it has
+    // this aggregator's readings. Aggregators loaded back from the store fall back to fetching.
+    public func firstReadingDate(onOrAfter date: Date)-> Date? {
+        if !self.readingTimeIndex.isEmpty {
+            return self.readingTimeIndex.firstDate(onOrAfter: date)
+        }
+        
+        return self.fetchFirstReading(afterDate: date)?.date
+    }
+    
+    public var lastReadingDate: Date? {
+        if let date = self.readingTimeIndex.lastDate {
+            return date
+        }
+        
+        return self.fetchLastReading()?.date
+    }
+    
     public func fetchFirstPrediction()-> Prediction? {
         let context = RouteRecorderDatabaseManager.shared.currentManagedObjectContext()
         let fetchedRequest = NSFetchRequest<NSFetchRequestResult>(entityName: "Prediction")
@@ -123,46 +160,100 @@ public class PredictionAggregator : NSManagedObject {
         prediction.addUnknownTypePredictedActivity()
     }
     
-    func updateAggregatePredictedActivity() {
-        var activityClassTopConfidenceVotes : [ActivityType: Float] = [:]
-        for prediction in self.predictions {
-            for predictedActivity in prediction.predictedActivities {
-                let currentVote = activityClassTopConfidenceVotes[predictedActivity.activityType] ?? 0
-                activityClassTopConfidenceVotes[predictedActivity.activityType] = currentVote + predictedActivity.confidence
-            }
+    // Stands in for a session that was skipped because a recent confident result still holds.
+    func addStandingPrediction(activityType: ActivityType, confidence: Float) {
+        let prediction = Prediction()
+        prediction.predictionAggregator = self
+        _ = PredictedActivity(activityType: activityType, confidence: confidence, prediction: prediction)
+        
+        self.aggregatePredictedActivity = PredictedActivity(activityType: activityType, confidence: confidence, prediction: nil)
+        RouteRecorderDatabaseManager.shared.scheduleSave()
+    }
+    
+    // Adds a newly classified prediction to the running aggregate and the stopping rule. The aggregate is only written
+    // back to the store by finishAggregatePredictedActivity(), once the session is over.
+    func addToAggregatePredictedActivity(_ prediction: Prediction) {
+        if let voteAccumulator = self.voteAccumulator, let stoppingRule = self.stoppingRule {
+            voteAccumulator.add(prediction)
+            stoppingRule.add(prediction)
+            return
         }
         
-        let predictedActivity = PredictedActivity()
-
-        var topVote: Float = 0
-        for (activityType, vote) in activityClassTopConfidenceVotes {
-            if vote > topVote {
-                predictedActivity.activityType = activityType
-                predictedActivity.confidence = vote / Float(self.predictions.count)
-                topVote = vote
-            }
+        // an aggregator loaded back from the store picks up the predictions it already has
+        let voteAccumulator = ActivityVoteAccumulator()
+        let stoppingRule = PredictionStoppingRule(kind: PredictionAggregator.stoppingRuleKind)
+        for existingPrediction in self.predictions.filter({ $0 != prediction }).sorted(by: { $0.startDate < $1.startDate }) + [prediction] {
+            voteAccumulator.add(existingPrediction)
+            stoppingRule.add(existingPrediction)
+        }
+        self.voteAccumulator = voteAccumulator
+        self.stoppingRule = stoppingRule
+    }
+    
+    public var currentAggregateActivityType: ActivityType? {
+        guard let voteAccumulator = self.voteAccumulator, voteAccumulator.predictionCount > 0 else {
+            return self.aggregatePredictedActivity?.activityType
         }
         
-        self.aggregatePredictedActivity = predictedActivity
-        RouteRecorderDatabaseManager.shared.saveContext()
+        return voteAccumulator.activityType
     }
     
-    func aggregatePredictionIsComplete()->Bool {
-        if predictions.count <= PredictionAggregator.minimumSampleCountForSuccess {
-            return false
+    public var currentAggregateConfidence: Float? {
+        guard let voteAccumulator = self.voteAccumulator, voteAccumulator.predictionCount > 0 else {
+            return self.aggregatePredictedActivity?.confidence
+        }
+        
+        return voteAccumulator.confidence
+    }
+    
+    func finishAggregatePredictedActivity() {
+        guard let voteAccumulator = self.voteAccumulator, voteAccumulator.predictionCount > 0 else {
+            return
         }
         
-        if let predictedActivity = self.aggregatePredictedActivity {
-            if predictedActivity.confidence > PredictionAggregator.highConfidence {
-                return true
+        if let stoppingRule = self.stoppingRule, stoppingRule.decision == PredictionStoppingDecisionDecided {
+            // the rule picks the type, but the confidence stays the mean vote, which is what highConfidence is tuned to
+            self.aggregatePredictedActivity = PredictedActivity(activityType: stoppingRule.activityType, confidence: voteAccumulator.confidence(of: stoppingRule.activityType), prediction: nil)
+        } else {
+            self.aggregatePredictedActivity = PredictedActivity(activityType: voteAccumulator.activityType, confidence: voteAccumulator.confidence, prediction: nil)
+        }
+        RouteRecorderDatabaseManager.shared.scheduleSave()
+    }
+    
+    // The period of the last few cadence estimates, if they agree and are all strongly periodic.
+    func steadyCadencePeriod()->Float? {
+        guard self.cadenceEstimates.count >= PredictionAggregator.minimumCadenceEstimateCount else {
+            return nil
+        }
+        
+        let recentEstimates = self.cadenceEstimates.suffix(PredictionAggregator.minimumCadenceEstimateCount)
+        guard let period = recentEstimates.last?.period, period > 0 else {
+            return nil
+        }
+        
+        for estimate in recentEstimates {
+            if estimate.confidence < PredictionAggregator.minimumCadenceConfidence || abs(estimate.period - period) > PredictionAggregator.maximumCadencePeriodVariation * period {
+                return nil
             }
         }
         
-        if predictions.count >= PredictionAggregator.maximumSampleBeforeFailure {
+        return period
+    }
+    
+    func aggregatePredictionIsComplete()->Bool {
+        if predictions.count > PredictionAggregator.minimumSampleCountForCadenceSuccess, let activityType = self.currentAggregateActivityType,
+            let confidence = self.currentAggregateConfidence, confidence >= PredictionAggregator.highConfidence,
+            let periodRange = PredictionAggregator.cadencePeriodRanges[activityType], let period = self.steadyCadencePeriod(), periodRange.contains(period) {
+            // walking vs cycling is the confusion that otherwise runs us out to maximumSampleBeforeFailure, so the
+            // cadence has to back up the predicted mode rather than just be steady
             return true
         }
         
-        return false
+        guard let stoppingRule = self.stoppingRule else {
+            return false
+        }
+        
+        return stoppingRule.decision != PredictionStoppingDecisionContinue
     }
     
     
@@ -189,6 +280,10 @@ public class PredictionAggregator : NSManagedObject {
             dict["aggregatePredictedActivity"] = aggregatePredictedActivity.jsonDictionary()
         }
         
+        if let cadenceEstimate = self.cadenceEstimates.last {
+            dict["cadence"] = ["period": cadenceEstimate.period, "confidence": cadenceEstimate.confidence]
+        }
+        
         var locsArray : [Any] = []
         
         if let route = self.route {
@@ -201,4 +296,13 @@ public class PredictionAggregator : NSManagedObject {
 
         return dict
     }
+    
+    // The same session as jsonDictionary(), as a binary sensor trace.
+    @discardableResult public func writeSensorTrace(to fileURL: URL)->Bool {
+        guard let writer = SensorTraceWriter(fileURL: fileURL) else {
+            return false
+        }
+        
+        return writer.append(self) && writer.finish()
+    }
 }
@@ -0,0 +1,79 @@
+//
+//  ReadingTimeIndex.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+
+// Append-only, in-memory index of reading dates, so window boundaries can be found without a sorted fetch.
+// Dates normally arrive in increasing order, which is how the sensor pipeline produces them; a late one is inserted
+// in place, and duplicates are kept, so answers match the sorted fetch they replace.
+struct ReadingTimeIndex {
+    private var timeIntervals: [TimeInterval] = [] // since the reference date, to keep comparisons cheap
+
+    var count: Int {
+        return self.timeIntervals.count
+    }
+
+    var isEmpty: Bool {
+        return self.timeIntervals.isEmpty
+    }
+
+    var firstDate: Date? {
+        guard let timeInterval = self.timeIntervals.first else {
+            return nil
+        }
+
+        return Date(timeIntervalSinceReferenceDate: timeInterval)
+    }
+
+    var lastDate: Date? {
+        guard let timeInterval = self.timeIntervals.last else {
+            return nil
+        }
+
+        return Date(timeIntervalSinceReferenceDate: timeInterval)
+    }
+
+    mutating func append(_ date: Date) {
+        let timeInterval = date.timeIntervalSinceReferenceDate
+        if let last = self.timeIntervals.last, timeInterval < last {
+            self.timeIntervals.insert(timeInterval, at: self.lowerBound(timeInterval))
+            return
+        }
+
+        self.timeIntervals.append(timeInterval)
+    }
+
+    mutating func reserveCapacity(_ minimumCapacity: Int) {
+        self.timeIntervals.reserveCapacity(minimumCapacity)
+    }
+
+    // The first indexed date on or after date.
+    func firstDate(onOrAfter date: Date)->Date? {
+        let index = self.lowerBound(date.timeIntervalSinceReferenceDate)
+        guard index < self.timeIntervals.count else {
+            return nil
+        }
+
+        return Date(timeIntervalSinceReferenceDate: self.timeIntervals[index])
+    }
+
+    private func lowerBound(_ timeInterval: TimeInterval)->Int {
+        var first = 0
+        var last = self.timeIntervals.count
+
+        while first < last {
+            let middle = first + (last - first) / 2
+            if self.timeIntervals[middle] < timeInterval {
+                first = middle + 1
+            } else {
+                last = middle
+            }
+        }
+
+        return first
+    }
+}
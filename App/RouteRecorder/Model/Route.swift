@@ -31,6 +31,14 @@ public class  Route: NSManagedObject {
     
     var lastLocationUpdateCount : Int = 0
     private var lastInProgressLocation : Location? = nil
+    private var cachedLocationColumns : RouteLocationColumns? = nil
+    private var activitySegmenter : ActivitySegmenter? = nil
+    private var isActivitySegmentationLive = false // fed everything since the route opened in this process
+    private var streamingSimplifier : StreamingRouteSimplifier? = nil
+    private var isSimplificationLive = false // likewise
+    private var liveSimplificationKeptCount = 0 // locations kept outright rather than appended to the streaming simplifier
+    private(set) var wasSimplifiedLive = false // whether the last simplification could finish the live one
+    public private(set) var activitySegments : [RouteActivitySegment] = []
     
     convenience init() {
         let context = RouteRecorderDatabaseManager.shared.currentManagedObjectContext()
@@ -79,6 +87,26 @@ public class  Route: NSManagedObject {
         return results! as! [Route]
     }
     
+    // Routes left open by a crash or a relaunch, with their location counts. Once the route journal is complete this is a
+    // lookup per journaled route instead of a scan of every route and its locations.
+    class func recoverOpenRoutes() -> [(route: Route, locationCount: Int)] {
+        guard let journal = RouteJournal.shared, journal.isComplete else {
+            return Route.openRoutes().map { (route: $0, locationCount: $0.locationCount()) }
+        }
+        
+        var routes: [(route: Route, locationCount: Int)] = []
+        for openRoute in journal.openRoutes {
+            if let route = Route.findRoute(withUUID: openRoute.uuid), !route.isClosed {
+                routes.append((route, openRoute.locationCount))
+            } else {
+                // never saved, or since deleted
+                journal.recordCancel(routeUUID: openRoute.uuid)
+            }
+        }
+        
+        return routes
+    }
+    
     class func nextClosedUnuploadedRoute() -> Route? {
         let context = RouteRecorderDatabaseManager.shared.currentManagedObjectContext()
         let fetchedRequest = NSFetchRequest<NSFetchRequestResult>(entityName: "Route")
@@ -165,6 +193,15 @@ public class  Route: NSManagedObject {
         }
     }
     
+    override public func prepareForDeletion() {
+        super.prepareForDeletion()
+        
+        self.cachedLocationColumns = nil
+        if let uuid = self.uuid {
+            RouteLocationColumns.remove(routeUUID: uuid)
+        }
+    }
+    
     func loadFromJSON(JSON: JSON) {
         if let activityTypeInteger = JSON["activityType"].int16 {
             self.activityTypeInteger = activityTypeInteger
@@ -191,6 +228,18 @@ public class  Route: NSManagedObject {
         return 0
     }
     
+    func uninferredLocationCount() -> Int {
+        let context = RouteRecorderDatabaseManager.shared.currentManagedObjectContext()
+        let fetchedRequest = NSFetchRequest<NSFetchRequestResult>(entityName: "Location")
+        fetchedRequest.predicate = NSPredicate(format: "route == %@ AND NOT (sourceInteger IN %@)", self, LocationSource.inferredSources.map { $0.rawValue })
+        
+        if let count = try? context.count(for: fetchedRequest) {
+            return count
+        }
+        
+        return 0
+    }
+    
     public func fetchLocations()->[Location] {
         return self.fetchOrderedLocations(simplified: false, includingInferred: true)
     }
@@ -262,6 +311,7 @@ public class  Route: NSManagedObject {
     
     func cancel() {
         let uuidToDelete: String = self.uuid
+        RouteJournal.shared?.recordCancel(routeUUID: uuidToDelete)
         RouteRecorderDatabaseManager.shared.currentManagedObjectContext().delete(self)
         RouteRecorderDatabaseManager.shared.saveContext()
         
@@ -284,21 +334,178 @@ public class  Route: NSManagedObject {
         }
         
         var length : CLLocationDistance = 0
-        var lastLocation : CLLocation! = nil
-        
-        for location in self.usableLocationsForSimplification() {
-            let cllocation = location.clLocation()
-            if (lastLocation == nil) {
-                lastLocation = cllocation
-                continue
+        var lastLocation : CLLocation? = nil
+        let addLocation = { (cllocation: CLLocation) in
+            if let lastLocation = lastLocation {
+                length += lastLocation.distance(from: cllocation)
             }
-            length += lastLocation!.distance(from: cllocation)
             lastLocation = cllocation
         }
         
+        if let columns = self.currentLocationColumns() {
+            // same filter as usableLocationsForSimplification
+            columns.forEachChunk { (records) in
+                for record in records where record.horizontalAccuracy <= Location.acceptableLocationAccuracy || record.source != LocationSource.activeGPS.rawValue {
+                    addLocation(CLLocation(latitude: record.latitude, longitude: record.longitude))
+                }
+            }
+        } else {
+            for location in self.usableLocationsForSimplification() {
+                addLocation(location.clLocation())
+            }
+        }
+        
         self.length = Float(length)
     }
     
+    //
+    // MARK: Location Columns
+    //
+    
+    func appendToLocationColumns(_ locations: [CLLocation], source: LocationSource) {
+        if self.cachedLocationColumns == nil, let uuid = self.uuid {
+            self.cachedLocationColumns = RouteLocationColumns(routeUUID: uuid)
+        }
+        
+        self.cachedLocationColumns?.append(locations, source: source)
+    }
+    
+    // Locations are also added to routes outside of the GPS path (inferred and copied locations, fetched routes), so
+    // the columns are checked against Core Data before each use and rebuilt from it when they disagree.
+    private func currentLocationColumns()->RouteLocationColumns? {
+        if self.cachedLocationColumns == nil, let uuid = self.uuid {
+            self.cachedLocationColumns = RouteLocationColumns(routeUUID: uuid)
+        }
+        
+        guard let columns = self.cachedLocationColumns else {
+            return nil
+        }
+        
+        if columns.rowCount != self.locationCount() || !columns.isSorted {
+            columns.rebuild(from: self.fetchOrderedLocations(includingInferred: true))
+        }
+        
+        return columns
+    }
+    
+    //
+    // MARK: Simplification
+    //
+    
+    func appendToSimplification(_ locations: [Location]) {
+        guard let simplifier = self.liveRouteSimplifier() else {
+            return
+        }
+        
+        // anything that isn't from active GPS is always kept, and can come in out of date order (aggregated locations
+        // from before the route opened, visits), so it's kept here rather than appended to the streaming simplifier
+        var gpsLocations: [Location] = []
+        for location in locations {
+            if location.source != .activeGPS {
+                location.simplifiedInRoute = self
+                self.liveSimplificationKeptCount += 1
+            } else if location.horizontalAccuracy <= Location.acceptableLocationAccuracy {
+                // same filter as usableLocationsForSimplification
+                gpsLocations.append(location)
+            }
+        }
+        
+        for location in simplifier.append(gpsLocations) {
+            location.simplifiedInRoute = self
+        }
+    }
+    
+    private func liveRouteSimplifier()->StreamingRouteSimplifier? {
+        guard self.isSimplificationLive else {
+            return nil
+        }
+        
+        if self.streamingSimplifier == nil {
+            self.streamingSimplifier = StreamingRouteSimplifier(episilon: simplificationEpisilon, speedEpisilon: simplificationSpeedEpisilon)
+        }
+        
+        return self.streamingSimplifier
+    }
+    
+    //
+    // MARK: Activity Segmentation
+    //
+    
+    func appendToActivitySegmentation(_ locations: [CLLocation]) {
+        self.liveActivitySegmenter()?.add(locations)
+    }
+    
+    private func liveActivitySegmenter()->ActivitySegmenter? {
+        guard self.isActivitySegmentationLive else {
+            return nil
+        }
+        
+        if self.activitySegmenter == nil {
+            // created on first use, once the route has the activity type it was opened with
+            self.activitySegmenter = ActivitySegmenter(initialActivityType: self.activityType)
+        }
+        
+        return self.activitySegmenter
+    }
+    
+    // Feeds a new segmenter the route's stored predictions and fixes in time order.
+    private func replayedActivitySegmenter()->ActivitySegmenter {
+        let segmenter = ActivitySegmenter(initialActivityType: self.activityType)
+        
+        var predictions = self.predictionAggregators.flatMap { $0.predictions }.sorted { $0.startDate < $1.startDate }[...]
+        let addSpeed = { (speed: CLLocationSpeed, date: Date) in
+            while let prediction = predictions.first, prediction.startDate <= date {
+                segmenter.add(prediction)
+                predictions = predictions.dropFirst()
+            }
+            segmenter.add(speed: speed, at: date)
+        }
+        
+        if let columns = self.currentLocationColumns() {
+            let inferredSources = LocationSource.inferredSources.map { $0.rawValue }
+            columns.forEachChunk { (records) in
+                for record in records where !inferredSources.contains(record.source) {
+                    addSpeed(record.speed, Date(timeIntervalSinceReferenceDate: record.t))
+                }
+            }
+        } else {
+            for location in self.fetchOrderedLocations(simplified: false, includingInferred: false) {
+                addSpeed(location.speed, location.date)
+            }
+        }
+        for prediction in predictions {
+            segmenter.add(prediction)
+        }
+        
+        return segmenter
+    }
+    
+    // Sets the route's activity type to the one it spent the most time in, not counting stops.
+    private func finishActivitySegmentation() {
+        let segmenter: ActivitySegmenter
+        if let liveSegmenter = self.liveActivitySegmenter(), liveSegmenter.locationCount == self.uninferredLocationCount() {
+            segmenter = liveSegmenter
+        } else {
+            // reopened, recovered after a relaunch, or given locations some other way, like copying them from a fetched route
+            segmenter = self.replayedActivitySegmenter()
+        }
+        self.activitySegmenter = nil
+        self.isActivitySegmentationLive = false
+        self.activitySegments = segmenter.finish()
+        
+        var durations: [ActivityType: TimeInterval] = [:]
+        for segment in self.activitySegments where segment.activityType != .stationary && segment.activityType != .unknown {
+            durations[segment.activityType] = (durations[segment.activityType] ?? 0) + segment.endDate.timeIntervalSince(segment.startDate)
+        }
+        
+        guard let longest = durations.max(by: { $0.value < $1.value }), longest.value > 0, longest.key != self.activityType else {
+            return
+        }
+        
+        DDLogInfo(String(format: "Re-classifying trip as %@ from its activity segments.", longest.key.emoji))
+        self.activityType = longest.key
+    }
+    
     func saveLocationsAndUpdateLength(intermittently: Bool = true)->Bool {
         let locSize = self.locationCount()
         
@@ -310,11 +517,12 @@ public class  Route: NSManagedObject {
                     let thiscllocation = thisLoc.clLocation()
                     let lastcllocation = lasLoc.clLocation()
 
+                    let newLocationCount = lastLocationUpdateCount == -1 ? locSize : abs(locSize - lastLocationUpdateCount)
                     lastLocationUpdateCount = locSize
                     self.length += Float(lastcllocation.distance(from: thiscllocation))
                     lastInProgressLocation = thisLoc
                     
-                    RouteRecorderDatabaseManager.shared.saveContext()
+                    RouteRecorderDatabaseManager.shared.scheduleSave(recordCount: max(1, newLocationCount))
                     
                     if let delegate = RouteRecorder.shared.delegate {
                         DispatchQueue.main.async(execute: { [weak self] in
@@ -341,13 +549,18 @@ public class  Route: NSManagedObject {
     }
     
     func open() {
+        self.isActivitySegmentationLive = true
+        self.isSimplificationLive = true
+        
         if let lastArrivalLocation = RouteRecorderStore.store().lastArrivalLocation {
             let inferredLoc = Location(lastArrivalLocation: lastArrivalLocation)
             inferredLoc.route = self
+            self.appendToSimplification([inferredLoc])
         } else {
             DDLogInfo("No lastArrivalLocation found")
         }
         
+        RouteJournal.shared?.recordOpen(self, locationCount: self.locationCount())
         
         if let delegate = RouteRecorder.shared.delegate {
             DispatchQueue.main.async(execute: { [weak self] in
@@ -388,6 +601,9 @@ public class  Route: NSManagedObject {
             }
         }
         
+        // too fast for a bike or too slow for a car comes out of the segmentation, so there's no speed check here
+        self.finishActivitySegmentation()
+        
         if let startLoc = self.firstLocation(includeCopied: true), let endLoc = self.mostRecentLocation() {
             let distance = startLoc.clLocation().distance(from: endLoc.clLocation())
             let time = endLoc.date.timeIntervalSince(startLoc.date as Date)
@@ -403,20 +619,7 @@ public class  Route: NSManagedObject {
             }
         }
         
-        let avgSpeed = self.averageMovingSpeed
-        if self.activityType == .cycling && avgSpeed > 11.176 { // 25 mph
-            if self.locationCount() > 20 { // make sure we have enough locations to ensure some confidence in the speed
-                DDLogInfo("Re-classifiying trip as car trip due to high average moving speed.")
-
-                self.activityType = .automotive
-            }
-        }
-        else if self.activityType == .cycling && avgSpeed >= 0 && avgSpeed < 2 {
-            // identify short walking trips that were mistaken for bike trips
-            DDLogInfo("Re-classifiying bike trip as walking trip due to low speed.")
-            self.activityType = .walking
-        }
-        else if self.activityType == .cycling && avgSpeed == -1 {
+        if self.activityType == .cycling && self.averageMovingSpeed == -1 {
             // We were unable to get a gps fix for any locations in the entire trip - if this was a sufficiently short trip, reclassify it as walking
             // We'll use the distance between the endpoints and subtract the horizontal accuracies
             let halfMile = 804.67
@@ -433,6 +636,7 @@ public class  Route: NSManagedObject {
         }
         
         self.calculateLength()
+        self.cachedLocationColumns?.sync()
         
         if self.activityType.isMotorizedMode && self.length < 300.0 {
             DDLogInfo("Tossing motorized route that was too short")
@@ -450,6 +654,8 @@ public class  Route: NSManagedObject {
         self.simplify({
             self.isClosed = true
             self.closedDate = Date()
+            RouteJournal.shared?.recordClose(routeUUID: self.uuid)
+            RouteUploadSpool.shared?.enqueue(self)
             if let delegate = RouteRecorder.shared.delegate {
                 DispatchQueue.main.async(execute: { [weak self] in
                     guard let strongSelf = self else {
@@ -472,12 +678,14 @@ public class  Route: NSManagedObject {
     func reopen() {
         self.isClosed = false
         self.closedDate = nil
+        self.activitySegments = []
         self.lastLocationUpdateCount = -1
         self.isUploaded = false
         self.isSummaryUploaded = false
         self.simplifiedLocations = Set<Location>()
         
         RouteRecorderDatabaseManager.shared.saveContext()
+        RouteJournal.shared?.recordOpen(self, locationCount: self.locationCount())
         
         if let delegate = RouteRecorder.shared.delegate {
             DispatchQueue.main.async(execute: { [weak self] in
@@ -506,10 +714,26 @@ public class  Route: NSManagedObject {
         return closestLocation
     }
     
+    private var usableLocationsForSimplificationPredicate: NSPredicate {
+        return NSPredicate(format: "route == %@ AND (horizontalAccuracy <= %f OR sourceInteger != %i)", self, Location.acceptableLocationAccuracy, LocationSource.activeGPS.rawValue)
+    }
+    
+    private func usableLocationCountForSimplification()->Int {
+        let context = RouteRecorderDatabaseManager.shared.currentManagedObjectContext()
+        let fetchedRequest = NSFetchRequest<NSFetchRequestResult>(entityName: "Location")
+        fetchedRequest.predicate = self.usableLocationsForSimplificationPredicate
+        
+        if let count = try? context.count(for: fetchedRequest) {
+            return count
+        }
+        
+        return 0
+    }
+    
     private func usableLocationsForSimplification()->[Location] {
         let context = RouteRecorderDatabaseManager.shared.currentManagedObjectContext()
         let fetchedRequest = NSFetchRequest<NSFetchRequestResult>(entityName: "Location")
-        fetchedRequest.predicate = NSPredicate(format: "route == %@ AND (horizontalAccuracy <= %f OR sourceInteger != %i)", self, Location.acceptableLocationAccuracy, LocationSource.activeGPS.rawValue)
+        fetchedRequest.predicate = self.usableLocationsForSimplificationPredicate
         fetchedRequest.sortDescriptors = [NSSortDescriptor(key: "date", ascending: true)]
         
         let results: [AnyObject]?
@@ -530,9 +754,31 @@ public class  Route: NSManagedObject {
     public func resimplify() {
         self.simplify()
     }
+    
+    public func compareSimplification()->SimplificationComparison {
+        return StreamingRouteSimplifier.compare(self.usableLocationsForSimplification(), episilon: simplificationEpisilon, speedEpisilon: simplificationSpeedEpisilon)
+    }
     #endif
     
     func simplify(_ handler: ()->Void = {}) {
+        let liveSimplifier = self.liveRouteSimplifier()
+        let liveLocationCount = (liveSimplifier?.locationCount ?? 0) + self.liveSimplificationKeptCount
+        self.streamingSimplifier = nil
+        self.isSimplificationLive = false
+        self.liveSimplificationKeptCount = 0
+        self.wasSimplifiedLive = liveSimplifier != nil && liveLocationCount == self.usableLocationCountForSimplification()
+        
+        if let liveSimplifier = liveSimplifier, self.wasSimplifiedLive {
+            // every usable location went through the live simplifier, so only its lookahead is left to settle
+            for location in liveSimplifier.finish() {
+                location.simplifiedInRoute = self
+            }
+            
+            RouteRecorderDatabaseManager.shared.saveContext()
+            handler()
+            return
+        }
+        
         let accurateOrNonActiveLocs = self.usableLocationsForSimplification()
         
         let currentSimplifiedLocs = self.fetchOrderedLocations(simplified: true, includingInferred: true)
@@ -545,113 +791,16 @@ public class  Route: NSManagedObject {
             return
         }
         
-        self.simplifyLocations(accurateOrNonActiveLocs, episilon: simplificationEpisilon, speedEpisilon: simplificationSpeedEpisilon)
+        let simplifier = RouteSimplifier(episilon: simplificationEpisilon, speedEpisilon: simplificationSpeedEpisilon)
+        simplifier.append(accurateOrNonActiveLocs)
+        for index in simplifier.simplify() {
+            accurateOrNonActiveLocs[index].simplifiedInRoute = self
+        }
         
         RouteRecorderDatabaseManager.shared.saveContext()
         handler()
     }
     
-    // Ramer–Douglas–Peucker geometric simplication algorithm
-    private func simplifyLocations(_ locations: [Location], episilon : CLLocationDegrees, speedEpisilon: CLLocationSpeed) {
-        var maximumDistance : CLLocationDegrees = 0
-        var indexOfMaximumDistance = 0
-        
-        var maximumSpeedDifference : CLLocationSpeed = 0
-        var indexOfMaximumSpeedDifference = 0
-        
-        let startLoc = locations.first
-        let endLoc = locations.last
-        var counter = 1
-        
-        var currentlyStopped = startLoc!.speed >= 0 && startLoc!.speed < Location.minimumMovingSpeed
-        
-        if (locations.count > 2) {
-            for loc in locations[counter...(locations.count - 2)] {
-                let distance = self.shortestDistanceFromLineToPoint(startLoc!.coordinate(), lineEndPoint: endLoc!.coordinate(), point: loc.coordinate())
-                if (distance > maximumDistance) {
-                    indexOfMaximumDistance = counter
-                    maximumDistance = distance
-                }
-                
-                let startSpeed = startLoc!.speed
-                let endSpeed = endLoc!.speed
-                let speedSlope = (endSpeed - startSpeed) / endLoc!.timeIntervalSinceLocation(location: startLoc!)
-                
-                if startSpeed >= 0 && endSpeed >= 0 && loc.speed >= 0 {
-                    let expectedSpeed = startSpeed + speedSlope * loc.timeIntervalSinceLocation(location: startLoc!)
-                    let speedDifference = fabs(expectedSpeed - loc.speed)
-                    if (speedDifference > maximumSpeedDifference) {
-                        indexOfMaximumSpeedDifference = counter
-                        maximumSpeedDifference = speedDifference
-                    } else if (!currentlyStopped && loc.speed < Location.minimumMovingSpeed) {
-                        currentlyStopped = true
-                        indexOfMaximumSpeedDifference = counter
-                        maximumSpeedDifference = Double.greatestFiniteMagnitude
-                    } else if (currentlyStopped && loc.speed >= Location.minimumMovingSpeed) {
-                        currentlyStopped = false
-                        indexOfMaximumSpeedDifference = counter
-                        maximumSpeedDifference = Double.greatestFiniteMagnitude
-                    }
-                }
-                
-                counter += 1
-            }
-        } else {
-            // trivial case: two points are more than episilon distance away.
-            startLoc!.simplifiedInRoute = self
-            endLoc!.simplifiedInRoute = self
-            return
-        }
-        
-        if (maximumDistance > episilon || maximumSpeedDifference > speedEpisilon) {
-            var cutOffIndex = indexOfMaximumSpeedDifference
-            if (maximumDistance > episilon && maximumSpeedDifference < Double.greatestFiniteMagnitude) {
-                // If both conditions are met, we prefer to include points that affect the geometry
-                // – unless the maximumSpeedDifference speed is greatestFiniteMagnitude because the user stopped
-                cutOffIndex = indexOfMaximumDistance
-            }
-            self.simplifyLocations(Array(locations[0...cutOffIndex]), episilon: episilon, speedEpisilon: speedEpisilon)
-            self.simplifyLocations(Array(locations[cutOffIndex...(locations.count - 1)]), episilon: episilon, speedEpisilon: speedEpisilon)
-        } else {
-            startLoc!.simplifiedInRoute = self
-
-            var i = 0
-            for loc in locations {
-                // also include any non-GPS location, plus the first location following it
-                if loc.source != .activeGPS {
-                    if loc.simplifiedInRoute == nil {
-                        loc.simplifiedInRoute = self
-                    }
-                    if (i + 1) < locations.count {
-                        if locations[i + 1].simplifiedInRoute == nil {
-                            locations[i + 1].simplifiedInRoute = self
-                        }
-                    }
-                }
-                i += 1
-            }
-            
-            endLoc!.simplifiedInRoute = self
-        }
-    }
-    
-    private func shortestDistanceFromLineToPoint(_ lineStartPoint: CLLocationCoordinate2D, lineEndPoint: CLLocationCoordinate2D, point: CLLocationCoordinate2D)->CLLocationDegrees {
-        // area of a triangle is given by a = .5 * |Ax(By-Cy) + Bx(Cy-Ay) + Cx(Ay-By)|
-        let part1 = lineStartPoint.longitude * (lineEndPoint.latitude - point.latitude)
-        let part2 = lineEndPoint.longitude * (point.latitude - lineStartPoint.latitude)
-        let part3 = point.longitude * (lineStartPoint.latitude - lineEndPoint.latitude)
-        let area = 0.5 * abs(part1
-                            + part2
-                            + part3)
-        
-        // base of the triangle is the distance from our start to end points
-        let base = sqrt(pow(lineStartPoint.longitude - lineEndPoint.longitude, 2) +
-                            pow(lineStartPoint.latitude - lineEndPoint.latitude, 2))
-        
-        // height = 2* area / base
-        return 2 * area / base
-    }
-    
     func mostRecentLocation() -> Location? {
         let context = RouteRecorderDatabaseManager.shared.currentManagedObjectContext()
         let fetchedRequest = NSFetchRequest<NSFetchRequestResult>(entityName: "Location")
@@ -698,10 +847,19 @@ public class  Route: NSManagedObject {
     
     func addPredictionAggregator(_ predictionAggregator: PredictionAggregator) {
         predictionAggregator.route = self
+        if let segmenter = self.liveActivitySegmenter() {
+            segmenter.add(predictionAggregator)
+            segmenter.add(Array(predictionAggregator.locations))
+        }
         
         for loc in predictionAggregator.locations {
             loc.route = self
         }
+        self.appendToSimplification(Array(predictionAggregator.locations))
+        
+        if let lastLocationDate = predictionAggregator.locations.map({ $0.date }).max() {
+            RouteJournal.shared?.recordLocations(count: predictionAggregator.locations.count, lastLocationDate: lastLocationDate, for: self)
+        }
     }
     
     func firstLocation(includeCopied: Bool) -> Location? {
@@ -749,17 +907,28 @@ public class  Route: NSManagedObject {
     var averageMovingSpeed : CLLocationSpeed {
         var sumSpeed : Double = 0.0
         var count = 0
-        let locs = self.fetchOrderedLocations(simplified: false, includingInferred: false)
         var hasFoundLocWithSpeed = false
-
-        for location in locs {
-            if (location.speed > Location.minimumMovingSpeed) {
+        let addSpeed = { (speed: CLLocationSpeed) in
+            if (speed > Location.minimumMovingSpeed) {
                 count += 1
-                sumSpeed += (location as Location).speed
-            } else if location.speed >= 0 {
+                sumSpeed += speed
+            } else if speed >= 0 {
                 hasFoundLocWithSpeed = true
             }
         }
+
+        if let columns = self.currentLocationColumns() {
+            let inferredSources = LocationSource.inferredSources.map { $0.rawValue }
+            columns.forEachChunk { (records) in
+                for record in records where !inferredSources.contains(record.source) {
+                    addSpeed(record.speed)
+                }
+            }
+        } else {
+            for location in self.fetchOrderedLocations(simplified: false, includingInferred: false) {
+                addSpeed(location.speed)
+            }
+        }
         
         if (count == 0) {
             if hasFoundLocWithSpeed {
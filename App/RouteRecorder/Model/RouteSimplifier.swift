@@ -0,0 +1,183 @@
+//
+//  RouteSimplifier.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+import CoreLocation
+
+extension RouteSimplifierLocation {
+    init(location: Location) {
+        self.init(t: location.date.timeIntervalSinceReferenceDate,
+                  latitude: location.latitude,
+                  longitude: location.longitude,
+                  speed: location.speed,
+                  isActiveGPS: location.source == .activeGPS)
+    }
+}
+
+public struct SimplificationComparison {
+    public let locationCount: Int
+    public let keptCount: Int
+    public let streamingKeptCount: Int
+    public let maximumDistance: CLLocationDegrees // of a dropped location from the line between the kept ones
+    public let streamingMaximumDistance: CLLocationDegrees
+    public let maximumSpeedDifference: CLLocationSpeed
+    public let streamingMaximumSpeedDifference: CLLocationSpeed
+}
+
+// Picks the locations a route is drawn and uploaded with, using Ramer–Douglas–Peucker on both the geometry and the
+// speed. Stops, starts and anything that isn't from active GPS are always kept.
+// Not thread safe.
+class RouteSimplifier {
+    private var simplifier: OpaquePointer!
+    private var locations: [RouteSimplifierLocation] = []
+
+    init(episilon: CLLocationDegrees, speedEpisilon: CLLocationSpeed) {
+        self.simplifier = createRouteSimplifier(episilon, speedEpisilon, Location.minimumMovingSpeed)
+    }
+
+    deinit {
+        deleteRouteSimplifier(self.simplifier)
+    }
+
+    var locationCount: Int {
+        return Int(routeSimplifierLocationCount(self.simplifier))
+    }
+
+    // Locations must be in date order.
+    func append(_ locations: [Location]) {
+        self.locations.removeAll(keepingCapacity: true)
+        for location in locations {
+            self.locations.append(RouteSimplifierLocation(location: location))
+        }
+
+        routeSimplifierAppend(self.simplifier, self.locations, Int32(self.locations.count))
+    }
+
+    func reset() {
+        routeSimplifierReset(self.simplifier)
+    }
+
+    // The indexes, in append order, of the locations to keep.
+    func simplify()->IndexSet {
+        var keptBitmap = [UInt8](repeating: 0, count: (self.locationCount + 7) / 8)
+        routeSimplifierSimplify(self.simplifier, &keptBitmap)
+
+        var keptIndexes = IndexSet()
+        for (byteIndex, byte) in keptBitmap.enumerated() where byte != 0 {
+            for bit in 0..<8 where byte & (1 << UInt8(bit)) != 0 {
+                keptIndexes.insert(byteIndex * 8 + bit)
+            }
+        }
+
+        return keptIndexes
+    }
+
+    // How far off a simplification of everything appended is, given as the indexes it kept.
+    func measureError(keptIndexes: IndexSet)->RouteSimplificationError {
+        var keptBitmap = [UInt8](repeating: 0, count: (self.locationCount + 7) / 8)
+        for index in keptIndexes {
+            keptBitmap[index / 8] |= 1 << UInt8(index % 8)
+        }
+        
+        return routeSimplifierMeasureError(self.simplifier, keptBitmap)
+    }
+}
+
+// Simplifies a route while it's being recorded, settling on the locations to keep as they come in, so that closing
+// the route only has the last couple of minutes left to simplify.
+// Not thread safe.
+class StreamingRouteSimplifier {
+    static let lookaheadCount = 120 // about two minutes of fixes
+
+    private var simplifier: OpaquePointer!
+    private var locations: [RouteSimplifierLocation] = []
+    private var pendingLocations: [Location] = [] // appended but not yet passed over, starting at pendingStartIndex
+    private var pendingStartIndex = 0
+    private var settledIndexes = [Int32](repeating: 0, count: StreamingRouteSimplifier.lookaheadCount + 1)
+
+    init(episilon: CLLocationDegrees, speedEpisilon: CLLocationSpeed) {
+        self.simplifier = createStreamingRouteSimplifier(episilon, speedEpisilon, Location.minimumMovingSpeed, Int32(StreamingRouteSimplifier.lookaheadCount))
+    }
+
+    deinit {
+        deleteRouteSimplifier(self.simplifier)
+    }
+
+    var locationCount: Int {
+        return Int(routeSimplifierLocationCount(self.simplifier))
+    }
+
+    // Locations must be in date order. Returns the ones newly settled on.
+    func append(_ locations: [Location])->[Location] {
+        self.locations.removeAll(keepingCapacity: true)
+        for location in locations {
+            self.locations.append(RouteSimplifierLocation(location: location))
+        }
+        self.pendingLocations.append(contentsOf: locations)
+        
+        routeSimplifierAppend(self.simplifier, self.locations, Int32(self.locations.count))
+        return self.readSettledLocations()
+    }
+
+    // Returns the rest of the locations to keep.
+    func finish()->[Location] {
+        routeSimplifierFinish(self.simplifier)
+        return self.readSettledLocations()
+    }
+
+    // Simplifies locations both whole and streaming, and measures both against the originals.
+    class func compare(_ locations: [Location], episilon: CLLocationDegrees, speedEpisilon: CLLocationSpeed)->SimplificationComparison {
+        let simplifier = RouteSimplifier(episilon: episilon, speedEpisilon: speedEpisilon)
+        simplifier.append(locations)
+        let error = simplifier.measureError(keptIndexes: simplifier.simplify())
+
+        let streamingSimplifier = StreamingRouteSimplifier(episilon: episilon, speedEpisilon: speedEpisilon)
+        var streamingKeptLocations = streamingSimplifier.append(locations)
+        streamingKeptLocations.append(contentsOf: streamingSimplifier.finish())
+
+        var streamingKeptIndexes = IndexSet()
+        var index = 0
+        for location in streamingKeptLocations {
+            while locations[index] !== location {
+                index += 1
+            }
+            streamingKeptIndexes.insert(index)
+        }
+        let streamingError = simplifier.measureError(keptIndexes: streamingKeptIndexes)
+
+        return SimplificationComparison(locationCount: locations.count,
+                                        keptCount: Int(error.keptCount),
+                                        streamingKeptCount: Int(streamingError.keptCount),
+                                        maximumDistance: CLLocationDegrees(error.maximumDistance),
+                                        streamingMaximumDistance: CLLocationDegrees(streamingError.maximumDistance),
+                                        maximumSpeedDifference: CLLocationSpeed(error.maximumSpeedDifference),
+                                        streamingMaximumSpeedDifference: CLLocationSpeed(streamingError.maximumSpeedDifference))
+    }
+
+    private func readSettledLocations()->[Location] {
+        var settledLocations: [Location] = []
+        var lastSettledIndex: Int? = nil
+        while true {
+            let count = Int(routeSimplifierReadSettled(self.simplifier, &self.settledIndexes, Int32(self.settledIndexes.count)))
+            if count == 0 {
+                break
+            }
+            for index in self.settledIndexes[0..<count] {
+                settledLocations.append(self.pendingLocations[Int(index) - self.pendingStartIndex])
+                lastSettledIndex = Int(index)
+            }
+        }
+
+        // nothing before the last location settled on can be settled on now
+        if let lastSettledIndex = lastSettledIndex {
+            self.pendingLocations.removeFirst(lastSettledIndex - self.pendingStartIndex)
+            self.pendingStartIndex = lastSettledIndex
+        }
+
+        return settledLocations
+    }
+}
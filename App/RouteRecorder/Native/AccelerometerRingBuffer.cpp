@@ -0,0 +1,166 @@
+//
+//  AccelerometerRingBuffer.cpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#include "AccelerometerRingBuffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace {
+    // keeps the producer and consumer indices on separate cache lines
+    const int kCacheLineSize = 64;
+}
+
+struct AccelerometerRingBuffer {
+    AccelerometerRingBuffer(int capacity, int maximumSpanCount);
+
+    int write(const AccelerometerSample *samples, int sampleCount);
+    const AccelerometerSample *span(int64_t sequence, int sampleCount) const;
+    int64_t lowerBound(float t) const;
+    void consume(int64_t sequence);
+
+    int64_t capacity;
+    int64_t mask;
+    int maximumSpanCount;
+
+    // capacity + maximumSpanCount slots, the tail mirrors the head
+    std::vector<AccelerometerSample> storage;
+
+    // padded rather than aligned, operator new doesn't honour extended alignment before C++17
+    char padding0[kCacheLineSize];
+    std::atomic<int64_t> writeSequence; // written by the producer only
+    std::atomic<int64_t> droppedCount;
+    char padding1[kCacheLineSize];
+    std::atomic<int64_t> readSequence; // written by the consumer only
+    char padding2[kCacheLineSize];
+};
+
+AccelerometerRingBuffer::AccelerometerRingBuffer(int requestedCapacity, int maximumSpanCount)
+    : maximumSpanCount(maximumSpanCount), writeSequence(0), droppedCount(0), readSequence(0)
+{
+    capacity = 1;
+    while (capacity < requestedCapacity || capacity < maximumSpanCount) {
+        capacity <<= 1;
+    }
+    mask = capacity - 1;
+
+    storage.resize(capacity + maximumSpanCount);
+}
+
+int AccelerometerRingBuffer::write(const AccelerometerSample *samples, int sampleCount)
+{
+    int64_t head = writeSequence.load(std::memory_order_relaxed);
+    int64_t tail = readSequence.load(std::memory_order_acquire);
+
+    int writeCount = (int)std::min<int64_t>(sampleCount, capacity - (head - tail));
+    for (int i = 0; i < writeCount; i++) {
+        int64_t index = (head + i) & mask;
+        storage[index] = samples[i];
+        if (index < maximumSpanCount) {
+            storage[capacity + index] = samples[i];
+        }
+    }
+
+    if (writeCount < sampleCount) {
+        droppedCount.fetch_add(sampleCount - writeCount, std::memory_order_relaxed);
+    }
+
+    // publish the samples only after they (and their mirrors) are in place
+    writeSequence.store(head + writeCount, std::memory_order_release);
+
+    return writeCount;
+}
+
+const AccelerometerSample *AccelerometerRingBuffer::span(int64_t sequence, int sampleCount) const
+{
+    int64_t head = writeSequence.load(std::memory_order_acquire);
+    int64_t tail = readSequence.load(std::memory_order_relaxed);
+
+    if (sampleCount < 0 || sampleCount > maximumSpanCount || sequence < tail || sequence + sampleCount > head) {
+        return NULL;
+    }
+
+    return &storage[sequence & mask];
+}
+
+int64_t AccelerometerRingBuffer::lowerBound(float t) const
+{
+    int64_t first = readSequence.load(std::memory_order_relaxed);
+    int64_t last = writeSequence.load(std::memory_order_acquire);
+
+    while (first < last) {
+        int64_t middle = first + (last - first) / 2;
+        if (storage[middle & mask].t < t) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+
+    return first;
+}
+
+void AccelerometerRingBuffer::consume(int64_t sequence)
+{
+    int64_t head = writeSequence.load(std::memory_order_acquire);
+    int64_t tail = readSequence.load(std::memory_order_relaxed);
+
+    sequence = std::min(sequence, head);
+    if (sequence > tail) {
+        readSequence.store(sequence, std::memory_order_release);
+    }
+}
+
+AccelerometerRingBuffer *createAccelerometerRingBuffer(int capacity, int maximumSpanCount)
+{
+    if (capacity <= 0 || maximumSpanCount < 0) {
+        return NULL;
+    }
+
+    return new AccelerometerRingBuffer(capacity, maximumSpanCount);
+}
+
+void deleteAccelerometerRingBuffer(AccelerometerRingBuffer *ringBuffer)
+{
+    delete ringBuffer;
+}
+
+int accelerometerRingBufferWrite(AccelerometerRingBuffer *ringBuffer, const AccelerometerSample *samples, int sampleCount)
+{
+    return ringBuffer->write(samples, sampleCount);
+}
+
+int64_t accelerometerRingBufferReadSequence(AccelerometerRingBuffer *ringBuffer)
+{
+    return ringBuffer->readSequence.load(std::memory_order_relaxed);
+}
+
+int64_t accelerometerRingBufferWriteSequence(AccelerometerRingBuffer *ringBuffer)
+{
+    return ringBuffer->writeSequence.load(std::memory_order_acquire);
+}
+
+const AccelerometerSample *accelerometerRingBufferSpan(AccelerometerRingBuffer *ringBuffer, int64_t sequence, int sampleCount)
+{
+    return ringBuffer->span(sequence, sampleCount);
+}
+
+int64_t accelerometerRingBufferLowerBound(AccelerometerRingBuffer *ringBuffer, float t)
+{
+    return ringBuffer->lowerBound(t);
+}
+
+void accelerometerRingBufferConsume(AccelerometerRingBuffer *ringBuffer, int64_t sequence)
+{
+    ringBuffer->consume(sequence);
+}
+
+int64_t accelerometerRingBufferDroppedCount(AccelerometerRingBuffer *ringBuffer)
+{
+    return ringBuffer->droppedCount.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,51 @@
+//
+//  AccelerometerRingBuffer.h
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#ifndef AccelerometerRingBuffer_h
+#define AccelerometerRingBuffer_h
+
+#include <stdint.h>
+
+#include "AccelerometerSample.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    // Fixed-capacity, lock-free ring of accelerometer samples for exactly one producer thread (the motion
+    // callback) and one consumer thread. Samples are addressed by sequence number, counting every sample
+    // ever written. The first maximumSpanCount slots are mirrored past the end of the storage, so any run of
+    // up to maximumSpanCount retained samples can be borrowed as one contiguous array without copying.
+    typedef struct AccelerometerRingBuffer AccelerometerRingBuffer;
+
+    // capacity is rounded up to a power of two
+    AccelerometerRingBuffer *createAccelerometerRingBuffer(int capacity, int maximumSpanCount);
+    void deleteAccelerometerRingBuffer(AccelerometerRingBuffer *ringBuffer);
+
+    // Producer. Returns the number of samples written; the rest are dropped (and counted) if the ring is full.
+    int accelerometerRingBufferWrite(AccelerometerRingBuffer *ringBuffer, const AccelerometerSample *samples, int sampleCount);
+
+    // Consumer. The oldest retained sample, and one past the newest published sample.
+    int64_t accelerometerRingBufferReadSequence(AccelerometerRingBuffer *ringBuffer);
+    int64_t accelerometerRingBufferWriteSequence(AccelerometerRingBuffer *ringBuffer);
+
+    // Borrows sampleCount samples starting at sequence, or returns NULL if any of them aren't retained or
+    // sampleCount exceeds maximumSpanCount. The pointer stays valid until the span is consumed.
+    const AccelerometerSample *accelerometerRingBufferSpan(AccelerometerRingBuffer *ringBuffer, int64_t sequence, int sampleCount);
+
+    // The sequence of the first retained sample with a time of at least t, or the write sequence if there
+    // isn't one. Sample times must be increasing.
+    int64_t accelerometerRingBufferLowerBound(AccelerometerRingBuffer *ringBuffer, float t);
+
+    // Releases every sample before sequence back to the producer.
+    void accelerometerRingBufferConsume(AccelerometerRingBuffer *ringBuffer, int64_t sequence);
+
+    int64_t accelerometerRingBufferDroppedCount(AccelerometerRingBuffer *ringBuffer);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AccelerometerRingBuffer_h */
@@ -0,0 +1,26 @@
+//
+//  AccelerometerSample.h
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#ifndef AccelerometerSample_h
+#define AccelerometerSample_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    // A packed accelerometer record shared by the native sensor pipeline.
+    // t is in seconds relative to the start of the sensor session, x/y/z are in g's.
+    typedef struct AccelerometerSample {
+        float t;
+        float x;
+        float y;
+        float z;
+    } AccelerometerSample;
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AccelerometerSample_h */
@@ -0,0 +1,366 @@
+//
+//  ActivitySegmenter.cpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#include "ActivitySegmenter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace {
+    const double minimumProbability = 1e-12;
+    const double tieTolerance = 1e-6;
+
+    struct Observation {
+        float speed;
+        std::vector<float> probabilities; // empty for a speed
+    };
+
+    struct SpeedModel {
+        SpeedModel() : isSet(false), typicalMinimumSpeed(0), maximumSpeed(INFINITY), logSlowProbability(0), logFastProbability(0) {}
+
+        bool isSet;
+        float typicalMinimumSpeed;
+        float maximumSpeed;
+        double logSlowProbability;
+        double logFastProbability;
+    };
+
+    // the part of a step that's still needed once it's been through the transition matrix
+    struct StepRecord {
+        double startTime;
+        double endTime;
+        std::vector<int> previousStates; // best previous state for each state
+    };
+
+    void normalizedLog(const float *probabilities, int count, double *logProbabilities)
+    {
+        double sum = 0;
+        for (int i = 0; i < count; i++) {
+            sum += std::max(probabilities[i], 0.0f);
+        }
+        for (int i = 0; i < count; i++) {
+            double probability = sum > 0 ? std::max(probabilities[i], 0.0f) / sum : 1.0 / count;
+            logProbabilities[i] = std::log(std::max(probability, minimumProbability));
+        }
+    }
+}
+
+struct ActivitySegmenter {
+    ActivitySegmenter(int classCount, double stepDuration, int lagStepCount, double reorderWindow, float switchProbability);
+
+    bool add(double time, const Observation &observation);
+    void release(double time, const Observation &observation);
+    void closeStep();
+    void decide(long step, int state);
+
+    const int classCount;
+    const double stepDuration;
+    const int lagStepCount;
+    const double reorderWindow;
+
+    std::vector<double> logTransitions;
+    std::vector<double> logInitialProbabilities;
+    std::vector<SpeedModel> speedModels;
+    double windowWeight;
+    double logProbabilityFloor;
+
+    std::multimap<double, Observation> heldBack;
+    double newestTime;
+    double releasedTime;
+    bool isFinished;
+
+    // the step being filled
+    bool isStepOpen;
+    double stepOrigin;
+    long stepIndex;
+    double stepStartTime;
+    double stepEndTime;
+    std::vector<double> stepEvidence;
+    double stepSpeedSum;
+    int stepSpeedCount;
+
+    std::vector<double> logDelta;
+    std::vector<double> nextLogDelta;
+    int topState;
+    long stepCount;
+    long decidedStepCount;
+    std::vector<StepRecord> steps; // ring of the last lagStepCount + 1 steps
+
+    bool isSegmentOpen;
+    ActivitySegment openSegment;
+    std::deque<ActivitySegment> segments;
+};
+
+ActivitySegmenter::ActivitySegmenter(int classCount, double stepDuration, int lagStepCount, double reorderWindow, float switchProbability)
+: classCount(classCount), stepDuration(stepDuration > 0 ? stepDuration : 1), lagStepCount(std::max(lagStepCount, 0)), reorderWindow(std::max(reorderWindow, 0.0)),
+logTransitions(classCount * classCount), logInitialProbabilities(classCount, -std::log((double)classCount)), speedModels(classCount),
+windowWeight(1), logProbabilityFloor(std::log(0.01)), newestTime(-INFINITY), releasedTime(-INFINITY), isFinished(false),
+isStepOpen(false), stepOrigin(0), stepIndex(0), stepStartTime(0), stepEndTime(0), stepEvidence(classCount, 0), stepSpeedSum(0), stepSpeedCount(0),
+logDelta(classCount, 0), nextLogDelta(classCount, 0), topState(-1), stepCount(0), decidedStepCount(0), steps(this->lagStepCount + 1), isSegmentOpen(false)
+{
+    std::vector<float> matrix(classCount * classCount);
+    for (int from = 0; from < classCount; from++) {
+        for (int to = 0; to < classCount; to++) {
+            matrix[from * classCount + to] = from == to ? 1 - switchProbability : (classCount > 1 ? switchProbability / (classCount - 1) : 0);
+        }
+    }
+    activitySegmenterSetTransitionMatrix(this, matrix.data());
+
+    for (size_t i = 0; i < steps.size(); i++) {
+        steps[i].previousStates.resize(classCount, 0);
+    }
+}
+
+bool ActivitySegmenter::add(double time, const Observation &observation)
+{
+    if (isFinished || !(time >= releasedTime)) {
+        return false;
+    }
+
+    heldBack.insert(std::make_pair(time, observation));
+    newestTime = std::max(newestTime, time);
+    while (!heldBack.empty() && heldBack.begin()->first <= newestTime - reorderWindow) {
+        release(heldBack.begin()->first, heldBack.begin()->second);
+        heldBack.erase(heldBack.begin());
+    }
+    return true;
+}
+
+void ActivitySegmenter::release(double time, const Observation &observation)
+{
+    releasedTime = time;
+
+    long index = isStepOpen ? (long)std::floor((time - stepOrigin) / stepDuration) : 0;
+    if (!isStepOpen || index > stepIndex) {
+        if (isStepOpen) {
+            closeStep();
+        } else {
+            stepOrigin = time;
+        }
+        isStepOpen = true;
+        stepIndex = index;
+        stepStartTime = time;
+        std::fill(stepEvidence.begin(), stepEvidence.end(), 0.0);
+        stepSpeedSum = 0;
+        stepSpeedCount = 0;
+    }
+    stepEndTime = time;
+
+    if (observation.probabilities.empty()) {
+        stepSpeedSum += observation.speed;
+        stepSpeedCount++;
+    } else {
+        for (int i = 0; i < classCount; i++) {
+            float probability = observation.probabilities[i];
+            stepEvidence[i] += windowWeight * (probability > 0 ? std::max((double)std::log(probability), logProbabilityFloor) : logProbabilityFloor);
+        }
+    }
+}
+
+void ActivitySegmenter::closeStep()
+{
+    if (stepSpeedCount > 0) {
+        float speed = (float)(stepSpeedSum / stepSpeedCount);
+        for (int i = 0; i < classCount; i++) {
+            const SpeedModel &model = speedModels[i];
+            if (!model.isSet) {
+                continue;
+            }
+            if (speed < model.typicalMinimumSpeed) {
+                stepEvidence[i] += model.logSlowProbability;
+            } else if (speed > model.maximumSpeed) {
+                stepEvidence[i] += model.logFastProbability;
+            }
+        }
+    }
+
+    StepRecord &record = steps[stepCount % steps.size()];
+    record.startTime = stepStartTime;
+    record.endTime = stepEndTime;
+
+    if (stepCount == 0) {
+        for (int i = 0; i < classCount; i++) {
+            nextLogDelta[i] = logInitialProbabilities[i] + stepEvidence[i];
+            record.previousStates[i] = i;
+        }
+    } else {
+        // when the evidence can't tell two classes apart, switching at any step in between scores the same, so ties
+        // go to coming from the previous step's best class. That puts the switch at the last step it could be.
+        for (int to = 0; to < classCount; to++) {
+            int bestFrom = topState;
+            double best = logDelta[bestFrom] + logTransitions[bestFrom * classCount + to];
+            for (int from = 0; from < classCount; from++) {
+                double value = logDelta[from] + logTransitions[from * classCount + to];
+                if (value > best + tieTolerance) {
+                    best = value;
+                    bestFrom = from;
+                }
+            }
+            nextLogDelta[to] = best + stepEvidence[to];
+            record.previousStates[to] = bestFrom;
+        }
+    }
+
+    // kept relative to the best state so a long route can't underflow
+    topState = (int)(std::max_element(nextLogDelta.begin(), nextLogDelta.end()) - nextLogDelta.begin());
+    double top = nextLogDelta[topState];
+    for (int i = 0; i < classCount; i++) {
+        logDelta[i] = nextLogDelta[i] - top;
+    }
+    stepCount++;
+
+    if (stepCount > lagStepCount) {
+        long step = stepCount - 1 - lagStepCount;
+        int state = topState;
+        for (long s = stepCount - 1; s > step; s--) {
+            state = steps[s % steps.size()].previousStates[state];
+        }
+        decide(step, state);
+    }
+}
+
+void ActivitySegmenter::decide(long step, int state)
+{
+    const StepRecord &record = steps[step % steps.size()];
+    if (isSegmentOpen && openSegment.activityClass == state) {
+        openSegment.endTime = record.endTime;
+    } else {
+        if (isSegmentOpen) {
+            segments.push_back(openSegment);
+        }
+        openSegment.startTime = record.startTime;
+        openSegment.endTime = record.endTime;
+        openSegment.activityClass = state;
+        isSegmentOpen = true;
+    }
+    decidedStepCount = step + 1;
+}
+
+ActivitySegmenter *createActivitySegmenter(int classCount, double stepDuration, int lagStepCount, double reorderWindow, float switchProbability)
+{
+    return new ActivitySegmenter(std::max(classCount, 1), stepDuration, lagStepCount, reorderWindow, switchProbability);
+}
+
+void deleteActivitySegmenter(ActivitySegmenter *segmenter)
+{
+    delete segmenter;
+}
+
+void activitySegmenterSetTransitionMatrix(ActivitySegmenter *segmenter, const float *matrix)
+{
+    if (segmenter->stepCount > 0) {
+        return;
+    }
+
+    int classCount = segmenter->classCount;
+    for (int from = 0; from < classCount; from++) {
+        normalizedLog(matrix + from * classCount, classCount, &segmenter->logTransitions[from * classCount]);
+    }
+}
+
+void activitySegmenterSetInitialProbabilities(ActivitySegmenter *segmenter, const float *probabilities)
+{
+    if (segmenter->stepCount > 0) {
+        return;
+    }
+
+    normalizedLog(probabilities, segmenter->classCount, segmenter->logInitialProbabilities.data());
+}
+
+void activitySegmenterSetWindowEvidence(ActivitySegmenter *segmenter, float weight, float probabilityFloor)
+{
+    segmenter->windowWeight = std::max(weight, 0.0f);
+    segmenter->logProbabilityFloor = std::log(std::max((double)probabilityFloor, minimumProbability));
+}
+
+void activitySegmenterSetSpeedModel(ActivitySegmenter *segmenter, int activityClass, float typicalMinimumSpeed, float maximumSpeed, float slowProbability, float fastProbability)
+{
+    if (activityClass < 0 || activityClass >= segmenter->classCount) {
+        return;
+    }
+
+    SpeedModel &model = segmenter->speedModels[activityClass];
+    model.isSet = true;
+    model.typicalMinimumSpeed = typicalMinimumSpeed;
+    model.maximumSpeed = maximumSpeed;
+    model.logSlowProbability = std::log(std::max((double)slowProbability, minimumProbability));
+    model.logFastProbability = std::log(std::max((double)fastProbability, minimumProbability));
+}
+
+bool activitySegmenterAddWindow(ActivitySegmenter *segmenter, double time, const float *probabilities)
+{
+    Observation observation;
+    observation.speed = 0;
+    observation.probabilities.assign(probabilities, probabilities + segmenter->classCount);
+    return segmenter->add(time, observation);
+}
+
+bool activitySegmenterAddSpeed(ActivitySegmenter *segmenter, double time, float speed)
+{
+    if (!(speed >= 0)) {
+        return false;
+    }
+
+    Observation observation;
+    observation.speed = speed;
+    return segmenter->add(time, observation);
+}
+
+void activitySegmenterFinish(ActivitySegmenter *segmenter)
+{
+    if (segmenter->isFinished) {
+        return;
+    }
+    segmenter->isFinished = true;
+
+    for (std::multimap<double, Observation>::iterator it = segmenter->heldBack.begin(); it != segmenter->heldBack.end(); ++it) {
+        segmenter->release(it->first, it->second);
+    }
+    segmenter->heldBack.clear();
+    if (segmenter->isStepOpen) {
+        segmenter->closeStep();
+        segmenter->isStepOpen = false;
+    }
+
+    // the rest of the path, back from the best final state
+    long remainingCount = segmenter->stepCount - segmenter->decidedStepCount;
+    if (remainingCount > 0) {
+        std::vector<int> states(remainingCount);
+        int state = segmenter->topState;
+        for (long s = segmenter->stepCount - 1; s >= segmenter->decidedStepCount; s--) {
+            states[s - segmenter->decidedStepCount] = state;
+            state = segmenter->steps[s % segmenter->steps.size()].previousStates[state];
+        }
+        long firstStep = segmenter->decidedStepCount;
+        for (long i = 0; i < remainingCount; i++) {
+            segmenter->decide(firstStep + i, states[i]);
+        }
+    }
+
+    if (segmenter->isSegmentOpen) {
+        segmenter->segments.push_back(segmenter->openSegment);
+        segmenter->isSegmentOpen = false;
+    }
+}
+
+int activitySegmenterReadSegments(ActivitySegmenter *segmenter, ActivitySegment *segments, int maximumCount)
+{
+    int count = 0;
+    while (count < maximumCount && !segmenter->segments.empty()) {
+        segments[count++] = segmenter->segments.front();
+        segmenter->segments.pop_front();
+    }
+    return count;
+}
+
+int activitySegmenterCurrentClass(ActivitySegmenter *segmenter)
+{
+    return segmenter->stepCount > 0 ? segmenter->topState : -1;
+}
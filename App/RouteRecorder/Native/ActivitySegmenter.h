@@ -0,0 +1,63 @@
+//
+//  ActivitySegmenter.h
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#ifndef ActivitySegmenter_h
+#define ActivitySegmenter_h
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    typedef struct ActivitySegment {
+        double startTime;
+        double endTime;
+        int activityClass;
+    } ActivitySegment;
+
+    // Online hidden Markov model over activity classes, decoded with a fixed-lag Viterbi. Observations are classifier
+    // windows (a probability for every class, indexed by class) and GPS speeds. They're combined into steps of
+    // stepDuration, and each step costs one pass over the transition matrix. A step's class is decided once
+    // lagStepCount more steps have been seen, and runs of steps with the same class come out as segments.
+    // Observations may arrive up to reorderWindow seconds out of order; they're held back that long before being
+    // used, and anything older is dropped. A gap with no observations is crossed in a single step. Memory is bounded
+    // by the lag and the reorder window, however long the route. Not thread safe.
+    typedef struct ActivitySegmenter ActivitySegmenter;
+
+    // Starts with a uniform prior, and a transition matrix that stays in the same class with probability
+    // 1 - switchProbability and spreads the rest evenly over the others.
+    ActivitySegmenter *createActivitySegmenter(int classCount, double stepDuration, int lagStepCount, double reorderWindow, float switchProbability);
+    void deleteActivitySegmenter(ActivitySegmenter *segmenter);
+
+    // matrix[from * classCount + to]. Rows are normalized. Only takes effect before the first step.
+    void activitySegmenterSetTransitionMatrix(ActivitySegmenter *segmenter, const float *matrix);
+    void activitySegmenterSetInitialProbabilities(ActivitySegmenter *segmenter, const float *probabilities);
+
+    // Each window's probabilities count for weight of an observation, floored at probabilityFloor.
+    void activitySegmenterSetWindowEvidence(ActivitySegmenter *segmenter, float weight, float probabilityFloor);
+
+    // A class's speeds: a step whose mean speed is below typicalMinimumSpeed has slowProbability under the class,
+    // and above maximumSpeed has fastProbability. Classes without a speed model ignore speed.
+    void activitySegmenterSetSpeedModel(ActivitySegmenter *segmenter, int activityClass, float typicalMinimumSpeed, float maximumSpeed, float slowProbability, float fastProbability);
+
+    // Return false if the observation is older than the reorder window allows.
+    bool activitySegmenterAddWindow(ActivitySegmenter *segmenter, double time, const float *probabilities);
+    bool activitySegmenterAddSpeed(ActivitySegmenter *segmenter, double time, float speed);
+
+    // Uses everything held back and decides every remaining step. Nothing can be added afterwards.
+    void activitySegmenterFinish(ActivitySegmenter *segmenter);
+
+    // Reads up to maximumCount finished segments, oldest first. Returns the number read.
+    int activitySegmenterReadSegments(ActivitySegmenter *segmenter, ActivitySegment *segments, int maximumCount);
+
+    // The most likely class of the latest step, before the lag has confirmed it. -1 before the first step.
+    int activitySegmenterCurrentClass(ActivitySegmenter *segmenter);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ActivitySegmenter_h */
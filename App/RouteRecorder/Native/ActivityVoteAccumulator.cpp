@@ -0,0 +1,82 @@
+//
+//  ActivityVoteAccumulator.cpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#include "ActivityVoteAccumulator.h"
+
+#include <algorithm>
+#include <vector>
+
+struct ActivityVoteAccumulator {
+    ActivityVoteAccumulator(int classCount) : votes(classCount, 0.0f), predictionCount(0), topClass(0) {}
+
+    std::vector<float> votes;
+    int predictionCount;
+    int topClass;
+};
+
+ActivityVoteAccumulator *createActivityVoteAccumulator(int classCount)
+{
+    return new ActivityVoteAccumulator(classCount < 1 ? 1 : classCount);
+}
+
+void deleteActivityVoteAccumulator(ActivityVoteAccumulator *accumulator)
+{
+    delete accumulator;
+}
+
+void activityVoteAccumulatorReset(ActivityVoteAccumulator *accumulator)
+{
+    std::fill(accumulator->votes.begin(), accumulator->votes.end(), 0.0f);
+    accumulator->predictionCount = 0;
+    accumulator->topClass = 0;
+}
+
+void activityVoteAccumulatorAddPrediction(ActivityVoteAccumulator *accumulator, const int *classes, const float *confidences, int count)
+{
+    int classCount = (int)accumulator->votes.size();
+    for (int i = 0; i < count; i++) {
+        if (classes[i] < 0 || classes[i] >= classCount || !(confidences[i] > 0)) {
+            continue;
+        }
+
+        // votes only ever grow, so the leader can only be overtaken by the class that just gained
+        float &vote = accumulator->votes[classes[i]];
+        vote += confidences[i];
+        if (vote > accumulator->votes[accumulator->topClass]) {
+            accumulator->topClass = classes[i];
+        }
+    }
+    accumulator->predictionCount++;
+}
+
+int activityVoteAccumulatorPredictionCount(ActivityVoteAccumulator *accumulator)
+{
+    return accumulator->predictionCount;
+}
+
+int activityVoteAccumulatorTopClass(ActivityVoteAccumulator *accumulator)
+{
+    return accumulator->topClass;
+}
+
+float activityVoteAccumulatorTopConfidence(ActivityVoteAccumulator *accumulator)
+{
+    if (accumulator->predictionCount == 0) {
+        return 0;
+    }
+
+    return accumulator->votes[accumulator->topClass] / accumulator->predictionCount;
+}
+
+float activityVoteAccumulatorVotes(ActivityVoteAccumulator *accumulator, int activityClass)
+{
+    if (activityClass < 0 || activityClass >= (int)accumulator->votes.size()) {
+        return 0;
+    }
+
+    return accumulator->votes[activityClass];
+}
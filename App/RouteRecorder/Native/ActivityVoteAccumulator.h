@@ -0,0 +1,42 @@
+//
+//  ActivityVoteAccumulator.h
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#ifndef ActivityVoteAccumulator_h
+#define ActivityVoteAccumulator_h
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    // Running sum of each class's confidence over every prediction of a session, indexed by class. Adding a prediction
+    // costs one step per predicted class, and the leading class and its mean confidence are kept up to date as they go,
+    // so the aggregate never has to be recomputed from the predictions. Not thread safe.
+    typedef struct ActivityVoteAccumulator ActivityVoteAccumulator;
+
+    ActivityVoteAccumulator *createActivityVoteAccumulator(int classCount);
+    void deleteActivityVoteAccumulator(ActivityVoteAccumulator *accumulator);
+    void activityVoteAccumulatorReset(ActivityVoteAccumulator *accumulator);
+
+    // Adds one prediction's confidence for each of its classes. Classes outside the accumulator and negative
+    // confidences are ignored, but the prediction still counts.
+    void activityVoteAccumulatorAddPrediction(ActivityVoteAccumulator *accumulator, const int *classes, const float *confidences, int count);
+
+    int activityVoteAccumulatorPredictionCount(ActivityVoteAccumulator *accumulator);
+
+    // The class with the most votes so far, or 0 until any class has a vote.
+    int activityVoteAccumulatorTopClass(ActivityVoteAccumulator *accumulator);
+
+    // The top class's votes over the number of predictions.
+    float activityVoteAccumulatorTopConfidence(ActivityVoteAccumulator *accumulator);
+
+    float activityVoteAccumulatorVotes(ActivityVoteAccumulator *accumulator, int activityClass);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ActivityVoteAccumulator_h */
@@ -0,0 +1,180 @@
+//
+//  CadenceDetector.cpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#include "CadenceDetector.h"
+#include "VectorKernels.h"
+
+#include <opencv2/core.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+    // below this much variance (in g^2) there is nothing to find a period in
+    const float kMinimumVariance = 1e-5f;
+
+    // a shorter lag wins over the strongest one if its peak is at least this close, so we report
+    // steps rather than strides and single pedal strokes rather than full revolutions
+    const float kSubharmonicTolerance = 0.9f;
+}
+
+struct CadenceDetector {
+    CadenceDetector(float sampleRate, int windowSampleCount, float minimumPeriod, float maximumPeriod);
+
+    void reset();
+    void push(const AccelerometerSample *samples, int sampleCount);
+    bool estimate(CadenceEstimate *estimate);
+
+private:
+    float sampleRate;
+    int windowSampleCount;
+    int minimumLag;
+    int maximumLag;
+
+    std::vector<float> magnitudes;
+    int head;
+    int filledCount;
+
+    // zero padded to at least twice the window so the circular correlation doesn't wrap
+    cv::Mat signal;
+    cv::Mat spectrum;
+    cv::Mat autocorrelation;
+};
+
+CadenceDetector::CadenceDetector(float sampleRate, int windowSampleCount, float minimumPeriod, float maximumPeriod)
+    : sampleRate(sampleRate), windowSampleCount(windowSampleCount)
+{
+    minimumLag = std::max(2, (int)std::floor(minimumPeriod * sampleRate));
+    // lags past half the window are averaged over too few products to trust
+    maximumLag = std::min(windowSampleCount / 2, (int)std::ceil(maximumPeriod * sampleRate));
+
+    magnitudes.resize(windowSampleCount);
+    signal = cv::Mat::zeros(1, cv::getOptimalDFTSize(2 * windowSampleCount), CV_32F);
+
+    reset();
+}
+
+void CadenceDetector::reset()
+{
+    head = 0;
+    filledCount = 0;
+}
+
+void CadenceDetector::push(const AccelerometerSample *samples, int sampleCount)
+{
+    for (int i = 0; i < sampleCount; i++) {
+        const AccelerometerSample &sample = samples[i];
+        magnitudes[head] = std::sqrt(sample.x * sample.x + sample.y * sample.y + sample.z * sample.z);
+        head = (head + 1) % windowSampleCount;
+        filledCount = std::min(filledCount + 1, windowSampleCount);
+    }
+}
+
+bool CadenceDetector::estimate(CadenceEstimate *estimate)
+{
+    if (filledCount < windowSampleCount || minimumLag + 1 >= maximumLag) {
+        return false;
+    }
+
+    estimate->period = 0;
+    estimate->confidence = 0;
+
+    float mean = vectorKernelsSum(&magnitudes[0], windowSampleCount) / windowSampleCount;
+
+    // unroll the ring oldest first, removing gravity and the mean
+    float *s = signal.ptr<float>();
+    for (int i = 0; i < windowSampleCount; i++) {
+        s[i] = magnitudes[(head + i) % windowSampleCount] - mean;
+    }
+
+    // forward transform is packed CCS; replace each bin with its power and transform back
+    cv::dft(signal, spectrum);
+    float *p = spectrum.ptr<float>();
+    int n = spectrum.cols;
+    p[0] = p[0] * p[0];
+    int k = 1;
+    for (; k + 1 < n; k += 2) {
+        p[k] = p[k] * p[k] + p[k + 1] * p[k + 1];
+        p[k + 1] = 0;
+    }
+    if (k < n) {
+        // even length, the last bin is the real-only nyquist term
+        p[k] = p[k] * p[k];
+    }
+    cv::dft(spectrum, autocorrelation, cv::DFT_INVERSE | cv::DFT_REAL_OUTPUT | cv::DFT_SCALE);
+
+    const float *r = autocorrelation.ptr<float>();
+    float variance = r[0] / windowSampleCount;
+    if (variance < kMinimumVariance) {
+        return true;
+    }
+
+    // unbiased and normalized, so a perfectly periodic signal scores 1 at every multiple of its period
+    std::vector<float> normalized(maximumLag + 2);
+    for (int lag = minimumLag - 1; lag <= maximumLag + 1; lag++) {
+        normalized[lag] = r[lag] / (windowSampleCount - lag) / variance;
+    }
+
+    int bestLag = -1;
+    for (int lag = minimumLag; lag <= maximumLag; lag++) {
+        if (normalized[lag] > normalized[lag - 1] && normalized[lag] >= normalized[lag + 1] && (bestLag < 0 || normalized[lag] > normalized[bestLag])) {
+            bestLag = lag;
+        }
+    }
+    if (bestLag < 0 || normalized[bestLag] <= 0) {
+        return true;
+    }
+
+    for (int lag = minimumLag; lag < bestLag; lag++) {
+        if (normalized[lag] > normalized[lag - 1] && normalized[lag] >= normalized[lag + 1] && normalized[lag] >= kSubharmonicTolerance * normalized[bestLag]) {
+            bestLag = lag;
+            break;
+        }
+    }
+
+    // parabolic interpolation around the peak for a sub-sample period
+    float a = normalized[bestLag - 1];
+    float b = normalized[bestLag];
+    float c = normalized[bestLag + 1];
+    float denominator = a - 2 * b + c;
+    float offset = (denominator < 0) ? 0.5f * (a - c) / denominator : 0.0f;
+
+    estimate->period = (bestLag + offset) / sampleRate;
+    estimate->confidence = std::min(1.0f, std::max(0.0f, b));
+
+    return true;
+}
+
+CadenceDetector *createCadenceDetector(float sampleRate, int windowSampleCount, float minimumPeriod, float maximumPeriod)
+{
+    if (sampleRate <= 0 || windowSampleCount <= 0 || minimumPeriod >= maximumPeriod) {
+        return NULL;
+    }
+
+    return new CadenceDetector(sampleRate, windowSampleCount, minimumPeriod, maximumPeriod);
+}
+
+void deleteCadenceDetector(CadenceDetector *detector)
+{
+    delete detector;
+}
+
+void cadenceDetectorReset(CadenceDetector *detector)
+{
+    detector->reset();
+}
+
+void cadenceDetectorPush(CadenceDetector *detector, const AccelerometerSample *samples, int sampleCount)
+{
+    detector->push(samples, sampleCount);
+}
+
+bool cadenceDetectorEstimate(CadenceDetector *detector, CadenceEstimate *estimate)
+{
+    return detector->estimate(estimate);
+}
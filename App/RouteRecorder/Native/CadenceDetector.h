@@ -0,0 +1,40 @@
+//
+//  CadenceDetector.h
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#ifndef CadenceDetector_h
+#define CadenceDetector_h
+
+#include <stdbool.h>
+
+#include "AccelerometerSample.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    typedef struct CadenceEstimate {
+        float period; // seconds between steps or pedal strokes
+        float confidence; // normalized autocorrelation at that period, 0 (no periodicity) to 1 (perfectly periodic)
+    } CadenceEstimate;
+
+    // Finds the dominant step or pedalling period in a sliding window of acceleration magnitudes.
+    // The autocorrelation is computed through the power spectrum with cv::dft, so each estimate costs
+    // two FFTs over the window rather than a full lag-by-lag correlation.
+    typedef struct CadenceDetector CadenceDetector;
+
+    CadenceDetector *createCadenceDetector(float sampleRate, int windowSampleCount, float minimumPeriod, float maximumPeriod);
+    void deleteCadenceDetector(CadenceDetector *detector);
+    void cadenceDetectorReset(CadenceDetector *detector);
+
+    void cadenceDetectorPush(CadenceDetector *detector, const AccelerometerSample *samples, int sampleCount);
+
+    // returns false until the window has filled
+    bool cadenceDetectorEstimate(CadenceDetector *detector, CadenceEstimate *estimate);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CadenceDetector_h */
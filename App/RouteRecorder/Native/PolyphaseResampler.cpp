@@ -0,0 +1,266 @@
+//
+//  PolyphaseResampler.cpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#include "PolyphaseResampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace {
+    const int kTapCount = 16; // taps per phase, must be even
+    const int kPhaseCount = 64;
+    const int kHalfTapCount = kTapCount / 2;
+
+    // an input interval longer than this many nominal periods is treated as a dropout and restarts the stream
+    const float kGapPeriodCount = 4.0f;
+
+    double sinc(double x)
+    {
+        if (std::fabs(x) < 1e-9) {
+            return 1.0;
+        }
+        return std::sin(M_PI * x) / (M_PI * x);
+    }
+
+    double blackman(double d, double halfWidth)
+    {
+        if (std::fabs(d) > halfWidth) {
+            return 0.0;
+        }
+        return 0.42 + 0.5 * std::cos(M_PI * d / halfWidth) + 0.08 * std::cos(2.0 * M_PI * d / halfWidth);
+    }
+}
+
+struct PolyphaseResampler {
+    PolyphaseResampler(float inputSampleRate, float outputSampleRate);
+
+    void reset();
+    int push(const AccelerometerSample &sample, AccelerometerSample *output, int maximumOutputCount);
+    int flush(AccelerometerSample *output, int maximumOutputCount);
+
+    float inputPeriod;
+    float outputPeriod;
+    int maximumOutputCount;
+
+private:
+    void append(const AccelerometerSample &sample);
+    int emit(AccelerometerSample *output, int maximumOutputCount, double lastOutputTime);
+
+    // (kPhaseCount + 1) rows of kTapCount coefficients, row p delays by p / kPhaseCount of an input period
+    std::vector<float> coefficients;
+
+    // the history is mirrored so that the kTapCount most recent samples are always contiguous at [head, head + kTapCount)
+    float historyT[2 * kTapCount];
+    float historyX[2 * kTapCount];
+    float historyY[2 * kTapCount];
+    float historyZ[2 * kTapCount];
+    int head;
+    int filledCount;
+
+    bool hasLastSample;
+    AccelerometerSample lastSample;
+
+    double outputOrigin;
+    long outputIndex;
+};
+
+PolyphaseResampler::PolyphaseResampler(float inputSampleRate, float outputSampleRate)
+{
+    inputPeriod = 1.0f / inputSampleRate;
+    outputPeriod = 1.0f / outputSampleRate;
+
+    float ratio = outputSampleRate / inputSampleRate;
+    int pushOutputCount = (int)std::ceil(kGapPeriodCount * ratio) + 1;
+    int flushOutputCount = (int)std::ceil(kHalfTapCount * ratio) + 1;
+    maximumOutputCount = std::max(pushOutputCount, flushOutputCount);
+
+    // cutoff in cycles per input sample: the output nyquist when decimating, the input nyquist otherwise,
+    // pulled in slightly to leave room for the transition band of a short filter.
+    double cutoff = 0.45 * std::min(1.0, (double)ratio);
+
+    coefficients.resize((kPhaseCount + 1) * kTapCount);
+    for (int phase = 0; phase <= kPhaseCount; phase++) {
+        double mu = (double)phase / kPhaseCount;
+        double sum = 0;
+        for (int j = 0; j < kTapCount; j++) {
+            double d = (j - (kHalfTapCount - 1)) - mu;
+            double h = 2.0 * cutoff * sinc(2.0 * cutoff * d) * blackman(d, kHalfTapCount);
+            coefficients[phase * kTapCount + j] = (float)h;
+            sum += h;
+        }
+
+        // unity gain at DC, so gravity passes through untouched
+        for (int j = 0; j < kTapCount; j++) {
+            coefficients[phase * kTapCount + j] = (float)(coefficients[phase * kTapCount + j] / sum);
+        }
+    }
+
+    reset();
+}
+
+void PolyphaseResampler::reset()
+{
+    head = 0;
+    filledCount = 0;
+    hasLastSample = false;
+    outputOrigin = 0;
+    outputIndex = 0;
+}
+
+void PolyphaseResampler::append(const AccelerometerSample &sample)
+{
+    historyT[head] = historyT[head + kTapCount] = sample.t;
+    historyX[head] = historyX[head + kTapCount] = sample.x;
+    historyY[head] = historyY[head + kTapCount] = sample.y;
+    historyZ[head] = historyZ[head + kTapCount] = sample.z;
+
+    head = (head + 1) % kTapCount;
+    if (filledCount < kTapCount) {
+        filledCount++;
+    }
+}
+
+int PolyphaseResampler::emit(AccelerometerSample *output, int maximumOutputCount, double lastOutputTime)
+{
+    if (filledCount < kTapCount) {
+        return 0;
+    }
+
+    const float *t = historyT + head;
+    const float *x = historyX + head;
+    const float *y = historyY + head;
+    const float *z = historyZ + head;
+
+    // outputs are interpolated between the two samples straddling the middle of the filter
+    double ta = t[kHalfTapCount - 1];
+    double tb = t[kHalfTapCount];
+
+    int count = 0;
+    while (count < maximumOutputCount) {
+        double outputTime = outputOrigin + outputIndex * (double)outputPeriod;
+        if (outputTime >= tb || outputTime > lastOutputTime) {
+            break;
+        }
+
+        if (outputTime < ta) {
+            // can only happen if the grid fell behind a restarted stream; skip ahead rather than extrapolate
+            outputIndex++;
+            continue;
+        }
+
+        double mu = (tb > ta) ? (outputTime - ta) / (tb - ta) : 0.0;
+        int phase = std::min(kPhaseCount, std::max(0, (int)(mu * kPhaseCount + 0.5)));
+        const float *h = &coefficients[phase * kTapCount];
+
+        float sx = 0, sy = 0, sz = 0;
+        for (int j = 0; j < kTapCount; j++) {
+            sx += h[j] * x[j];
+            sy += h[j] * y[j];
+            sz += h[j] * z[j];
+        }
+
+        output[count].t = (float)outputTime;
+        output[count].x = sx;
+        output[count].y = sy;
+        output[count].z = sz;
+        count++;
+        outputIndex++;
+    }
+
+    return count;
+}
+
+int PolyphaseResampler::push(const AccelerometerSample &sample, AccelerometerSample *output, int maximumOutputCount)
+{
+    if (hasLastSample) {
+        if (sample.t <= lastSample.t) {
+            // out of order or duplicate
+            return 0;
+        }
+        if (sample.t - lastSample.t > kGapPeriodCount * inputPeriod) {
+            reset();
+        }
+    }
+
+    if (!hasLastSample) {
+        // pad the start with copies of the first sample so the first output lands on its timestamp
+        for (int i = kHalfTapCount - 1; i > 0; i--) {
+            AccelerometerSample padding = sample;
+            padding.t = sample.t - i * inputPeriod;
+            append(padding);
+        }
+        outputOrigin = sample.t;
+        outputIndex = 0;
+    }
+
+    append(sample);
+    lastSample = sample;
+    hasLastSample = true;
+
+    return emit(output, maximumOutputCount, std::numeric_limits<double>::infinity());
+}
+
+int PolyphaseResampler::flush(AccelerometerSample *output, int maximumOutputCount)
+{
+    if (!hasLastSample) {
+        return 0;
+    }
+
+    int count = 0;
+    AccelerometerSample last = lastSample;
+    for (int i = 1; i <= kHalfTapCount && count < maximumOutputCount; i++) {
+        AccelerometerSample padding = last;
+        padding.t = last.t + i * inputPeriod;
+        append(padding);
+        count += emit(output + count, maximumOutputCount - count, last.t);
+    }
+
+    reset();
+
+    return count;
+}
+
+PolyphaseResampler *createPolyphaseResampler(float inputSampleRate, float outputSampleRate)
+{
+    if (inputSampleRate <= 0 || outputSampleRate <= 0) {
+        return NULL;
+    }
+
+    return new PolyphaseResampler(inputSampleRate, outputSampleRate);
+}
+
+void deletePolyphaseResampler(PolyphaseResampler *resampler)
+{
+    delete resampler;
+}
+
+void polyphaseResamplerReset(PolyphaseResampler *resampler)
+{
+    resampler->reset();
+}
+
+int polyphaseResamplerMaximumOutputCount(PolyphaseResampler *resampler)
+{
+    return resampler->maximumOutputCount;
+}
+
+float polyphaseResamplerLatency(PolyphaseResampler *resampler)
+{
+    return kHalfTapCount * resampler->inputPeriod;
+}
+
+int polyphaseResamplerPush(PolyphaseResampler *resampler, AccelerometerSample sample, AccelerometerSample *output, int maximumOutputCount)
+{
+    return resampler->push(sample, output, maximumOutputCount);
+}
+
+int polyphaseResamplerFlush(PolyphaseResampler *resampler, AccelerometerSample *output, int maximumOutputCount)
+{
+    return resampler->flush(output, maximumOutputCount);
+}
@@ -0,0 +1,40 @@
+//
+//  PolyphaseResampler.h
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#ifndef PolyphaseResampler_h
+#define PolyphaseResampler_h
+
+#include "AccelerometerSample.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    // Streams accelerometer samples recorded at inputSampleRate onto a uniform grid at outputSampleRate.
+    // Each output is computed with a windowed-sinc polyphase filter whose phase is picked from the
+    // actual sample timestamps, so timestamp jitter is absorbed as a fractional delay.
+    typedef struct PolyphaseResampler PolyphaseResampler;
+
+    PolyphaseResampler *createPolyphaseResampler(float inputSampleRate, float outputSampleRate);
+    void deletePolyphaseResampler(PolyphaseResampler *resampler);
+    void polyphaseResamplerReset(PolyphaseResampler *resampler);
+
+    // the largest number of samples a single call to polyphaseResamplerPush can produce
+    int polyphaseResamplerMaximumOutputCount(PolyphaseResampler *resampler);
+
+    // the delay, in seconds, between an input sample arriving and the output covering its time being emitted
+    float polyphaseResamplerLatency(PolyphaseResampler *resampler);
+
+    // returns the number of samples written to output
+    int polyphaseResamplerPush(PolyphaseResampler *resampler, AccelerometerSample sample, AccelerometerSample *output, int maximumOutputCount);
+
+    // emits the outputs still held back by the filter's lookahead, up to the last pushed timestamp
+    int polyphaseResamplerFlush(PolyphaseResampler *resampler, AccelerometerSample *output, int maximumOutputCount);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PolyphaseResampler_h */
@@ -0,0 +1,284 @@
+//
+//  PredictionScheduler.cpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#include "PredictionScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+struct PredictionScheduler {
+    PredictionScheduler(const PredictionSchedulerConfiguration &configuration);
+
+    void refill(double time);
+    double cost(double duration, double sampleRate) const;
+    void charge(double time, double sensorDuration, double sampleRate);
+
+    const PredictionSchedulerConfiguration configuration;
+    const double capacity;
+    const double refillRate; // per second
+
+    std::vector<double> sampleRates; // fastest first
+
+    double budget;
+    double budgetTime;
+
+    bool isSampling;
+    double sessionStartTime;
+    double reservedCost;
+
+    double interval;
+    double lastSessionEndTime;
+
+    bool hasResult;
+    double resultTime;
+    bool resultIsStationary;
+    float resultConfidence;
+};
+
+PredictionScheduler::PredictionScheduler(const PredictionSchedulerConfiguration &configuration)
+: configuration(configuration), capacity(std::max(configuration.sensorSecondsPerHour, 0.0)), refillRate(capacity / 3600),
+sampleRates(1, configuration.referenceSampleRate), budget(capacity), budgetTime(-INFINITY), isSampling(false), sessionStartTime(0),
+reservedCost(0), interval(configuration.minimumInterval), lastSessionEndTime(-INFINITY),
+hasResult(false), resultTime(0), resultIsStationary(false), resultConfidence(0)
+{
+}
+
+void PredictionScheduler::refill(double time)
+{
+    if (budgetTime > -INFINITY && time > budgetTime) {
+        budget = std::min(capacity, budget + (time - budgetTime) * refillRate);
+    }
+    budgetTime = std::max(budgetTime, time);
+}
+
+double PredictionScheduler::cost(double duration, double sampleRate) const
+{
+    return std::max(duration, 0.0) * sampleRate / configuration.referenceSampleRate;
+}
+
+void PredictionScheduler::charge(double time, double sensorDuration, double sampleRate)
+{
+    refill(time);
+    budget -= cost(sensorDuration, sampleRate);
+}
+
+PredictionScheduler *createPredictionScheduler(PredictionSchedulerConfiguration configuration)
+{
+    if (!(configuration.referenceSampleRate > 0)) {
+        configuration.referenceSampleRate = 50;
+    }
+    configuration.maximumSessionDuration = std::max(configuration.maximumSessionDuration, configuration.minimumSessionDuration);
+    configuration.maximumInterval = std::max(configuration.maximumInterval, configuration.minimumInterval);
+
+    return new PredictionScheduler(configuration);
+}
+
+void deletePredictionScheduler(PredictionScheduler *scheduler)
+{
+    delete scheduler;
+}
+
+void predictionSchedulerSetSampleRates(PredictionScheduler *scheduler, const double *sampleRates, int count)
+{
+    std::vector<double> rates;
+    for (int i = 0; i < count; i++) {
+        if (sampleRates[i] > 0) {
+            rates.push_back(sampleRates[i]);
+        }
+    }
+    if (rates.empty()) {
+        return;
+    }
+
+    std::sort(rates.begin(), rates.end(), std::greater<double>());
+    scheduler->sampleRates = rates;
+}
+
+PredictionSchedulerDecision predictionSchedulerDecide(PredictionScheduler *scheduler, double time, float speed)
+{
+    const PredictionSchedulerConfiguration &configuration = scheduler->configuration;
+    PredictionSchedulerDecision decision = {false, 0, 0, time, PredictionSchedulerDeclineReasonNone};
+
+    scheduler->refill(time);
+
+    if (scheduler->isSampling) {
+        decision.retryTime = scheduler->sessionStartTime + configuration.maximumSessionDuration;
+        decision.declineReason = PredictionSchedulerDeclineReasonSampling;
+        return decision;
+    }
+
+    // a fast fix is the best sign a trip is starting, so it cuts any back-off short
+    bool isMoving = speed >= configuration.movingSpeed;
+    if (isMoving) {
+        scheduler->interval = configuration.minimumInterval;
+    }
+
+    double earliestTime = scheduler->lastSessionEndTime + scheduler->interval;
+    if (time < earliestTime) {
+        decision.retryTime = earliestTime;
+        decision.declineReason = PredictionSchedulerDeclineReasonInterval;
+        return decision;
+    }
+
+    if (scheduler->hasResult && scheduler->resultConfidence >= configuration.highConfidence && time - scheduler->resultTime < configuration.confidentResultLifetime) {
+        bool speedAgrees = speed < 0 || isMoving != scheduler->resultIsStationary;
+        if (speedAgrees) {
+            decision.retryTime = scheduler->resultTime + configuration.confidentResultLifetime;
+            decision.declineReason = PredictionSchedulerDeclineReasonConfidentResult;
+            return decision;
+        }
+    }
+
+    // the fastest rate that affords a whole session, or failing that as long a session as the slowest rate affords
+    double sampleRate = 0;
+    double duration = 0;
+    for (size_t i = 0; i < scheduler->sampleRates.size(); i++) {
+        if (scheduler->budget >= scheduler->cost(configuration.maximumSessionDuration, scheduler->sampleRates[i])) {
+            sampleRate = scheduler->sampleRates[i];
+            duration = configuration.maximumSessionDuration;
+            break;
+        }
+    }
+    if (sampleRate == 0) {
+        double slowestRate = scheduler->sampleRates.back();
+        double affordableDuration = scheduler->budget / scheduler->cost(1, slowestRate);
+        if (affordableDuration < configuration.minimumSessionDuration) {
+            double shortfall = scheduler->cost(configuration.minimumSessionDuration, slowestRate) - scheduler->budget;
+            decision.retryTime = scheduler->refillRate > 0 ? time + shortfall / scheduler->refillRate : INFINITY;
+            decision.declineReason = PredictionSchedulerDeclineReasonBudget;
+            return decision;
+        }
+        sampleRate = slowestRate;
+        duration = affordableDuration;
+    }
+
+    // held against the budget until the session says what it really took
+    scheduler->isSampling = true;
+    scheduler->sessionStartTime = time;
+    scheduler->reservedCost = scheduler->cost(duration, sampleRate);
+    scheduler->budget -= scheduler->reservedCost;
+
+    decision.shouldSample = true;
+    decision.sessionDuration = duration;
+    decision.sampleRate = sampleRate;
+    return decision;
+}
+
+void predictionSchedulerRecordResult(PredictionScheduler *scheduler, double time, double sensorDuration, double sampleRate, bool isStationary, float confidence)
+{
+    const PredictionSchedulerConfiguration &configuration = scheduler->configuration;
+
+    if (scheduler->isSampling) {
+        scheduler->budget += scheduler->reservedCost;
+        scheduler->reservedCost = 0;
+        scheduler->isSampling = false;
+    }
+    scheduler->charge(time, sensorDuration, sampleRate);
+    scheduler->lastSessionEndTime = time;
+
+    if (confidence <= 0) {
+        // says nothing either way, so the back-off stays where it was
+        return;
+    }
+
+    scheduler->hasResult = true;
+    scheduler->resultTime = time;
+    scheduler->resultIsStationary = isStationary;
+    scheduler->resultConfidence = confidence;
+
+    if (isStationary && confidence >= configuration.highConfidence) {
+        scheduler->interval = std::min(std::max(scheduler->interval * 2, configuration.minimumInterval), configuration.maximumInterval);
+    } else {
+        scheduler->interval = configuration.minimumInterval;
+    }
+}
+
+void predictionSchedulerRecordUsage(PredictionScheduler *scheduler, double time, double sensorDuration, double sampleRate)
+{
+    scheduler->charge(time, sensorDuration, sampleRate);
+}
+
+double predictionSchedulerAvailableBudget(PredictionScheduler *scheduler, double time)
+{
+    scheduler->refill(time);
+    return scheduler->budget;
+}
+
+void predictionSchedulerSimulate(PredictionScheduler *scheduler, const double *fixTimes, const float *fixSpeeds, int fixCount, const double *labelTimes, const bool *labelIsStationary, const float *labelConfidences, int labelCount, PredictionSchedulerSimulation *simulation)
+{
+    const PredictionSchedulerConfiguration &configuration = scheduler->configuration;
+    PredictionSchedulerSimulation result = {0, 0, 0, 0, 0, 0, 0};
+    double detectionDelaySum = 0;
+
+    bool isInEpisode = false;
+    bool isEpisodeDetected = false;
+    double episodeStartTime = 0;
+
+    bool hasPendingSession = false;
+    double pendingStartTime = 0;
+    double pendingEndTime = 0;
+    double pendingSampleRate = 0;
+    int pendingLabel = -1;
+
+    for (int i = 0; i <= fixCount; i++) {
+        double time = i < fixCount ? fixTimes[i] : INFINITY;
+
+        if (hasPendingSession && pendingEndTime <= time) {
+            bool isStationary = pendingLabel >= 0 && labelIsStationary[pendingLabel];
+            float confidence = pendingLabel >= 0 ? labelConfidences[pendingLabel] : 0;
+            predictionSchedulerRecordResult(scheduler, pendingEndTime, pendingEndTime - pendingStartTime, pendingSampleRate, isStationary, confidence);
+            result.sensorSeconds += scheduler->cost(pendingEndTime - pendingStartTime, pendingSampleRate);
+            hasPendingSession = false;
+
+            if (isInEpisode && !isEpisodeDetected && !isStationary && confidence >= configuration.highConfidence) {
+                isEpisodeDetected = true;
+                result.detectedEpisodeCount++;
+                detectionDelaySum += pendingEndTime - episodeStartTime;
+            }
+        }
+        if (i == fixCount) {
+            break;
+        }
+
+        // a fix without a speed neither starts nor ends an episode
+        float speed = fixSpeeds[i];
+        if (speed >= configuration.movingSpeed && !isInEpisode) {
+            isInEpisode = true;
+            isEpisodeDetected = false;
+            episodeStartTime = time;
+            result.movingEpisodeCount++;
+        } else if (speed >= 0 && speed < configuration.movingSpeed) {
+            isInEpisode = false;
+        }
+
+        result.requestCount++;
+        PredictionSchedulerDecision decision = predictionSchedulerDecide(scheduler, time, speed);
+        if (!decision.shouldSample) {
+            if (decision.declineReason == PredictionSchedulerDeclineReasonBudget) {
+                result.budgetDeclinedCount++;
+            }
+            continue;
+        }
+
+        result.sessionCount++;
+        hasPendingSession = true;
+        pendingStartTime = time;
+        pendingSampleRate = decision.sampleRate;
+        pendingLabel = (int)(std::lower_bound(labelTimes, labelTimes + labelCount, time) - labelTimes);
+        if (pendingLabel < labelCount && labelTimes[pendingLabel] <= time + decision.sessionDuration) {
+            pendingEndTime = std::max(labelTimes[pendingLabel], time + std::min(configuration.minimumSessionDuration, decision.sessionDuration));
+        } else {
+            pendingLabel = -1;
+            pendingEndTime = time + decision.sessionDuration;
+        }
+    }
+
+    result.meanDetectionDelay = result.detectedEpisodeCount > 0 ? detectionDelaySum / result.detectedEpisodeCount : 0;
+    *simulation = result;
+}
@@ -0,0 +1,96 @@
+//
+//  PredictionScheduler.h
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#ifndef PredictionScheduler_h
+#define PredictionScheduler_h
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    typedef struct PredictionSchedulerConfiguration {
+        // The budget, in seconds of sampling at referenceSampleRate per hour. Sampling at a lower rate costs
+        // proportionally less. Unspent budget carries over, up to an hour's worth.
+        double sensorSecondsPerHour;
+        double referenceSampleRate;
+
+        double minimumSessionDuration; // shorter than this can't produce a prediction, so isn't worth starting
+        double maximumSessionDuration;
+
+        // Requests closer together than minimumInterval are declined. Each confident stationary result doubles
+        // the interval, up to maximumInterval, until a fix at movingSpeed or faster or a moving result resets it.
+        double minimumInterval;
+        double maximumInterval;
+        float movingSpeed; // m/s
+
+        // A confident result stands for confidentResultLifetime, as long as the speed still agrees with it.
+        float highConfidence;
+        double confidentResultLifetime;
+    } PredictionSchedulerConfiguration;
+
+    typedef enum PredictionSchedulerDeclineReason {
+        PredictionSchedulerDeclineReasonNone = 0,
+        PredictionSchedulerDeclineReasonSampling,        // a session is already in progress
+        PredictionSchedulerDeclineReasonInterval,        // too soon after the last session
+        PredictionSchedulerDeclineReasonConfidentResult, // the last result still stands, and the speed agrees with it
+        PredictionSchedulerDeclineReasonBudget,
+    } PredictionSchedulerDeclineReason;
+
+    typedef struct PredictionSchedulerDecision {
+        bool shouldSample;
+        double sessionDuration; // the most sensor time the session should take
+        double sampleRate;
+        double retryTime;       // if declined, the earliest a request could be granted, as things stand
+        PredictionSchedulerDeclineReason declineReason;
+    } PredictionSchedulerDecision;
+
+    // Decides when a prediction is worth the sensor time, for how long, and at what accelerometer rate, from the
+    // speed of the fix that prompted it, how recent and confident the last result was, and a leaky bucket of
+    // sensor time. Times are seconds on any clock, as long as it's the same one throughout. Not thread safe.
+    typedef struct PredictionScheduler PredictionScheduler;
+
+    PredictionScheduler *createPredictionScheduler(PredictionSchedulerConfiguration configuration);
+    void deletePredictionScheduler(PredictionScheduler *scheduler);
+
+    // The rates a session can run at. Defaults to only the reference rate.
+    void predictionSchedulerSetSampleRates(PredictionScheduler *scheduler, const double *sampleRates, int count);
+
+    // speed is negative if unknown. A granted request counts as a session in progress, and every request is
+    // declined until its result is recorded.
+    PredictionSchedulerDecision predictionSchedulerDecide(PredictionScheduler *scheduler, double time, float speed);
+
+    // Ends the session in progress, charging it for the sensor time it actually took. An unknown result has a
+    // confidence of 0.
+    void predictionSchedulerRecordResult(PredictionScheduler *scheduler, double time, double sensorDuration, double sampleRate, bool isStationary, float confidence);
+
+    // Sensor time spent outside of a scheduled session, like gathering training data.
+    void predictionSchedulerRecordUsage(PredictionScheduler *scheduler, double time, double sensorDuration, double sampleRate);
+
+    // In seconds at the reference rate. Negative after a session overran what was left.
+    double predictionSchedulerAvailableBudget(PredictionScheduler *scheduler, double time);
+
+    typedef struct PredictionSchedulerSimulation {
+        int requestCount;
+        int sessionCount;
+        int budgetDeclinedCount;     // requests declined only because the budget was spent
+        double sensorSeconds;        // at the reference rate
+        int movingEpisodeCount;      // runs of fixes at movingSpeed or faster
+        int detectedEpisodeCount;    // that a session confidently called moving before the run ended
+        double meanDetectionDelay;   // from the first fast fix of a detected episode to the result
+    } PredictionSchedulerSimulation;
+
+    // Replays a recorded trace through the scheduler as if every fix were a request. A granted session gets the
+    // first recorded label within its duration, ending when that label arrives, or runs its full duration with an
+    // unknown result if there isn't one. Label i is what a prediction at labelTimes[i] said. Fixes and labels
+    // must be in time order. Meant for a freshly created scheduler, so policies can be compared offline.
+    void predictionSchedulerSimulate(PredictionScheduler *scheduler, const double *fixTimes, const float *fixSpeeds, int fixCount, const double *labelTimes, const bool *labelIsStationary, const float *labelConfidences, int labelCount, PredictionSchedulerSimulation *simulation);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PredictionScheduler_h */
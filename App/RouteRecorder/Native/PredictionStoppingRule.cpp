@@ -0,0 +1,217 @@
+//
+//  PredictionStoppingRule.cpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#include "PredictionStoppingRule.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+    class Rule {
+    public:
+        Rule(int classCount, int minimumWindowCount, int maximumWindowCount)
+        : classCount(classCount), minimumWindowCount(minimumWindowCount), maximumWindowCount(maximumWindowCount) {}
+        virtual ~Rule() {}
+
+        virtual void reset()
+        {
+            windowCount = 0;
+            decision = PredictionStoppingDecisionContinue;
+        }
+
+        PredictionStoppingDecision addWindow(const float *probabilities)
+        {
+            if (decision != PredictionStoppingDecisionContinue) {
+                return decision;
+            }
+
+            accumulate(probabilities);
+            windowCount++;
+            if (windowCount > minimumWindowCount && isDecided()) {
+                decision = PredictionStoppingDecisionDecided;
+            } else if (windowCount >= maximumWindowCount) {
+                decision = PredictionStoppingDecisionUndecided;
+            }
+            return decision;
+        }
+
+        virtual int topClass() const = 0;
+        virtual float confidence() const = 0;
+
+        const int classCount;
+        int windowCount;
+        PredictionStoppingDecision decision;
+
+    protected:
+        virtual void accumulate(const float *probabilities) = 0;
+        virtual bool isDecided() const = 0;
+
+        const int minimumWindowCount;
+        const int maximumWindowCount;
+    };
+
+    // the rule the aggregator has always used: enough windows, then a high enough mean confidence
+    class FixedRule : public Rule {
+    public:
+        FixedRule(int classCount, int minimumWindowCount, int maximumWindowCount, float confidenceThreshold)
+        : Rule(classCount, minimumWindowCount, maximumWindowCount), confidenceThreshold(confidenceThreshold), votes(classCount) { reset(); }
+
+        void reset()
+        {
+            Rule::reset();
+            std::fill(votes.begin(), votes.end(), 0.0f);
+            top = 0;
+        }
+
+        int topClass() const { return top; }
+        float confidence() const { return windowCount > 0 ? votes[top] / windowCount : 0; }
+
+    protected:
+        void accumulate(const float *probabilities)
+        {
+            for (int i = 0; i < classCount; i++) {
+                votes[i] += probabilities[i];
+                if (votes[i] > votes[top]) {
+                    top = i;
+                }
+            }
+        }
+
+        bool isDecided() const { return confidence() > confidenceThreshold; }
+
+    private:
+        const float confidenceThreshold;
+        std::vector<float> votes;
+        int top;
+    };
+
+    class SequentialRule : public Rule {
+    public:
+        SequentialRule(int classCount, int minimumWindowCount, int maximumWindowCount, float errorRate, float evidenceWeight, float probabilityFloor)
+        : Rule(classCount, minimumWindowCount, maximumWindowCount), errorRate(errorRate), evidenceWeight(evidenceWeight),
+        logFloor(std::log(std::max(probabilityFloor, 1e-6f))), evidence(classCount) { reset(); }
+
+        void reset()
+        {
+            Rule::reset();
+            std::fill(evidence.begin(), evidence.end(), 0.0);
+            top = 0;
+            posterior = 1.0 / classCount;
+        }
+
+        int topClass() const { return top; }
+        float confidence() const { return (float)posterior; }
+
+    protected:
+        void accumulate(const float *probabilities)
+        {
+            // a uniform prior, so the posterior is the normalized likelihood
+            for (int i = 0; i < classCount; i++) {
+                evidence[i] += evidenceWeight * (probabilities[i] > 0 ? std::max((double)std::log(probabilities[i]), logFloor) : logFloor);
+                if (evidence[i] > evidence[top]) {
+                    top = i;
+                }
+            }
+
+            double sum = 0;
+            for (int i = 0; i < classCount; i++) {
+                sum += std::exp(evidence[i] - evidence[top]);
+            }
+            posterior = 1.0 / sum;
+        }
+
+        bool isDecided() const { return posterior >= 1.0 - errorRate; }
+
+    private:
+        const double errorRate;
+        const double evidenceWeight;
+        const double logFloor;
+        std::vector<double> evidence; // log likelihood of each class so far
+        int top;
+        double posterior;
+    };
+}
+
+struct PredictionStoppingRule {
+    PredictionStoppingRule(Rule *rule) : rule(rule) {}
+    ~PredictionStoppingRule() { delete rule; }
+
+    Rule *rule;
+};
+
+PredictionStoppingRule *createFixedPredictionStoppingRule(int classCount, int minimumWindowCount, int maximumWindowCount, float confidenceThreshold)
+{
+    return new PredictionStoppingRule(new FixedRule(std::max(classCount, 1), minimumWindowCount, maximumWindowCount, confidenceThreshold));
+}
+
+PredictionStoppingRule *createSequentialPredictionStoppingRule(int classCount, int minimumWindowCount, int maximumWindowCount, float errorRate, float evidenceWeight, float probabilityFloor)
+{
+    return new PredictionStoppingRule(new SequentialRule(std::max(classCount, 1), minimumWindowCount, maximumWindowCount, errorRate, evidenceWeight, probabilityFloor));
+}
+
+void deletePredictionStoppingRule(PredictionStoppingRule *rule)
+{
+    delete rule;
+}
+
+void predictionStoppingRuleReset(PredictionStoppingRule *rule)
+{
+    rule->rule->reset();
+}
+
+PredictionStoppingDecision predictionStoppingRuleAddWindow(PredictionStoppingRule *rule, const float *probabilities)
+{
+    return rule->rule->addWindow(probabilities);
+}
+
+PredictionStoppingDecision predictionStoppingRuleDecision(PredictionStoppingRule *rule)
+{
+    return rule->rule->decision;
+}
+
+int predictionStoppingRuleWindowCount(PredictionStoppingRule *rule)
+{
+    return rule->rule->windowCount;
+}
+
+int predictionStoppingRuleTopClass(PredictionStoppingRule *rule)
+{
+    return rule->rule->topClass();
+}
+
+float predictionStoppingRuleConfidence(PredictionStoppingRule *rule)
+{
+    return rule->rule->confidence();
+}
+
+void predictionStoppingRuleEvaluate(PredictionStoppingRule *rule, const float *windows, const int *windowCounts, const int *labels, int sessionCount, PredictionStoppingRuleEvaluation *evaluation)
+{
+    Rule *r = rule->rule;
+    PredictionStoppingRuleEvaluation result = {0, 0, 0, 0};
+    long totalWindowCount = 0;
+
+    const float *session = windows;
+    for (int i = 0; i < sessionCount; i++) {
+        r->reset();
+        for (int w = 0; w < windowCounts[i] && r->addWindow(session + w * r->classCount) == PredictionStoppingDecisionContinue; w++) {}
+
+        totalWindowCount += r->windowCount;
+        if (r->decision == PredictionStoppingDecisionDecided) {
+            result.decidedCount++;
+            if (r->topClass() == labels[i]) {
+                result.decidedCorrectCount++;
+            }
+        }
+        result.sessionCount++;
+        session += windowCounts[i] * r->classCount;
+    }
+    r->reset();
+
+    result.meanWindowCount = sessionCount > 0 ? (double)totalWindowCount / sessionCount : 0;
+    *evaluation = result;
+}
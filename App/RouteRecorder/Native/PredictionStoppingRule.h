@@ -0,0 +1,66 @@
+//
+//  PredictionStoppingRule.h
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#ifndef PredictionStoppingRule_h
+#define PredictionStoppingRule_h
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    typedef enum PredictionStoppingDecision {
+        PredictionStoppingDecisionContinue = 0,
+        PredictionStoppingDecisionDecided,   // the top class is settled
+        PredictionStoppingDecisionUndecided, // out of windows without settling on a class
+    } PredictionStoppingDecision;
+
+    // Decides when a prediction session has seen enough windows. Each window is a probability for every class,
+    // indexed by class, and classes missing from a window's prediction are zero. Not thread safe.
+    typedef struct PredictionStoppingRule PredictionStoppingRule;
+
+    // Stops once more than minimumWindowCount windows have a mean top class confidence above confidenceThreshold.
+    PredictionStoppingRule *createFixedPredictionStoppingRule(int classCount, int minimumWindowCount, int maximumWindowCount, float confidenceThreshold);
+
+    // Multi-hypothesis sequential probability ratio test: treats each window's probabilities as the likelihood of
+    // each class, and stops as soon as the top class's posterior reaches 1 - errorRate, which is Wald's test
+    // between it and all the others together. Overlapping windows share most of their samples, so each window only
+    // counts for evidenceWeight of an independent observation. Probabilities are floored at probabilityFloor so
+    // one window that misses a class can't rule it out.
+    PredictionStoppingRule *createSequentialPredictionStoppingRule(int classCount, int minimumWindowCount, int maximumWindowCount, float errorRate, float evidenceWeight, float probabilityFloor);
+
+    void deletePredictionStoppingRule(PredictionStoppingRule *rule);
+    void predictionStoppingRuleReset(PredictionStoppingRule *rule);
+
+    // probabilities holds classCount values. Once the rule has stopped, further windows are ignored.
+    PredictionStoppingDecision predictionStoppingRuleAddWindow(PredictionStoppingRule *rule, const float *probabilities);
+
+    PredictionStoppingDecision predictionStoppingRuleDecision(PredictionStoppingRule *rule);
+    int predictionStoppingRuleWindowCount(PredictionStoppingRule *rule);
+
+    // The leading class, and the rule's confidence in it: the mean confidence for the fixed rule, the posterior
+    // for the sequential one.
+    int predictionStoppingRuleTopClass(PredictionStoppingRule *rule);
+    float predictionStoppingRuleConfidence(PredictionStoppingRule *rule);
+
+    typedef struct PredictionStoppingRuleEvaluation {
+        int sessionCount;
+        int decidedCount;        // sessions the rule stopped on with a decision
+        int decidedCorrectCount; // of those, the ones whose top class matched the label
+        double meanWindowCount;  // windows read before stopping, or the whole session if the rule never did
+    } PredictionStoppingRuleEvaluation;
+
+    // Replays recorded sessions through the rule, resetting it before each one. Session i has windowCounts[i]
+    // windows of classCount probabilities, laid end to end after the previous session's in windows, and
+    // labels[i] is the class it should decide on. A session that runs out of recorded windows before the rule stops
+    // counts as undecided.
+    void predictionStoppingRuleEvaluate(PredictionStoppingRule *rule, const float *windows, const int *windowCounts, const int *labels, int sessionCount, PredictionStoppingRuleEvaluation *evaluation);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PredictionStoppingRule_h */
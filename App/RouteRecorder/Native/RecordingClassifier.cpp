@@ -0,0 +1,439 @@
+//
+//  RecordingClassifier.cpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#include "RecordingClassifier.h"
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+    const int inFlightChunkCountPerWorker = 2;
+
+    struct Chunk {
+        long index;
+        double startTime;
+        bool startsAfterGap;
+        std::vector<AccelerometerSample> samples; // times relative to startTime
+
+        // filled in by a worker
+        std::vector<double> windowStartTimes;
+        std::vector<float> probabilities; // classCount per window, all zero for a window that spans a gap
+        int scoredWindowCount;
+    };
+
+    struct Run {
+        int activityClass;
+        double startTime;
+        double endTime;
+        double confidenceSum;
+        int windowCount;
+    };
+
+    float magnitudeStandardDeviation(const AccelerometerSample *samples, int count)
+    {
+        double sum = 0;
+        double sumOfSquares = 0;
+        for (int i = 0; i < count; i++) {
+            double magnitude = std::sqrt(samples[i].x * samples[i].x + samples[i].y * samples[i].y + samples[i].z * samples[i].z);
+            sum += magnitude;
+            sumOfSquares += magnitude * magnitude;
+        }
+        double mean = sum / count;
+
+        return (float)std::sqrt(std::max(sumOfSquares / count - mean * mean, 0.0));
+    }
+}
+
+struct RecordingClassifier {
+    RecordingClassifier(const RecordingClassifierConfiguration &configuration, RecordingWindowScorer scorer, void *context);
+    ~RecordingClassifier();
+
+    void work(int workerIndex);
+    void score(Chunk *chunk, int workerIndex, SpectralAnalyzer *analyzer, std::vector<SpectralFeatures> &features);
+
+    Chunk *freeChunk(std::unique_lock<std::mutex> &lock);
+    void submit(Chunk *chunk);
+    void drain(std::unique_lock<std::mutex> &lock);
+    void addWindow(double startTime, const float *probabilities);
+    void closeRun();
+
+    const RecordingClassifierConfiguration configuration;
+    const RecordingWindowScorer scorer;
+    void *const context;
+    const int chunkCapacity; // samples for chunkWindowCount windows
+    const int inFlightLimit;
+
+    // the chunk being filled, only touched by the appending thread
+    Chunk *filling;
+    double lastSampleTime;
+    bool isFinished;
+    long nextChunkIndex;
+
+    // shared with the workers
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::vector<Chunk *> pending; // waiting for a worker, oldest first
+    std::map<long, Chunk *> scored;
+    std::vector<Chunk *> recycled;
+    std::vector<Chunk *> allChunks;
+    std::vector<std::thread> workers;
+    int inFlightCount;
+    bool isStopping;
+    RecordingClassifierStatistics statistics;
+
+    // the timeline, built in chunk order by the appending thread
+    long nextDrainIndex;
+    Run run;
+    bool hasRun;
+    bool breaksBeforeRun;
+    std::vector<RecordingSegment> segments;
+    std::vector<float> segmentConfidenceSums; // parallel to segments
+};
+
+RecordingClassifier::RecordingClassifier(const RecordingClassifierConfiguration &configuration, RecordingWindowScorer scorer, void *context)
+: configuration(configuration), scorer(scorer), context(context),
+chunkCapacity((configuration.chunkWindowCount - 1) * configuration.windowOffsetSampleCount + configuration.windowSampleCount),
+inFlightLimit(configuration.workerCount * inFlightChunkCountPerWorker), filling(NULL), lastSampleTime(-INFINITY), isFinished(false),
+nextChunkIndex(0), inFlightCount(0), isStopping(false), nextDrainIndex(0), hasRun(false), breaksBeforeRun(false)
+{
+    statistics = {0, 0, 0, 0, 0, 0};
+    run = {0, 0, 0, 0, 0};
+
+    for (int i = 0; i < configuration.workerCount; i++) {
+        workers.push_back(std::thread(&RecordingClassifier::work, this, i));
+    }
+}
+
+RecordingClassifier::~RecordingClassifier()
+{
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        isStopping = true;
+    }
+    condition.notify_all();
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+
+    for (size_t i = 0; i < allChunks.size(); i++) {
+        delete allChunks[i];
+    }
+}
+
+void RecordingClassifier::work(int workerIndex)
+{
+    SpectralAnalyzer *analyzer = configuration.computesSpectralFeatures ? createSpectralAnalyzer(configuration.sampleRate, configuration.windowSampleCount) : NULL;
+    std::vector<SpectralFeatures> features(SpectralChannelCount);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        condition.wait(lock, [this] { return isStopping || !pending.empty(); });
+        if (pending.empty()) {
+            break;
+        }
+
+        Chunk *chunk = pending.front();
+        pending.erase(pending.begin());
+
+        lock.unlock();
+        score(chunk, workerIndex, analyzer, features);
+        lock.lock();
+
+        scored[chunk->index] = chunk;
+        statistics.scoredWindowCount += chunk->scoredWindowCount;
+        condition.notify_all();
+    }
+
+    if (analyzer != NULL) {
+        deleteSpectralAnalyzer(analyzer);
+    }
+}
+
+void RecordingClassifier::score(Chunk *chunk, int workerIndex, SpectralAnalyzer *analyzer, std::vector<SpectralFeatures> &features)
+{
+    const int classCount = configuration.classCount;
+    const int windowSampleCount = configuration.windowSampleCount;
+    const float maximumWindowSpan = (windowSampleCount + 1) / configuration.sampleRate;
+    const int sampleCount = (int)chunk->samples.size();
+
+    chunk->windowStartTimes.clear();
+    chunk->probabilities.clear();
+    chunk->scoredWindowCount = 0;
+
+    for (int start = 0; start + windowSampleCount <= sampleCount; start += configuration.windowOffsetSampleCount) {
+        const AccelerometerSample *samples = chunk->samples.data() + start;
+        chunk->windowStartTimes.push_back(chunk->startTime + samples[0].t);
+        chunk->probabilities.resize(chunk->probabilities.size() + classCount, 0);
+        float *probabilities = chunk->probabilities.data() + chunk->probabilities.size() - classCount;
+
+        if (samples[windowSampleCount - 1].t - samples[0].t > maximumWindowSpan) {
+            continue;
+        }
+
+        if (configuration.stationaryClass >= 0 && magnitudeStandardDeviation(samples, windowSampleCount) < configuration.stationaryThreshold) {
+            probabilities[configuration.stationaryClass] = 1;
+            continue;
+        }
+
+        if (analyzer != NULL) {
+            spectralAnalyzerCompute(analyzer, samples, windowSampleCount, features.data());
+        }
+        scorer(context, workerIndex, chunk->windowStartTimes.back(), samples, windowSampleCount, analyzer != NULL ? features.data() : NULL, probabilities);
+        chunk->scoredWindowCount++;
+    }
+}
+
+Chunk *RecordingClassifier::freeChunk(std::unique_lock<std::mutex> &lock)
+{
+    // the oldest chunk in flight may still be with a worker, so drain as the workers catch up
+    drain(lock);
+    while (inFlightCount >= inFlightLimit) {
+        condition.wait(lock);
+        drain(lock);
+    }
+
+    Chunk *chunk;
+    if (recycled.empty()) {
+        chunk = new Chunk();
+        chunk->samples.reserve(chunkCapacity);
+        allChunks.push_back(chunk);
+    } else {
+        chunk = recycled.back();
+        recycled.pop_back();
+    }
+
+    chunk->index = nextChunkIndex++;
+    chunk->startsAfterGap = false;
+    chunk->samples.clear();
+    return chunk;
+}
+
+void RecordingClassifier::submit(Chunk *chunk)
+{
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        pending.push_back(chunk);
+        inFlightCount++;
+        statistics.chunkCount++;
+    }
+    condition.notify_all();
+}
+
+void RecordingClassifier::drain(std::unique_lock<std::mutex> &lock)
+{
+    while (true) {
+        std::map<long, Chunk *>::iterator next = scored.find(nextDrainIndex);
+        if (next == scored.end()) {
+            return;
+        }
+        Chunk *chunk = next->second;
+        scored.erase(next);
+
+        lock.unlock();
+        if (chunk->startsAfterGap) {
+            closeRun();
+            breaksBeforeRun = true;
+        }
+        for (size_t i = 0; i < chunk->windowStartTimes.size(); i++) {
+            addWindow(chunk->windowStartTimes[i], chunk->probabilities.data() + i * configuration.classCount);
+        }
+        lock.lock();
+
+        statistics.windowCount += (int)chunk->windowStartTimes.size();
+        recycled.push_back(chunk);
+        inFlightCount--;
+        nextDrainIndex++;
+    }
+}
+
+void RecordingClassifier::addWindow(double startTime, const float *probabilities)
+{
+    int activityClass = (int)(std::max_element(probabilities, probabilities + configuration.classCount) - probabilities);
+    float confidence = probabilities[activityClass];
+    if (confidence <= 0) {
+        // spans a gap in the samples, so it says nothing
+        return;
+    }
+
+    double endTime = startTime + configuration.windowOffsetSampleCount / configuration.sampleRate;
+    if (hasRun && run.activityClass == activityClass) {
+        run.endTime = endTime;
+        run.confidenceSum += confidence;
+        run.windowCount++;
+        return;
+    }
+
+    closeRun();
+    run = {activityClass, startTime, endTime, confidence, 1};
+    hasRun = true;
+}
+
+void RecordingClassifier::closeRun()
+{
+    if (!hasRun) {
+        return;
+    }
+    hasRun = false;
+
+    bool canJoin = !segments.empty() && !breaksBeforeRun;
+    breaksBeforeRun = false;
+
+    if (canJoin && segments.back().activityClass == run.activityClass) {
+        RecordingSegment &segment = segments.back();
+        segment.endTime = run.endTime;
+        segment.windowCount += run.windowCount;
+        segmentConfidenceSums.back() += run.confidenceSum;
+        segment.confidence = segmentConfidenceSums.back() / segment.windowCount;
+        return;
+    }
+
+    if (canJoin && run.endTime - run.startTime < configuration.minimumSegmentDuration) {
+        // a blip, so the segment before simply carries on through it
+        segments.back().endTime = run.endTime;
+        return;
+    }
+
+    RecordingSegment segment = {run.startTime, run.endTime, run.activityClass, (float)(run.confidenceSum / run.windowCount), run.windowCount};
+    if (canJoin && segments.back().endTime - segments.back().startTime < configuration.minimumSegmentDuration) {
+        // a blip before anything it could be folded into, so this segment takes it over instead
+        segment.startTime = segments.back().startTime;
+        segments.pop_back();
+        segmentConfidenceSums.pop_back();
+    }
+    segments.push_back(segment);
+    segmentConfidenceSums.push_back((float)run.confidenceSum);
+}
+
+RecordingClassifier *createRecordingClassifier(RecordingClassifierConfiguration configuration, RecordingWindowScorer scorer, void *context)
+{
+    if (scorer == NULL || configuration.sampleRate <= 0 || configuration.windowSampleCount <= 0 || configuration.classCount <= 0) {
+        return NULL;
+    }
+    configuration.windowOffsetSampleCount = std::max(configuration.windowOffsetSampleCount, 1);
+    configuration.chunkWindowCount = std::max(configuration.chunkWindowCount, 1);
+    configuration.workerCount = std::max(configuration.workerCount, 1);
+    if (configuration.stationaryClass >= configuration.classCount) {
+        configuration.stationaryClass = -1;
+    }
+
+    return new RecordingClassifier(configuration, scorer, context);
+}
+
+void deleteRecordingClassifier(RecordingClassifier *classifier)
+{
+    delete classifier;
+}
+
+void recordingClassifierAppend(RecordingClassifier *classifier, double referenceTime, const AccelerometerSample *samples, int count)
+{
+    if (classifier->isFinished) {
+        return;
+    }
+
+    const int chunkCapacity = classifier->chunkCapacity;
+    const int overlapStart = classifier->configuration.chunkWindowCount * classifier->configuration.windowOffsetSampleCount;
+
+    for (int i = 0; i < count; i++) {
+        double time = referenceTime + samples[i].t;
+        if (time < classifier->lastSampleTime) {
+            continue;
+        }
+
+        bool isAfterGap = time - classifier->lastSampleTime > classifier->configuration.maximumGap && classifier->lastSampleTime > -INFINITY;
+        if (isAfterGap && classifier->filling != NULL) {
+            classifier->submit(classifier->filling);
+            classifier->filling = NULL;
+        }
+        classifier->lastSampleTime = time;
+
+        if (classifier->filling == NULL) {
+            std::unique_lock<std::mutex> lock(classifier->mutex);
+            classifier->filling = classifier->freeChunk(lock);
+            lock.unlock();
+
+            classifier->filling->startTime = time;
+            classifier->filling->startsAfterGap = isAfterGap;
+            if (isAfterGap) {
+                std::lock_guard<std::mutex> guard(classifier->mutex);
+                classifier->statistics.gapCount++;
+            }
+        }
+
+        Chunk *chunk = classifier->filling;
+        AccelerometerSample sample = samples[i];
+        sample.t = (float)(time - chunk->startTime);
+        chunk->samples.push_back(sample);
+
+        if ((int)chunk->samples.size() == chunkCapacity) {
+            // the windows this chunk didn't get to start the next one
+            std::unique_lock<std::mutex> lock(classifier->mutex);
+            Chunk *next = classifier->freeChunk(lock);
+            lock.unlock();
+
+            next->startTime = chunk->startTime + chunk->samples[overlapStart].t;
+            for (int j = overlapStart; j < chunkCapacity; j++) {
+                AccelerometerSample overlap = chunk->samples[j];
+                overlap.t = (float)(chunk->startTime + overlap.t - next->startTime);
+                next->samples.push_back(overlap);
+            }
+            classifier->submit(chunk);
+            classifier->filling = next;
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(classifier->mutex);
+            classifier->statistics.sampleCount++;
+            classifier->statistics.peakBufferedSampleCount = std::max(classifier->statistics.peakBufferedSampleCount, (classifier->inFlightCount + 1) * chunkCapacity);
+        }
+    }
+}
+
+void recordingClassifierFinish(RecordingClassifier *classifier)
+{
+    if (classifier->isFinished) {
+        return;
+    }
+    classifier->isFinished = true;
+
+    if (classifier->filling != NULL) {
+        classifier->submit(classifier->filling);
+        classifier->filling = NULL;
+    }
+
+    std::unique_lock<std::mutex> lock(classifier->mutex);
+    classifier->drain(lock);
+    while (classifier->inFlightCount > 0) {
+        classifier->condition.wait(lock);
+        classifier->drain(lock);
+    }
+    lock.unlock();
+
+    classifier->closeRun();
+}
+
+int recordingClassifierSegmentCount(RecordingClassifier *classifier)
+{
+    return (int)classifier->segments.size();
+}
+
+int recordingClassifierCopySegments(RecordingClassifier *classifier, RecordingSegment *segments, int capacity)
+{
+    int count = std::min(capacity, (int)classifier->segments.size());
+    std::copy(classifier->segments.begin(), classifier->segments.begin() + count, segments);
+    return count;
+}
+
+RecordingClassifierStatistics recordingClassifierStatistics(RecordingClassifier *classifier)
+{
+    std::lock_guard<std::mutex> guard(classifier->mutex);
+    return classifier->statistics;
+}
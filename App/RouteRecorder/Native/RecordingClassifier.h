@@ -0,0 +1,85 @@
+//
+//  RecordingClassifier.h
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#ifndef RecordingClassifier_h
+#define RecordingClassifier_h
+
+#include <stdbool.h>
+
+#include "AccelerometerSample.h"
+#include "SpectralFeatures.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    typedef struct RecordingClassifierConfiguration {
+        float sampleRate;
+        int windowSampleCount;
+        int windowOffsetSampleCount;
+        int chunkWindowCount;           // windows handed to a worker at a time
+        int workerCount;
+        int classCount;
+        bool computesSpectralFeatures;  // for scorers that work from features rather than samples
+
+        // Windows whose magnitude has a standard deviation under stationaryThreshold (in g's) are taken to be
+        // stationaryClass without being scored. A stationaryClass of -1 scores every window.
+        int stationaryClass;
+        float stationaryThreshold;
+
+        float maximumGap;               // seconds between samples; a longer gap ends the segment it falls in
+        float minimumSegmentDuration;   // shorter runs of windows are folded into a neighbouring segment
+    } RecordingClassifierConfiguration;
+
+    // Fills probabilities, which has classCount zeroed entries, for one window. samples are the window's, with times
+    // relative to the start of its chunk. features is NULL unless computesSpectralFeatures, when it has
+    // SpectralChannelCount entries. Called on the workers' threads: concurrently for different workerIndex values,
+    // never for the same one.
+    typedef void (*RecordingWindowScorer)(void *context, int workerIndex, double windowStartTime, const AccelerometerSample *samples, int sampleCount, const SpectralFeatures *features, float *probabilities);
+
+    typedef struct RecordingSegment {
+        double startTime;
+        double endTime;
+        int activityClass;
+        float confidence; // mean probability of activityClass over the segment's own windows
+        int windowCount;
+    } RecordingSegment;
+
+    typedef struct RecordingClassifierStatistics {
+        long long sampleCount;
+        int windowCount;
+        int scoredWindowCount;  // the rest were still enough to call stationary, or spanned a gap
+        int chunkCount;
+        int gapCount;
+        int peakBufferedSampleCount; // in the chunk being filled and the chunks in flight
+    } RecordingClassifierStatistics;
+
+    // Classifies a long accelerometer recording, like hours of CMSensorRecorder history, into a timeline of activity
+    // segments. Samples are gathered into chunks of chunkWindowCount overlapping windows, and each chunk is scored on
+    // one of workerCount threads. Chunks are recycled and at most two per worker are in flight, so memory stays the
+    // same however long the recording is; only the timeline grows, one segment per change of activity.
+    // Not thread safe, apart from the scorer.
+    typedef struct RecordingClassifier RecordingClassifier;
+
+    RecordingClassifier *createRecordingClassifier(RecordingClassifierConfiguration configuration, RecordingWindowScorer scorer, void *context);
+    void deleteRecordingClassifier(RecordingClassifier *classifier); // waits for the workers to stop
+
+    // Samples must be in time order, each at referenceTime + t seconds. Blocks while the workers are behind.
+    void recordingClassifierAppend(RecordingClassifier *classifier, double referenceTime, const AccelerometerSample *samples, int count);
+
+    // Scores whatever is left and closes the last segment. Nothing can be appended after.
+    void recordingClassifierFinish(RecordingClassifier *classifier);
+
+    // Segments so far, in time order. The last one can still change until the recording is finished.
+    int recordingClassifierSegmentCount(RecordingClassifier *classifier);
+    int recordingClassifierCopySegments(RecordingClassifier *classifier, RecordingSegment *segments, int capacity);
+
+    RecordingClassifierStatistics recordingClassifierStatistics(RecordingClassifier *classifier);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RecordingClassifier_h */
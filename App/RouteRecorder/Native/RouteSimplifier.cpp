@@ -0,0 +1,396 @@
+//
+//  RouteSimplifier.cpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#include "RouteSimplifier.h"
+#include "VectorKernels.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace {
+    // what a stop or a start counts as, so that it wins over any distance
+    const double stopOrStartSpeedDifference = DBL_MAX;
+
+    class KeptBitmap {
+    public:
+        KeptBitmap(uint8_t *bytes, int locationCount) : bytes(bytes), count(0)
+        {
+            memset(bytes, 0, (locationCount + 7) / 8);
+        }
+
+        void keep(int index)
+        {
+            uint8_t bit = (uint8_t)(1 << (index % 8));
+            if ((bytes[index / 8] & bit) == 0) {
+                bytes[index / 8] |= bit;
+                count++;
+            }
+        }
+
+        bool isKept(int index) const { return (bytes[index / 8] & (1 << (index % 8))) != 0; }
+        int keptCount() const { return count; }
+
+    private:
+        uint8_t *bytes;
+        int count;
+    };
+}
+
+struct RouteSimplifier {
+    RouteSimplifier(double epsilon, double speedEpsilon, double minimumMovingSpeed, int lookaheadCount);
+
+    void append(const RouteSimplifierLocation *locations, int count);
+    void reset();
+    int simplify(uint8_t *keptBitmap);
+    RouteSimplificationError measureError(const uint8_t *keptBitmap) const;
+    void finish();
+
+    const double epsilon;
+    const double speedEpsilon;
+    const double minimumMovingSpeed;
+    const int lookaheadCount; // 0 for a whole-route simplifier
+
+    // the first location's, which the columns are relative to so they keep their precision as floats
+    double originTime;
+    double originLatitude;
+    double originLongitude;
+
+    std::vector<float> times;
+    std::vector<float> latitudes;
+    std::vector<float> longitudes;
+    std::vector<float> speeds;
+    std::vector<bool> isActiveGPS;
+
+    // For a streaming simplifier the columns start at the last location settled on, which is location firstIndex.
+    int appendedCount;
+    int firstIndex;
+    bool isFinished;
+    std::vector<int> settledIndexes;
+    std::vector<uint8_t> windowKeptBitmap;
+
+    // scratch for a stretch's interior locations, and the stretches still to be looked at
+    std::vector<float> distances;
+    std::vector<float> speedDifferences;
+    std::vector<std::pair<int, int>> ranges;
+
+private:
+    void simplifyRanges(int first, int last, KeptBitmap &kept);
+    void simplifyRange(int first, int last, KeptBitmap &kept);
+    void settle(bool finishing);
+};
+
+RouteSimplifier::RouteSimplifier(double epsilon, double speedEpsilon, double minimumMovingSpeed, int lookaheadCount) :
+epsilon(epsilon),
+speedEpsilon(speedEpsilon),
+minimumMovingSpeed(minimumMovingSpeed),
+lookaheadCount(lookaheadCount),
+originTime(0),
+originLatitude(0),
+originLongitude(0),
+appendedCount(0),
+firstIndex(0),
+isFinished(false)
+{
+}
+
+void RouteSimplifier::append(const RouteSimplifierLocation *locations, int count)
+{
+    if (count <= 0 || isFinished) {
+        return;
+    }
+    if (appendedCount == 0) {
+        originTime = locations[0].t;
+        originLatitude = locations[0].latitude;
+        originLongitude = locations[0].longitude;
+    }
+
+    for (int i = 0; i < count; i++) {
+        const RouteSimplifierLocation &location = locations[i];
+        times.push_back((float)(location.t - originTime));
+        latitudes.push_back((float)(location.latitude - originLatitude));
+        longitudes.push_back((float)(location.longitude - originLongitude));
+        speeds.push_back((float)location.speed);
+        isActiveGPS.push_back(location.isActiveGPS);
+        appendedCount++;
+
+        if (lookaheadCount > 0 && (int)times.size() > lookaheadCount) {
+            settle(false);
+        }
+    }
+}
+
+void RouteSimplifier::reset()
+{
+    times.clear();
+    latitudes.clear();
+    longitudes.clear();
+    speeds.clear();
+    isActiveGPS.clear();
+    appendedCount = 0;
+    firstIndex = 0;
+    isFinished = false;
+    settledIndexes.clear();
+}
+
+int RouteSimplifier::simplify(uint8_t *keptBitmap)
+{
+    const int count = (int)times.size();
+    KeptBitmap kept(keptBitmap, count);
+    if (count == 0) {
+        return 0;
+    }
+
+    simplifyRanges(0, count - 1, kept);
+    return kept.keptCount();
+}
+
+RouteSimplificationError RouteSimplifier::measureError(const uint8_t *keptBitmap) const
+{
+    RouteSimplificationError error = {0, 0, 0};
+    const int count = (int)times.size();
+
+    int previousKept = -1;
+    for (int i = 0; i < count; i++) {
+        if ((keptBitmap[i / 8] & (1 << (i % 8))) == 0) {
+            continue;
+        }
+
+        error.keptCount++;
+        if (previousKept >= 0) {
+            const double latitudeDelta = (double)latitudes[i] - latitudes[previousKept];
+            const double longitudeDelta = (double)longitudes[i] - longitudes[previousKept];
+            const double base = std::sqrt(latitudeDelta * latitudeDelta + longitudeDelta * longitudeDelta);
+            const double startSpeed = speeds[previousKept];
+            const double speedSlope = (speeds[i] - startSpeed) / ((double)times[i] - times[previousKept]);
+            const bool hasSpeeds = startSpeed >= 0 && speeds[i] >= 0 && std::isfinite(speedSlope);
+
+            for (int j = previousKept + 1; j < i; j++) {
+                if (base > 0) {
+                    const double area = std::fabs(longitudeDelta * ((double)latitudes[j] - latitudes[previousKept]) - latitudeDelta * ((double)longitudes[j] - longitudes[previousKept]));
+                    error.maximumDistance = std::max(error.maximumDistance, (float)(area / base));
+                }
+                if (hasSpeeds && speeds[j] >= 0) {
+                    const double expectedSpeed = startSpeed + speedSlope * ((double)times[j] - times[previousKept]);
+                    error.maximumSpeedDifference = std::max(error.maximumSpeedDifference, (float)std::fabs(expectedSpeed - speeds[j]));
+                }
+            }
+        }
+        previousKept = i;
+    }
+
+    return error;
+}
+
+void RouteSimplifier::finish()
+{
+    if (!isFinished) {
+        settle(true);
+        isFinished = true;
+    }
+}
+
+// Simplifies the window and settles on every location kept before the last stretch, which is left to grow with the
+// locations still to come. When the window is a single stretch, it's closed at the last location instead, so the
+// lookahead stays bounded.
+void RouteSimplifier::settle(bool finishing)
+{
+    const int count = (int)times.size();
+    if (count == 0) {
+        return;
+    }
+
+    windowKeptBitmap.resize((count + 7) / 8);
+    KeptBitmap kept(windowKeptBitmap.data(), count);
+    simplifyRanges(0, count - 1, kept);
+
+    int lastSettled = count - 1;
+    if (!finishing) {
+        lastSettled = count - 2;
+        while (lastSettled > 0 && !kept.isKept(lastSettled)) {
+            lastSettled--;
+        }
+        if (lastSettled == 0) {
+            lastSettled = count - 1;
+        }
+    }
+
+    // the window's first location was settled on by the last window, unless this is the first
+    for (int i = firstIndex == 0 ? 0 : 1; i <= lastSettled; i++) {
+        if (kept.isKept(i)) {
+            settledIndexes.push_back(firstIndex + i);
+        }
+    }
+
+    times.erase(times.begin(), times.begin() + lastSettled);
+    latitudes.erase(latitudes.begin(), latitudes.begin() + lastSettled);
+    longitudes.erase(longitudes.begin(), longitudes.begin() + lastSettled);
+    speeds.erase(speeds.begin(), speeds.begin() + lastSettled);
+    isActiveGPS.erase(isActiveGPS.begin(), isActiveGPS.begin() + lastSettled);
+    firstIndex += lastSettled;
+}
+
+void RouteSimplifier::simplifyRanges(int first, int last, KeptBitmap &kept)
+{
+    ranges.clear();
+    ranges.push_back(std::make_pair(first, last));
+    while (!ranges.empty()) {
+        std::pair<int, int> range = ranges.back();
+        ranges.pop_back();
+        simplifyRange(range.first, range.second, kept);
+    }
+}
+
+void RouteSimplifier::simplifyRange(int first, int last, KeptBitmap &kept)
+{
+    if (last - first < 2) {
+        kept.keep(first);
+        kept.keep(last);
+        return;
+    }
+
+    const int interiorCount = last - first - 1;
+    const int interior = first + 1;
+    if ((int)distances.size() < interiorCount) {
+        distances.resize(interiorCount);
+        speedDifferences.resize(interiorCount);
+    }
+
+    // twice the area of the triangle each location makes with the ends, which is the distance from the line between
+    // them times its length
+    const double latitudeDelta = (double)latitudes[last] - latitudes[first];
+    const double longitudeDelta = (double)longitudes[last] - longitudes[first];
+    const double base = std::sqrt(latitudeDelta * latitudeDelta + longitudeDelta * longitudeDelta);
+    vectorKernelsAbsLinear(&longitudes[interior], &latitudes[interior], (float)-latitudeDelta, (float)longitudeDelta,
+                           (float)(latitudeDelta * longitudes[first] - longitudeDelta * latitudes[first]), distances.data(), interiorCount);
+
+    // how far each speed is from the one interpolated between the ends
+    const double startSpeed = speeds[first];
+    const double endSpeed = speeds[last];
+    const bool hasSpeeds = startSpeed >= 0 && endSpeed >= 0;
+    if (hasSpeeds) {
+        const double speedSlope = (endSpeed - startSpeed) / ((double)times[last] - times[first]);
+        if (std::isfinite(speedSlope)) {
+            vectorKernelsAbsLinear(&times[interior], &speeds[interior], (float)speedSlope, -1.0f,
+                                   (float)(startSpeed - speedSlope * times[first]), speedDifferences.data(), interiorCount);
+        } else {
+            // the ends are at the same time, so there's no speed to expect
+            std::fill(speedDifferences.begin(), speedDifferences.begin() + interiorCount, NAN);
+        }
+    }
+
+    double maximumArea = 0;
+    int indexOfMaximumDistance = 0;
+    double maximumSpeedDifference = 0;
+    int indexOfMaximumSpeedDifference = 0;
+    bool currentlyStopped = startSpeed >= 0 && startSpeed < minimumMovingSpeed;
+    for (int i = 0; i < interiorCount; i++) {
+        if (distances[i] > maximumArea) {
+            indexOfMaximumDistance = interior + i;
+            maximumArea = distances[i];
+        }
+
+        const float speed = speeds[interior + i];
+        if (hasSpeeds && speed >= 0) {
+            if (speedDifferences[i] > maximumSpeedDifference) {
+                indexOfMaximumSpeedDifference = interior + i;
+                maximumSpeedDifference = speedDifferences[i];
+            } else if (!currentlyStopped && speed < minimumMovingSpeed) {
+                currentlyStopped = true;
+                indexOfMaximumSpeedDifference = interior + i;
+                maximumSpeedDifference = stopOrStartSpeedDifference;
+            } else if (currentlyStopped && speed >= minimumMovingSpeed) {
+                currentlyStopped = false;
+                indexOfMaximumSpeedDifference = interior + i;
+                maximumSpeedDifference = stopOrStartSpeedDifference;
+            }
+        }
+    }
+
+    // ends in the same place leave no line to measure from
+    const double maximumDistance = base > 0 ? maximumArea / base : 0;
+
+    if (maximumDistance > epsilon || maximumSpeedDifference > speedEpsilon) {
+        int cutOffIndex = indexOfMaximumSpeedDifference;
+        if (maximumDistance > epsilon && maximumSpeedDifference < stopOrStartSpeedDifference) {
+            // If both conditions are met, we prefer to include points that affect the geometry
+            // – unless the speed difference is a stop or a start
+            cutOffIndex = indexOfMaximumDistance;
+        }
+        ranges.push_back(std::make_pair(cutOffIndex, last));
+        ranges.push_back(std::make_pair(first, cutOffIndex));
+    } else {
+        kept.keep(first);
+        for (int i = first; i <= last; i++) {
+            // also include any non-GPS location, plus the first location following it
+            if (!isActiveGPS[i]) {
+                kept.keep(i);
+                if (i + 1 <= last) {
+                    kept.keep(i + 1);
+                }
+            }
+        }
+        kept.keep(last);
+    }
+}
+
+RouteSimplifier *createRouteSimplifier(double epsilon, double speedEpsilon, double minimumMovingSpeed)
+{
+    return new RouteSimplifier(epsilon, speedEpsilon, minimumMovingSpeed, 0);
+}
+
+RouteSimplifier *createStreamingRouteSimplifier(double epsilon, double speedEpsilon, double minimumMovingSpeed, int lookaheadCount)
+{
+    return new RouteSimplifier(epsilon, speedEpsilon, minimumMovingSpeed, std::max(lookaheadCount, 2));
+}
+
+void deleteRouteSimplifier(RouteSimplifier *simplifier)
+{
+    delete simplifier;
+}
+
+void routeSimplifierAppend(RouteSimplifier *simplifier, const RouteSimplifierLocation *locations, int count)
+{
+    simplifier->append(locations, count);
+}
+
+int routeSimplifierLocationCount(RouteSimplifier *simplifier)
+{
+    return simplifier->appendedCount;
+}
+
+void routeSimplifierReset(RouteSimplifier *simplifier)
+{
+    simplifier->reset();
+}
+
+int routeSimplifierSimplify(RouteSimplifier *simplifier, uint8_t *keptBitmap)
+{
+    return simplifier->simplify(keptBitmap);
+}
+
+RouteSimplificationError routeSimplifierMeasureError(RouteSimplifier *simplifier, const uint8_t *keptBitmap)
+{
+    return simplifier->measureError(keptBitmap);
+}
+
+int routeSimplifierReadSettled(RouteSimplifier *simplifier, int *indexes, int maximumCount)
+{
+    std::vector<int> &settledIndexes = simplifier->settledIndexes;
+    const int count = std::min(maximumCount, (int)settledIndexes.size());
+    std::copy(settledIndexes.begin(), settledIndexes.begin() + count, indexes);
+    settledIndexes.erase(settledIndexes.begin(), settledIndexes.begin() + count);
+    return count;
+}
+
+void routeSimplifierFinish(RouteSimplifier *simplifier)
+{
+    simplifier->finish();
+}
@@ -0,0 +1,75 @@
+//
+//  RouteSimplifier.h
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#ifndef RouteSimplifier_h
+#define RouteSimplifier_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    typedef struct RouteSimplifierLocation {
+        double t;           // seconds, from any reference date
+        double latitude;
+        double longitude;
+        double speed;       // m/s, negative when unknown
+        bool isActiveGPS;   // anything else is always kept, along with the location after it
+    } RouteSimplifierLocation;
+
+    // How far the locations a simplification dropped are from the line between the kept locations either side of them,
+    // in degrees, and from the speed interpolated between them, in m/s.
+    typedef struct RouteSimplificationError {
+        int keptCount;
+        float maximumDistance;
+        float maximumSpeedDifference;
+    } RouteSimplificationError;
+
+    // Ramer–Douglas–Peucker over a route's locations, splitting where a location is further than epsilon (in degrees)
+    // from the line between the ends of a stretch, or where its speed is further than speedEpsilon from the speed
+    // interpolated between them. A stop or a start, by minimumMovingSpeed, always splits. Locations are packed into
+    // float columns relative to the first one, and stretches are worked through with an explicit stack of index
+    // ranges, so nothing is copied however deep the split goes.
+    // Not thread safe.
+    typedef struct RouteSimplifier RouteSimplifier;
+
+    RouteSimplifier *createRouteSimplifier(double epsilon, double speedEpsilon, double minimumMovingSpeed);
+
+    // Settles on the locations to keep while they're being appended, looking no more than lookaheadCount locations
+    // past the last one kept, so a route can be simplified as it's recorded and only the lookahead is left at the end.
+    // Each stretch between kept locations is held to the same epsilons as a whole-route simplification, but the
+    // lookahead costs an extra kept location wherever a stretch would have run longer than it.
+    RouteSimplifier *createStreamingRouteSimplifier(double epsilon, double speedEpsilon, double minimumMovingSpeed, int lookaheadCount);
+
+    void deleteRouteSimplifier(RouteSimplifier *simplifier);
+
+    // Locations must be appended in date order.
+    void routeSimplifierAppend(RouteSimplifier *simplifier, const RouteSimplifierLocation *locations, int count);
+    int routeSimplifierLocationCount(RouteSimplifier *simplifier); // every location ever appended
+    void routeSimplifierReset(RouteSimplifier *simplifier);
+
+    // Simplifies everything appended, setting bit i % 8 of keptBitmap[i / 8] for each location i that's kept. keptBitmap
+    // must have room for (locationCount + 7) / 8 bytes. Returns the number of locations kept.
+    // Not for a streaming simplifier.
+    int routeSimplifierSimplify(RouteSimplifier *simplifier, uint8_t *keptBitmap);
+
+    // Measures a simplification of everything appended, such as a streaming simplifier's, given as a keptBitmap.
+    // Not for a streaming simplifier.
+    RouteSimplificationError routeSimplifierMeasureError(RouteSimplifier *simplifier, const uint8_t *keptBitmap);
+
+    // Reads up to maximumCount indexes, in append order, of the locations a streaming simplifier has settled on keeping
+    // since the last read. Returns the number read.
+    int routeSimplifierReadSettled(RouteSimplifier *simplifier, int *indexes, int maximumCount);
+
+    // Settles the rest of a streaming simplifier's lookahead, ready to be read. Nothing can be appended after.
+    void routeSimplifierFinish(RouteSimplifier *simplifier);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RouteSimplifier_h */
@@ -0,0 +1,191 @@
+//
+//  SpectralFeatures.cpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#include "SpectralFeatures.h"
+#include "VectorKernels.h"
+
+#include <opencv2/core.hpp>
+#include <opencv2/core/hal/hal.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+namespace {
+    const float kBandEdges[SpectralFeaturesBandCount + 1] = {0.5f, 1.5f, 3.0f, 6.0f, FLT_MAX};
+
+    // below this much power (in g^2) the distribution features are meaningless and are left at zero
+    const float kMinimumPower = 1e-8f;
+}
+
+struct SpectralAnalyzer {
+    SpectralAnalyzer(float sampleRate, int windowSampleCount);
+
+    void compute(const AccelerometerSample *samples, int sampleCount, SpectralFeatures *features);
+
+private:
+    float sampleRate;
+    int windowSampleCount;
+    int binCount; // one-sided, including DC
+    std::vector<float> window;
+    float windowPower;
+
+    // channel-major scratch so every kernel runs over contiguous memory
+    std::vector<float> channels;
+    std::vector<float> real;
+    std::vector<float> imaginary;
+    std::vector<float> powers;
+    std::vector<float> logPowers;
+    cv::Mat signal;
+    cv::Mat spectrum;
+};
+
+SpectralAnalyzer::SpectralAnalyzer(float sampleRate, int windowSampleCount)
+    : sampleRate(sampleRate), windowSampleCount(windowSampleCount)
+{
+    int dftSize = cv::getOptimalDFTSize(windowSampleCount);
+    binCount = dftSize / 2 + 1;
+
+    window.resize(windowSampleCount);
+    windowPower = 0;
+    for (int i = 0; i < windowSampleCount; i++) {
+        window[i] = 0.5f - 0.5f * std::cos(2.0f * (float)M_PI * i / (windowSampleCount - 1));
+        windowPower += window[i] * window[i];
+    }
+
+    channels.resize(SpectralChannelCount * windowSampleCount);
+    real.resize(binCount);
+    imaginary.resize(binCount);
+    powers.resize(SpectralChannelCount * binCount);
+    logPowers.resize(SpectralChannelCount * binCount);
+    signal = cv::Mat::zeros(SpectralChannelCount, dftSize, CV_32F);
+}
+
+void SpectralAnalyzer::compute(const AccelerometerSample *samples, int sampleCount, SpectralFeatures *features)
+{
+    int n = std::min(sampleCount, windowSampleCount);
+    float *x = &channels[SpectralChannelX * windowSampleCount];
+    float *y = &channels[SpectralChannelY * windowSampleCount];
+    float *z = &channels[SpectralChannelZ * windowSampleCount];
+    float *magnitude = &channels[SpectralChannelMagnitude * windowSampleCount];
+
+    for (int i = 0; i < n; i++) {
+        x[i] = samples[i].x;
+        y[i] = samples[i].y;
+        z[i] = samples[i].z;
+    }
+    vectorKernelsMagnitude3(x, y, z, magnitude, n);
+
+    for (int c = 0; c < SpectralChannelCount; c++) {
+        const float *channel = &channels[c * windowSampleCount];
+        float mean = (n > 0) ? vectorKernelsSum(channel, n) / n : 0;
+
+        float *row = signal.ptr<float>(c);
+        vectorKernelsSubtractAndMultiply(channel, mean, &window[0], row, n);
+        std::fill(row + n, row + signal.cols, 0.0f);
+    }
+
+    cv::dft(signal, spectrum, cv::DFT_ROWS);
+
+    // unpack each row's CCS spectrum into a contiguous one-sided power spectrum
+    int dftSize = spectrum.cols;
+    for (int c = 0; c < SpectralChannelCount; c++) {
+        const float *packed = spectrum.ptr<float>(c);
+        real[0] = packed[0];
+        imaginary[0] = 0;
+        for (int k = 1; k < binCount; k++) {
+            real[k] = packed[2 * k - 1];
+            imaginary[k] = (2 * k < dftSize) ? packed[2 * k] : 0; // the nyquist bin of an even size is real
+        }
+
+        float *power = &powers[c * binCount];
+        cv::hal::magnitude32f(&real[0], &imaginary[0], power, binCount);
+        vectorKernelsSquare(power, power, binCount, FLT_MIN); // the floor keeps log defined for empty bins
+    }
+
+    // one pass over every bin of every channel
+    cv::hal::log32f(&powers[0], &logPowers[0], SpectralChannelCount * binCount);
+
+    float binWidth = sampleRate / dftSize;
+    float meanLogPowers[SpectralChannelCount];
+    float geometricMeanPowers[SpectralChannelCount];
+    float totalPowers[SpectralChannelCount];
+
+    for (int c = 0; c < SpectralChannelCount; c++) {
+        const float *power = &powers[c * binCount];
+        const float *logPower = &logPowers[c * binCount];
+        SpectralFeatures &feature = features[c];
+
+        // DC is skipped, the mean was removed
+        float total = 0, weightedFrequency = 0, powerLogPower = 0, logPowerSum = 0;
+        float bands[SpectralFeaturesBandCount] = {0};
+        int band = 0;
+        for (int k = 1; k < binCount; k++) {
+            float frequency = k * binWidth;
+            total += power[k];
+            weightedFrequency += frequency * power[k];
+            powerLogPower += power[k] * logPower[k];
+            logPowerSum += logPower[k];
+
+            while (band < SpectralFeaturesBandCount && frequency >= kBandEdges[band + 1]) {
+                band++;
+            }
+            if (band < SpectralFeaturesBandCount && frequency >= kBandEdges[band]) {
+                bands[band] += power[k];
+            }
+        }
+
+        int bins = binCount - 1;
+        totalPowers[c] = total;
+        meanLogPowers[c] = logPowerSum / bins;
+
+        // parseval, counting the mirrored half of the spectrum
+        feature.power = (n > 0 && windowPower > 0) ? 2.0f * total / (dftSize * windowPower) : 0;
+
+        if (total < kMinimumPower || bins < 2) {
+            std::fill(feature.bandEnergies, feature.bandEnergies + SpectralFeaturesBandCount, 0.0f);
+            feature.centroid = 0;
+            feature.entropy = 0;
+            continue;
+        }
+
+        for (int b = 0; b < SpectralFeaturesBandCount; b++) {
+            feature.bandEnergies[b] = bands[b] / total;
+        }
+        feature.centroid = weightedFrequency / total;
+
+        // with p = P / total, -sum(p log p) = log(total) - sum(P log P) / total
+        float entropy = std::log(total) - powerLogPower / total;
+        feature.entropy = std::min(1.0f, std::max(0.0f, entropy / std::log((float)bins)));
+    }
+
+    cv::hal::exp32f(meanLogPowers, geometricMeanPowers, SpectralChannelCount);
+    for (int c = 0; c < SpectralChannelCount; c++) {
+        float arithmeticMean = totalPowers[c] / (binCount - 1);
+        features[c].flatness = (totalPowers[c] < kMinimumPower) ? 0 : std::min(1.0f, geometricMeanPowers[c] / arithmeticMean);
+    }
+}
+
+SpectralAnalyzer *createSpectralAnalyzer(float sampleRate, int windowSampleCount)
+{
+    if (sampleRate <= 0 || windowSampleCount < 4) {
+        return NULL;
+    }
+
+    return new SpectralAnalyzer(sampleRate, windowSampleCount);
+}
+
+void deleteSpectralAnalyzer(SpectralAnalyzer *analyzer)
+{
+    delete analyzer;
+}
+
+void spectralAnalyzerCompute(SpectralAnalyzer *analyzer, const AccelerometerSample *samples, int sampleCount, SpectralFeatures *features)
+{
+    analyzer->compute(samples, sampleCount, features);
+}
@@ -0,0 +1,48 @@
+//
+//  SpectralFeatures.h
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#ifndef SpectralFeatures_h
+#define SpectralFeatures_h
+
+#include "AccelerometerSample.h"
+
+#define SpectralFeaturesBandCount 4
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    // features are computed for x, y, z and the magnitude, in that order
+    typedef enum SpectralChannel {
+        SpectralChannelX = 0,
+        SpectralChannelY,
+        SpectralChannelZ,
+        SpectralChannelMagnitude,
+        SpectralChannelCount,
+    } SpectralChannel;
+
+    typedef struct SpectralFeatures {
+        float power; // mean square of the (windowed, mean removed) signal, in g^2
+        float bandEnergies[SpectralFeaturesBandCount]; // fraction of the power in 0.5-1.5, 1.5-3, 3-6 and 6hz-nyquist
+        float centroid; // hz
+        float entropy; // normalized, 0 for a pure tone to 1 for white noise
+        float flatness; // geometric over arithmetic mean of the power spectrum
+    } SpectralFeatures;
+
+    // Computes power spectrum features for all channels of a window in one pass: one row-wise cv::dft, then
+    // cv::hal magnitude/log/exp kernels over contiguous bins rather than scalar math per bin.
+    typedef struct SpectralAnalyzer SpectralAnalyzer;
+
+    SpectralAnalyzer *createSpectralAnalyzer(float sampleRate, int windowSampleCount);
+    void deleteSpectralAnalyzer(SpectralAnalyzer *analyzer);
+
+    // features must have room for SpectralChannelCount entries. Windows shorter than windowSampleCount are zero padded.
+    void spectralAnalyzerCompute(SpectralAnalyzer *analyzer, const AccelerometerSample *samples, int sampleCount, SpectralFeatures *features);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SpectralFeatures_h */
@@ -0,0 +1,178 @@
+//
+//  StationaryGate.cpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#include "StationaryGate.h"
+#include "VectorKernels.h"
+
+#include <opencv2/core/hal/intrin.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace cv;
+
+struct StationaryGate {
+    StationaryGate(int windowSampleCount, int holdSampleCount, float stationaryThreshold, float movingThreshold);
+
+    void reset();
+    StationaryGateState push(const AccelerometerSample *samples, int sampleCount);
+    float standardDeviation() const;
+
+private:
+    void append(float deviation);
+    void recomputeSums();
+
+    int windowSampleCount;
+    int holdSampleCount;
+    float stationaryThreshold;
+    float movingThreshold;
+
+    // magnitudes are stored as deviations from 1g so the running sums don't lose precision to gravity
+    std::vector<float> deviations;
+    int head;
+    int filledCount;
+    double sum;
+    double sumOfSquares;
+
+    int quietSampleCount;
+    StationaryGateState state;
+};
+
+StationaryGate::StationaryGate(int windowSampleCount, int holdSampleCount, float stationaryThreshold, float movingThreshold)
+    : windowSampleCount(windowSampleCount), holdSampleCount(holdSampleCount), stationaryThreshold(stationaryThreshold), movingThreshold(movingThreshold)
+{
+    deviations.resize(windowSampleCount);
+    reset();
+}
+
+void StationaryGate::reset()
+{
+    std::fill(deviations.begin(), deviations.end(), 0.0f);
+    head = 0;
+    filledCount = 0;
+    sum = 0;
+    sumOfSquares = 0;
+    quietSampleCount = 0;
+    state = StationaryGateStateUndetermined;
+}
+
+void StationaryGate::recomputeSums()
+{
+    // the incremental sums drift as samples are added and removed, so start over each time the ring wraps
+    float windowSum, windowSumOfSquares;
+    vectorKernelsSumAndSumOfSquares(&deviations[0], windowSampleCount, &windowSum, &windowSumOfSquares);
+
+    sum = windowSum;
+    sumOfSquares = windowSumOfSquares;
+}
+
+void StationaryGate::append(float deviation)
+{
+    if (filledCount == windowSampleCount) {
+        float evicted = deviations[head];
+        sum -= evicted;
+        sumOfSquares -= (double)evicted * evicted;
+    } else {
+        filledCount++;
+    }
+
+    deviations[head] = deviation;
+    sum += deviation;
+    sumOfSquares += (double)deviation * deviation;
+
+    head++;
+    if (head == windowSampleCount) {
+        head = 0;
+        recomputeSums();
+    }
+}
+
+float StationaryGate::standardDeviation() const
+{
+    if (filledCount < windowSampleCount) {
+        return -1.0f;
+    }
+
+    double mean = sum / windowSampleCount;
+    double variance = sumOfSquares / windowSampleCount - mean * mean;
+
+    return (float)std::sqrt(std::max(0.0, variance));
+}
+
+StationaryGateState StationaryGate::push(const AccelerometerSample *samples, int sampleCount)
+{
+    const v_float32x4 one = v_setall_f32(1.0f);
+    float batch[4];
+
+    for (int i = 0; i < sampleCount; i += 4) {
+        int batchCount = std::min(4, sampleCount - i);
+        if (batchCount == 4) {
+            v_float32x4 t, x, y, z;
+            v_load_deinterleave((const float *)(samples + i), t, x, y, z);
+            v_store(batch, v_sqrt(x * x + y * y + z * z) - one);
+        } else {
+            for (int j = 0; j < batchCount; j++) {
+                const AccelerometerSample &sample = samples[i + j];
+                batch[j] = std::sqrt(sample.x * sample.x + sample.y * sample.y + sample.z * sample.z) - 1.0f;
+            }
+        }
+
+        for (int j = 0; j < batchCount; j++) {
+            append(batch[j]);
+
+            float deviation = standardDeviation();
+            if (deviation < 0) {
+                continue;
+            }
+
+            if (deviation > movingThreshold) {
+                quietSampleCount = 0;
+                state = StationaryGateStateMoving;
+            } else if (deviation < stationaryThreshold) {
+                quietSampleCount++;
+                if (quietSampleCount >= holdSampleCount) {
+                    state = StationaryGateStateStationary;
+                }
+            } else {
+                // in the hysteresis band, hold whatever state we're in
+                quietSampleCount = 0;
+            }
+        }
+    }
+
+    return state;
+}
+
+StationaryGate *createStationaryGate(int windowSampleCount, int holdSampleCount, float stationaryThreshold, float movingThreshold)
+{
+    if (windowSampleCount <= 1 || stationaryThreshold > movingThreshold) {
+        return NULL;
+    }
+
+    return new StationaryGate(windowSampleCount, holdSampleCount, stationaryThreshold, movingThreshold);
+}
+
+void deleteStationaryGate(StationaryGate *gate)
+{
+    delete gate;
+}
+
+void stationaryGateReset(StationaryGate *gate)
+{
+    gate->reset();
+}
+
+StationaryGateState stationaryGatePush(StationaryGate *gate, const AccelerometerSample *samples, int sampleCount)
+{
+    return gate->push(samples, sampleCount);
+}
+
+float stationaryGateStandardDeviation(StationaryGate *gate)
+{
+    return gate->standardDeviation();
+}
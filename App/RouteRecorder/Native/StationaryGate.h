@@ -0,0 +1,40 @@
+//
+//  StationaryGate.h
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#ifndef StationaryGate_h
+#define StationaryGate_h
+
+#include "AccelerometerSample.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    typedef enum StationaryGateState {
+        StationaryGateStateUndetermined = 0,
+        StationaryGateStateMoving,
+        StationaryGateStateStationary,
+    } StationaryGateState;
+
+    // Tracks the running variance of the acceleration magnitude over a sliding window of raw samples.
+    // The gate only reports stationary after the standard deviation has stayed below stationaryThreshold
+    // for holdSampleCount samples, and only leaves it once it rises above movingThreshold.
+    typedef struct StationaryGate StationaryGate;
+
+    StationaryGate *createStationaryGate(int windowSampleCount, int holdSampleCount, float stationaryThreshold, float movingThreshold);
+    void deleteStationaryGate(StationaryGate *gate);
+    void stationaryGateReset(StationaryGate *gate);
+
+    // returns the state after the last of the samples has been considered
+    StationaryGateState stationaryGatePush(StationaryGate *gate, const AccelerometerSample *samples, int sampleCount);
+
+    // standard deviation of the magnitude over the current window, in g's. Negative until the window has filled.
+    float stationaryGateStandardDeviation(StationaryGate *gate);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* StationaryGate_h */
@@ -0,0 +1,210 @@
+//
+//  TimeSeriesJoin.cpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#include "TimeSeriesJoin.h"
+
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <vector>
+
+namespace {
+    struct Sample {
+        double t;
+        float value;
+    };
+
+    struct Stream {
+        Stream() : method(TimeSeriesJoinMethodPrevious), tolerance(INFINITY), lastTime(-INFINITY), isFinished(false) {}
+
+        bool isReady(double key) const
+        {
+            // a sample could still arrive at the key's time, so it takes one past it. Only a mean needs every sample
+            // in the tolerance; the other methods just need the first one after the key.
+            return isFinished || lastTime > (method == TimeSeriesJoinMethodMean ? key + tolerance : key);
+        }
+
+        float valueAt(double key) const;
+
+        TimeSeriesJoinMethod method;
+        double tolerance;
+        std::deque<Sample> samples; // none earlier than the oldest pending key's tolerance
+        double lastTime;
+        bool isFinished;
+    };
+
+    float Stream::valueAt(double key) const
+    {
+        const float missing = std::numeric_limits<float>::quiet_NaN();
+
+        // samples are few per key once trimmed, so a scan from the front is cheaper than a search
+        size_t after = 0;
+        while (after < samples.size() && samples[after].t <= key) {
+            after++;
+        }
+        const Sample *previous = after > 0 ? &samples[after - 1] : NULL;
+        const Sample *next = after < samples.size() ? &samples[after] : NULL;
+        if (previous && key - previous->t > tolerance) {
+            previous = NULL;
+        }
+        if (next && next->t - key > tolerance) {
+            next = NULL;
+        }
+
+        switch (method) {
+            case TimeSeriesJoinMethodPrevious:
+                return previous ? previous->value : missing;
+            case TimeSeriesJoinMethodNearest:
+                if (previous && next) {
+                    return key - previous->t <= next->t - key ? previous->value : next->value;
+                }
+                return previous ? previous->value : next ? next->value : missing;
+            case TimeSeriesJoinMethodLinear:
+                if (previous && next) {
+                    if (previous->t == key) {
+                        return previous->value;
+                    }
+                    double fraction = (key - previous->t) / (next->t - previous->t);
+                    return (float)(previous->value + fraction * (next->value - previous->value));
+                }
+                return previous ? previous->value : next ? next->value : missing;
+            case TimeSeriesJoinMethodMean: {
+                double sum = 0;
+                int count = 0;
+                for (size_t i = 0; i < samples.size() && samples[i].t <= key + tolerance; i++) {
+                    if (samples[i].t >= key - tolerance) {
+                        sum += samples[i].value;
+                        count++;
+                    }
+                }
+                return count > 0 ? (float)(sum / count) : missing;
+            }
+        }
+        return missing;
+    }
+}
+
+struct TimeSeriesJoin {
+    TimeSeriesJoin(int streamCount) : streams(streamCount), lastKeyTime(-INFINITY) {}
+
+    void trim(double key);
+
+    std::vector<Stream> streams;
+    std::deque<double> keys;
+    double lastKeyTime;
+};
+
+void TimeSeriesJoin::trim(double key)
+{
+    for (size_t i = 0; i < streams.size(); i++) {
+        Stream &stream = streams[i];
+        if (stream.method == TimeSeriesJoinMethodMean) {
+            while (!stream.samples.empty() && stream.samples.front().t < key - stream.tolerance) {
+                stream.samples.pop_front();
+            }
+        } else {
+            // only the last sample at or before the key can matter to it or any later key
+            while (stream.samples.size() > 1 && stream.samples[1].t <= key) {
+                stream.samples.pop_front();
+            }
+        }
+    }
+}
+
+TimeSeriesJoin *createTimeSeriesJoin(int streamCount)
+{
+    return new TimeSeriesJoin(streamCount < 0 ? 0 : streamCount);
+}
+
+void deleteTimeSeriesJoin(TimeSeriesJoin *join)
+{
+    delete join;
+}
+
+void timeSeriesJoinConfigureStream(TimeSeriesJoin *join, int stream, TimeSeriesJoinMethod method, double tolerance)
+{
+    join->streams[stream].method = method;
+    join->streams[stream].tolerance = tolerance >= 0 ? tolerance : INFINITY;
+}
+
+bool timeSeriesJoinAppendSamples(TimeSeriesJoin *join, int stream, const double *times, const float *values, int count)
+{
+    Stream &target = join->streams[stream];
+    double lastTime = target.lastTime;
+    for (int i = 0; i < count; i++) {
+        if (!(times[i] >= lastTime)) {
+            return false;
+        }
+        lastTime = times[i];
+    }
+    if (target.isFinished && count > 0) {
+        return false;
+    }
+
+    // samples that no pending or later key can reach are never kept
+    double horizon = join->keys.empty() ? join->lastKeyTime : join->keys.front();
+    for (int i = 0; i < count; i++) {
+        if (target.method == TimeSeriesJoinMethodMean && times[i] < horizon - target.tolerance) {
+            continue;
+        }
+        Sample sample = {times[i], values[i]};
+        target.samples.push_back(sample);
+    }
+    target.lastTime = lastTime;
+    if (horizon > -INFINITY) {
+        join->trim(horizon);
+    }
+    return true;
+}
+
+void timeSeriesJoinFinishStream(TimeSeriesJoin *join, int stream)
+{
+    join->streams[stream].isFinished = true;
+}
+
+bool timeSeriesJoinAppendKeys(TimeSeriesJoin *join, const double *times, int count)
+{
+    double lastKeyTime = join->lastKeyTime;
+    for (int i = 0; i < count; i++) {
+        if (!(times[i] >= lastKeyTime)) {
+            return false;
+        }
+        lastKeyTime = times[i];
+    }
+
+    join->keys.insert(join->keys.end(), times, times + count);
+    join->lastKeyTime = lastKeyTime;
+    return true;
+}
+
+int timeSeriesJoinRead(TimeSeriesJoin *join, double *times, float *values, int maximumCount)
+{
+    size_t streamCount = join->streams.size();
+    int count = 0;
+    while (count < maximumCount && !join->keys.empty()) {
+        double key = join->keys.front();
+        for (size_t i = 0; i < streamCount; i++) {
+            if (!join->streams[i].isReady(key)) {
+                return count;
+            }
+        }
+
+        join->trim(key);
+        times[count] = key;
+        for (size_t i = 0; i < streamCount; i++) {
+            values[count * streamCount + i] = join->streams[i].valueAt(key);
+        }
+        join->keys.pop_front();
+        count++;
+    }
+    return count;
+}
+
+int timeSeriesJoinPendingKeyCount(TimeSeriesJoin *join)
+{
+    return (int)join->keys.size();
+}
@@ -0,0 +1,53 @@
+//
+//  TimeSeriesJoin.h
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#ifndef TimeSeriesJoin_h
+#define TimeSeriesJoin_h
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    typedef enum TimeSeriesJoinMethod {
+        TimeSeriesJoinMethodPrevious = 0, // the last sample at or before the key
+        TimeSeriesJoinMethodNearest,
+        TimeSeriesJoinMethodLinear,       // between the samples either side, or the nearest one past either end
+        TimeSeriesJoinMethodMean,         // of every sample within the tolerance either side
+    } TimeSeriesJoinMethod;
+
+    // As-of join of any number of sample streams onto a stream of key times, such as every location fix of a route.
+    // Each key gets one value per stream, taken only from samples within that stream's tolerance of it, or NaN if
+    // there aren't any. Keys and each stream's samples are appended in time order, in whatever batches they arrive,
+    // and a joined row can be read as soon as every stream has a sample past the key's tolerance or has finished.
+    // Samples are dropped once no later key can use them, so as long as keys are appended ahead of the samples,
+    // memory stays bounded by the tolerances rather than the length of the streams. Not thread safe.
+    typedef struct TimeSeriesJoin TimeSeriesJoin;
+
+    TimeSeriesJoin *createTimeSeriesJoin(int streamCount);
+    void deleteTimeSeriesJoin(TimeSeriesJoin *join);
+
+    // Streams default to TimeSeriesJoinMethodPrevious with an unlimited tolerance.
+    void timeSeriesJoinConfigureStream(TimeSeriesJoin *join, int stream, TimeSeriesJoinMethod method, double tolerance);
+
+    // Returns false without appending anything if the times aren't in order, or are earlier than what's been appended.
+    bool timeSeriesJoinAppendSamples(TimeSeriesJoin *join, int stream, const double *times, const float *values, int count);
+    void timeSeriesJoinFinishStream(TimeSeriesJoin *join, int stream);
+
+    bool timeSeriesJoinAppendKeys(TimeSeriesJoin *join, const double *times, int count);
+
+    // Reads up to maximumCount joined rows: the key's time into times[i], and its value for each stream into
+    // values[i * streamCount + stream]. Returns the number of rows read.
+    int timeSeriesJoinRead(TimeSeriesJoin *join, double *times, float *values, int maximumCount);
+
+    // Keys appended but not yet read.
+    int timeSeriesJoinPendingKeyCount(TimeSeriesJoin *join);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TimeSeriesJoin_h */
@@ -0,0 +1,110 @@
+//
+//  VectorKernels.cpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#include "VectorKernels.h"
+#include "VectorKernelsDispatch.hpp"
+
+#include <opencv2/core/hal/intrin.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+
+namespace baseline {
+    using namespace cv;
+
+    typedef v_float32x4 vfloat;
+    inline vfloat vx_load(const float *ptr) { return v_load(ptr); }
+    inline vfloat vx_setall(float value) { return v_setall_f32(value); }
+    inline vfloat vx_setzero() { return v_setzero_f32(); }
+
+    #include "VectorKernelsImpl.hpp"
+
+    const VectorKernelsTable table = VECTOR_KERNELS_TABLE;
+}
+
+namespace {
+    const VectorKernelsTable *tableForInstructionSet(VectorInstructionSet instructionSet)
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        if (instructionSet >= VectorInstructionSetAVX512 && vectorKernelsAVX512Table() != NULL && __builtin_cpu_supports("avx512f")) {
+            return vectorKernelsAVX512Table();
+        }
+        if (instructionSet >= VectorInstructionSetAVX2 && vectorKernelsAVX2Table() != NULL && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            return vectorKernelsAVX2Table();
+        }
+#endif
+        return &baseline::table;
+    }
+
+    // read from every thread that classifies. Picking the table twice on a race is harmless, since both threads
+    // pick the same one.
+    std::atomic<const VectorKernelsTable *> currentTable(NULL);
+
+    const VectorKernelsTable *kernels()
+    {
+        const VectorKernelsTable *table = currentTable.load(std::memory_order_acquire);
+        if (table == NULL) {
+            table = tableForInstructionSet(VectorInstructionSetAVX512);
+            currentTable.store(table, std::memory_order_release);
+        }
+        return table;
+    }
+}
+
+VectorInstructionSet vectorKernelsInstructionSet(void)
+{
+    const VectorKernelsTable *table = kernels();
+    if (table == vectorKernelsAVX512Table()) {
+        return VectorInstructionSetAVX512;
+    }
+    if (table == vectorKernelsAVX2Table()) {
+        return VectorInstructionSetAVX2;
+    }
+    return VectorInstructionSetBaseline;
+}
+
+VectorInstructionSet vectorKernelsSetInstructionSet(VectorInstructionSet instructionSet)
+{
+    currentTable.store(tableForInstructionSet(instructionSet), std::memory_order_release);
+    return vectorKernelsInstructionSet();
+}
+
+float vectorKernelsSum(const float *src, int count)
+{
+    return kernels()->sum(src, count);
+}
+
+void vectorKernelsSumAndSumOfSquares(const float *src, int count, float *sum, float *sumOfSquares)
+{
+    kernels()->sumAndSumOfSquares(src, count, sum, sumOfSquares);
+}
+
+void vectorKernelsMagnitude3(const float *x, const float *y, const float *z, float *dst, int count)
+{
+    kernels()->magnitude3(x, y, z, dst, count);
+}
+
+void vectorKernelsSquare(const float *src, float *dst, int count, float minimum)
+{
+    kernels()->square(src, dst, count, minimum);
+}
+
+void vectorKernelsSubtractAndMultiply(const float *src, float offset, const float *window, float *dst, int count)
+{
+    kernels()->subtractAndMultiply(src, offset, window, dst, count);
+}
+
+void vectorKernelsAbsLinear(const float *u, const float *v, float a, float b, float c, float *dst, int count)
+{
+    kernels()->absLinear(u, v, a, b, c, dst, count);
+}
+
+int vectorKernelsLessOrEqual(const float *values, const float *thresholds, float *dst, int count)
+{
+    return kernels()->lessOrEqual(values, thresholds, dst, count);
+}
@@ -0,0 +1,48 @@
+//
+//  VectorKernels.h
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#ifndef VectorKernels_h
+#define VectorKernels_h
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    typedef enum VectorInstructionSet {
+        VectorInstructionSetBaseline = 0, // 128-bit universal intrinsics: SSE2, NEON, or the scalar intrin_cpp fallback
+        VectorInstructionSetAVX2,
+        VectorInstructionSetAVX512,
+    } VectorInstructionSet;
+
+    // Float kernels shared by feature extraction and route simplification. Each is built once per instruction set
+    // and the widest one the CPU supports is picked the first time any kernel runs.
+    VectorInstructionSet vectorKernelsInstructionSet(void);
+
+    // Pins the kernels to an instruction set (or lower, if the CPU can't run it), for benchmarking. Returns the one in use.
+    VectorInstructionSet vectorKernelsSetInstructionSet(VectorInstructionSet instructionSet);
+
+    float vectorKernelsSum(const float *src, int count);
+    void vectorKernelsSumAndSumOfSquares(const float *src, int count, float *sum, float *sumOfSquares);
+
+    // dst = sqrt(x^2 + y^2 + z^2)
+    void vectorKernelsMagnitude3(const float *x, const float *y, const float *z, float *dst, int count);
+
+    // dst = max(src^2, minimum), dst may be src
+    void vectorKernelsSquare(const float *src, float *dst, int count, float minimum);
+
+    // dst = (src - offset) * window
+    void vectorKernelsSubtractAndMultiply(const float *src, float offset, const float *window, float *dst, int count);
+
+    // dst = |a * u + b * v + c|, such as the distances of points from a line, scaled by its length
+    void vectorKernelsAbsLinear(const float *u, const float *v, float a, float b, float c, float *dst, int count);
+
+    // dst = 1 where values <= thresholds, otherwise 0, as used by tree split tests. Returns the number of ones.
+    int vectorKernelsLessOrEqual(const float *values, const float *thresholds, float *dst, int count);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VectorKernels_h */
@@ -0,0 +1,36 @@
+//
+//  VectorKernelsDispatch.hpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#ifndef VectorKernelsDispatch_hpp
+#define VectorKernelsDispatch_hpp
+
+// one table per instruction set, filled in by that instruction set's translation unit
+struct VectorKernelsTable {
+    float (*sum)(const float *src, int count);
+    void (*sumAndSumOfSquares)(const float *src, int count, float *sum, float *sumOfSquares);
+    void (*magnitude3)(const float *x, const float *y, const float *z, float *dst, int count);
+    void (*square)(const float *src, float *dst, int count, float minimum);
+    void (*subtractAndMultiply)(const float *src, float offset, const float *window, float *dst, int count);
+    void (*absLinear)(const float *u, const float *v, float a, float b, float c, float *dst, int count);
+    int (*lessOrEqual)(const float *values, const float *thresholds, float *dst, int count);
+};
+
+#define VECTOR_KERNELS_TABLE { \
+    Kernels::sum, \
+    Kernels::sumAndSumOfSquares, \
+    Kernels::magnitude3, \
+    Kernels::square, \
+    Kernels::subtractAndMultiply, \
+    Kernels::absLinear, \
+    Kernels::lessOrEqual, \
+}
+
+// NULL when the instruction set isn't compiled in for this architecture
+const VectorKernelsTable *vectorKernelsAVX2Table();
+const VectorKernelsTable *vectorKernelsAVX512Table();
+
+#endif /* VectorKernelsDispatch_hpp */
@@ -0,0 +1,128 @@
+//
+//  VectorKernelsImpl.hpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+// Kernel bodies shared by every instruction set. There is deliberately no include guard: each
+// VectorKernels*.cpp includes this inside its own namespace after defining
+//   vfloat                       the universal intrinsic float vector type
+//   vx_load, vx_setall, vx_setzero  its constructors
+// so the same code compiles to v_float32x4, v_float32x8 or v_float32x16.
+
+struct Kernels {
+    static float sum(const float *src, int count)
+    {
+        const int lanes = vfloat::nlanes;
+        vfloat s0 = vx_setzero(), s1 = vx_setzero();
+        int i = 0;
+        for (; i <= count - 2 * lanes; i += 2 * lanes) {
+            s0 += vx_load(src + i);
+            s1 += vx_load(src + i + lanes);
+        }
+        for (; i <= count - lanes; i += lanes) {
+            s0 += vx_load(src + i);
+        }
+
+        float result = v_reduce_sum(s0 + s1);
+        for (; i < count; i++) {
+            result += src[i];
+        }
+        return result;
+    }
+
+    static void sumAndSumOfSquares(const float *src, int count, float *sum, float *sumOfSquares)
+    {
+        const int lanes = vfloat::nlanes;
+        vfloat s = vx_setzero(), ss = vx_setzero();
+        int i = 0;
+        for (; i <= count - lanes; i += lanes) {
+            vfloat v = vx_load(src + i);
+            s += v;
+            ss = v_muladd(v, v, ss);
+        }
+
+        float resultSum = v_reduce_sum(s);
+        float resultSumOfSquares = v_reduce_sum(ss);
+        for (; i < count; i++) {
+            resultSum += src[i];
+            resultSumOfSquares += src[i] * src[i];
+        }
+        *sum = resultSum;
+        *sumOfSquares = resultSumOfSquares;
+    }
+
+    static void magnitude3(const float *x, const float *y, const float *z, float *dst, int count)
+    {
+        const int lanes = vfloat::nlanes;
+        int i = 0;
+        for (; i <= count - lanes; i += lanes) {
+            vfloat vx = vx_load(x + i), vy = vx_load(y + i), vz = vx_load(z + i);
+            v_store(dst + i, v_sqrt(v_muladd(vx, vx, v_muladd(vy, vy, vz * vz))));
+        }
+        for (; i < count; i++) {
+            dst[i] = std::sqrt(x[i] * x[i] + y[i] * y[i] + z[i] * z[i]);
+        }
+    }
+
+    static void square(const float *src, float *dst, int count, float minimum)
+    {
+        const int lanes = vfloat::nlanes;
+        const vfloat vminimum = vx_setall(minimum);
+        int i = 0;
+        for (; i <= count - lanes; i += lanes) {
+            vfloat v = vx_load(src + i);
+            v_store(dst + i, v_max(v * v, vminimum));
+        }
+        for (; i < count; i++) {
+            dst[i] = std::max(src[i] * src[i], minimum);
+        }
+    }
+
+    static void subtractAndMultiply(const float *src, float offset, const float *window, float *dst, int count)
+    {
+        const int lanes = vfloat::nlanes;
+        const vfloat voffset = vx_setall(offset);
+        int i = 0;
+        for (; i <= count - lanes; i += lanes) {
+            v_store(dst + i, (vx_load(src + i) - voffset) * vx_load(window + i));
+        }
+        for (; i < count; i++) {
+            dst[i] = (src[i] - offset) * window[i];
+        }
+    }
+
+    static void absLinear(const float *u, const float *v, float a, float b, float c, float *dst, int count)
+    {
+        const int lanes = vfloat::nlanes;
+        const vfloat va = vx_setall(a), vb = vx_setall(b), vc = vx_setall(c);
+        int i = 0;
+        for (; i <= count - lanes; i += lanes) {
+            v_store(dst + i, v_abs(v_muladd(va, vx_load(u + i), v_muladd(vb, vx_load(v + i), vc))));
+        }
+        for (; i < count; i++) {
+            dst[i] = std::fabs(a * u[i] + b * v[i] + c);
+        }
+    }
+
+    static int lessOrEqual(const float *values, const float *thresholds, float *dst, int count)
+    {
+        const int lanes = vfloat::nlanes;
+        const vfloat one = vx_setall(1.0f), zero = vx_setzero();
+        vfloat total = vx_setzero();
+        int i = 0;
+        for (; i <= count - lanes; i += lanes) {
+            vfloat result = v_select(vx_load(values + i) <= vx_load(thresholds + i), one, zero);
+            v_store(dst + i, result);
+            total += result;
+        }
+
+        int ones = (int)v_reduce_sum(total);
+        for (; i < count; i++) {
+            dst[i] = (values[i] <= thresholds[i]) ? 1.0f : 0.0f;
+            ones += (int)dst[i];
+        }
+        return ones;
+    }
+};
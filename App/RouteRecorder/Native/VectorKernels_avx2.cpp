@@ -0,0 +1,63 @@
+//
+//  VectorKernels_avx2.cpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#include "VectorKernelsDispatch.hpp"
+
+#include <stddef.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || defined(__GNUC__))
+
+#include <algorithm>
+#include <cmath>
+
+// Only this file is built for AVX2, so the rest of the target still runs on any x86 CPU. The
+// target is set here rather than with per-file compiler flags so the file also builds, as
+// nothing, for arm64.
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx2,fma"))), apply_to = function)
+#define CV_FMA3 1
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+
+#include <immintrin.h>
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/core/hal/intrin_avx.hpp>
+
+namespace avx2 {
+    using namespace cv;
+
+    typedef v_float32x8 vfloat;
+    inline vfloat vx_load(const float *ptr) { return v256_load(ptr); }
+    inline vfloat vx_setall(float value) { return v256_setall_f32(value); }
+    inline vfloat vx_setzero() { return v256_setzero_f32(); }
+
+    #include "VectorKernelsImpl.hpp"
+
+    const VectorKernelsTable table = VECTOR_KERNELS_TABLE;
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+const VectorKernelsTable *vectorKernelsAVX2Table()
+{
+    return &avx2::table;
+}
+
+#else
+
+const VectorKernelsTable *vectorKernelsAVX2Table()
+{
+    return NULL;
+}
+
+#endif
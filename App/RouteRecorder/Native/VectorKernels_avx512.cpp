@@ -0,0 +1,62 @@
+//
+//  VectorKernels_avx512.cpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#include "VectorKernelsDispatch.hpp"
+
+#include <stddef.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__clang__) || defined(__GNUC__))
+
+#include <algorithm>
+#include <cmath>
+
+// Only this file is built for AVX-512, so the rest of the target still runs on any x86 CPU. The
+// target is set here rather than with per-file compiler flags so the file also builds, as
+// nothing, for arm64.
+#if defined(__clang__)
+#pragma clang attribute push (__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#endif
+
+#include <immintrin.h>
+#include <opencv2/core/hal/intrin.hpp>
+#include <opencv2/core/hal/intrin_avx512.hpp>
+
+namespace avx512 {
+    using namespace cv;
+
+    typedef v_float32x16 vfloat;
+    inline vfloat vx_load(const float *ptr) { return v512_load(ptr); }
+    inline vfloat vx_setall(float value) { return v512_setall_f32(value); }
+    inline vfloat vx_setzero() { return v512_setzero_f32(); }
+
+    #include "VectorKernelsImpl.hpp"
+
+    const VectorKernelsTable table = VECTOR_KERNELS_TABLE;
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+const VectorKernelsTable *vectorKernelsAVX512Table()
+{
+    return &avx512::table;
+}
+
+#else
+
+const VectorKernelsTable *vectorKernelsAVX512Table()
+{
+    return NULL;
+}
+
+#endif
@@ -94,8 +94,8 @@ public class RouteManager : NSObject, CLLocationManagerDelegate {
     }
     
     private func closeOpenRoutes() {
-        for route in Route.openRoutes() {
-            if (route.locations.count <= 3) {
+        for (route, locationCount) in Route.recoverOpenRoutes() {
+            if (locationCount <= 3) {
                 // if it doesn't more than 3 points, toss it.
                 DDLogInfo("Canceling route with fewer than 3 locations")
                 route.cancel()
@@ -252,7 +252,16 @@ public class RouteManager : NSObject, CLLocationManagerDelegate {
             
             stoppedRoute.close()
             
-            APIClient.shared.uploadRoute(stoppedRoute, includeFullLocations: false).apiResponse() { (response) -> Void in
+            let uploadRequest: AuthenticatedAPIRequest
+            if let spool = RouteUploadSpool.shared, let entry = spool.nextEntry(.summary, skipping: RouteUploadSpool.routeIsUploaded), entry.routeUUID == stoppedRoute.uuid {
+                // this route's spooled summary, as long as no earlier ones are still waiting. otherwise this route
+                // goes up directly and its spooled summary is skipped once it reaches the head.
+                uploadRequest = APIClient.shared.uploadSpooledRoute(entry)
+            } else {
+                uploadRequest = APIClient.shared.uploadRoute(stoppedRoute, includeFullLocations: false)
+            }
+            
+            uploadRequest.apiResponse() { (response) -> Void in
                 switch response.result {
                 case .success(_):
                     DDLogInfo("Route summary was successfully sync'd.")
@@ -297,7 +306,7 @@ public class RouteManager : NSObject, CLLocationManagerDelegate {
         }
     }
     
-    private func processGPSLocations(_ locations:[CLLocation], forRoute route: Route) {
+    func processGPSLocations(_ locations:[CLLocation], forRoute route: Route) {
         guard let firstLocation = locations.first else {
             return
         }
@@ -311,11 +320,12 @@ public class RouteManager : NSObject, CLLocationManagerDelegate {
         }
         
         var gotGPSSpeed = false
+        var recordedLocations: [Location] = []
         
         for location in locations {
             DDLogVerbose(String(format: "Location found for bike route. Speed: %f, Accuracy: %f", location.speed, location.horizontalAccuracy))
             
-            _ = Location(recordedLocation: location, isActiveGPS: true, route: route)
+            recordedLocations.append(Location(recordedLocation: location, isActiveGPS: true, route: route))
             
             var manualSpeed : CLLocationSpeed = 0
             if (location.speed >= 0) {
@@ -362,6 +372,10 @@ public class RouteManager : NSObject, CLLocationManagerDelegate {
             }
         }
         
+        route.appendToLocationColumns(locations, source: .activeGPS)
+        route.appendToActivitySegmentation(locations)
+        route.appendToSimplification(recordedLocations)
+        RouteJournal.shared?.recordLocations(locations, for: route)
         _ = route.saveLocationsAndUpdateLength()
         self.beginDeferringUpdatesIfAppropriate()
         
@@ -499,25 +513,25 @@ public class RouteManager : NSObject, CLLocationManagerDelegate {
                     for aggregator in strongSelf.pendingAggregators {
                         if shouldAppendToCurrentRoute {
                             if let aggregatePredictedActivity = aggregator.aggregatePredictedActivity,
-                                let date = aggregator.fetchLastReading()?.date, let currentRoute = strongSelf.currentRoute,  strongSelf.routeQualifiesForResumption(route: currentRoute, fromActivityType: aggregatePredictedActivity.activityType, fromDate: date) {
+                                let date = aggregator.lastReadingDate, let currentRoute = strongSelf.currentRoute,  strongSelf.routeQualifiesForResumption(route: currentRoute, fromActivityType: aggregatePredictedActivity.activityType, fromDate: date) {
                                 currentRoute.addPredictionAggregator(aggregator)
                             }
                         } else {
                             if let aggregatePredictedActivity = aggregator.aggregatePredictedActivity,
                                 aggregatePredictedActivity.activityType ~= mostRecentRoute!.activityType {
                                 // if the mode ~= the last route, append there
-                                if let date = aggregator.fetchLastReading()?.date, let mostRecentRoute = mostRecentRoute, strongSelf.routeQualifiesForResumption(route: mostRecentRoute, fromActivityType: aggregatePredictedActivity.activityType, fromDate: date) {
+                                if let date = aggregator.lastReadingDate, let mostRecentRoute = mostRecentRoute, strongSelf.routeQualifiesForResumption(route: mostRecentRoute, fromActivityType: aggregatePredictedActivity.activityType, fromDate: date) {
                                     mostRecentRoute.addPredictionAggregator(aggregator)
                                 }
                             } else if let aggregatePredictedActivity = aggregator.aggregatePredictedActivity,
                                 aggregatePredictedActivity.activityType ~= strongSelf.currentRoute!.activityType {
                                 // as soon as the mode switches to ~= the current route, start prepending there instead
                                 shouldAppendToCurrentRoute = true
-                                if let date = aggregator.fetchLastReading()?.date, let currentRoute = strongSelf.currentRoute,  strongSelf.routeQualifiesForResumption(route: currentRoute, fromActivityType: aggregatePredictedActivity.activityType, fromDate: date) {
+                                if let date = aggregator.lastReadingDate, let currentRoute = strongSelf.currentRoute,  strongSelf.routeQualifiesForResumption(route: currentRoute, fromActivityType: aggregatePredictedActivity.activityType, fromDate: date) {
                                     currentRoute.addPredictionAggregator(aggregator)
                                 }
                             } else {
-                                if let aggregatePredictedActivity = aggregator.aggregatePredictedActivity, let date = aggregator.fetchLastReading()?.date, let mostRecentRoute = mostRecentRoute, strongSelf.routeQualifiesForResumption(route: mostRecentRoute, fromActivityType: aggregatePredictedActivity.activityType, fromDate: date) {
+                                if let aggregatePredictedActivity = aggregator.aggregatePredictedActivity, let date = aggregator.lastReadingDate, let mostRecentRoute = mostRecentRoute, strongSelf.routeQualifiesForResumption(route: mostRecentRoute, fromActivityType: aggregatePredictedActivity.activityType, fromDate: date) {
                                     mostRecentRoute.addPredictionAggregator(aggregator)
                                 }
                             }
@@ -754,6 +768,7 @@ public class RouteManager : NSObject, CLLocationManagerDelegate {
         }
         
         DDLogVerbose("Received location updates.")
+        RawSensorStore.shared?.append(locations)
         defer {
             var oldBackgroundTaskID = UIBackgroundTaskIdentifier.invalid
             if (self.locationUpdateBackgroundTaskID != UIBackgroundTaskIdentifier.invalid) {
@@ -800,6 +815,7 @@ public class RouteManager : NSObject, CLLocationManagerDelegate {
 
                     let loc = Location(visit: visit, isArriving: true)
                     loc.route = route
+                    route.appendToSimplification([loc])
                     route.close()
                     
                     self.currentRoute = nil
@@ -816,6 +832,7 @@ public class RouteManager : NSObject, CLLocationManagerDelegate {
                 DDLogInfo("Including departure location in current route")
                 
                 loc.route = route
+                route.appendToSimplification([loc])
                 RouteRecorderDatabaseManager.shared.saveContext()
             } else if let priorRoute = Route.mostRecentRoute(), let priorLoc = priorRoute.mostRecentLocation(), loc.date < priorLoc.date {
                 // if the departure occured prior to the end of the last route, prepend it in that route
@@ -825,6 +842,7 @@ public class RouteManager : NSObject, CLLocationManagerDelegate {
                     return
                 }
                 loc.route = priorRoute
+                priorRoute.appendToSimplification([loc])
                 RouteRecorderDatabaseManager.shared.saveContext()
             } else {
                 self.runPredictionAndStartRouteIfNeeded(withLocations: [loc])
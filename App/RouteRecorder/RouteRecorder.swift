@@ -58,11 +58,17 @@ public class RouteRecorder {
     public func logout() {
         RouteRecorder.shared.routeManager.abortRoute()
         RouteRecorderDatabaseManager.shared.resetDatabase()
+        RawSensorStore.shared?.removeAll()
+        RouteLocationColumns.removeAll()
+        RouteUploadSpool.shared?.removeAll()
         APIClient.shared.logout()
     }
     
     private func startup() {
         RouteRecorderDatabaseManager.startup()
+        RouteJournal.startup()
+        RawSensorStore.startup()
+        RouteUploadSpool.startup()
         KeychainManager.startup()
         APIClient.startup()
                 
@@ -85,10 +91,14 @@ public class RouteRecorder {
                 NotificationCenter.default.removeObserver(strongSelf, name: NSNotification.Name(rawValue: "RouteRecorderDatabaseManagerDidStartup"), object: nil)
                 strongSelf.syncUnsyncedRoutes()
                 strongSelf.deleteUploadedRoutes()
+                strongSelf.expireRawSensorData()
+                strongSelf.classificationManager.classifyRecordedActivity()
             }
         } else {
             self.syncUnsyncedRoutes()
             self.deleteUploadedRoutes()
+            self.expireRawSensorData()
+            self.classificationManager.classifyRecordedActivity()
         }
     }
     
@@ -117,6 +127,11 @@ public class RouteRecorder {
         RouteRecorderDatabaseManager.shared.saveContext()
     }
     
+    private func expireRawSensorData() {
+        // raw samples are kept in whole segment files, so they're dropped without touching Core Data
+        RawSensorStore.shared?.compactAndExpire()
+    }
+    
     private func syncUnsyncedRoutes(includePredictionAggregators: Bool = false) {
         if (UIApplication.shared.applicationState == UIApplication.State.active) {
             self.uploadRoutes(includeFullLocations: UIDevice.current.batteryState == UIDevice.BatteryState.charging || UIDevice.current.batteryState == UIDevice.BatteryState.full, includePredictionAggregators: includePredictionAggregators)
@@ -125,10 +140,45 @@ public class RouteRecorder {
     
     public func uploadRoutes(includeFullLocations: Bool = false, includePredictionAggregators: Bool = false, completionBlock: @escaping ()->Void = {}) {
         self.didEncounterUnrecoverableErrorUploadingRoutes = false
+        RouteUploadSpool.shared?.enqueueExistingRoutesIfNeeded()
         self.uploadNextRoute(includeFullLocations: includeFullLocations, includePredictionAggregators: includePredictionAggregators, completionBlock: completionBlock)
     }
     
     private func uploadNextRoute(includeFullLocations: Bool, includePredictionAggregators: Bool = false, completionBlock: @escaping ()->Void = {}) {
+        guard let spool = RouteUploadSpool.shared else {
+            self.uploadNextUnspooledRoute(includeFullLocations: includeFullLocations, includePredictionAggregators: includePredictionAggregators, completionBlock: completionBlock)
+            return
+        }
+        
+        guard let entry = spool.nextEntry(includeFullLocations ? .full : .summary, skipping: RouteUploadSpool.routeIsUploaded), !self.didEncounterUnrecoverableErrorUploadingRoutes else {
+            completionBlock()
+            return
+        }
+        
+        APIClient.shared.uploadSpooledRoute(entry).apiResponse({ (response) -> Void in
+            switch response.result {
+            case .success(_): break
+                
+            case .failure(_):
+                // a conflict is spooled again under a new UUID. anything else leaves the entry at the head of the
+                // spool, so stop rather than retry it until the next sync.
+                if response.response?.statusCode != 409 {
+                    self.didEncounterUnrecoverableErrorUploadingRoutes = true
+                    completionBlock()
+                    return
+                }
+            }
+            if includePredictionAggregators == true, let route = Route.findRoute(withUUID: entry.routeUUID) {
+                APIClient.shared.uploadPredictionAggregators(forRoute: route)
+            }
+            
+            DispatchQueue.main.asyncAfter(deadline: DispatchTime.now() + Double(Int64(0.6 * Double(NSEC_PER_SEC))) / Double(NSEC_PER_SEC), execute: { () -> Void in
+                self.uploadNextRoute(includeFullLocations: includeFullLocations, includePredictionAggregators: includePredictionAggregators, completionBlock: completionBlock)
+            })
+        })
+    }
+    
+    private func uploadNextUnspooledRoute(includeFullLocations: Bool, includePredictionAggregators: Bool = false, completionBlock: @escaping ()->Void = {}) {
         if let route = (includeFullLocations ? Route.nextClosedUnuploadedRoute() : Route.nextUnuploadedSummaryRoute()), !self.didEncounterUnrecoverableErrorUploadingRoutes {
             APIClient.shared.uploadRoute(route, includeFullLocations: includeFullLocations).apiResponse({ (response) -> Void in
                 switch response.result {
@@ -147,7 +197,7 @@ public class RouteRecorder {
                 }
             
                 DispatchQueue.main.asyncAfter(deadline: DispatchTime.now() + Double(Int64(0.6 * Double(NSEC_PER_SEC))) / Double(NSEC_PER_SEC), execute: { () -> Void in
-                    self.uploadNextRoute(includeFullLocations: includeFullLocations, completionBlock: completionBlock)
+                    self.uploadNextUnspooledRoute(includeFullLocations: includeFullLocations, completionBlock: completionBlock)
                 })
             })
         } else {
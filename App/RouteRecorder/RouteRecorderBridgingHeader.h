@@ -7,3 +7,22 @@
 //
 
 #import "RandomForestManager.h"
+#import "AccelerometerSample.h"
+#import "PolyphaseResampler.h"
+#import "StationaryGate.h"
+#import "CadenceDetector.h"
+#import "SpectralFeatures.h"
+#import "AccelerometerRingBuffer.h"
+#import "TimeSeriesJoin.h"
+#import "SensorSegmentStore.h"
+#import "LocationColumnStore.h"
+#import "RouteEventJournal.h"
+#import "UploadSpool.h"
+#import "SensorTrace.h"
+#import "ActivityVoteAccumulator.h"
+#import "PredictionStoppingRule.h"
+#import "ActivitySegmenter.h"
+#import "PredictionScheduler.h"
+#import "RecordingClassifier.h"
+#import "RouteSimplifier.h"
+#import "VectorKernels.h"
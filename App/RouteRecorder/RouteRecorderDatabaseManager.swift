@@ -7,6 +7,7 @@
 //
 
 import Foundation
+import UIKit
 import CoreData
 import EventKit
 import CocoaLumberjack
@@ -14,6 +15,14 @@ import CocoaLumberjack
 class RouteRecorderDatabaseManager {
     var isStartingUp : Bool = true
     private var usesInMemoryStore: Bool
+    
+    // Hot paths call scheduleSave() and have their changes committed together, saveContext() commits right away.
+    static let groupCommitLatency: TimeInterval = 0.25
+    static let groupCommitBatchSize = 500
+    
+    private(set) lazy var writeScheduler: GroupCommitScheduler = GroupCommitScheduler(maximumLatency: RouteRecorderDatabaseManager.groupCommitLatency, maximumBatchSize: RouteRecorderDatabaseManager.groupCommitBatchSize) { [unowned self] in
+        return self.commitContext()
+    }
 
     static private(set) var shared : RouteRecorderDatabaseManager!
     
@@ -33,12 +42,24 @@ class RouteRecorderDatabaseManager {
 
     init (useInMemoryStore: Bool = false) {
         self.usesInMemoryStore = useInMemoryStore
+        
+        // nothing pending may be left behind when we get suspended
+        for name in [UIApplication.didEnterBackgroundNotification, UIApplication.willTerminateNotification] {
+            NotificationCenter.default.addObserver(forName: name, object: nil, queue: OperationQueue.main) { [weak self] (_) in
+                guard let strongSelf = self else {
+                    return
+                }
+                
+                strongSelf.saveContext()
+                strongSelf.writeScheduler.logMetrics()
+            }
+        }
     }
     
     private func startup () {
         // clean up open route
-        for route in Route.openRoutes() {
-            if (route.locationCount() <= 6) {
+        for (route, locationCount) in Route.recoverOpenRoutes() {
+            if (locationCount <= 6) {
                 // if it doesn't more than 6 points, toss it.
                 route.cancel()
             } else if !route.isClosed {
@@ -47,6 +68,9 @@ class RouteRecorderDatabaseManager {
         }
         
         self.saveContext()
+        
+        // every route that was open has now been closed or canceled, so the journal can be trusted from here on
+        RouteJournal.shared?.checkpoint()
         self.isStartingUp = false
         NotificationCenter.default.post(name: Notification.Name(rawValue: "RouteRecorderDatabaseManagerDidStartup"), object: nil)
     }
@@ -173,11 +197,22 @@ class RouteRecorderDatabaseManager {
         }
     }
 
+    // Commits within groupCommitLatency, or as soon as groupCommitBatchSize records are pending.
+    func scheduleSave(recordCount: Int = 1) {
+        self.writeScheduler.enqueue(recordCount: recordCount)
+    }
+    
+    // A durability barrier: commits everything pending, including anything scheduled, before it returns.
     func saveContext () {
+        self.writeScheduler.flush()
+    }
+    
+    private func commitContext ()->Bool {
         if let moc = self.managedObjectContext {
             if moc.hasChanges {
                 do {
                     try moc.save()
+                    return true
                 } catch let error {
                     // Replace this implementation with code to handle the error appropriately.
                     // abort() causes the application to generate a crash log and terminate. You should not use this function in a shipping application, although it may be useful during development.
@@ -186,6 +221,8 @@ class RouteRecorderDatabaseManager {
                 }
             }
         }
+        
+        return false
     }
     
 }
@@ -0,0 +1,39 @@
+//
+//  CRC32.hpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#ifndef CRC32_hpp
+#define CRC32_hpp
+
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC-32 (IEEE 802.3), the same one zlib and PNG use. Frames the records of the files in Storage.
+inline uint32_t crc32(const uint8_t *bytes, size_t count)
+{
+    struct Table {
+        Table()
+        {
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t value = i;
+                for (int bit = 0; bit < 8; bit++) {
+                    value = (value & 1) ? 0xedb88320u ^ (value >> 1) : value >> 1;
+                }
+                values[i] = value;
+            }
+        }
+        uint32_t values[256];
+    };
+    static const Table table;
+
+    uint32_t crc = 0xffffffffu;
+    for (size_t i = 0; i < count; i++) {
+        crc = table.values[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+    }
+    return crc ^ 0xffffffffu;
+}
+
+#endif /* CRC32_hpp */
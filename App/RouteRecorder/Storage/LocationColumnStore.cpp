@@ -0,0 +1,524 @@
+//
+//  LocationColumnStore.cpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#include "LocationColumnStore.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const char kFileMagic[4] = {'R', 'R', 'L', 'C'};
+    const char kChunkMagic[4] = {'R', 'R', 'L', 'K'};
+    const uint32_t kFileVersion = 1;
+    const uint32_t kFileFlagUnsorted = 1 << 0;
+
+    enum Column {
+        ColumnTime = 0,
+        ColumnLatitude,
+        ColumnLongitude,
+        ColumnAltitude,
+        ColumnSpeed,
+        ColumnCourse,
+        ColumnHorizontalAccuracy,
+        ColumnVerticalAccuracy,
+        ColumnSource,
+        ColumnCount
+    };
+
+    // fixed-point units per second, degree, meter, meter per second and degree of course
+    const double kColumnScales[ColumnCount] = {1e3, 1e7, 1e7, 1e2, 1e2, 1e2, 1e2, 1e2, 1};
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t flags;
+        uint32_t reserved;
+    };
+
+    // Followed by the columns, in Column order. Bounds are in the columns' fixed-point units.
+    struct ChunkHeader {
+        char magic[4];
+        uint32_t rowCount;
+        uint32_t columnSizes[ColumnCount];
+        uint32_t checksum; // of the columns
+        int64_t startMilliseconds;
+        int64_t endMilliseconds;
+        int32_t minimumLatitude;
+        int32_t maximumLatitude;
+        int32_t minimumLongitude;
+        int32_t maximumLongitude;
+        int32_t maximumSpeed;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(FileHeader) == 16, "File header layout changed");
+    static_assert(sizeof(ChunkHeader) == 88, "Chunk header layout changed");
+
+    struct Chunk {
+        off_t offset; // of the header
+        ChunkHeader header;
+    };
+
+    // a record in fixed point, one value per column
+    struct FixedRecord {
+        int64_t values[ColumnCount];
+    };
+
+    int64_t toFixed(double value, Column column)
+    {
+        if (!std::isfinite(value)) {
+            return 0;
+        }
+        return (int64_t)llround(value * kColumnScales[column]);
+    }
+
+    FixedRecord fixedRecord(const LocationColumnRecord &record)
+    {
+        FixedRecord fixed;
+        fixed.values[ColumnTime] = toFixed(record.t, ColumnTime);
+        fixed.values[ColumnLatitude] = toFixed(record.latitude, ColumnLatitude);
+        fixed.values[ColumnLongitude] = toFixed(record.longitude, ColumnLongitude);
+        fixed.values[ColumnAltitude] = toFixed(record.altitude, ColumnAltitude);
+        fixed.values[ColumnSpeed] = toFixed(record.speed, ColumnSpeed);
+        fixed.values[ColumnCourse] = toFixed(record.course, ColumnCourse);
+        fixed.values[ColumnHorizontalAccuracy] = toFixed(record.horizontalAccuracy, ColumnHorizontalAccuracy);
+        fixed.values[ColumnVerticalAccuracy] = toFixed(record.verticalAccuracy, ColumnVerticalAccuracy);
+        fixed.values[ColumnSource] = record.source;
+        return fixed;
+    }
+
+    uint64_t zigzag(int64_t value)
+    {
+        return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+    }
+
+    int64_t unzigzag(uint64_t value)
+    {
+        return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+    }
+
+    void putVarint(std::vector<uint8_t> &bytes, uint64_t value)
+    {
+        while (value >= 0x80) {
+            bytes.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        bytes.push_back((uint8_t)value);
+    }
+
+    // Returns false if the varint runs past end.
+    inline bool getVarint(const uint8_t *&cursor, const uint8_t *end, uint64_t &value)
+    {
+        value = 0;
+        for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+            uint8_t byte = *cursor++;
+            value |= (uint64_t)(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint32_t checksum(const uint8_t *bytes, size_t count)
+    {
+        // FNV-1a; only here to catch a chunk that was torn by a crash mid-write
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < count; i++) {
+            hash ^= bytes[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    void encodeChunk(const std::vector<FixedRecord> &rows, ChunkHeader &header, std::vector<uint8_t> &payload)
+    {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, kChunkMagic, sizeof(header.magic));
+        header.rowCount = (uint32_t)rows.size();
+        header.startMilliseconds = INT64_MAX;
+        header.endMilliseconds = INT64_MIN;
+        header.minimumLatitude = header.minimumLongitude = INT32_MAX;
+        header.maximumLatitude = header.maximumLongitude = header.maximumSpeed = INT32_MIN;
+
+        payload.clear();
+        for (int column = 0; column < ColumnCount; column++) {
+            size_t columnStart = payload.size();
+            int64_t previous = 0;
+            for (size_t i = 0; i < rows.size(); i++) {
+                int64_t value = rows[i].values[column];
+                putVarint(payload, zigzag(value - previous));
+                previous = value;
+            }
+            header.columnSizes[column] = (uint32_t)(payload.size() - columnStart);
+        }
+
+        for (size_t i = 0; i < rows.size(); i++) {
+            const int64_t *values = rows[i].values;
+            header.startMilliseconds = std::min(header.startMilliseconds, values[ColumnTime]);
+            header.endMilliseconds = std::max(header.endMilliseconds, values[ColumnTime]);
+            header.minimumLatitude = std::min(header.minimumLatitude, (int32_t)values[ColumnLatitude]);
+            header.maximumLatitude = std::max(header.maximumLatitude, (int32_t)values[ColumnLatitude]);
+            header.minimumLongitude = std::min(header.minimumLongitude, (int32_t)values[ColumnLongitude]);
+            header.maximumLongitude = std::max(header.maximumLongitude, (int32_t)values[ColumnLongitude]);
+            header.maximumSpeed = std::max(header.maximumSpeed, (int32_t)std::min(values[ColumnSpeed], (int64_t)INT32_MAX));
+        }
+
+        header.checksum = checksum(payload.data(), payload.size());
+    }
+
+    // Decodes one column of deltas straight into a field of every record.
+    template <typename Field>
+    bool decodeColumn(const uint8_t *cursor, const uint8_t *end, int rowCount, double scale, LocationColumnRecord *records, Field LocationColumnRecord::*field)
+    {
+        int64_t value = 0;
+        for (int i = 0; i < rowCount; i++) {
+            uint64_t delta;
+            if (!getVarint(cursor, end, delta)) {
+                return false;
+            }
+            value += unzigzag(delta);
+            records[i].*field = (Field)(value / scale);
+        }
+        return cursor == end;
+    }
+
+    bool decodeChunk(const ChunkHeader &header, const uint8_t *payload, LocationColumnRecord *records)
+    {
+        static double LocationColumnRecord::*const fields[] = {
+            &LocationColumnRecord::t,
+            &LocationColumnRecord::latitude,
+            &LocationColumnRecord::longitude,
+            &LocationColumnRecord::altitude,
+            &LocationColumnRecord::speed,
+            &LocationColumnRecord::course,
+            &LocationColumnRecord::horizontalAccuracy,
+            &LocationColumnRecord::verticalAccuracy,
+        };
+
+        int rowCount = (int)header.rowCount;
+        const uint8_t *cursor = payload;
+        for (int column = 0; column < ColumnCount; column++) {
+            const uint8_t *end = cursor + header.columnSizes[column];
+            bool decoded = column == ColumnSource
+                ? decodeColumn(cursor, end, rowCount, kColumnScales[column], records, &LocationColumnRecord::source)
+                : decodeColumn(cursor, end, rowCount, kColumnScales[column], records, fields[column]);
+            if (!decoded) {
+                return false;
+            }
+            cursor = end;
+        }
+        return true;
+    }
+
+    size_t payloadSize(const ChunkHeader &header)
+    {
+        size_t size = 0;
+        for (int column = 0; column < ColumnCount; column++) {
+            size += header.columnSizes[column];
+        }
+        return size;
+    }
+
+    bool readFully(int fd, void *bytes, size_t count, off_t offset)
+    {
+        return pread(fd, bytes, count, offset) == (ssize_t)count;
+    }
+
+    bool writeFully(int fd, const void *bytes, size_t count, off_t offset)
+    {
+        return pwrite(fd, bytes, count, offset) == (ssize_t)count;
+    }
+}
+
+struct LocationColumnStore {
+    LocationColumnStore(int fd) : fd(fd), openOffset(sizeof(FileHeader)), openChunkIsDirty(false), flags(0), headerIsDirty(false) {}
+    ~LocationColumnStore() { close(fd); }
+
+    bool load();
+    bool writeChunk(const std::vector<FixedRecord> &rows, off_t offset, ChunkHeader &header);
+    bool sealOpenChunk();
+    bool sync();
+    bool reset();
+
+    int fd;
+    std::vector<Chunk> chunks; // every chunk but the open one
+
+    // the open chunk, written at openOffset on sync until it fills up
+    std::vector<FixedRecord> openRows;
+    off_t openOffset;
+    bool openChunkIsDirty;
+
+    uint32_t flags;
+    bool headerIsDirty;
+
+    std::vector<uint8_t> payload;
+};
+
+bool LocationColumnStore::load()
+{
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        return false;
+    }
+
+    FileHeader fileHeader;
+    if (status.st_size < (off_t)sizeof(fileHeader) || !readFully(fd, &fileHeader, sizeof(fileHeader), 0) ||
+        memcmp(fileHeader.magic, kFileMagic, sizeof(kFileMagic)) != 0 || fileHeader.version != kFileVersion) {
+        // new, or not something we can read; it's only ever a copy, so start over
+        return reset() && sync();
+    }
+    flags = fileHeader.flags;
+
+    off_t offset = sizeof(fileHeader);
+    while (offset < status.st_size) {
+        Chunk chunk;
+        chunk.offset = offset;
+        ChunkHeader &header = chunk.header;
+        if (!readFully(fd, &header, sizeof(header), offset) || memcmp(header.magic, kChunkMagic, sizeof(kChunkMagic)) != 0 ||
+            header.rowCount == 0 || header.rowCount > LocationColumnStoreChunkRowCount) {
+            break;
+        }
+
+        size_t size = payloadSize(header);
+        if (offset + (off_t)(sizeof(header) + size) > status.st_size) {
+            break;
+        }
+        payload.resize(size);
+        if (!readFully(fd, payload.data(), size, offset + sizeof(header)) || checksum(payload.data(), size) != header.checksum) {
+            break;
+        }
+
+        chunks.push_back(chunk);
+        offset += sizeof(header) + size;
+    }
+
+    if (offset < status.st_size && ftruncate(fd, offset) != 0) {
+        return false;
+    }
+    openOffset = offset;
+
+    // keep filling a partial last chunk instead of leaving a run of small ones behind
+    if (!chunks.empty() && chunks.back().header.rowCount < LocationColumnStoreChunkRowCount) {
+        Chunk last = chunks.back();
+        std::vector<LocationColumnRecord> records(last.header.rowCount);
+        payload.resize(payloadSize(last.header));
+        if (!readFully(fd, payload.data(), payload.size(), last.offset + sizeof(last.header)) || !decodeChunk(last.header, payload.data(), records.data())) {
+            return false;
+        }
+        for (size_t i = 0; i < records.size(); i++) {
+            openRows.push_back(fixedRecord(records[i]));
+        }
+        chunks.pop_back();
+        openOffset = last.offset;
+    }
+
+    return true;
+}
+
+bool LocationColumnStore::writeChunk(const std::vector<FixedRecord> &rows, off_t offset, ChunkHeader &header)
+{
+    encodeChunk(rows, header, payload);
+    return writeFully(fd, &header, sizeof(header), offset) && writeFully(fd, payload.data(), payload.size(), offset + sizeof(header));
+}
+
+bool LocationColumnStore::sealOpenChunk()
+{
+    Chunk chunk;
+    chunk.offset = openOffset;
+    if (!writeChunk(openRows, openOffset, chunk.header)) {
+        return false;
+    }
+
+    chunks.push_back(chunk);
+    openOffset += sizeof(chunk.header) + payloadSize(chunk.header);
+    openRows.clear();
+    openChunkIsDirty = false;
+
+    return true;
+}
+
+bool LocationColumnStore::sync()
+{
+    if (headerIsDirty) {
+        FileHeader header;
+        memcpy(header.magic, kFileMagic, sizeof(header.magic));
+        header.version = kFileVersion;
+        header.flags = flags;
+        header.reserved = 0;
+        if (!writeFully(fd, &header, sizeof(header), 0)) {
+            return false;
+        }
+        headerIsDirty = false;
+    }
+
+    if (openChunkIsDirty) {
+        off_t end = openOffset;
+        if (!openRows.empty()) {
+            ChunkHeader header;
+            if (!writeChunk(openRows, openOffset, header)) {
+                return false;
+            }
+            end += sizeof(header) + payloadSize(header);
+        }
+        if (ftruncate(fd, end) != 0) {
+            return false;
+        }
+        openChunkIsDirty = false;
+    }
+
+    return fsync(fd) == 0;
+}
+
+bool LocationColumnStore::reset()
+{
+    chunks.clear();
+    openRows.clear();
+    openOffset = sizeof(FileHeader);
+    openChunkIsDirty = true;
+    flags = 0;
+    headerIsDirty = true;
+
+    return true;
+}
+
+LocationColumnStore *createLocationColumnStore(const char *path)
+{
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    LocationColumnStore *store = new LocationColumnStore(fd);
+    if (!store->load()) {
+        delete store;
+        return NULL;
+    }
+
+    return store;
+}
+
+void deleteLocationColumnStore(LocationColumnStore *store)
+{
+    store->sync();
+    delete store;
+}
+
+bool locationColumnStoreAppend(LocationColumnStore *store, const LocationColumnRecord *records, int recordCount)
+{
+    for (int i = 0; i < recordCount; i++) {
+        if (store->openRows.size() == LocationColumnStoreChunkRowCount && !store->sealOpenChunk()) {
+            return false;
+        }
+
+        FixedRecord row = fixedRecord(records[i]);
+        bool hasPreviousRow = !store->openRows.empty() || !store->chunks.empty();
+        int64_t previousMilliseconds = !store->openRows.empty() ? store->openRows.back().values[ColumnTime] : (hasPreviousRow ? store->chunks.back().header.endMilliseconds : 0);
+        if (hasPreviousRow && row.values[ColumnTime] < previousMilliseconds && (store->flags & kFileFlagUnsorted) == 0) {
+            store->flags |= kFileFlagUnsorted;
+            store->headerIsDirty = true;
+        }
+
+        store->openRows.push_back(row);
+        store->openChunkIsDirty = true;
+    }
+
+    if (store->openRows.size() == LocationColumnStoreChunkRowCount) {
+        return store->sealOpenChunk();
+    }
+
+    return true;
+}
+
+bool locationColumnStoreSync(LocationColumnStore *store)
+{
+    return store->sync();
+}
+
+bool locationColumnStoreReset(LocationColumnStore *store)
+{
+    return store->reset() && store->sync();
+}
+
+int64_t locationColumnStoreRowCount(LocationColumnStore *store)
+{
+    int64_t rowCount = (int64_t)store->openRows.size();
+    for (size_t i = 0; i < store->chunks.size(); i++) {
+        rowCount += store->chunks[i].header.rowCount;
+    }
+    return rowCount;
+}
+
+bool locationColumnStoreIsSorted(LocationColumnStore *store)
+{
+    return (store->flags & kFileFlagUnsorted) == 0;
+}
+
+int locationColumnStoreChunkCount(LocationColumnStore *store)
+{
+    return (int)store->chunks.size() + (store->openRows.empty() ? 0 : 1);
+}
+
+LocationColumnChunkStatistics locationColumnStoreChunkStatistics(LocationColumnStore *store, int chunk)
+{
+    ChunkHeader header;
+    if (chunk < (int)store->chunks.size()) {
+        header = store->chunks[chunk].header;
+    } else {
+        encodeChunk(store->openRows, header, store->payload);
+    }
+
+    LocationColumnChunkStatistics statistics;
+    statistics.rowCount = (int)header.rowCount;
+    statistics.startTime = header.startMilliseconds / kColumnScales[ColumnTime];
+    statistics.endTime = header.endMilliseconds / kColumnScales[ColumnTime];
+    statistics.minimumLatitude = header.minimumLatitude / kColumnScales[ColumnLatitude];
+    statistics.maximumLatitude = header.maximumLatitude / kColumnScales[ColumnLatitude];
+    statistics.minimumLongitude = header.minimumLongitude / kColumnScales[ColumnLongitude];
+    statistics.maximumLongitude = header.maximumLongitude / kColumnScales[ColumnLongitude];
+    statistics.maximumSpeed = header.maximumSpeed / kColumnScales[ColumnSpeed];
+
+    return statistics;
+}
+
+int locationColumnStoreDecodeChunk(LocationColumnStore *store, int chunk, LocationColumnRecord *records)
+{
+    if (chunk == (int)store->chunks.size()) {
+        // the open chunk is already in fixed point, so this matches what it'll decode to once it's written
+        const std::vector<FixedRecord> &rows = store->openRows;
+        for (size_t i = 0; i < rows.size(); i++) {
+            const int64_t *values = rows[i].values;
+            LocationColumnRecord &record = records[i];
+            record.t = values[ColumnTime] / kColumnScales[ColumnTime];
+            record.latitude = values[ColumnLatitude] / kColumnScales[ColumnLatitude];
+            record.longitude = values[ColumnLongitude] / kColumnScales[ColumnLongitude];
+            record.altitude = values[ColumnAltitude] / kColumnScales[ColumnAltitude];
+            record.speed = values[ColumnSpeed] / kColumnScales[ColumnSpeed];
+            record.course = values[ColumnCourse] / kColumnScales[ColumnCourse];
+            record.horizontalAccuracy = values[ColumnHorizontalAccuracy] / kColumnScales[ColumnHorizontalAccuracy];
+            record.verticalAccuracy = values[ColumnVerticalAccuracy] / kColumnScales[ColumnVerticalAccuracy];
+            record.source = (int16_t)values[ColumnSource];
+        }
+        return (int)rows.size();
+    }
+
+    const Chunk &sealed = store->chunks[chunk];
+    store->payload.resize(payloadSize(sealed.header));
+    if (!readFully(store->fd, store->payload.data(), store->payload.size(), sealed.offset + sizeof(sealed.header)) ||
+        !decodeChunk(sealed.header, store->payload.data(), records)) {
+        return -1;
+    }
+
+    return (int)sealed.header.rowCount;
+}
@@ -0,0 +1,79 @@
+//
+//  LocationColumnStore.h
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#ifndef LocationColumnStore_h
+#define LocationColumnStore_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LocationColumnStoreChunkRowCount 1024
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    // One route's locations in a single file, stored column by column in chunks of up to
+    // LocationColumnStoreChunkRowCount rows. Every column is fixed-point, delta and zigzag varint encoded, so a fix
+    // takes around a dozen bytes instead of a Core Data row, and each chunk carries the time, coordinate and speed
+    // bounds of its rows so scans can skip it without decoding.
+    //
+    // Appends fill an open chunk in memory that's written out once it's full or on sync; reopening the file picks a
+    // partial last chunk back up. Times are seconds since the reference date (Date.timeIntervalSinceReferenceDate)
+    // with millisecond resolution, coordinates are kept to 1e-7 degrees and everything else to centimeters or
+    // hundredths. Not thread safe.
+    typedef struct LocationColumnStore LocationColumnStore;
+
+    typedef struct LocationColumnRecord {
+        double t;
+        double latitude;
+        double longitude;
+        double altitude;
+        double speed;
+        double course;
+        double horizontalAccuracy;
+        double verticalAccuracy;
+        int16_t source;
+    } LocationColumnRecord;
+
+    typedef struct LocationColumnChunkStatistics {
+        int rowCount;
+        double startTime;
+        double endTime;
+        double minimumLatitude;
+        double maximumLatitude;
+        double minimumLongitude;
+        double maximumLongitude;
+        double maximumSpeed;
+    } LocationColumnChunkStatistics;
+
+    // Creates the file if needed and drops anything after the last intact chunk. Returns NULL if it can't be opened.
+    LocationColumnStore *createLocationColumnStore(const char *path);
+    // Syncs before closing.
+    void deleteLocationColumnStore(LocationColumnStore *store);
+
+    // Returns false if a full chunk couldn't be written, in which case the rest of the records aren't appended.
+    bool locationColumnStoreAppend(LocationColumnStore *store, const LocationColumnRecord *records, int recordCount);
+    // Writes the open chunk through to the file system.
+    bool locationColumnStoreSync(LocationColumnStore *store);
+    // Drops every row.
+    bool locationColumnStoreReset(LocationColumnStore *store);
+
+    int64_t locationColumnStoreRowCount(LocationColumnStore *store);
+    // False once a row has been appended with an earlier time than the one before it.
+    bool locationColumnStoreIsSorted(LocationColumnStore *store);
+
+    // Chunks are in append order, and the open chunk is the last one.
+    int locationColumnStoreChunkCount(LocationColumnStore *store);
+    LocationColumnChunkStatistics locationColumnStoreChunkStatistics(LocationColumnStore *store, int chunk);
+    // records must hold LocationColumnStoreChunkRowCount rows. Returns the number of rows decoded, or -1 if the chunk
+    // couldn't be read.
+    int locationColumnStoreDecodeChunk(LocationColumnStore *store, int chunk, LocationColumnRecord *records);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LocationColumnStore_h */
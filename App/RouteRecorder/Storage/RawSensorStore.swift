@@ -0,0 +1,135 @@
+//
+//  RawSensorStore.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+import UIKit
+import CoreLocation
+import CocoaLumberjack
+
+// Raw accelerometer and location samples, appended to hour-long segment files instead of kept as Core Data rows.
+// Old data is dropped a whole segment at a time. Not thread safe; use it from the main queue.
+class RawSensorStore {
+    static let partitionDuration: TimeInterval = 60 * 60
+    static let retentionInterval: TimeInterval = 7 * 24 * 60 * 60 // as long as uploaded routes are kept
+
+    static private(set) var shared: RawSensorStore!
+
+    let directoryURL: URL
+    private var store: OpaquePointer!
+    private var locationRecords: [SensorStoreLocationRecord] = []
+
+    class func startup() {
+        if (RawSensorStore.shared == nil) {
+            let directoryURL = RouteRecorderDatabaseManager.shared.applicationDocumentsDirectory.appendingPathComponent("RawSensorData")
+            RawSensorStore.shared = RawSensorStore(directoryURL: directoryURL)
+        }
+    }
+
+    init?(directoryURL: URL, partitionDuration: TimeInterval = RawSensorStore.partitionDuration) {
+        self.directoryURL = directoryURL
+        guard let store = createSensorSegmentStore(directoryURL.path, partitionDuration) else {
+            DDLogError(String(format: "Could not open raw sensor store at %@", directoryURL.path))
+            return nil
+        }
+        self.store = store
+
+        // segments are written in the background, same as the database
+        try? FileManager.default.setAttributes([FileAttributeKey.protectionKey: FileProtectionType.completeUntilFirstUserAuthentication], ofItemAtPath: directoryURL.path)
+
+        for name in [UIApplication.didEnterBackgroundNotification, UIApplication.willTerminateNotification] {
+            NotificationCenter.default.addObserver(forName: name, object: nil, queue: OperationQueue.main) { [weak self] (_) in
+                self?.sync()
+            }
+        }
+    }
+
+    deinit {
+        deleteSensorSegmentStore(self.store)
+    }
+
+    //
+    // MARK: Writing
+    //
+
+    // Sample times are relative to referenceDate.
+    func append(_ samples: UnsafeBufferPointer<AccelerometerSample>, referenceDate: Date) {
+        if !sensorSegmentStoreAppendAccelerometerSamples(self.store, referenceDate.timeIntervalSinceReferenceDate, samples.baseAddress, Int32(samples.count)) {
+            DDLogWarn("Error appending accelerometer samples to raw sensor store!")
+        }
+    }
+
+    func append(_ locations: [CLLocation]) {
+        self.locationRecords.removeAll(keepingCapacity: true)
+        for location in locations {
+            self.locationRecords.append(SensorStoreLocationRecord(t: location.timestamp.timeIntervalSinceReferenceDate,
+                                                                  latitude: location.coordinate.latitude,
+                                                                  longitude: location.coordinate.longitude,
+                                                                  altitude: Float(location.altitude),
+                                                                  speed: Float(location.speed),
+                                                                  course: Float(location.course),
+                                                                  horizontalAccuracy: Float(location.horizontalAccuracy)))
+        }
+
+        if !sensorSegmentStoreAppendLocations(self.store, self.locationRecords, Int32(self.locationRecords.count)) {
+            DDLogWarn("Error appending locations to raw sensor store!")
+        }
+    }
+
+    func sync() {
+        sensorSegmentStoreSync(self.store)
+    }
+
+    //
+    // MARK: Reading
+    //
+
+    func accelerometerRecords(from startDate: Date, to endDate: Date)->[SensorStoreAccelerometerRecord] {
+        let count = sensorSegmentStoreReadAccelerometerSamples(self.store, startDate.timeIntervalSinceReferenceDate, endDate.timeIntervalSinceReferenceDate, nil, 0)
+        var records = [SensorStoreAccelerometerRecord](repeating: SensorStoreAccelerometerRecord(), count: Int(count))
+        let readCount = sensorSegmentStoreReadAccelerometerSamples(self.store, startDate.timeIntervalSinceReferenceDate, endDate.timeIntervalSinceReferenceDate, &records, count)
+
+        return Array(records.prefix(Int(readCount)))
+    }
+
+    func locationRecords(from startDate: Date, to endDate: Date)->[SensorStoreLocationRecord] {
+        let count = sensorSegmentStoreReadLocations(self.store, startDate.timeIntervalSinceReferenceDate, endDate.timeIntervalSinceReferenceDate, nil, 0)
+        var records = [SensorStoreLocationRecord](repeating: SensorStoreLocationRecord(), count: Int(count))
+        let readCount = sensorSegmentStoreReadLocations(self.store, startDate.timeIntervalSinceReferenceDate, endDate.timeIntervalSinceReferenceDate, &records, count)
+
+        return Array(records.prefix(Int(readCount)))
+    }
+
+    var statistics: SensorSegmentStoreStatistics {
+        return sensorSegmentStoreStatistics(self.store)
+    }
+
+    //
+    // MARK: Retention
+    //
+
+    // Merges finished days into one segment each. Returns the number of segments merged away.
+    @discardableResult func compact(before date: Date)->Int {
+        return Int(sensorSegmentStoreCompact(self.store, date.timeIntervalSinceReferenceDate))
+    }
+
+    // Unlinks every segment that ends before date. Returns the number of segments removed.
+    @discardableResult func expire(before date: Date)->Int {
+        return Int(sensorSegmentStoreExpire(self.store, date.timeIntervalSinceReferenceDate))
+    }
+
+    func compactAndExpire(now: Date = Date()) {
+        let start = ProcessInfo.processInfo.systemUptime
+        let compactedCount = self.compact(before: now)
+        let expiredCount = self.expire(before: now.addingTimeInterval(-1 * RawSensorStore.retentionInterval))
+
+        DDLogInfo(String(format: "Raw sensor store merged %d and expired %d segments in %.1fms", compactedCount, expiredCount, 1000 * (ProcessInfo.processInfo.systemUptime - start)))
+    }
+
+    func removeAll() {
+        self.expire(before: Date.distantFuture)
+    }
+}
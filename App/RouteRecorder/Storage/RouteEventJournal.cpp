@@ -0,0 +1,446 @@
+//
+//  RouteEventJournal.cpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#include "RouteEventJournal.h"
+#include "CRC32.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const char kJournalMagic[4] = {'R', 'R', 'J', 'N'};
+    const uint32_t kJournalVersion = 1;
+    const uint32_t kMaximumFrameLength = 1 << 20;
+
+    enum EventType {
+        EventTypeOpen = 1,
+        EventTypeLocations,
+        EventTypeClose,
+        EventTypeCancel,
+        EventTypeCheckpoint
+    };
+
+    struct JournalHeader {
+        char magic[4];
+        uint32_t version;
+    };
+
+    // Each event is a FrameHeader followed by length bytes: the event type, then its fields.
+    struct FrameHeader {
+        uint32_t length;
+        uint32_t crc; // of the length bytes that follow
+    };
+
+    static_assert(sizeof(JournalHeader) == 8, "Journal header layout changed");
+    static_assert(sizeof(FrameHeader) == 8, "Frame header layout changed");
+
+    struct OpenRoute {
+        std::string uuid;
+        double openTime;
+        int64_t locationCount;
+        double lastLocationTime;
+    };
+
+    class FrameWriter {
+    public:
+        explicit FrameWriter(EventType type) : bytes(sizeof(FrameHeader)) { bytes.push_back((uint8_t)type); }
+
+        template <typename Value>
+        void put(Value value)
+        {
+            const uint8_t *valueBytes = (const uint8_t *)&value;
+            bytes.insert(bytes.end(), valueBytes, valueBytes + sizeof(value));
+        }
+
+        void putString(const std::string &string)
+        {
+            put((uint16_t)string.size());
+            bytes.insert(bytes.end(), string.begin(), string.end());
+        }
+
+        // Fills in the frame header and returns the whole frame.
+        const std::vector<uint8_t> &frame()
+        {
+            FrameHeader header;
+            header.length = (uint32_t)(bytes.size() - sizeof(header));
+            header.crc = crc32(bytes.data() + sizeof(header), header.length);
+            memcpy(bytes.data(), &header, sizeof(header));
+            return bytes;
+        }
+
+    private:
+        std::vector<uint8_t> bytes;
+    };
+
+    class FrameReader {
+    public:
+        FrameReader(const uint8_t *bytes, size_t count) : cursor(bytes), end(bytes + count) {}
+
+        template <typename Value>
+        bool get(Value &value)
+        {
+            if ((size_t)(end - cursor) < sizeof(value)) {
+                return false;
+            }
+            memcpy(&value, cursor, sizeof(value));
+            cursor += sizeof(value);
+            return true;
+        }
+
+        bool getString(std::string &string)
+        {
+            uint16_t length;
+            if (!get(length) || (size_t)(end - cursor) < length) {
+                return false;
+            }
+            string.assign((const char *)cursor, length);
+            cursor += length;
+            return true;
+        }
+
+        bool isAtEnd() const { return cursor == end; }
+
+    private:
+        const uint8_t *cursor;
+        const uint8_t *end;
+    };
+
+    bool writeFully(int fd, const void *bytes, size_t count, off_t offset)
+    {
+        return pwrite(fd, bytes, count, offset) == (ssize_t)count;
+    }
+}
+
+struct RouteEventJournal {
+    RouteEventJournal(const std::string &path, int checkpointInterval)
+        : path(path), fd(-1), endOffset(0), checkpointInterval(checkpointInterval), eventsSinceCheckpoint(0), isComplete(false), replayedEventCount(0), discardedByteCount(0) {}
+    ~RouteEventJournal() { if (fd >= 0) close(fd); }
+
+    bool load();
+    bool apply(const uint8_t *event, size_t length);
+    bool append(FrameWriter &writer, bool sync);
+    bool checkpoint();
+    void fail();
+
+    std::vector<OpenRoute>::iterator find(const std::string &uuid);
+
+    std::string path;
+    int fd;
+    off_t endOffset;
+
+    int checkpointInterval;
+    int eventsSinceCheckpoint;
+    bool isComplete;
+
+    std::vector<OpenRoute> routes;
+
+    int replayedEventCount;
+    int64_t discardedByteCount;
+};
+
+std::vector<OpenRoute>::iterator RouteEventJournal::find(const std::string &uuid)
+{
+    return std::find_if(routes.begin(), routes.end(), [&uuid](const OpenRoute &route) { return route.uuid == uuid; });
+}
+
+bool RouteEventJournal::load()
+{
+    fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        return false;
+    }
+
+    // between checkpoints the journal stays small, so it's read in one go
+    std::vector<uint8_t> bytes((size_t)status.st_size);
+    if (!bytes.empty() && pread(fd, bytes.data(), bytes.size(), 0) != (ssize_t)bytes.size()) {
+        return false;
+    }
+
+    JournalHeader header;
+    bool hasHeader = bytes.size() >= sizeof(header);
+    if (hasHeader) {
+        memcpy(&header, bytes.data(), sizeof(header));
+    }
+    if (!hasHeader || memcmp(header.magic, kJournalMagic, sizeof(kJournalMagic)) != 0 || header.version != kJournalVersion) {
+        // new, or not something we can replay
+        memcpy(header.magic, kJournalMagic, sizeof(header.magic));
+        header.version = kJournalVersion;
+        discardedByteCount = (int64_t)bytes.size();
+        endOffset = sizeof(header);
+        return ftruncate(fd, 0) == 0 && writeFully(fd, &header, sizeof(header), 0) && fsync(fd) == 0;
+    }
+
+    size_t offset = sizeof(header);
+    while (bytes.size() - offset >= sizeof(FrameHeader)) {
+        FrameHeader frame;
+        memcpy(&frame, bytes.data() + offset, sizeof(frame));
+        const uint8_t *event = bytes.data() + offset + sizeof(frame);
+        if (frame.length == 0 || frame.length > kMaximumFrameLength || frame.length > bytes.size() - offset - sizeof(frame) ||
+            crc32(event, frame.length) != frame.crc || !apply(event, frame.length)) {
+            break;
+        }
+
+        offset += sizeof(frame) + frame.length;
+    }
+    replayedEventCount = eventsSinceCheckpoint;
+
+    endOffset = (off_t)offset;
+    if (offset < bytes.size()) {
+        discardedByteCount = (int64_t)(bytes.size() - offset);
+        if (ftruncate(fd, endOffset) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Returns false for an event that doesn't parse.
+bool RouteEventJournal::apply(const uint8_t *event, size_t length)
+{
+    FrameReader reader(event + 1, length - 1);
+    std::string uuid;
+
+    switch (event[0]) {
+        case EventTypeOpen: {
+            double time;
+            int64_t locationCount;
+            if (!reader.getString(uuid) || !reader.get(time) || !reader.get(locationCount) || !reader.isAtEnd()) {
+                return false;
+            }
+            std::vector<OpenRoute>::iterator route = find(uuid);
+            if (route == routes.end()) {
+                OpenRoute openRoute = {uuid, time, locationCount, 0};
+                routes.push_back(openRoute);
+            } else {
+                route->openTime = time;
+                route->locationCount = locationCount;
+            }
+            break;
+        }
+        case EventTypeLocations: {
+            int64_t locationCount;
+            double lastLocationTime;
+            if (!reader.getString(uuid) || !reader.get(locationCount) || !reader.get(lastLocationTime) || !reader.isAtEnd()) {
+                return false;
+            }
+            std::vector<OpenRoute>::iterator route = find(uuid);
+            if (route == routes.end()) {
+                // the open was lost with a failed write; the route is evidently still recording
+                OpenRoute openRoute = {uuid, lastLocationTime, 0, 0};
+                route = routes.insert(routes.end(), openRoute);
+            }
+            route->locationCount += locationCount;
+            route->lastLocationTime = std::max(route->lastLocationTime, lastLocationTime);
+            break;
+        }
+        case EventTypeClose:
+        case EventTypeCancel: {
+            double time;
+            if (!reader.getString(uuid) || !reader.get(time) || !reader.isAtEnd()) {
+                return false;
+            }
+            std::vector<OpenRoute>::iterator route = find(uuid);
+            if (route != routes.end()) {
+                routes.erase(route);
+            }
+            break;
+        }
+        case EventTypeCheckpoint: {
+            uint32_t routeCount;
+            if (!reader.get(routeCount)) {
+                return false;
+            }
+            std::vector<OpenRoute> checkpointRoutes;
+            for (uint32_t i = 0; i < routeCount; i++) {
+                OpenRoute route;
+                if (!reader.getString(route.uuid) || !reader.get(route.openTime) || !reader.get(route.locationCount) || !reader.get(route.lastLocationTime)) {
+                    return false;
+                }
+                checkpointRoutes.push_back(route);
+            }
+            if (!reader.isAtEnd()) {
+                return false;
+            }
+            routes.swap(checkpointRoutes);
+            isComplete = true;
+            eventsSinceCheckpoint = 0;
+            return true;
+        }
+        default:
+            return false;
+    }
+
+    eventsSinceCheckpoint++;
+    return true;
+}
+
+bool RouteEventJournal::append(FrameWriter &writer, bool sync)
+{
+    const std::vector<uint8_t> &frame = writer.frame();
+    apply(frame.data() + sizeof(FrameHeader), frame.size() - sizeof(FrameHeader));
+
+    if (fd < 0 || !writeFully(fd, frame.data(), frame.size(), endOffset) || (sync && fsync(fd) != 0)) {
+        fail();
+        return false;
+    }
+    endOffset += (off_t)frame.size();
+
+    // a journal that's missing events can't vouch for its routes, so it isn't checkpointed until it's told to be
+    if (isComplete && eventsSinceCheckpoint >= checkpointInterval) {
+        return checkpoint();
+    }
+
+    return true;
+}
+
+bool RouteEventJournal::checkpoint()
+{
+    FrameWriter writer(EventTypeCheckpoint);
+    writer.put((uint32_t)routes.size());
+    for (size_t i = 0; i < routes.size(); i++) {
+        writer.putString(routes[i].uuid);
+        writer.put(routes[i].openTime);
+        writer.put(routes[i].locationCount);
+        writer.put(routes[i].lastLocationTime);
+    }
+    const std::vector<uint8_t> &frame = writer.frame();
+
+    JournalHeader header;
+    memcpy(header.magic, kJournalMagic, sizeof(header.magic));
+    header.version = kJournalVersion;
+
+    // written beside the journal and renamed over it, so a crash leaves one or the other
+    std::string temporaryPath = path + ".tmp";
+    int temporaryFD = open(temporaryPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (temporaryFD < 0) {
+        fail();
+        return false;
+    }
+    if (!writeFully(temporaryFD, &header, sizeof(header), 0) || !writeFully(temporaryFD, frame.data(), frame.size(), sizeof(header)) ||
+        fsync(temporaryFD) != 0 || rename(temporaryPath.c_str(), path.c_str()) != 0) {
+        close(temporaryFD);
+        unlink(temporaryPath.c_str());
+        fail();
+        return false;
+    }
+
+    if (fd >= 0) {
+        close(fd);
+    }
+    fd = temporaryFD;
+    endOffset = (off_t)(sizeof(header) + frame.size());
+    eventsSinceCheckpoint = 0;
+    isComplete = true;
+
+    return true;
+}
+
+void RouteEventJournal::fail()
+{
+    // the in-memory state is still right, but the file no longer is
+    unlink(path.c_str());
+    isComplete = false;
+}
+
+RouteEventJournal *createRouteEventJournal(const char *path, int checkpointInterval)
+{
+    RouteEventJournal *journal = new RouteEventJournal(path, std::max(checkpointInterval, 1));
+    if (!journal->load()) {
+        delete journal;
+        return NULL;
+    }
+
+    return journal;
+}
+
+void deleteRouteEventJournal(RouteEventJournal *journal)
+{
+    delete journal;
+}
+
+bool routeEventJournalRecordOpen(RouteEventJournal *journal, const char *uuid, double time, int64_t locationCount)
+{
+    FrameWriter writer(EventTypeOpen);
+    writer.putString(uuid);
+    writer.put(time);
+    writer.put(locationCount);
+    return journal->append(writer, true);
+}
+
+bool routeEventJournalRecordLocations(RouteEventJournal *journal, const char *uuid, int64_t locationCount, double lastLocationTime)
+{
+    FrameWriter writer(EventTypeLocations);
+    writer.putString(uuid);
+    writer.put(locationCount);
+    writer.put(lastLocationTime);
+    return journal->append(writer, false);
+}
+
+bool routeEventJournalRecordClose(RouteEventJournal *journal, const char *uuid, double time)
+{
+    FrameWriter writer(EventTypeClose);
+    writer.putString(uuid);
+    writer.put(time);
+    return journal->append(writer, true);
+}
+
+bool routeEventJournalRecordCancel(RouteEventJournal *journal, const char *uuid, double time)
+{
+    FrameWriter writer(EventTypeCancel);
+    writer.putString(uuid);
+    writer.put(time);
+    return journal->append(writer, true);
+}
+
+bool routeEventJournalCheckpoint(RouteEventJournal *journal)
+{
+    return journal->checkpoint();
+}
+
+bool routeEventJournalIsComplete(RouteEventJournal *journal)
+{
+    return journal->isComplete;
+}
+
+int routeEventJournalOpenRouteCount(RouteEventJournal *journal)
+{
+    return (int)journal->routes.size();
+}
+
+RouteEventJournalRoute routeEventJournalOpenRoute(RouteEventJournal *journal, int index)
+{
+    const OpenRoute &route = journal->routes[index];
+
+    RouteEventJournalRoute journalRoute;
+    journalRoute.uuid = route.uuid.c_str();
+    journalRoute.openTime = route.openTime;
+    journalRoute.locationCount = route.locationCount;
+    journalRoute.lastLocationTime = route.lastLocationTime;
+    return journalRoute;
+}
+
+RouteEventJournalStatistics routeEventJournalStatistics(RouteEventJournal *journal)
+{
+    RouteEventJournalStatistics statistics;
+    statistics.replayedEventCount = journal->replayedEventCount;
+    statistics.byteCount = (int64_t)journal->endOffset;
+    statistics.discardedByteCount = journal->discardedByteCount;
+    return statistics;
+}
@@ -0,0 +1,65 @@
+//
+//  RouteEventJournal.h
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#ifndef RouteEventJournal_h
+#define RouteEventJournal_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    // Append-only log of route lifecycle and location events, each framed with its length and a CRC-32. Every
+    // checkpointInterval events the journal is rewritten as a single checkpoint of the routes that are still open,
+    // so opening it only ever replays a checkpoint and a short tail. A torn or corrupt tail is cut off at the last
+    // intact frame.
+    //
+    // Routes are identified by their UUID strings, and times are seconds since the reference date. Not thread safe.
+    typedef struct RouteEventJournal RouteEventJournal;
+
+    typedef struct RouteEventJournalRoute {
+        const char *uuid; // valid until the journal is next changed
+        double openTime;
+        int64_t locationCount;
+        double lastLocationTime; // 0 until a location is recorded
+    } RouteEventJournalRoute;
+
+    typedef struct RouteEventJournalStatistics {
+        int replayedEventCount; // since the checkpoint, when the journal was opened
+        int64_t byteCount;
+        int64_t discardedByteCount; // cut off the tail when the journal was opened
+    } RouteEventJournalStatistics;
+
+    // Creates the file if needed and replays it. Returns NULL if it can't be opened.
+    RouteEventJournal *createRouteEventJournal(const char *path, int checkpointInterval);
+    void deleteRouteEventJournal(RouteEventJournal *journal);
+
+    // An open starts the route's location count at locationCount, which covers reopening a route that already has
+    // locations. Opens, closes and cancels are synced to disk before returning; locations are only written, since
+    // losing the last few counts to a power cut costs nothing. A failed write removes the file so that it won't be
+    // trusted next time.
+    bool routeEventJournalRecordOpen(RouteEventJournal *journal, const char *uuid, double time, int64_t locationCount);
+    bool routeEventJournalRecordLocations(RouteEventJournal *journal, const char *uuid, int64_t locationCount, double lastLocationTime);
+    bool routeEventJournalRecordClose(RouteEventJournal *journal, const char *uuid, double time);
+    bool routeEventJournalRecordCancel(RouteEventJournal *journal, const char *uuid, double time);
+
+    // Rewrites the journal as one checkpoint of the open routes. This is also what makes a new journal complete.
+    bool routeEventJournalCheckpoint(RouteEventJournal *journal);
+
+    // False for a new or lost journal, until its first checkpoint; until then it may not know about every open route.
+    bool routeEventJournalIsComplete(RouteEventJournal *journal);
+
+    int routeEventJournalOpenRouteCount(RouteEventJournal *journal);
+    RouteEventJournalRoute routeEventJournalOpenRoute(RouteEventJournal *journal, int index);
+
+    RouteEventJournalStatistics routeEventJournalStatistics(RouteEventJournal *journal);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RouteEventJournal_h */
@@ -0,0 +1,122 @@
+//
+//  RouteJournal.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+import CoreLocation
+import CocoaLumberjack
+
+// Crash-safe journal of which routes are open and how many locations they have, so startup can clean up after a
+// crash or a background relaunch without scanning every route in Core Data. Not thread safe; use it from the main
+// queue.
+class RouteJournal {
+    static let checkpointInterval = 256 // events replayed at most when opening the journal
+
+    static private(set) var shared: RouteJournal!
+
+    struct OpenRoute {
+        let uuid: String
+        let openDate: Date
+        let locationCount: Int
+        let lastLocationDate: Date?
+    }
+
+    let fileURL: URL
+    private var journal: OpaquePointer!
+
+    class func startup() {
+        if (RouteJournal.shared == nil) {
+            let fileURL = RouteRecorderDatabaseManager.shared.applicationDocumentsDirectory.appendingPathComponent("RouteJournal.log")
+            RouteJournal.shared = RouteJournal(fileURL: fileURL)
+        }
+    }
+
+    init?(fileURL: URL, checkpointInterval: Int = RouteJournal.checkpointInterval) {
+        self.fileURL = fileURL
+
+        let start = ProcessInfo.processInfo.systemUptime
+        guard let journal = createRouteEventJournal(fileURL.path, Int32(checkpointInterval)) else {
+            DDLogError(String(format: "Could not open route journal at %@", fileURL.path))
+            return nil
+        }
+        self.journal = journal
+
+        // written to in the background, same as the database
+        try? FileManager.default.setAttributes([FileAttributeKey.protectionKey: FileProtectionType.completeUntilFirstUserAuthentication], ofItemAtPath: fileURL.path)
+
+        let statistics = routeEventJournalStatistics(journal)
+        DDLogInfo(String(format: "Replayed %d route journal events in %.1fms, discarded %lld bytes", statistics.replayedEventCount, 1000 * (ProcessInfo.processInfo.systemUptime - start), statistics.discardedByteCount))
+    }
+
+    deinit {
+        deleteRouteEventJournal(self.journal)
+    }
+
+    //
+    // MARK: Recording
+    //
+
+    func recordOpen(_ route: Route, locationCount: Int) {
+        if !routeEventJournalRecordOpen(self.journal, route.uuid, Date().timeIntervalSinceReferenceDate, Int64(locationCount)) {
+            DDLogWarn("Error recording route open in journal!")
+        }
+    }
+
+    func recordLocations(_ locations: [CLLocation], for route: Route) {
+        guard let lastLocation = locations.last else {
+            return
+        }
+
+        self.recordLocations(count: locations.count, lastLocationDate: lastLocation.timestamp, for: route)
+    }
+
+    func recordLocations(count: Int, lastLocationDate: Date, for route: Route) {
+        if !routeEventJournalRecordLocations(self.journal, route.uuid, Int64(count), lastLocationDate.timeIntervalSinceReferenceDate) {
+            DDLogWarn("Error recording route locations in journal!")
+        }
+    }
+
+    func recordClose(routeUUID uuid: String) {
+        if !routeEventJournalRecordClose(self.journal, uuid, Date().timeIntervalSinceReferenceDate) {
+            DDLogWarn("Error recording route close in journal!")
+        }
+    }
+
+    func recordCancel(routeUUID uuid: String) {
+        if !routeEventJournalRecordCancel(self.journal, uuid, Date().timeIntervalSinceReferenceDate) {
+            DDLogWarn("Error recording route cancel in journal!")
+        }
+    }
+
+    // Call once the journal is known to match Core Data, such as after every open route has been closed.
+    func checkpoint() {
+        if !routeEventJournalCheckpoint(self.journal) {
+            DDLogWarn("Error checkpointing route journal!")
+        }
+    }
+
+    //
+    // MARK: Recovery
+    //
+
+    // False until the first checkpoint, or after a failed write; until then openRoutes may be missing routes.
+    var isComplete: Bool {
+        return routeEventJournalIsComplete(self.journal)
+    }
+
+    var openRoutes: [OpenRoute] {
+        var openRoutes: [OpenRoute] = []
+        for i in 0..<routeEventJournalOpenRouteCount(self.journal) {
+            let route = routeEventJournalOpenRoute(self.journal, i)
+            openRoutes.append(OpenRoute(uuid: String(cString: route.uuid),
+                                        openDate: Date(timeIntervalSinceReferenceDate: route.openTime),
+                                        locationCount: Int(route.locationCount),
+                                        lastLocationDate: route.lastLocationTime > 0 ? Date(timeIntervalSinceReferenceDate: route.lastLocationTime) : nil))
+        }
+
+        return openRoutes
+    }
+}
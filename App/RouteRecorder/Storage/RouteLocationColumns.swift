@@ -0,0 +1,154 @@
+//
+//  RouteLocationColumns.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+import CoreLocation
+import CocoaLumberjack
+
+// A route's locations in one column-encoded file, so whole-route scans like the length don't have to fetch and sort
+// every Location. Core Data stays the source of truth; this is a copy that Route rebuilds whenever the two disagree.
+// Not thread safe; use it from the main queue.
+class RouteLocationColumns {
+    let fileURL: URL
+    private var store: OpaquePointer!
+    private var records: [LocationColumnRecord] = []
+    private var chunkRecords = [LocationColumnRecord](repeating: LocationColumnRecord(), count: Int(LocationColumnStoreChunkRowCount))
+
+    class var directoryURL: URL {
+        return RouteRecorderDatabaseManager.shared.applicationDocumentsDirectory.appendingPathComponent("RouteLocations")
+    }
+
+    class func fileURL(forRouteUUID uuid: String)->URL {
+        return RouteLocationColumns.directoryURL.appendingPathComponent(uuid + ".loc")
+    }
+
+    convenience init?(routeUUID uuid: String) {
+        self.init(fileURL: RouteLocationColumns.fileURL(forRouteUUID: uuid))
+    }
+
+    init?(fileURL: URL) {
+        let directoryURL = fileURL.deletingLastPathComponent()
+        do {
+            try FileManager.default.createDirectory(at: directoryURL, withIntermediateDirectories: true, attributes: [FileAttributeKey.protectionKey: FileProtectionType.completeUntilFirstUserAuthentication])
+        } catch let error {
+            DDLogError(String(format: "Could not create route locations directory: %@", error as NSError))
+            return nil
+        }
+
+        self.fileURL = fileURL
+        guard let store = createLocationColumnStore(fileURL.path) else {
+            DDLogError(String(format: "Could not open route locations at %@", fileURL.path))
+            return nil
+        }
+        self.store = store
+    }
+
+    deinit {
+        deleteLocationColumnStore(self.store)
+    }
+
+    class func remove(routeUUID uuid: String) {
+        try? FileManager.default.removeItem(at: RouteLocationColumns.fileURL(forRouteUUID: uuid))
+    }
+
+    class func removeAll() {
+        try? FileManager.default.removeItem(at: RouteLocationColumns.directoryURL)
+    }
+
+    var rowCount: Int {
+        return Int(locationColumnStoreRowCount(self.store))
+    }
+
+    var isSorted: Bool {
+        return locationColumnStoreIsSorted(self.store)
+    }
+
+    //
+    // MARK: Writing
+    //
+
+    func append(_ locations: [CLLocation], source: LocationSource) {
+        self.records.removeAll(keepingCapacity: true)
+        for location in locations {
+            self.records.append(LocationColumnRecord(t: location.timestamp.timeIntervalSinceReferenceDate,
+                                                     latitude: location.coordinate.latitude,
+                                                     longitude: location.coordinate.longitude,
+                                                     altitude: location.altitude,
+                                                     speed: location.speed,
+                                                     course: location.course,
+                                                     horizontalAccuracy: location.horizontalAccuracy,
+                                                     verticalAccuracy: location.verticalAccuracy,
+                                                     source: source.rawValue))
+        }
+
+        self.appendRecords()
+    }
+
+    func append(_ locations: [Location]) {
+        self.records.removeAll(keepingCapacity: true)
+        for location in locations {
+            self.records.append(LocationColumnRecord(t: location.date.timeIntervalSinceReferenceDate,
+                                                     latitude: location.latitude,
+                                                     longitude: location.longitude,
+                                                     altitude: location.altitude,
+                                                     speed: location.speed,
+                                                     course: location.course,
+                                                     horizontalAccuracy: location.horizontalAccuracy,
+                                                     verticalAccuracy: location.verticalAccuracy,
+                                                     source: location.sourceInteger))
+        }
+
+        self.appendRecords()
+    }
+
+    private func appendRecords() {
+        if !locationColumnStoreAppend(self.store, self.records, Int32(self.records.count)) {
+            DDLogWarn("Error appending to route locations!")
+        }
+    }
+
+    // Replaces every row with locations, which should already be in date order.
+    func rebuild(from locations: [Location]) {
+        guard locationColumnStoreReset(self.store) else {
+            DDLogWarn("Error resetting route locations!")
+            return
+        }
+
+        self.append(locations)
+        self.sync()
+    }
+
+    func sync() {
+        if !locationColumnStoreSync(self.store) {
+            DDLogWarn("Error syncing route locations!")
+        }
+    }
+
+    //
+    // MARK: Reading
+    //
+
+    // Decodes one chunk at a time, in append order, so a long route never has to be in memory all at once. Chunks
+    // for which include returns false are skipped without being decoded.
+    func forEachChunk(including include: (LocationColumnChunkStatistics)->Bool = { _ in true }, _ body: (UnsafeBufferPointer<LocationColumnRecord>)->Void) {
+        for chunk in 0..<locationColumnStoreChunkCount(self.store) {
+            guard include(locationColumnStoreChunkStatistics(self.store, chunk)) else {
+                continue
+            }
+
+            let rowCount = Int(locationColumnStoreDecodeChunk(self.store, chunk, &self.chunkRecords))
+            guard rowCount >= 0 else {
+                DDLogWarn("Error decoding route locations!")
+                return
+            }
+
+            self.chunkRecords.withUnsafeBufferPointer { (records) in
+                body(UnsafeBufferPointer(rebasing: records[0..<rowCount]))
+            }
+        }
+    }
+}
@@ -0,0 +1,220 @@
+//
+//  RouteUploadSpool.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+import CoreData
+import CocoaLumberjack
+
+// Route uploads, encoded once when the route closes and kept on disk until the server has them, so the uploader
+// sends them in order without querying Core Data or encoding the route again. Summaries and full uploads are spooled
+// separately since full uploads wait for the phone to charge. Not thread safe; use it from the main queue.
+class RouteUploadSpool {
+    static let maximumSegmentSize: Int64 = 1024 * 1024
+    static let didSpoolExistingRoutesKey = "RouteUploadSpoolDidSpoolExistingRoutes"
+
+    static private(set) var shared: RouteUploadSpool!
+
+    enum Kind: String {
+        case summary
+        case full
+
+        static let all: [Kind] = [.summary, .full]
+    }
+
+    struct Entry {
+        let kind: Kind
+        let sequence: UInt64
+        let routeUUID: String
+        let idempotencyKey: String
+        let body: Data // gzipped JSON
+    }
+
+    let directoryURL: URL
+    private var spools: [Kind: OpaquePointer] = [:]
+
+    // UUIDs that routes gave up after the server reported a conflict. Anything still spooled under one would conflict
+    // again, so it's dropped instead of sent. Kept in memory; after a relaunch a stale entry costs one more conflict.
+    private var retiredRouteUUIDs = Set<String>()
+
+    class func startup() {
+        if (RouteUploadSpool.shared == nil) {
+            let directoryURL = RouteRecorderDatabaseManager.shared.applicationDocumentsDirectory.appendingPathComponent("RouteUploads")
+            RouteUploadSpool.shared = RouteUploadSpool(directoryURL: directoryURL)
+        }
+    }
+
+    init?(directoryURL: URL, maximumSegmentSize: Int64 = RouteUploadSpool.maximumSegmentSize) {
+        self.directoryURL = directoryURL
+
+        do {
+            // uploads are spooled in the background, same as the database
+            try FileManager.default.createDirectory(at: directoryURL, withIntermediateDirectories: true, attributes: [FileAttributeKey.protectionKey.rawValue: FileProtectionType.completeUntilFirstUserAuthentication])
+        } catch let error {
+            DDLogError(String(format: "Could not create route upload spool directory: %@", error as NSError))
+            return nil
+        }
+
+        for kind in Kind.all {
+            let path = directoryURL.appendingPathComponent(kind.rawValue).path
+            guard let spool = createUploadSpool(path, maximumSegmentSize) else {
+                DDLogError(String(format: "Could not open route upload spool at %@", path))
+                return nil
+            }
+            self.spools[kind] = spool
+        }
+    }
+
+    deinit {
+        for spool in self.spools.values {
+            deleteUploadSpool(spool)
+        }
+    }
+
+    //
+    // MARK: Spooling
+    //
+
+    // Spools whichever uploads the route still needs.
+    func enqueue(_ route: Route) {
+        if !route.isSummaryUploaded {
+            self.enqueue(route, kind: .summary)
+        }
+        if !route.isUploaded {
+            self.enqueue(route, kind: .full)
+        }
+    }
+
+    func enqueue(_ route: Route, kind: Kind) {
+        guard let parameters = APIClient.routeUploadParameters(for: route, includeFullLocations: kind == .full) else {
+            return
+        }
+
+        let body: Data
+        do {
+            body = try GZipEncoding.gzippedBody(with: parameters)
+        } catch let error {
+            DDLogWarn(String(format: "Error encoding route upload: %@", error as NSError))
+            return
+        }
+
+        self.enqueue(body, routeUUID: route.uuid, kind: kind)
+    }
+
+    @discardableResult func enqueue(_ body: Data, routeUUID: String, kind: Kind)->Bool {
+        let sequence = body.withUnsafeBytes { (bytes: UnsafePointer<UInt8>) -> UInt64 in
+            return uploadSpoolEnqueue(self.spools[kind], UUID().uuidString, routeUUID, bytes, Int64(body.count))
+        }
+        if sequence == 0 {
+            DDLogWarn("Error spooling route upload!")
+            return false
+        }
+
+        return true
+    }
+
+    // Routes that closed before there was a spool are spooled once, the first time it's used.
+    func enqueueExistingRoutesIfNeeded() {
+        guard !UserDefaults.standard.bool(forKey: RouteUploadSpool.didSpoolExistingRoutesKey) else {
+            return
+        }
+
+        let context = RouteRecorderDatabaseManager.shared.currentManagedObjectContext()
+        let fetchedRequest = NSFetchRequest<NSFetchRequestResult>(entityName: "Route")
+        fetchedRequest.predicate = NSPredicate(format: "isClosed == YES AND isUploaded == NO")
+        fetchedRequest.sortDescriptors = [NSSortDescriptor(key: "creationDate", ascending: true)]
+
+        let results: [AnyObject]?
+        do {
+            results = try context.fetch(fetchedRequest)
+        } catch let error {
+            DDLogWarn(String(format: "Error executing fetch request: %@", error as NSError))
+            return
+        }
+
+        if let routes = results as? [Route] {
+            for route in routes {
+                self.enqueue(route)
+            }
+        }
+
+        UserDefaults.standard.set(true, forKey: RouteUploadSpool.didSpoolExistingRoutesKey)
+        UserDefaults.standard.synchronize()
+    }
+
+    //
+    // MARK: Uploading
+    //
+
+    // The oldest upload of the given kind that the server hasn't acknowledged.
+    func nextEntry(_ kind: Kind)->Entry? {
+        var entry = UploadSpoolEntry()
+        guard uploadSpoolPeek(self.spools[kind], &entry) else {
+            return nil
+        }
+
+        return Entry(kind: kind,
+                     sequence: entry.sequence,
+                     routeUUID: String(cString: entry.destination),
+                     idempotencyKey: String(cString: entry.idempotencyKey),
+                     body: Data(bytes: entry.body, count: Int(entry.bodyLength)))
+    }
+
+    // The oldest upload of the given kind that the route still needs. Entries at the head of the spool that
+    // isUploaded says went up some other way, like a summary made stale by its route's full upload, are acknowledged
+    // on the way.
+    func nextEntry(_ kind: Kind, skipping isUploaded: (Entry)->Bool)->Entry? {
+        self.acknowledgeEntries(kind, while: isUploaded)
+        return self.nextEntry(kind)
+    }
+
+    func acknowledgeEntries(_ kind: Kind, while isUploaded: (Entry)->Bool) {
+        while let entry = self.nextEntry(kind) {
+            if self.retiredRouteUUIDs.contains(entry.routeUUID) {
+                DDLogInfo("Dropping spooled route upload, the route has a new UUID")
+            } else if isUploaded(entry) {
+                DDLogInfo("Dropping spooled route upload, the route was already uploaded")
+            } else {
+                break
+            }
+            self.acknowledge(entry)
+        }
+    }
+
+    // Drops the entries of either kind spooled under a UUID the route no longer uses. Entries that are behind others
+    // in the spool are dropped once they reach its head.
+    func retireRouteUUID(_ routeUUID: String) {
+        self.retiredRouteUUIDs.insert(routeUUID)
+        for kind in Kind.all {
+            self.acknowledgeEntries(kind, while: { _ in false })
+        }
+    }
+
+    // Whether a route already has what the entry would upload. Routes that are gone aren't, so their uploads still go.
+    class func routeIsUploaded(_ entry: Entry)->Bool {
+        guard let route = Route.findRoute(withUUID: entry.routeUUID), route.isClosed else {
+            return false
+        }
+
+        return entry.kind == .full ? route.isUploaded : route.isSummaryUploaded
+    }
+
+    func acknowledge(_ entry: Entry) {
+        if !uploadSpoolAcknowledge(self.spools[entry.kind], entry.sequence) {
+            DDLogWarn("Error acknowledging spooled route upload!")
+        }
+    }
+
+    func pendingCount(_ kind: Kind)->Int {
+        return Int(uploadSpoolStatistics(self.spools[kind]).pendingCount)
+    }
+
+    func removeAll() {
+        for spool in self.spools.values {
+            uploadSpoolAcknowledge(spool, UInt64.max)
+        }
+    }
+}
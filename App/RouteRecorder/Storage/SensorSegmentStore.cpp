@@ -0,0 +1,625 @@
+//
+//  SensorSegmentStore.cpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#include "SensorSegmentStore.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const char kSegmentMagic[4] = {'R', 'R', 'S', 'G'};
+    const uint32_t kSegmentVersion = 1;
+    const int64_t kDayDuration = 24 * 60 * 60;
+    const char *kKindDirectoryNames[SensorSegmentKindCount] = {"accelerometer", "location"};
+
+    struct SegmentHeader {
+        char magic[4];
+        uint32_t version;
+        uint32_t kind;
+        uint32_t recordSize;
+        int64_t partitionStart; // seconds since the reference date
+        int64_t partitionDuration; // seconds
+    };
+
+    // On disk, times are milliseconds from the start of the segment's partition.
+    struct AccelerometerDiskRecord {
+        uint32_t milliseconds;
+        float x;
+        float y;
+        float z;
+    };
+
+    struct LocationDiskRecord {
+        double latitude;
+        double longitude;
+        uint32_t milliseconds;
+        float altitude;
+        float speed;
+        float course;
+        float horizontalAccuracy;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(SegmentHeader) == 32, "Segment header layout changed");
+    static_assert(sizeof(AccelerometerDiskRecord) == 16, "Accelerometer record layout changed");
+    static_assert(sizeof(LocationDiskRecord) == 40, "Location record layout changed");
+
+    const size_t kRecordSizes[SensorSegmentKindCount] = {sizeof(AccelerometerDiskRecord), sizeof(LocationDiskRecord)};
+    const size_t kRecordTimeOffsets[SensorSegmentKindCount] = {offsetof(AccelerometerDiskRecord, milliseconds), offsetof(LocationDiskRecord, milliseconds)};
+
+    struct Segment {
+        int64_t partitionStart;
+        int64_t partitionDuration;
+        std::string path;
+    };
+
+    // a record read back from a segment, with its time made absolute
+    struct TimedRecord {
+        int64_t milliseconds; // since the reference date
+        std::vector<char>::size_type offset;
+    };
+
+    int64_t floorDivide(int64_t value, int64_t divisor)
+    {
+        int64_t quotient = value / divisor;
+        if ((value % divisor != 0) && ((value < 0) != (divisor < 0))) {
+            quotient--;
+        }
+        return quotient;
+    }
+
+    uint32_t recordMilliseconds(const char *record, SensorSegmentKind kind)
+    {
+        uint32_t milliseconds;
+        memcpy(&milliseconds, record + kRecordTimeOffsets[kind], sizeof(milliseconds));
+        return milliseconds;
+    }
+
+    void setRecordMilliseconds(char *record, SensorSegmentKind kind, uint32_t milliseconds)
+    {
+        memcpy(record + kRecordTimeOffsets[kind], &milliseconds, sizeof(milliseconds));
+    }
+
+    bool makeDirectory(const std::string &path)
+    {
+        return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+    }
+
+    // Drops records read more than once, which happens when a crash during compaction leaves both the merged segment
+    // and the segments it merged. A duplicate has the same time and the same sample. timedRecords must be sorted by time.
+    void removeDuplicateRecords(std::vector<TimedRecord> &timedRecords, const std::vector<char> &records, SensorSegmentKind kind)
+    {
+        size_t recordSize = kRecordSizes[kind];
+        size_t timeOffset = kRecordTimeOffsets[kind];
+        size_t afterTimeOffset = timeOffset + sizeof(uint32_t);
+        auto isSameSample = [&](const TimedRecord &a, const TimedRecord &b) {
+            const char *recordA = &records[a.offset];
+            const char *recordB = &records[b.offset];
+            return memcmp(recordA, recordB, timeOffset) == 0 && memcmp(recordA + afterTimeOffset, recordB + afterTimeOffset, recordSize - afterTimeOffset) == 0;
+        };
+
+        size_t keptCount = 0;
+        size_t runStart = 0; // the first kept record with the same time as the current one
+        for (size_t i = 0; i < timedRecords.size(); i++) {
+            if (keptCount == 0 || timedRecords[keptCount - 1].milliseconds != timedRecords[i].milliseconds) {
+                runStart = keptCount;
+            }
+
+            bool isDuplicate = false;
+            for (size_t j = runStart; j < keptCount && !isDuplicate; j++) {
+                isDuplicate = isSameSample(timedRecords[j], timedRecords[i]);
+            }
+            if (!isDuplicate) {
+                timedRecords[keptCount++] = timedRecords[i];
+            }
+        }
+        timedRecords.resize(keptCount);
+    }
+
+    bool syncAndClose(FILE *file)
+    {
+        bool succeeded = fflush(file) == 0 && fsync(fileno(file)) == 0;
+        return fclose(file) == 0 && succeeded;
+    }
+}
+
+struct SensorSegmentStore {
+    SensorSegmentStore(const std::string &directoryPath, int64_t partitionDuration);
+    ~SensorSegmentStore();
+
+    std::string kindDirectory(SensorSegmentKind kind) const;
+    std::string segmentPath(SensorSegmentKind kind, int64_t partitionStart, int64_t partitionDuration) const;
+    std::vector<Segment> segments(SensorSegmentKind kind) const;
+
+    FILE *appendFile(SensorSegmentKind kind, int64_t partitionStart);
+    void closeAppendFile(SensorSegmentKind kind);
+    bool append(SensorSegmentKind kind, const std::vector<char> &records, const std::vector<int64_t> &milliseconds);
+
+    bool readSegment(const Segment &segment, SensorSegmentKind kind, std::vector<char> &records, std::vector<TimedRecord> &timedRecords) const;
+    int64_t read(SensorSegmentKind kind, double startTime, double endTime, std::vector<char> &records, std::vector<TimedRecord> &timedRecords) const;
+
+    int compact(SensorSegmentKind kind, double beforeTime);
+    int expire(SensorSegmentKind kind, double beforeTime);
+
+    std::string directoryPath;
+    int64_t partitionDuration;
+
+    FILE *appendFiles[SensorSegmentKindCount];
+    int64_t appendPartitionStarts[SensorSegmentKindCount];
+};
+
+SensorSegmentStore::SensorSegmentStore(const std::string &directoryPath, int64_t partitionDuration)
+    : directoryPath(directoryPath), partitionDuration(partitionDuration)
+{
+    for (int kind = 0; kind < SensorSegmentKindCount; kind++) {
+        appendFiles[kind] = NULL;
+        appendPartitionStarts[kind] = 0;
+    }
+}
+
+SensorSegmentStore::~SensorSegmentStore()
+{
+    for (int kind = 0; kind < SensorSegmentKindCount; kind++) {
+        closeAppendFile((SensorSegmentKind)kind);
+    }
+}
+
+std::string SensorSegmentStore::kindDirectory(SensorSegmentKind kind) const
+{
+    return directoryPath + "/" + kKindDirectoryNames[kind];
+}
+
+std::string SensorSegmentStore::segmentPath(SensorSegmentKind kind, int64_t partitionStart, int64_t partitionDuration) const
+{
+    char name[64];
+    snprintf(name, sizeof(name), "/%lld_%lld.seg", (long long)partitionStart, (long long)partitionDuration);
+    return kindDirectory(kind) + name;
+}
+
+std::vector<Segment> SensorSegmentStore::segments(SensorSegmentKind kind) const
+{
+    std::vector<Segment> segments;
+
+    std::string directory = kindDirectory(kind);
+    DIR *dir = opendir(directory.c_str());
+    if (dir == NULL) {
+        return segments;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        long long partitionStart, partitionDuration;
+        char suffix[8];
+        if (sscanf(entry->d_name, "%lld_%lld.%7s", &partitionStart, &partitionDuration, suffix) == 3 && strcmp(suffix, "seg") == 0 && partitionDuration > 0) {
+            Segment segment = {partitionStart, partitionDuration, directory + "/" + entry->d_name};
+            segments.push_back(segment);
+        }
+    }
+    closedir(dir);
+
+    std::sort(segments.begin(), segments.end(), [](const Segment &a, const Segment &b) {
+        return a.partitionStart < b.partitionStart || (a.partitionStart == b.partitionStart && a.partitionDuration < b.partitionDuration);
+    });
+
+    return segments;
+}
+
+FILE *SensorSegmentStore::appendFile(SensorSegmentKind kind, int64_t partitionStart)
+{
+    if (appendFiles[kind] != NULL && appendPartitionStarts[kind] == partitionStart) {
+        return appendFiles[kind];
+    }
+    closeAppendFile(kind);
+
+    if (!makeDirectory(kindDirectory(kind))) {
+        return NULL;
+    }
+
+    FILE *file = fopen(segmentPath(kind, partitionStart, partitionDuration).c_str(), "ab");
+    if (file == NULL) {
+        return NULL;
+    }
+
+    // a crash can leave a partial record (or header) at the end, which would put every record appended after it out
+    // of line, so it's cut off before appending
+    struct stat fileStatus;
+    if (fstat(fileno(file), &fileStatus) != 0) {
+        fclose(file);
+        return NULL;
+    }
+    off_t alignedSize = 0;
+    if (fileStatus.st_size >= (off_t)sizeof(SegmentHeader)) {
+        alignedSize = (off_t)sizeof(SegmentHeader) + (fileStatus.st_size - (off_t)sizeof(SegmentHeader)) / (off_t)kRecordSizes[kind] * (off_t)kRecordSizes[kind];
+    }
+    if (alignedSize != fileStatus.st_size && ftruncate(fileno(file), alignedSize) != 0) {
+        fclose(file);
+        return NULL;
+    }
+
+    if (alignedSize == 0) {
+        SegmentHeader header;
+        memcpy(header.magic, kSegmentMagic, sizeof(header.magic));
+        header.version = kSegmentVersion;
+        header.kind = (uint32_t)kind;
+        header.recordSize = (uint32_t)kRecordSizes[kind];
+        header.partitionStart = partitionStart;
+        header.partitionDuration = partitionDuration;
+        if (fwrite(&header, sizeof(header), 1, file) != 1) {
+            fclose(file);
+            return NULL;
+        }
+    }
+
+    appendFiles[kind] = file;
+    appendPartitionStarts[kind] = partitionStart;
+
+    return file;
+}
+
+void SensorSegmentStore::closeAppendFile(SensorSegmentKind kind)
+{
+    if (appendFiles[kind] != NULL) {
+        fclose(appendFiles[kind]);
+        appendFiles[kind] = NULL;
+    }
+}
+
+// milliseconds are absolute, one per record; records are written to their partitions in runs
+bool SensorSegmentStore::append(SensorSegmentKind kind, const std::vector<char> &records, const std::vector<int64_t> &milliseconds)
+{
+    size_t recordSize = kRecordSizes[kind];
+    int64_t partitionMilliseconds = partitionDuration * 1000;
+    std::vector<char> run;
+
+    size_t i = 0;
+    while (i < milliseconds.size()) {
+        int64_t partitionStart = floorDivide(milliseconds[i], partitionMilliseconds) * partitionDuration;
+
+        run.clear();
+        for (; i < milliseconds.size() && floorDivide(milliseconds[i], partitionMilliseconds) * partitionDuration == partitionStart; i++) {
+            run.insert(run.end(), records.begin() + i * recordSize, records.begin() + (i + 1) * recordSize);
+            setRecordMilliseconds(&run[run.size() - recordSize], kind, (uint32_t)(milliseconds[i] - partitionStart * 1000));
+        }
+
+        FILE *file = appendFile(kind, partitionStart);
+        if (file == NULL || fwrite(run.data(), recordSize, run.size() / recordSize, file) != run.size() / recordSize) {
+            closeAppendFile(kind);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool SensorSegmentStore::readSegment(const Segment &segment, SensorSegmentKind kind, std::vector<char> &records, std::vector<TimedRecord> &timedRecords) const
+{
+    FILE *file = fopen(segment.path.c_str(), "rb");
+    if (file == NULL) {
+        return false;
+    }
+
+    SegmentHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, kSegmentMagic, sizeof(header.magic)) != 0 ||
+        header.version != kSegmentVersion || header.kind != (uint32_t)kind || header.recordSize != kRecordSizes[kind]) {
+        fclose(file);
+        return false;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    fseek(file, sizeof(header), SEEK_SET);
+
+    // a crash can leave a partial record at the end; it's ignored
+    size_t recordSize = kRecordSizes[kind];
+    size_t recordCount = (size_t)(fileSize - (long)sizeof(header)) / recordSize;
+
+    size_t offset = records.size();
+    records.resize(offset + recordCount * recordSize);
+    recordCount = fread(&records[offset], recordSize, recordCount, file);
+    records.resize(offset + recordCount * recordSize);
+    fclose(file);
+
+    for (size_t i = 0; i < recordCount; i++) {
+        TimedRecord timedRecord = {header.partitionStart * 1000 + recordMilliseconds(&records[offset + i * recordSize], kind), offset + i * recordSize};
+        timedRecords.push_back(timedRecord);
+    }
+
+    return true;
+}
+
+int64_t SensorSegmentStore::read(SensorSegmentKind kind, double startTime, double endTime, std::vector<char> &records, std::vector<TimedRecord> &timedRecords) const
+{
+    int64_t startMilliseconds = (int64_t)std::ceil(startTime * 1000);
+    int64_t endMilliseconds = (int64_t)std::ceil(endTime * 1000);
+
+    for (const Segment &segment : segments(kind)) {
+        if (segment.partitionStart * 1000 >= endMilliseconds || (segment.partitionStart + segment.partitionDuration) * 1000 <= startMilliseconds) {
+            continue;
+        }
+
+        readSegment(segment, kind, records, timedRecords);
+    }
+
+    timedRecords.erase(std::remove_if(timedRecords.begin(), timedRecords.end(), [&](const TimedRecord &record) {
+        return record.milliseconds < startMilliseconds || record.milliseconds >= endMilliseconds;
+    }), timedRecords.end());
+    std::stable_sort(timedRecords.begin(), timedRecords.end(), [](const TimedRecord &a, const TimedRecord &b) {
+        return a.milliseconds < b.milliseconds;
+    });
+    removeDuplicateRecords(timedRecords, records, kind);
+
+    return (int64_t)timedRecords.size();
+}
+
+int SensorSegmentStore::compact(SensorSegmentKind kind, double beforeTime)
+{
+    std::map<int64_t, std::vector<Segment>> days;
+    for (const Segment &segment : segments(kind)) {
+        int64_t dayStart = floorDivide(segment.partitionStart, kDayDuration) * kDayDuration;
+        if (dayStart + kDayDuration <= beforeTime && segment.partitionStart + segment.partitionDuration <= dayStart + kDayDuration) {
+            days[dayStart].push_back(segment);
+        }
+    }
+
+    int removedCount = 0;
+    size_t recordSize = kRecordSizes[kind];
+    for (const auto &day : days) {
+        int64_t dayStart = day.first;
+        const std::vector<Segment> &daySegments = day.second;
+        if (daySegments.size() == 1 && daySegments[0].partitionDuration == kDayDuration) {
+            continue; // already compact
+        }
+
+        if (appendFiles[kind] != NULL && appendPartitionStarts[kind] >= dayStart && appendPartitionStarts[kind] < dayStart + kDayDuration) {
+            closeAppendFile(kind);
+        }
+
+        std::vector<char> records;
+        std::vector<TimedRecord> timedRecords;
+        for (const Segment &segment : daySegments) {
+            readSegment(segment, kind, records, timedRecords);
+        }
+        std::stable_sort(timedRecords.begin(), timedRecords.end(), [](const TimedRecord &a, const TimedRecord &b) {
+            return a.milliseconds < b.milliseconds;
+        });
+        removeDuplicateRecords(timedRecords, records, kind);
+
+        std::vector<char> sortedRecords(timedRecords.size() * recordSize);
+        for (size_t i = 0; i < timedRecords.size(); i++) {
+            memcpy(&sortedRecords[i * recordSize], &records[timedRecords[i].offset], recordSize);
+            setRecordMilliseconds(&sortedRecords[i * recordSize], kind, (uint32_t)(timedRecords[i].milliseconds - dayStart * 1000));
+        }
+
+        // write the merged segment aside and rename it into place before unlinking what it merged. A crash in between
+        // leaves both, which reads and the next compaction of the day see through by dropping the duplicate records.
+        std::string dayPath = segmentPath(kind, dayStart, kDayDuration);
+        std::string temporaryPath = dayPath + ".tmp";
+        FILE *file = fopen(temporaryPath.c_str(), "wb");
+        if (file == NULL) {
+            continue;
+        }
+
+        SegmentHeader header;
+        memcpy(header.magic, kSegmentMagic, sizeof(header.magic));
+        header.version = kSegmentVersion;
+        header.kind = (uint32_t)kind;
+        header.recordSize = (uint32_t)recordSize;
+        header.partitionStart = dayStart;
+        header.partitionDuration = kDayDuration;
+
+        bool succeeded = fwrite(&header, sizeof(header), 1, file) == 1;
+        succeeded = succeeded && fwrite(sortedRecords.data(), recordSize, timedRecords.size(), file) == timedRecords.size();
+        succeeded = syncAndClose(file) && succeeded;
+        if (!succeeded || rename(temporaryPath.c_str(), dayPath.c_str()) != 0) {
+            unlink(temporaryPath.c_str());
+            continue;
+        }
+
+        for (const Segment &segment : daySegments) {
+            if (segment.path != dayPath) {
+                unlink(segment.path.c_str());
+            }
+        }
+        removedCount += (int)daySegments.size() - 1;
+    }
+
+    return removedCount;
+}
+
+int SensorSegmentStore::expire(SensorSegmentKind kind, double beforeTime)
+{
+    int removedCount = 0;
+    for (const Segment &segment : segments(kind)) {
+        if (segment.partitionStart + segment.partitionDuration > beforeTime) {
+            continue;
+        }
+
+        if (appendFiles[kind] != NULL && appendPartitionStarts[kind] == segment.partitionStart) {
+            closeAppendFile(kind);
+        }
+        if (unlink(segment.path.c_str()) == 0) {
+            removedCount++;
+        }
+    }
+
+    return removedCount;
+}
+
+SensorSegmentStore *createSensorSegmentStore(const char *directoryPath, double partitionDuration)
+{
+    int64_t duration = (int64_t)partitionDuration;
+    if (duration <= 0 || (double)duration != partitionDuration || kDayDuration % duration != 0) {
+        return NULL;
+    }
+
+    std::string path(directoryPath);
+    if (!makeDirectory(path)) {
+        return NULL;
+    }
+
+    SensorSegmentStore *store = new SensorSegmentStore(path, duration);
+
+    // clean up after a compaction that didn't get as far as renaming its merged segment into place
+    for (int kind = 0; kind < SensorSegmentKindCount; kind++) {
+        std::string directory = store->kindDirectory((SensorSegmentKind)kind);
+        DIR *dir = opendir(directory.c_str());
+        if (dir == NULL) {
+            continue;
+        }
+
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            size_t length = strlen(entry->d_name);
+            if (length > 4 && strcmp(entry->d_name + length - 4, ".tmp") == 0) {
+                unlink((directory + "/" + entry->d_name).c_str());
+            }
+        }
+        closedir(dir);
+    }
+
+    return store;
+}
+
+void deleteSensorSegmentStore(SensorSegmentStore *store)
+{
+    delete store;
+}
+
+bool sensorSegmentStoreAppendAccelerometerSamples(SensorSegmentStore *store, double referenceTime, const AccelerometerSample *samples, int sampleCount)
+{
+    std::vector<char> records(sampleCount * sizeof(AccelerometerDiskRecord));
+    std::vector<int64_t> milliseconds(sampleCount);
+
+    for (int i = 0; i < sampleCount; i++) {
+        AccelerometerDiskRecord record = {0, samples[i].x, samples[i].y, samples[i].z};
+        memcpy(&records[i * sizeof(record)], &record, sizeof(record));
+        milliseconds[i] = (int64_t)std::llround((referenceTime + samples[i].t) * 1000);
+    }
+
+    return store->append(SensorSegmentKindAccelerometer, records, milliseconds);
+}
+
+bool sensorSegmentStoreAppendLocations(SensorSegmentStore *store, const SensorStoreLocationRecord *locations, int recordCount)
+{
+    std::vector<char> records(recordCount * sizeof(LocationDiskRecord));
+    std::vector<int64_t> milliseconds(recordCount);
+
+    for (int i = 0; i < recordCount; i++) {
+        LocationDiskRecord record = {locations[i].latitude, locations[i].longitude, 0, locations[i].altitude, locations[i].speed, locations[i].course, locations[i].horizontalAccuracy, 0};
+        memcpy(&records[i * sizeof(record)], &record, sizeof(record));
+        milliseconds[i] = (int64_t)std::llround(locations[i].t * 1000);
+    }
+
+    return store->append(SensorSegmentKindLocation, records, milliseconds);
+}
+
+void sensorSegmentStoreSync(SensorSegmentStore *store)
+{
+    for (int kind = 0; kind < SensorSegmentKindCount; kind++) {
+        if (store->appendFiles[kind] != NULL) {
+            fflush(store->appendFiles[kind]);
+            fsync(fileno(store->appendFiles[kind]));
+        }
+    }
+}
+
+int64_t sensorSegmentStoreReadAccelerometerSamples(SensorSegmentStore *store, double startTime, double endTime, SensorStoreAccelerometerRecord *records, int64_t capacity)
+{
+    sensorSegmentStoreSync(store);
+
+    std::vector<char> diskRecords;
+    std::vector<TimedRecord> timedRecords;
+    int64_t count = store->read(SensorSegmentKindAccelerometer, startTime, endTime, diskRecords, timedRecords);
+
+    for (int64_t i = 0; i < std::min(count, capacity); i++) {
+        AccelerometerDiskRecord record;
+        memcpy(&record, &diskRecords[timedRecords[i].offset], sizeof(record));
+        records[i].t = timedRecords[i].milliseconds / 1000.0;
+        records[i].x = record.x;
+        records[i].y = record.y;
+        records[i].z = record.z;
+    }
+
+    return count;
+}
+
+int64_t sensorSegmentStoreReadLocations(SensorSegmentStore *store, double startTime, double endTime, SensorStoreLocationRecord *records, int64_t capacity)
+{
+    sensorSegmentStoreSync(store);
+
+    std::vector<char> diskRecords;
+    std::vector<TimedRecord> timedRecords;
+    int64_t count = store->read(SensorSegmentKindLocation, startTime, endTime, diskRecords, timedRecords);
+
+    for (int64_t i = 0; i < std::min(count, capacity); i++) {
+        LocationDiskRecord record;
+        memcpy(&record, &diskRecords[timedRecords[i].offset], sizeof(record));
+        records[i].t = timedRecords[i].milliseconds / 1000.0;
+        records[i].latitude = record.latitude;
+        records[i].longitude = record.longitude;
+        records[i].altitude = record.altitude;
+        records[i].speed = record.speed;
+        records[i].course = record.course;
+        records[i].horizontalAccuracy = record.horizontalAccuracy;
+    }
+
+    return count;
+}
+
+int sensorSegmentStoreCompact(SensorSegmentStore *store, double beforeTime)
+{
+    int removedCount = 0;
+    for (int kind = 0; kind < SensorSegmentKindCount; kind++) {
+        removedCount += store->compact((SensorSegmentKind)kind, beforeTime);
+    }
+
+    return removedCount;
+}
+
+int sensorSegmentStoreExpire(SensorSegmentStore *store, double beforeTime)
+{
+    int removedCount = 0;
+    for (int kind = 0; kind < SensorSegmentKindCount; kind++) {
+        removedCount += store->expire((SensorSegmentKind)kind, beforeTime);
+    }
+
+    return removedCount;
+}
+
+SensorSegmentStoreStatistics sensorSegmentStoreStatistics(SensorSegmentStore *store)
+{
+    sensorSegmentStoreSync(store);
+
+    SensorSegmentStoreStatistics statistics = {0, 0, 0};
+    for (int kind = 0; kind < SensorSegmentKindCount; kind++) {
+        for (const Segment &segment : store->segments((SensorSegmentKind)kind)) {
+            struct stat fileStatus;
+            if (stat(segment.path.c_str(), &fileStatus) != 0) {
+                continue;
+            }
+
+            statistics.segmentCount++;
+            statistics.byteCount += fileStatus.st_size;
+            if (fileStatus.st_size > (off_t)sizeof(SegmentHeader)) {
+                statistics.recordCount += (fileStatus.st_size - sizeof(SegmentHeader)) / kRecordSizes[kind];
+            }
+        }
+    }
+
+    return statistics;
+}
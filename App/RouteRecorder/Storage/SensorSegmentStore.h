@@ -0,0 +1,84 @@
+//
+//  SensorSegmentStore.h
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#ifndef SensorSegmentStore_h
+#define SensorSegmentStore_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "AccelerometerSample.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    // Append-only store for raw accelerometer and location samples, partitioned by time into one segment file per
+    // partition and kind. Appends go to the partition of each sample's time, compaction merges finished partitions
+    // into day-long, time-sorted segments, and retention drops whole segment files.
+    //
+    // Times are seconds since the reference date (Date.timeIntervalSinceReferenceDate) and are stored with
+    // millisecond resolution. Not thread safe.
+    typedef struct SensorSegmentStore SensorSegmentStore;
+
+    typedef enum SensorSegmentKind {
+        SensorSegmentKindAccelerometer = 0,
+        SensorSegmentKindLocation,
+        SensorSegmentKindCount
+    } SensorSegmentKind;
+
+    typedef struct SensorStoreAccelerometerRecord {
+        double t;
+        float x;
+        float y;
+        float z;
+    } SensorStoreAccelerometerRecord;
+
+    typedef struct SensorStoreLocationRecord {
+        double t;
+        double latitude;
+        double longitude;
+        float altitude;
+        float speed;
+        float course;
+        float horizontalAccuracy;
+    } SensorStoreLocationRecord;
+
+    typedef struct SensorSegmentStoreStatistics {
+        int segmentCount;
+        int64_t byteCount;
+        int64_t recordCount;
+    } SensorSegmentStoreStatistics;
+
+    // Creates the directory if needed. partitionDuration is in seconds and must divide a day evenly.
+    // Returns NULL if the directory can't be created.
+    SensorSegmentStore *createSensorSegmentStore(const char *directoryPath, double partitionDuration);
+    void deleteSensorSegmentStore(SensorSegmentStore *store);
+
+    // samples[i].t is relative to referenceTime. Returns false if a segment couldn't be written.
+    bool sensorSegmentStoreAppendAccelerometerSamples(SensorSegmentStore *store, double referenceTime, const AccelerometerSample *samples, int sampleCount);
+    bool sensorSegmentStoreAppendLocations(SensorSegmentStore *store, const SensorStoreLocationRecord *records, int recordCount);
+
+    // Writes buffered appends through to the file system.
+    void sensorSegmentStoreSync(SensorSegmentStore *store);
+
+    // Copies up to capacity records in [startTime, endTime), sorted by time, and returns how many there are in total.
+    int64_t sensorSegmentStoreReadAccelerometerSamples(SensorSegmentStore *store, double startTime, double endTime, SensorStoreAccelerometerRecord *records, int64_t capacity);
+    int64_t sensorSegmentStoreReadLocations(SensorSegmentStore *store, double startTime, double endTime, SensorStoreLocationRecord *records, int64_t capacity);
+
+    // Merges the segments of every day that ends at or before beforeTime into one sorted segment per day and kind.
+    // Returns the number of segments removed by merging.
+    int sensorSegmentStoreCompact(SensorSegmentStore *store, double beforeTime);
+
+    // Unlinks every segment that ends at or before beforeTime. Returns the number of segments removed.
+    int sensorSegmentStoreExpire(SensorSegmentStore *store, double beforeTime);
+
+    SensorSegmentStoreStatistics sensorSegmentStoreStatistics(SensorSegmentStore *store);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SensorSegmentStore_h */
@@ -0,0 +1,584 @@
+//
+//  SensorTrace.cpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#include "SensorTrace.h"
+#include "CRC32.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+namespace {
+    const char kFileMagic[4] = {'R', 'R', 'T', 'R'};
+    const char kChunkMagic[4] = {'R', 'R', 'T', 'C'};
+    const char kTrailerMagic[4] = {'R', 'R', 'T', 'X'};
+    const uint32_t kTraceVersion = 1;
+
+    enum ChunkCompression : uint32_t {
+        ChunkCompressionNone = 0,
+        ChunkCompressionDeflate = 1,
+    };
+
+    struct FileHeader {
+        char magic[4];
+        uint32_t version;
+    };
+
+    // Followed by storedSize bytes, which inflate to rawSize bytes of records when the chunk is deflated. A record is
+    // its type byte followed by its fields, packed.
+    struct ChunkHeader {
+        char magic[4];
+        uint32_t rawSize;
+        uint32_t storedSize;
+        uint32_t recordCount;
+        double startTime;
+        double endTime;
+        uint32_t compression;
+        uint32_t crc; // of the stored bytes
+    };
+
+    struct IndexEntry {
+        uint64_t offset; // of the chunk header
+        double startTime;
+        double endTime;
+        uint32_t recordCount;
+        uint32_t reserved;
+    };
+
+    // Last thing in a finished trace, after the index.
+    struct Trailer {
+        uint64_t indexOffset;
+        uint32_t chunkCount;
+        uint32_t crc; // of the index
+        char magic[4];
+        uint32_t version;
+    };
+
+    static_assert(sizeof(FileHeader) == 8, "File header layout changed");
+    static_assert(sizeof(ChunkHeader) == 40, "Chunk header layout changed");
+    static_assert(sizeof(IndexEntry) == 32, "Index entry layout changed");
+    static_assert(sizeof(Trailer) == 24, "Trailer layout changed");
+
+    const size_t kAccelerometerRecordSize = 1 + 8 + 3 * 4;
+    const size_t kLocationRecordSize = 1 + 3 * 8 + 5 * 4 + 2;
+    const size_t kPredictionRecordSize = 1 + 8 + 2 + 4;
+
+    double recordTime(const SensorTraceRecord &record)
+    {
+        switch (record.type) {
+            case SensorTraceRecordTypeAccelerometer:
+                return record.accelerometer.t;
+            case SensorTraceRecordTypeLocation:
+                return record.location.t;
+            case SensorTraceRecordTypePrediction:
+                return record.prediction.t;
+        }
+        return 0;
+    }
+
+    size_t recordSize(const SensorTraceRecord &record)
+    {
+        switch (record.type) {
+            case SensorTraceRecordTypeAccelerometer:
+                return kAccelerometerRecordSize;
+            case SensorTraceRecordTypeLocation:
+                return kLocationRecordSize;
+            case SensorTraceRecordTypePrediction:
+                return kPredictionRecordSize;
+        }
+        return 0;
+    }
+
+    template <typename T>
+    void put(std::vector<uint8_t> &bytes, T value)
+    {
+        const uint8_t *valueBytes = reinterpret_cast<const uint8_t *>(&value);
+        bytes.insert(bytes.end(), valueBytes, valueBytes + sizeof(T));
+    }
+
+    template <typename T>
+    T take(const uint8_t *&cursor)
+    {
+        T value;
+        memcpy(&value, cursor, sizeof(T));
+        cursor += sizeof(T);
+        return value;
+    }
+
+    void encodeRecord(const SensorTraceRecord &record, std::vector<uint8_t> &bytes)
+    {
+        bytes.push_back((uint8_t)record.type);
+        switch (record.type) {
+            case SensorTraceRecordTypeAccelerometer:
+                put(bytes, record.accelerometer.t);
+                put(bytes, record.accelerometer.x);
+                put(bytes, record.accelerometer.y);
+                put(bytes, record.accelerometer.z);
+                break;
+            case SensorTraceRecordTypeLocation:
+                put(bytes, record.location.t);
+                put(bytes, record.location.latitude);
+                put(bytes, record.location.longitude);
+                put(bytes, record.location.altitude);
+                put(bytes, record.location.speed);
+                put(bytes, record.location.course);
+                put(bytes, record.location.horizontalAccuracy);
+                put(bytes, record.location.verticalAccuracy);
+                put(bytes, record.location.source);
+                break;
+            case SensorTraceRecordTypePrediction:
+                put(bytes, record.prediction.t);
+                put(bytes, record.prediction.activityType);
+                put(bytes, record.prediction.confidence);
+                break;
+        }
+    }
+
+    bool decodeRecord(const uint8_t *&cursor, const uint8_t *end, SensorTraceRecord &record)
+    {
+        if (cursor >= end) {
+            return false;
+        }
+        record.type = (SensorTraceRecordType)*cursor;
+        size_t size = recordSize(record);
+        if (size == 0 || end - cursor < (ptrdiff_t)size) {
+            return false;
+        }
+        cursor++;
+
+        switch (record.type) {
+            case SensorTraceRecordTypeAccelerometer:
+                record.accelerometer.t = take<double>(cursor);
+                record.accelerometer.x = take<float>(cursor);
+                record.accelerometer.y = take<float>(cursor);
+                record.accelerometer.z = take<float>(cursor);
+                break;
+            case SensorTraceRecordTypeLocation:
+                record.location.t = take<double>(cursor);
+                record.location.latitude = take<double>(cursor);
+                record.location.longitude = take<double>(cursor);
+                record.location.altitude = take<float>(cursor);
+                record.location.speed = take<float>(cursor);
+                record.location.course = take<float>(cursor);
+                record.location.horizontalAccuracy = take<float>(cursor);
+                record.location.verticalAccuracy = take<float>(cursor);
+                record.location.source = take<int16_t>(cursor);
+                break;
+            case SensorTraceRecordTypePrediction:
+                record.prediction.t = take<double>(cursor);
+                record.prediction.activityType = take<int16_t>(cursor);
+                record.prediction.confidence = take<float>(cursor);
+                break;
+        }
+        return true;
+    }
+
+    bool readFully(int fd, void *bytes, size_t count, off_t offset)
+    {
+        return pread(fd, bytes, count, offset) == (ssize_t)count;
+    }
+
+    bool writeFully(int fd, const void *bytes, size_t count, off_t offset)
+    {
+        return pwrite(fd, bytes, count, offset) == (ssize_t)count;
+    }
+}
+
+struct SensorTraceWriter {
+    SensorTraceWriter(int fd, size_t chunkSize, double reorderWindow, bool compress)
+        : fd(fd), chunkSize(chunkSize), reorderWindow(reorderWindow), compress(compress), offset(sizeof(FileHeader)),
+          bufferedSize(0), newestTime(-INFINITY), writtenEndTime(-INFINITY), isFinished(false), didFail(false) {}
+
+    template <typename T>
+    bool append(SensorTraceRecordType type, const T *records, int count, T SensorTraceRecord::*field);
+    bool writeChunk(bool holdingBackReorderWindow);
+    bool finish();
+
+    int fd;
+    size_t chunkSize;
+    double reorderWindow;
+    bool compress;
+    off_t offset;
+
+    std::vector<SensorTraceRecord> buffer;
+    size_t bufferedSize;
+    double newestTime; // buffered
+    double writtenEndTime; // of the last written chunk
+    std::vector<IndexEntry> index;
+    bool isFinished;
+    bool didFail;
+
+    // reused between chunks
+    std::vector<uint8_t> raw;
+    std::vector<uint8_t> deflated;
+};
+
+template <typename T>
+bool SensorTraceWriter::append(SensorTraceRecordType type, const T *records, int count, T SensorTraceRecord::*field)
+{
+    if (isFinished || didFail) {
+        return false;
+    }
+    for (int i = 0; i < count; i++) {
+        if (!(records[i].t >= writtenEndTime)) {
+            return false;
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        SensorTraceRecord record;
+        record.type = type;
+        record.*field = records[i];
+        buffer.push_back(record);
+        bufferedSize += recordSize(record);
+        newestTime = std::max(newestTime, records[i].t);
+
+        if (bufferedSize >= chunkSize && !writeChunk(true)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SensorTraceWriter::writeChunk(bool holdingBackReorderWindow)
+{
+    if (buffer.empty()) {
+        return true;
+    }
+
+    std::stable_sort(buffer.begin(), buffer.end(), [](const SensorTraceRecord &a, const SensorTraceRecord &b) { return recordTime(a) < recordTime(b); });
+
+    size_t count = buffer.size();
+    if (holdingBackReorderWindow) {
+        double cutoff = newestTime - reorderWindow;
+        size_t heldBack = std::upper_bound(buffer.begin(), buffer.end(), cutoff, [](double time, const SensorTraceRecord &record) { return time < recordTime(record); }) - buffer.begin();
+        if (heldBack > 0) {
+            // otherwise the whole chunk is inside the window, and there's no choice but to write it
+            count = heldBack;
+        }
+    }
+
+    raw.clear();
+    for (size_t i = 0; i < count; i++) {
+        encodeRecord(buffer[i], raw);
+    }
+
+    ChunkHeader header;
+    memcpy(header.magic, kChunkMagic, sizeof(kChunkMagic));
+    header.rawSize = (uint32_t)raw.size();
+    header.recordCount = (uint32_t)count;
+    header.startTime = recordTime(buffer.front());
+    header.endTime = recordTime(buffer[count - 1]);
+    header.compression = ChunkCompressionNone;
+
+    const std::vector<uint8_t> *stored = &raw;
+    if (compress) {
+        uLongf deflatedSize = compressBound(raw.size());
+        deflated.resize(deflatedSize);
+        if (compress2(deflated.data(), &deflatedSize, raw.data(), raw.size(), Z_DEFAULT_COMPRESSION) == Z_OK && deflatedSize < raw.size()) {
+            deflated.resize(deflatedSize);
+            stored = &deflated;
+            header.compression = ChunkCompressionDeflate;
+        }
+    }
+    header.storedSize = (uint32_t)stored->size();
+    header.crc = crc32(stored->data(), stored->size());
+
+    if (!writeFully(fd, &header, sizeof(header), offset) || !writeFully(fd, stored->data(), stored->size(), offset + sizeof(header))) {
+        didFail = true;
+        return false;
+    }
+
+    IndexEntry entry;
+    entry.offset = (uint64_t)offset;
+    entry.startTime = header.startTime;
+    entry.endTime = header.endTime;
+    entry.recordCount = header.recordCount;
+    entry.reserved = 0;
+    index.push_back(entry);
+
+    offset += sizeof(header) + stored->size();
+    writtenEndTime = header.endTime;
+    buffer.erase(buffer.begin(), buffer.begin() + count);
+    bufferedSize = 0;
+    for (size_t i = 0; i < buffer.size(); i++) {
+        bufferedSize += recordSize(buffer[i]);
+    }
+    return true;
+}
+
+bool SensorTraceWriter::finish()
+{
+    if (isFinished) {
+        return !didFail;
+    }
+    isFinished = true;
+    if (didFail || !writeChunk(false)) {
+        return false;
+    }
+
+    size_t indexSize = index.size() * sizeof(IndexEntry);
+    Trailer trailer;
+    trailer.indexOffset = (uint64_t)offset;
+    trailer.chunkCount = (uint32_t)index.size();
+    trailer.crc = crc32(reinterpret_cast<const uint8_t *>(index.data()), indexSize);
+    memcpy(trailer.magic, kTrailerMagic, sizeof(kTrailerMagic));
+    trailer.version = kTraceVersion;
+
+    if (!writeFully(fd, index.data(), indexSize, offset) || !writeFully(fd, &trailer, sizeof(trailer), offset + indexSize) ||
+        ftruncate(fd, offset + indexSize + sizeof(trailer)) != 0 || fsync(fd) != 0) {
+        didFail = true;
+        return false;
+    }
+    return true;
+}
+
+SensorTraceWriter *createSensorTraceWriter(const char *path, int chunkSize, double reorderWindow, bool compress)
+{
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    FileHeader header;
+    memcpy(header.magic, kFileMagic, sizeof(kFileMagic));
+    header.version = kTraceVersion;
+    if (!writeFully(fd, &header, sizeof(header), 0)) {
+        close(fd);
+        unlink(path);
+        return NULL;
+    }
+
+    return new SensorTraceWriter(fd, (size_t)std::max(chunkSize, 1), std::max(reorderWindow, 0.0), compress);
+}
+
+void deleteSensorTraceWriter(SensorTraceWriter *writer)
+{
+    writer->finish();
+    close(writer->fd);
+    delete writer;
+}
+
+bool sensorTraceWriterAppendAccelerometer(SensorTraceWriter *writer, const SensorTraceAccelerometerRecord *records, int count)
+{
+    return writer->append(SensorTraceRecordTypeAccelerometer, records, count, &SensorTraceRecord::accelerometer);
+}
+
+bool sensorTraceWriterAppendLocations(SensorTraceWriter *writer, const SensorTraceLocationRecord *records, int count)
+{
+    return writer->append(SensorTraceRecordTypeLocation, records, count, &SensorTraceRecord::location);
+}
+
+bool sensorTraceWriterAppendPredictions(SensorTraceWriter *writer, const SensorTracePredictionRecord *records, int count)
+{
+    return writer->append(SensorTraceRecordTypePrediction, records, count, &SensorTraceRecord::prediction);
+}
+
+bool sensorTraceWriterFinish(SensorTraceWriter *writer)
+{
+    return writer->finish();
+}
+
+struct SensorTraceReader {
+    SensorTraceReader(int fd) : fd(fd), recordCount(0), currentChunk(-1), position(0) {}
+
+    bool load();
+    bool loadIndex(off_t fileSize);
+    void scanChunks(off_t fileSize);
+    bool loadChunk(int chunk);
+
+    int fd;
+    std::vector<IndexEntry> index;
+    int64_t recordCount;
+
+    int currentChunk;
+    std::vector<SensorTraceRecord> records; // of currentChunk
+    size_t position;
+
+    // reused between chunks
+    std::vector<uint8_t> stored;
+    std::vector<uint8_t> raw;
+};
+
+bool SensorTraceReader::load()
+{
+    struct stat status;
+    FileHeader header;
+    if (fstat(fd, &status) != 0 || !readFully(fd, &header, sizeof(header), 0) ||
+        memcmp(header.magic, kFileMagic, sizeof(kFileMagic)) != 0 || header.version != kTraceVersion) {
+        return false;
+    }
+
+    if (!loadIndex(status.st_size)) {
+        scanChunks(status.st_size);
+    }
+    for (size_t i = 0; i < index.size(); i++) {
+        recordCount += index[i].recordCount;
+    }
+    return true;
+}
+
+bool SensorTraceReader::loadIndex(off_t fileSize)
+{
+    Trailer trailer;
+    if (fileSize < (off_t)(sizeof(FileHeader) + sizeof(Trailer)) || !readFully(fd, &trailer, sizeof(trailer), fileSize - sizeof(trailer)) ||
+        memcmp(trailer.magic, kTrailerMagic, sizeof(kTrailerMagic)) != 0 ||
+        trailer.indexOffset + (uint64_t)trailer.chunkCount * sizeof(IndexEntry) + sizeof(trailer) != (uint64_t)fileSize) {
+        return false;
+    }
+
+    index.resize(trailer.chunkCount);
+    size_t indexSize = index.size() * sizeof(IndexEntry);
+    if (!readFully(fd, index.data(), indexSize, trailer.indexOffset) || crc32(reinterpret_cast<const uint8_t *>(index.data()), indexSize) != trailer.crc) {
+        index.clear();
+        return false;
+    }
+    return true;
+}
+
+void SensorTraceReader::scanChunks(off_t fileSize)
+{
+    // the writer never finished, so index whatever whole chunks made it to disk
+    off_t offset = sizeof(FileHeader);
+    ChunkHeader header;
+    while (offset + (off_t)sizeof(header) <= fileSize && readFully(fd, &header, sizeof(header), offset) &&
+           memcmp(header.magic, kChunkMagic, sizeof(kChunkMagic)) == 0 && offset + (off_t)sizeof(header) + (off_t)header.storedSize <= fileSize) {
+        IndexEntry entry;
+        entry.offset = (uint64_t)offset;
+        entry.startTime = header.startTime;
+        entry.endTime = header.endTime;
+        entry.recordCount = header.recordCount;
+        entry.reserved = 0;
+        index.push_back(entry);
+
+        offset += sizeof(header) + header.storedSize;
+    }
+}
+
+bool SensorTraceReader::loadChunk(int chunk)
+{
+    currentChunk = chunk;
+    records.clear();
+    position = 0;
+
+    ChunkHeader header;
+    if (!readFully(fd, &header, sizeof(header), index[chunk].offset) || memcmp(header.magic, kChunkMagic, sizeof(kChunkMagic)) != 0) {
+        return false;
+    }
+    stored.resize(header.storedSize);
+    if (!readFully(fd, stored.data(), stored.size(), index[chunk].offset + sizeof(header)) || crc32(stored.data(), stored.size()) != header.crc) {
+        return false;
+    }
+
+    const std::vector<uint8_t> *bytes = &stored;
+    if (header.compression == ChunkCompressionDeflate) {
+        raw.resize(header.rawSize);
+        uLongf rawSize = header.rawSize;
+        if (uncompress(raw.data(), &rawSize, stored.data(), stored.size()) != Z_OK || rawSize != header.rawSize) {
+            return false;
+        }
+        bytes = &raw;
+    } else if (header.compression != ChunkCompressionNone) {
+        return false;
+    }
+
+    records.resize(header.recordCount);
+    const uint8_t *cursor = bytes->data();
+    const uint8_t *end = cursor + bytes->size();
+    for (size_t i = 0; i < records.size(); i++) {
+        if (!decodeRecord(cursor, end, records[i])) {
+            records.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+SensorTraceReader *createSensorTraceReader(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    SensorTraceReader *reader = new SensorTraceReader(fd);
+    if (!reader->load()) {
+        deleteSensorTraceReader(reader);
+        return NULL;
+    }
+    return reader;
+}
+
+void deleteSensorTraceReader(SensorTraceReader *reader)
+{
+    close(reader->fd);
+    delete reader;
+}
+
+int sensorTraceReaderChunkCount(SensorTraceReader *reader)
+{
+    return (int)reader->index.size();
+}
+
+int64_t sensorTraceReaderRecordCount(SensorTraceReader *reader)
+{
+    return reader->recordCount;
+}
+
+double sensorTraceReaderStartTime(SensorTraceReader *reader)
+{
+    return reader->index.empty() ? 0 : reader->index.front().startTime;
+}
+
+double sensorTraceReaderEndTime(SensorTraceReader *reader)
+{
+    return reader->index.empty() ? 0 : reader->index.back().endTime;
+}
+
+bool sensorTraceReaderSeek(SensorTraceReader *reader, double time)
+{
+    // chunks never overlap, so end times are sorted too
+    std::vector<IndexEntry>::const_iterator chunk = std::lower_bound(reader->index.begin(), reader->index.end(), time,
+                                                                     [](const IndexEntry &entry, double time) { return entry.endTime < time; });
+    if (chunk == reader->index.end()) {
+        reader->currentChunk = (int)reader->index.size();
+        reader->records.clear();
+        reader->position = 0;
+        return true;
+    }
+
+    if (!reader->loadChunk((int)(chunk - reader->index.begin()))) {
+        return false;
+    }
+    reader->position = std::lower_bound(reader->records.begin(), reader->records.end(), time,
+                                        [](const SensorTraceRecord &record, double time) { return recordTime(record) < time; }) - reader->records.begin();
+    return true;
+}
+
+bool sensorTraceReaderNext(SensorTraceReader *reader, SensorTraceRecord *record)
+{
+    while (reader->position >= reader->records.size()) {
+        int nextChunk = reader->currentChunk + 1;
+        if (nextChunk >= (int)reader->index.size()) {
+            return false;
+        }
+        if (!reader->loadChunk(nextChunk)) {
+            reader->currentChunk = (int)reader->index.size(); // stop at the corrupt chunk
+            return false;
+        }
+    }
+
+    *record = reader->records[reader->position++];
+    return true;
+}
@@ -0,0 +1,100 @@
+//
+//  SensorTrace.h
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#ifndef SensorTrace_h
+#define SensorTrace_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    // A recorded session of accelerometer, location and prediction records interleaved in time order, for replaying
+    // through the classifier and for training tools that would otherwise parse PredictionAggregator JSON dumps.
+    //
+    // The file is a run of chunks, each holding a time-sorted block of fixed-size records and optionally deflated,
+    // followed by an index of every chunk's time span and offset. Readers binary search the index to seek, and a
+    // file whose writer never finished (so has no index) is indexed by walking its chunk headers instead. Times are
+    // seconds since the reference date (Date.timeIntervalSinceReferenceDate). Not thread safe.
+    typedef struct SensorTraceWriter SensorTraceWriter;
+    typedef struct SensorTraceReader SensorTraceReader;
+
+    typedef enum SensorTraceRecordType {
+        SensorTraceRecordTypeAccelerometer = 1,
+        SensorTraceRecordTypeLocation = 2,
+        SensorTraceRecordTypePrediction = 3,
+    } SensorTraceRecordType;
+
+    typedef struct SensorTraceAccelerometerRecord {
+        double t;
+        float x;
+        float y;
+        float z;
+    } SensorTraceAccelerometerRecord;
+
+    typedef struct SensorTraceLocationRecord {
+        double t;
+        double latitude;
+        double longitude;
+        float altitude;
+        float speed;
+        float course;
+        float horizontalAccuracy;
+        float verticalAccuracy;
+        int16_t source;
+    } SensorTraceLocationRecord;
+
+    // One activity's confidence in a prediction; a prediction is one record per activity, all at its start time.
+    typedef struct SensorTracePredictionRecord {
+        double t;
+        int16_t activityType;
+        float confidence;
+    } SensorTracePredictionRecord;
+
+    typedef struct SensorTraceRecord {
+        SensorTraceRecordType type;
+        union {
+            SensorTraceAccelerometerRecord accelerometer;
+            SensorTraceLocationRecord location;
+            SensorTracePredictionRecord prediction;
+        };
+    } SensorTraceRecord;
+
+    // Records are buffered until chunkSize bytes of them have been appended, then sorted and written out as a chunk,
+    // deflated if compress is set and that makes it smaller. Streams arrive in batches that overlap in time, so records
+    // within reorderWindow seconds of the newest one are held back for the next chunk; an append that's earlier than
+    // a chunk already written is rejected. Returns NULL if the file can't be created.
+    SensorTraceWriter *createSensorTraceWriter(const char *path, int chunkSize, double reorderWindow, bool compress);
+    void deleteSensorTraceWriter(SensorTraceWriter *writer); // finishes the trace if it wasn't already
+
+    bool sensorTraceWriterAppendAccelerometer(SensorTraceWriter *writer, const SensorTraceAccelerometerRecord *records, int count);
+    bool sensorTraceWriterAppendLocations(SensorTraceWriter *writer, const SensorTraceLocationRecord *records, int count);
+    bool sensorTraceWriterAppendPredictions(SensorTraceWriter *writer, const SensorTracePredictionRecord *records, int count);
+
+    // Writes the last chunk and the index. Nothing can be appended after. Returns false if anything failed to write.
+    bool sensorTraceWriterFinish(SensorTraceWriter *writer);
+
+    // Returns NULL if the file isn't a trace.
+    SensorTraceReader *createSensorTraceReader(const char *path);
+    void deleteSensorTraceReader(SensorTraceReader *reader);
+
+    int sensorTraceReaderChunkCount(SensorTraceReader *reader);
+    int64_t sensorTraceReaderRecordCount(SensorTraceReader *reader);
+    double sensorTraceReaderStartTime(SensorTraceReader *reader);
+    double sensorTraceReaderEndTime(SensorTraceReader *reader);
+
+    // Positions the reader at the first record at or after time, decoding only the chunk that holds it.
+    bool sensorTraceReaderSeek(SensorTraceReader *reader, double time);
+
+    // The next record in time order. Returns false at the end, or at a chunk that's corrupt.
+    bool sensorTraceReaderNext(SensorTraceReader *reader, SensorTraceRecord *record);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SensorTrace_h */
@@ -0,0 +1,259 @@
+//
+//  SensorTrace.swift
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+import Foundation
+import SwiftyJSON
+import CocoaLumberjack
+
+// Writes a session's accelerometer readings, locations and predictions to a binary trace, which is a small fraction
+// of the size of the same session as JSON and can be replayed from any point without parsing what comes before it.
+// Spectral features and model identifiers aren't kept. Not thread safe.
+class SensorTraceWriter {
+    static let chunkSize = 64 * 1024
+    static let reorderWindow: TimeInterval = 10
+
+    let fileURL: URL
+    private var writer: OpaquePointer!
+
+    init?(fileURL: URL, compressed: Bool = true) {
+        self.fileURL = fileURL
+        guard let writer = createSensorTraceWriter(fileURL.path, Int32(SensorTraceWriter.chunkSize), SensorTraceWriter.reorderWindow, compressed) else {
+            DDLogError(String(format: "Could not create sensor trace at %@", fileURL.path))
+            return nil
+        }
+        self.writer = writer
+    }
+
+    deinit {
+        deleteSensorTraceWriter(self.writer)
+    }
+
+    //
+    // MARK: Writing
+    //
+
+    // Appends a whole session, such as a PredictionAggregator's. Each stream covers all of it, so the streams are
+    // merged into time order first.
+    @discardableResult func append(_ aggregator: PredictionAggregator)->Bool {
+        var records: [SensorTraceRecord] = []
+        for reading in aggregator.accelerometerReadings {
+            records.append(SensorTraceRecord(SensorTraceAccelerometerRecord(t: reading.date.timeIntervalSinceReferenceDate, x: Float(reading.x), y: Float(reading.y), z: Float(reading.z))))
+        }
+
+        let locations = aggregator.route?.fetchOrderedLocations(includingInferred: true) ?? Array(aggregator.locations)
+        for location in locations {
+            records.append(SensorTraceRecord(SensorTraceLocationRecord(t: location.date.timeIntervalSinceReferenceDate,
+                                                                       latitude: location.latitude,
+                                                                       longitude: location.longitude,
+                                                                       altitude: Float(location.altitude),
+                                                                       speed: Float(location.speed),
+                                                                       course: Float(location.course),
+                                                                       horizontalAccuracy: Float(location.horizontalAccuracy),
+                                                                       verticalAccuracy: Float(location.verticalAccuracy),
+                                                                       source: location.sourceInteger)))
+        }
+
+        for prediction in aggregator.predictions {
+            for predictedActivity in prediction.predictedActivities {
+                records.append(SensorTraceRecord(SensorTracePredictionRecord(t: prediction.startDate.timeIntervalSinceReferenceDate, activityType: predictedActivity.activityType.rawValue, confidence: Float(predictedActivity.confidence))))
+            }
+        }
+
+        return self.append(session: records)
+    }
+
+    private func append(session records: [SensorTraceRecord])->Bool {
+        let records = records.sorted { $0.time < $1.time }
+
+        // append each run of one stream together
+        var runStart = 0
+        while runStart < records.count {
+            var runEnd = runStart + 1
+            while runEnd < records.count && records[runEnd].type == records[runStart].type {
+                runEnd += 1
+            }
+
+            let run = records[runStart..<runEnd]
+            let didAppend: Bool
+            switch records[runStart].type {
+            case SensorTraceRecordTypeAccelerometer:
+                didAppend = self.append(accelerometerRecords: run.map { $0.accelerometer })
+            case SensorTraceRecordTypeLocation:
+                didAppend = self.append(locationRecords: run.map { $0.location })
+            default:
+                didAppend = self.append(predictionRecords: run.map { $0.prediction })
+            }
+            if !didAppend {
+                return false
+            }
+
+            runStart = runEnd
+        }
+
+        return true
+    }
+
+    @discardableResult func append(accelerometerRecords records: [SensorTraceAccelerometerRecord])->Bool {
+        if !sensorTraceWriterAppendAccelerometer(self.writer, records, Int32(records.count)) {
+            DDLogWarn("Error appending accelerometer readings to sensor trace!")
+            return false
+        }
+        return true
+    }
+
+    @discardableResult func append(locationRecords records: [SensorTraceLocationRecord])->Bool {
+        if !sensorTraceWriterAppendLocations(self.writer, records, Int32(records.count)) {
+            DDLogWarn("Error appending locations to sensor trace!")
+            return false
+        }
+        return true
+    }
+
+    @discardableResult func append(predictionRecords records: [SensorTracePredictionRecord])->Bool {
+        if !sensorTraceWriterAppendPredictions(self.writer, records, Int32(records.count)) {
+            DDLogWarn("Error appending predictions to sensor trace!")
+            return false
+        }
+        return true
+    }
+
+    // Writes out the rest of the trace and its index. Nothing can be appended after.
+    @discardableResult func finish()->Bool {
+        if !sensorTraceWriterFinish(self.writer) {
+            DDLogWarn("Error finishing sensor trace!")
+            return false
+        }
+        return true
+    }
+
+    //
+    // MARK: Converting
+    //
+
+    // Converts a PredictionAggregator JSON dump, in the format of PredictionAggregator.jsonDictionary().
+    class func convert(JSON json: JSON, to fileURL: URL)->Bool {
+        guard let writer = SensorTraceWriter(fileURL: fileURL) else {
+            return false
+        }
+
+        var records: [SensorTraceRecord] = []
+        for reading in json["accelerometerReadings"].arrayValue {
+            if let dateString = reading["date"].string, let date = Date.dateFromJSONString(dateString) {
+                records.append(SensorTraceRecord(SensorTraceAccelerometerRecord(t: date.timeIntervalSinceReferenceDate, x: reading["x"].floatValue, y: reading["y"].floatValue, z: reading["z"].floatValue)))
+            }
+        }
+
+        for location in json["locations"].arrayValue {
+            if let dateString = location["date"].string, let date = Date.dateFromJSONString(dateString) {
+                records.append(SensorTraceRecord(SensorTraceLocationRecord(t: date.timeIntervalSinceReferenceDate,
+                                                                           latitude: location["latitude"].doubleValue,
+                                                                           longitude: location["longitude"].doubleValue,
+                                                                           altitude: location["altitude"].floatValue,
+                                                                           speed: location["speed"].float ?? -1,
+                                                                           course: location["course"].float ?? -1,
+                                                                           horizontalAccuracy: location["horizontalAccuracy"].floatValue,
+                                                                           verticalAccuracy: location["verticalAccuracy"].float ?? -1,
+                                                                           source: location["source"].int16Value)))
+            }
+        }
+
+        for prediction in json["predictions"].arrayValue {
+            guard let dateString = prediction["startDate"].string, let date = Date.dateFromJSONString(dateString) else {
+                continue
+            }
+            for predictedActivity in prediction["predictedActivities"].arrayValue {
+                records.append(SensorTraceRecord(SensorTracePredictionRecord(t: date.timeIntervalSinceReferenceDate, activityType: predictedActivity["activityType"].int16Value, confidence: predictedActivity["confidence"].floatValue)))
+            }
+        }
+
+        guard writer.append(session: records) else {
+            return false
+        }
+
+        return writer.finish()
+    }
+}
+
+// Reads a trace written by SensorTraceWriter in time order, starting anywhere. Not thread safe.
+class SensorTraceReader {
+    let fileURL: URL
+    private var reader: OpaquePointer!
+
+    init?(fileURL: URL) {
+        self.fileURL = fileURL
+        guard let reader = createSensorTraceReader(fileURL.path) else {
+            DDLogError(String(format: "Could not open sensor trace at %@", fileURL.path))
+            return nil
+        }
+        self.reader = reader
+    }
+
+    deinit {
+        deleteSensorTraceReader(self.reader)
+    }
+
+    var recordCount: Int {
+        return Int(sensorTraceReaderRecordCount(self.reader))
+    }
+
+    var chunkCount: Int {
+        return Int(sensorTraceReaderChunkCount(self.reader))
+    }
+
+    var startDate: Date {
+        return Date(timeIntervalSinceReferenceDate: sensorTraceReaderStartTime(self.reader))
+    }
+
+    var endDate: Date {
+        return Date(timeIntervalSinceReferenceDate: sensorTraceReaderEndTime(self.reader))
+    }
+
+    // The next record returned is the first one at or after date.
+    @discardableResult func seek(to date: Date)->Bool {
+        return sensorTraceReaderSeek(self.reader, date.timeIntervalSinceReferenceDate)
+    }
+
+    func next()->SensorTraceRecord? {
+        var record = SensorTraceRecord()
+        guard sensorTraceReaderNext(self.reader, &record) else {
+            return nil
+        }
+
+        return record
+    }
+}
+
+extension SensorTraceRecord {
+    init(_ record: SensorTraceAccelerometerRecord) {
+        self.init()
+        self.type = SensorTraceRecordTypeAccelerometer
+        self.accelerometer = record
+    }
+
+    init(_ record: SensorTraceLocationRecord) {
+        self.init()
+        self.type = SensorTraceRecordTypeLocation
+        self.location = record
+    }
+
+    init(_ record: SensorTracePredictionRecord) {
+        self.init()
+        self.type = SensorTraceRecordTypePrediction
+        self.prediction = record
+    }
+
+    var time: TimeInterval {
+        switch self.type {
+        case SensorTraceRecordTypeAccelerometer:
+            return self.accelerometer.t
+        case SensorTraceRecordTypeLocation:
+            return self.location.t
+        default:
+            return self.prediction.t
+        }
+    }
+}
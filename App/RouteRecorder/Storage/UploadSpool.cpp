@@ -0,0 +1,400 @@
+//
+//  UploadSpool.cpp
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#include "UploadSpool.h"
+#include "CRC32.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const char kSegmentMagic[4] = {'R', 'R', 'S', 'P'};
+    const char kAcknowledgementMagic[4] = {'R', 'R', 'A', 'K'};
+    const uint32_t kSpoolVersion = 1;
+    const char *kAcknowledgementFileName = "acknowledged";
+
+    struct SegmentHeader {
+        char magic[4];
+        uint32_t version;
+    };
+
+    // Each entry is a FrameHeader followed by length bytes: the sequence, the idempotency key and destination as
+    // length-prefixed strings, then the body.
+    struct FrameHeader {
+        uint32_t length;
+        uint32_t crc; // of the length bytes that follow
+    };
+
+    struct AcknowledgementRecord {
+        char magic[4];
+        uint32_t crc; // of sequence
+        uint64_t sequence;
+    };
+
+    static_assert(sizeof(SegmentHeader) == 8, "Segment header layout changed");
+    static_assert(sizeof(FrameHeader) == 8, "Frame header layout changed");
+    static_assert(sizeof(AcknowledgementRecord) == 16, "Acknowledgement layout changed");
+
+    struct Segment {
+        uint64_t firstSequence;
+        std::string path;
+        off_t size;
+        bool isSealed; // after a write we couldn't take back
+    };
+
+    struct IndexedEntry {
+        uint64_t sequence;
+        size_t segment;
+        off_t offset; // of the frame header
+        uint32_t length;
+    };
+
+    bool readFully(int fd, void *bytes, size_t count, off_t offset)
+    {
+        return pread(fd, bytes, count, offset) == (ssize_t)count;
+    }
+
+    bool writeFully(int fd, const void *bytes, size_t count, off_t offset)
+    {
+        return pwrite(fd, bytes, count, offset) == (ssize_t)count;
+    }
+
+    bool readString(const uint8_t *&cursor, const uint8_t *end, const char *&string, std::vector<char> &storage)
+    {
+        uint16_t length;
+        if (end - cursor < (ptrdiff_t)sizeof(length)) {
+            return false;
+        }
+        memcpy(&length, cursor, sizeof(length));
+        cursor += sizeof(length);
+        if (end - cursor < (ptrdiff_t)length) {
+            return false;
+        }
+        storage.assign(cursor, cursor + length);
+        storage.push_back('\0');
+        string = storage.data();
+        cursor += length;
+        return true;
+    }
+}
+
+struct UploadSpool {
+    UploadSpool(const std::string &directoryPath, int64_t maximumSegmentSize)
+        : directoryPath(directoryPath), maximumSegmentSize(maximumSegmentSize), acknowledgedSequence(0), nextSequence(1) {}
+
+    bool load();
+    bool loadSegment(Segment &segment);
+    bool writeAcknowledgement(uint64_t sequence);
+    void removeAcknowledgedSegments();
+
+    std::string directoryPath;
+    int64_t maximumSegmentSize;
+
+    std::vector<Segment> segments;
+    std::vector<IndexedEntry> entries; // unacknowledged, oldest first
+    uint64_t acknowledgedSequence;
+    uint64_t nextSequence;
+
+    // backing for the last peeked entry
+    std::vector<uint8_t> frame;
+    std::vector<char> idempotencyKey;
+    std::vector<char> destination;
+};
+
+bool UploadSpool::load()
+{
+    if (mkdir(directoryPath.c_str(), 0755) != 0 && errno != EEXIST) {
+        return false;
+    }
+
+    int fd = open((directoryPath + "/" + kAcknowledgementFileName).c_str(), O_RDONLY);
+    if (fd >= 0) {
+        AcknowledgementRecord record;
+        if (readFully(fd, &record, sizeof(record), 0) && memcmp(record.magic, kAcknowledgementMagic, sizeof(kAcknowledgementMagic)) == 0 &&
+            crc32((const uint8_t *)&record.sequence, sizeof(record.sequence)) == record.crc) {
+            acknowledgedSequence = record.sequence;
+        }
+        close(fd);
+    }
+
+    DIR *dir = opendir(directoryPath.c_str());
+    if (dir == NULL) {
+        return false;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        unsigned long long firstSequence;
+        char suffix[8];
+        if (sscanf(entry->d_name, "%llu.%7s", &firstSequence, suffix) == 2 && strcmp(suffix, "spool") == 0) {
+            Segment segment = {(uint64_t)firstSequence, directoryPath + "/" + entry->d_name, 0, false};
+            segments.push_back(segment);
+        }
+    }
+    closedir(dir);
+
+    std::sort(segments.begin(), segments.end(), [](const Segment &a, const Segment &b) { return a.firstSequence < b.firstSequence; });
+
+    nextSequence = acknowledgedSequence + 1;
+    for (size_t i = 0; i < segments.size(); i++) {
+        if (!loadSegment(segments[i])) {
+            return false;
+        }
+    }
+
+    removeAcknowledgedSegments();
+
+    return true;
+}
+
+bool UploadSpool::loadSegment(Segment &segment)
+{
+    int fd = open(segment.path.c_str(), O_RDWR);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0) {
+        close(fd);
+        return false;
+    }
+
+    SegmentHeader header;
+    off_t offset = sizeof(header);
+    if (status.st_size < (off_t)sizeof(header) || !readFully(fd, &header, sizeof(header), 0) ||
+        memcmp(header.magic, kSegmentMagic, sizeof(kSegmentMagic)) != 0 || header.version != kSpoolVersion) {
+        offset = 0;
+    }
+
+    size_t segmentIndex = &segment - segments.data();
+    while (offset > 0 && status.st_size - offset >= (off_t)sizeof(FrameHeader)) {
+        FrameHeader frameHeader;
+        uint64_t sequence;
+        if (!readFully(fd, &frameHeader, sizeof(frameHeader), offset) || frameHeader.length < sizeof(sequence) ||
+            frameHeader.length > status.st_size - offset - sizeof(frameHeader)) {
+            break;
+        }
+        frame.resize(frameHeader.length);
+        if (!readFully(fd, frame.data(), frame.size(), offset + sizeof(frameHeader)) || crc32(frame.data(), frame.size()) != frameHeader.crc) {
+            break;
+        }
+
+        memcpy(&sequence, frame.data(), sizeof(sequence));
+        if (sequence > acknowledgedSequence) {
+            IndexedEntry indexed = {sequence, segmentIndex, offset, frameHeader.length};
+            entries.push_back(indexed);
+        }
+        nextSequence = std::max(nextSequence, sequence + 1);
+        offset += sizeof(frameHeader) + frameHeader.length;
+    }
+
+    // a torn entry can only be the last one written, which was never acknowledged as enqueued
+    bool succeeded = true;
+    if (offset < status.st_size) {
+        succeeded = ftruncate(fd, offset) == 0;
+    }
+    segment.size = offset;
+    close(fd);
+
+    return succeeded;
+}
+
+bool UploadSpool::writeAcknowledgement(uint64_t sequence)
+{
+    AcknowledgementRecord record;
+    memcpy(record.magic, kAcknowledgementMagic, sizeof(record.magic));
+    record.sequence = sequence;
+    record.crc = crc32((const uint8_t *)&record.sequence, sizeof(record.sequence));
+
+    // written beside the old one and renamed over it, so a crash leaves one or the other
+    std::string path = directoryPath + "/" + kAcknowledgementFileName;
+    std::string temporaryPath = path + ".tmp";
+    int fd = open(temporaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    bool succeeded = writeFully(fd, &record, sizeof(record), 0) && fsync(fd) == 0;
+    close(fd);
+
+    return succeeded && rename(temporaryPath.c_str(), path.c_str()) == 0;
+}
+
+void UploadSpool::removeAcknowledgedSegments()
+{
+    // a segment is done once the next one starts at or before the first unacknowledged sequence
+    size_t removedCount = 0;
+    for (size_t i = 0; i < segments.size(); i++) {
+        uint64_t nextFirstSequence = i + 1 < segments.size() ? segments[i + 1].firstSequence : nextSequence;
+        if (nextFirstSequence > acknowledgedSequence + 1) {
+            break;
+        }
+        unlink(segments[i].path.c_str());
+        removedCount++;
+    }
+
+    if (removedCount > 0) {
+        segments.erase(segments.begin(), segments.begin() + removedCount);
+        for (size_t i = 0; i < entries.size(); i++) {
+            entries[i].segment -= removedCount;
+        }
+    }
+}
+
+UploadSpool *createUploadSpool(const char *directoryPath, int64_t maximumSegmentSize)
+{
+    UploadSpool *spool = new UploadSpool(directoryPath, maximumSegmentSize);
+    if (!spool->load()) {
+        delete spool;
+        return NULL;
+    }
+
+    return spool;
+}
+
+void deleteUploadSpool(UploadSpool *spool)
+{
+    delete spool;
+}
+
+uint64_t uploadSpoolEnqueue(UploadSpool *spool, const char *idempotencyKey, const char *destination, const uint8_t *body, int64_t bodyLength)
+{
+    size_t keyLength = strlen(idempotencyKey);
+    size_t destinationLength = strlen(destination);
+    if (keyLength > UINT16_MAX || destinationLength > UINT16_MAX || bodyLength < 0) {
+        return 0;
+    }
+
+    uint64_t sequence = spool->nextSequence;
+    uint16_t keyLength16 = (uint16_t)keyLength;
+    uint16_t destinationLength16 = (uint16_t)destinationLength;
+
+    std::vector<uint8_t> &frame = spool->frame;
+    frame.resize(sizeof(FrameHeader));
+    frame.insert(frame.end(), (const uint8_t *)&sequence, (const uint8_t *)&sequence + sizeof(sequence));
+    frame.insert(frame.end(), (const uint8_t *)&keyLength16, (const uint8_t *)&keyLength16 + sizeof(keyLength16));
+    frame.insert(frame.end(), idempotencyKey, idempotencyKey + keyLength);
+    frame.insert(frame.end(), (const uint8_t *)&destinationLength16, (const uint8_t *)&destinationLength16 + sizeof(destinationLength16));
+    frame.insert(frame.end(), destination, destination + destinationLength);
+    frame.insert(frame.end(), body, body + bodyLength);
+
+    FrameHeader frameHeader;
+    frameHeader.length = (uint32_t)(frame.size() - sizeof(frameHeader));
+    frameHeader.crc = crc32(frame.data() + sizeof(frameHeader), frameHeader.length);
+    memcpy(frame.data(), &frameHeader, sizeof(frameHeader));
+
+    if (spool->segments.empty() || spool->segments.back().isSealed || spool->segments.back().size + (off_t)frame.size() > spool->maximumSegmentSize) {
+        char name[32];
+        snprintf(name, sizeof(name), "%020llu.spool", (unsigned long long)sequence);
+        Segment segment = {sequence, spool->directoryPath + "/" + name, 0, false};
+        spool->segments.push_back(segment);
+    }
+
+    Segment &segment = spool->segments.back();
+    int fd = open(segment.path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        return 0;
+    }
+
+    bool succeeded = true;
+    if (segment.size == 0) {
+        SegmentHeader header;
+        memcpy(header.magic, kSegmentMagic, sizeof(header.magic));
+        header.version = kSpoolVersion;
+        succeeded = writeFully(fd, &header, sizeof(header), 0);
+        if (succeeded) {
+            segment.size = sizeof(header);
+        }
+    }
+    succeeded = succeeded && writeFully(fd, frame.data(), frame.size(), segment.size) && fsync(fd) == 0;
+    if (!succeeded) {
+        // cut off whatever part of the frame made it, or failing that, make sure nothing is written after it
+        if (ftruncate(fd, segment.size) != 0) {
+            segment.isSealed = true;
+        }
+        close(fd);
+        return 0;
+    }
+    close(fd);
+
+    IndexedEntry indexed = {sequence, spool->segments.size() - 1, segment.size, frameHeader.length};
+    spool->entries.push_back(indexed);
+    segment.size += (off_t)frame.size();
+    spool->nextSequence = sequence + 1;
+
+    return sequence;
+}
+
+bool uploadSpoolPeek(UploadSpool *spool, UploadSpoolEntry *entry)
+{
+    if (spool->entries.empty()) {
+        return false;
+    }
+
+    const IndexedEntry &indexed = spool->entries.front();
+    int fd = open(spool->segments[indexed.segment].path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    std::vector<uint8_t> &frame = spool->frame;
+    frame.resize(indexed.length);
+    bool succeeded = readFully(fd, frame.data(), frame.size(), indexed.offset + sizeof(FrameHeader));
+    close(fd);
+    if (!succeeded) {
+        return false;
+    }
+
+    const uint8_t *cursor = frame.data() + sizeof(uint64_t);
+    const uint8_t *end = frame.data() + frame.size();
+    if (!readString(cursor, end, entry->idempotencyKey, spool->idempotencyKey) || !readString(cursor, end, entry->destination, spool->destination)) {
+        return false;
+    }
+    entry->sequence = indexed.sequence;
+    entry->body = cursor;
+    entry->bodyLength = end - cursor;
+
+    return true;
+}
+
+bool uploadSpoolAcknowledge(UploadSpool *spool, uint64_t sequence)
+{
+    if (sequence <= spool->acknowledgedSequence) {
+        return true;
+    }
+    sequence = std::min(sequence, spool->nextSequence - 1);
+
+    if (!spool->writeAcknowledgement(sequence)) {
+        return false;
+    }
+    spool->acknowledgedSequence = sequence;
+
+    std::vector<IndexedEntry>::iterator firstPending = std::find_if(spool->entries.begin(), spool->entries.end(), [sequence](const IndexedEntry &entry) { return entry.sequence > sequence; });
+    spool->entries.erase(spool->entries.begin(), firstPending);
+    spool->removeAcknowledgedSegments();
+
+    return true;
+}
+
+UploadSpoolStatistics uploadSpoolStatistics(UploadSpool *spool)
+{
+    UploadSpoolStatistics statistics;
+    statistics.pendingCount = (int)spool->entries.size();
+    statistics.segmentCount = (int)spool->segments.size();
+    statistics.byteCount = 0;
+    for (size_t i = 0; i < spool->segments.size(); i++) {
+        statistics.byteCount += spool->segments[i].size;
+    }
+    return statistics;
+}
@@ -0,0 +1,57 @@
+//
+//  UploadSpool.h
+//  RouteRecorder
+//
+//  Copyright © 2026 Knock Softwae, Inc. All rights reserved.
+//
+
+#ifndef UploadSpool_h
+#define UploadSpool_h
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    // Persistent FIFO of encoded upload payloads, kept in a directory of segment files. Every entry is framed with
+    // its length and a CRC-32 and stays on disk until it's acknowledged, so a payload that was sent but never
+    // acknowledged is delivered again after a crash; the idempotency key it was enqueued with lets the server drop
+    // the duplicate. Segments are unlinked once every entry in them has been acknowledged. Not thread safe.
+    typedef struct UploadSpool UploadSpool;
+
+    typedef struct UploadSpoolEntry {
+        uint64_t sequence;
+        const char *idempotencyKey; // these three are valid until the spool is next used
+        const char *destination;
+        const uint8_t *body;
+        int64_t bodyLength;
+    } UploadSpoolEntry;
+
+    typedef struct UploadSpoolStatistics {
+        int pendingCount;
+        int segmentCount;
+        int64_t byteCount;
+    } UploadSpoolStatistics;
+
+    // Creates the directory if needed and drops any torn entry at the end. A new segment is started once the current
+    // one would grow past maximumSegmentSize bytes. Returns NULL if the directory can't be used.
+    UploadSpool *createUploadSpool(const char *directoryPath, int64_t maximumSegmentSize);
+    void deleteUploadSpool(UploadSpool *spool);
+
+    // Appends and syncs an entry. Returns its sequence number, or 0 if it couldn't be written.
+    uint64_t uploadSpoolEnqueue(UploadSpool *spool, const char *idempotencyKey, const char *destination, const uint8_t *body, int64_t bodyLength);
+
+    // The oldest entry that hasn't been acknowledged. Returns false if there isn't one or it can't be read.
+    bool uploadSpoolPeek(UploadSpool *spool, UploadSpoolEntry *entry);
+
+    // Acknowledges every entry up to and including sequence, and unlinks the segments that leaves empty. UINT64_MAX
+    // acknowledges everything.
+    bool uploadSpoolAcknowledge(UploadSpool *spool, uint64_t sequence);
+
+    UploadSpoolStatistics uploadSpoolStatistics(UploadSpool *spool);
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UploadSpool_h */
@@ -45,7 +45,8 @@ public class TestClassificationManager : ClassificationManager {
         let _ = PredictedActivity(activityType: predictionTemplate.activityType, confidence: predictionTemplate.confidence, prediction: prediction)
         predictionAggregator.predictions.insert(prediction)
         
-        predictionAggregator.updateAggregatePredictedActivity()
+        predictionAggregator.addToAggregatePredictedActivity(prediction)
+        predictionAggregator.finishAggregatePredictedActivity()
         
         handler(predictionAggregator)
         